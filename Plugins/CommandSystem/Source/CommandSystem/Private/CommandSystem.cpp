@@ -2,6 +2,7 @@
 
 #include "CommandSystem.h"
 #include "Common/UdpSocketBuilder.h"
+#include "Async/Async.h"
 
 
 TMap<FName,TSubclassOf<UCommandBase>> FCommandBaseFactory::CommandFactoryMap;
@@ -42,7 +43,8 @@ FNetworkServer::~FNetworkServer()
 
 uint32 FNetworkServer::Run()
 {
-    const int32 BufferSize = 1024;
+    //UDP数据报的最大长度,避免截断
+    const int32 BufferSize = 65507;
     TArray<uint8> ReceiveBuffer;
     ReceiveBuffer.SetNumUninitialized(BufferSize);
 
@@ -66,8 +68,9 @@ uint32 FNetworkServer::Run()
 
 bool FNetworkServer::ParseDatagram(const TArray<uint8>& DataBuffer)
 {
-    // 转换为字符串
-    FString JsonString = FString((reinterpret_cast<const char*>(DataBuffer.GetData())));
+    // 转换为字符串,按长度转换,数据报不一定以'\0'结尾
+    const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(DataBuffer.GetData()), DataBuffer.Num());
+    FString JsonString(Converter.Length(), Converter.Get());
     if (JsonString.Len() > 0)
     {
         OnDataReceived.ExecuteIfBound(JsonString);
@@ -123,18 +126,36 @@ void UCommandSystem::Initialize(FSubsystemCollectionBase& Collection)
 {
     UGameInstanceSubsystem::Initialize(Collection);
     //初始化网络模块.
-    NetworkServer = new FNetworkServer(7751);
+    NetworkServer = new FNetworkServer(UdpServerPort);
     NetworkServer->OnDataReceived.BindUObject(this, &UCommandSystem::OnReceiveCommand_ThreadSafe);
+    if (bEnableFramedServer)
+    {
+        FramedServer = new FFramedCommandServer(FramedServerPort);
+        FramedServer->OnFrameReceived.BindUObject(this, &UCommandSystem::OnReceiveFrame_ThreadSafe);
+    }
     FCommandBaseFactory::CommandFactoryMap.Append(CommandFactoryMap);
     FCommandBaseFactory::CommandFactoryMap.Append(FCommandBaseFactory::NativeCommandFactoryMap);
 }
 
 void UCommandSystem::Deinitialize()
 {
+    //等待后台IO阶段结束,它们持有命令对象指针
+    while (NumRunningAsyncPhases.GetValue() > 0)
+    {
+        FPlatformProcess::Sleep(0.001f);
+    }
+    InFlightCommands.Reset();
+    CommandObjectPools.Reset();
+
     UGameInstanceSubsystem::Deinitialize();
     FCommandBaseFactory::CommandFactoryMap.Reset();
     NetworkServer->Stop();
     delete NetworkServer;
+    if (FramedServer)
+    {
+        delete FramedServer;
+        FramedServer = nullptr;
+    }
 }
 
 void UCommandSystem::Tick(float DeltaTime)
@@ -148,13 +169,93 @@ void UCommandSystem::Tick(float DeltaTime)
         {
             break;
         }
+        ++CurrentHandleCommandCount;
+
         //Handle Command
-        UCommandBase* CommandBase = FCommandBaseFactory::CreateCommandProcessObject(this,CommandDescribe.CommandTypeName);
+        UCommandBase* CommandBase = AcquireCommandObject(CommandDescribe.CommandTypeName);
+        if (!CommandBase)
+        {
+            continue;
+        }
+
+        const uint64 Sequence = NextCommandSequence++;
+        FInFlightCommand& InFlightCommand = InFlightCommands.Add(Sequence);
+        InFlightCommand.Command = CommandBase;
+        InFlightCommand.CommandDesc = MoveTemp(CommandDescribe);
+        InFlightCommand.bReadyToApply = !CommandBase->HasAsyncPhase();
+
+        if (!InFlightCommand.bReadyToApply)
+        {
+            //IO阶段在后台线程池执行,命令对象由InFlightCommands保持引用
+            NumRunningAsyncPhases.Increment();
+            AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, CommandBase, CommandDesc = InFlightCommand.CommandDesc, Sequence]()
+            {
+                CommandBase->PrepareCommand_AnyThread(CommandDesc);
+                CompletedAsyncCommands.Enqueue(Sequence);
+                NumRunningAsyncPhases.Decrement();
+            });
+        }
+    }
+
+    ApplyReadyCommands();
+}
+
+void UCommandSystem::ApplyReadyCommands()
+{
+    uint64 CompletedSequence = 0;
+    while (CompletedAsyncCommands.Dequeue(CompletedSequence))
+    {
+        if (FInFlightCommand* InFlightCommand = InFlightCommands.Find(CompletedSequence))
+        {
+            InFlightCommand->bReadyToApply = true;
+        }
+    }
+
+    //保持命令的到达顺序,前面的命令IO未完成时后面的命令等待
+    while (FInFlightCommand* InFlightCommand = InFlightCommands.Find(NextApplySequence))
+    {
+        if (!InFlightCommand->bReadyToApply)
+        {
+            break;
+        }
+        UCommandBase* CommandBase = InFlightCommand->Command;
+        const FCommandDescribe CommandDesc = MoveTemp(InFlightCommand->CommandDesc);
+        InFlightCommands.Remove(NextApplySequence);
+        ++NextApplySequence;
+
         if (CommandBase)
         {
-            CommandBase->ProcessCommand(CommandDescribe);
+            CommandBase->ApplyCommand(CommandDesc);
+            ReleaseCommandObject(CommandBase);
         }
-        ++CurrentHandleCommandCount;
+    }
+}
+
+UCommandBase* UCommandSystem::AcquireCommandObject(FName CommandType)
+{
+    const TSubclassOf<UCommandBase>* CommandClass = FCommandBaseFactory::CommandFactoryMap.Find(CommandType);
+    if (!CommandClass || !*CommandClass)
+    {
+        return nullptr;
+    }
+
+    if (FCommandObjectPool* Pool = CommandObjectPools.Find(*CommandClass))
+    {
+        if (Pool->FreeObjects.Num() > 0)
+        {
+            return Pool->FreeObjects.Pop(false);
+        }
+    }
+    return FCommandBaseFactory::CreateCommandProcessObject(this, CommandType);
+}
+
+void UCommandSystem::ReleaseCommandObject(UCommandBase* CommandBase)
+{
+    CommandBase->ResetCommand();
+    FCommandObjectPool& Pool = CommandObjectPools.FindOrAdd(CommandBase->GetClass());
+    if (Pool.FreeObjects.Num() < MaxPooledObjectsPerType)
+    {
+        Pool.FreeObjects.Add(CommandBase);
     }
 }
 
@@ -165,27 +266,86 @@ void UCommandSystem::PushCommandByString(const FString& JsonParam)
 
 void UCommandSystem::OnReceiveCommand_ThreadSafe(const FString& JsonString)
 {
-    TSharedPtr<FJsonObject> JsonObject;
+    if (EnqueueCommandsFromJson(JsonString, nullptr) == 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Invalid UDP datagram received"));
+    }
+}
+
+int32 UCommandSystem::OnReceiveFrame_ThreadSafe(const FString& Json, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Payload)
+{
+    const int32 NumEnqueued = EnqueueCommandsFromJson(Json, Payload);
+    if (NumEnqueued == 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Invalid command frame received"));
+    }
+    return NumEnqueued;
+}
+
+int32 UCommandSystem::EnqueueCommandsFromJson(const FString& JsonString, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Payload)
+{
+    TSharedPtr<FJsonValue> JsonValue;
     TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
-    if (FJsonSerializer::Deserialize(Reader, JsonObject))
+    if (!FJsonSerializer::Deserialize(Reader, JsonValue) || !JsonValue.IsValid())
+    {
+        return 0;
+    }
+
+    //支持单个命令或命令数组(批量)
+    TArray<TSharedPtr<FJsonValue>> CommandValues;
+    if (JsonValue->Type == EJson::Array)
+    {
+        CommandValues = JsonValue->AsArray();
+    }
+    else if (JsonValue->Type == EJson::Object)
     {
-        
+        CommandValues.Add(JsonValue);
+    }
+
+    int32 NumEnqueued = 0;
+    for (const TSharedPtr<FJsonValue>& CommandValue : CommandValues)
+    {
+        const TSharedPtr<FJsonObject>* JsonObject = nullptr;
         FCommandDescribe CommandDescribe;
-        FString CommandTypeName;
-        //todo 反射封装
-        if (JsonObject->TryGetStringField(TEXT("voice_file"), CommandDescribe.VoiceSourceFileFullPath) &&
-            JsonObject->TryGetStringField(TEXT("expression_type"), CommandDescribe.ExpressionType) &&
-            JsonObject->TryGetStringField(TEXT("animation_type"), CommandDescribe.AnimationType)&&
-            JsonObject->TryGetStringField(TEXT("cmd_type"),CommandTypeName))
+        if (CommandValue.IsValid() && CommandValue->TryGetObject(JsonObject) && ParseCommandObject(*JsonObject, Payload, CommandDescribe))
         {
-            CommandDescribe.CommandTypeName = FName(CommandTypeName);
-            PendingCommands.Enqueue(CommandDescribe);
+            PendingCommands.Enqueue(MoveTemp(CommandDescribe));
+            ++NumEnqueued;
         }
     }
-    else
+    return NumEnqueued;
+}
+
+bool UCommandSystem::ParseCommandObject(const TSharedPtr<FJsonObject>& JsonObject, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Payload, FCommandDescribe& OutCommandDescribe)
+{
+    FString CommandTypeName;
+    //todo 反射封装
+    if (!JsonObject->TryGetStringField(TEXT("cmd_type"), CommandTypeName))
     {
-        UE_LOG(LogTemp, Error, TEXT("Invalid UDP datagram received"));
+        return false;
     }
+    OutCommandDescribe.CommandTypeName = FName(CommandTypeName);
+    JsonObject->TryGetStringField(TEXT("voice_file"), OutCommandDescribe.VoiceSourceFileFullPath);
+    JsonObject->TryGetStringField(TEXT("expression_type"), OutCommandDescribe.ExpressionType);
+    JsonObject->TryGetStringField(TEXT("animation_type"), OutCommandDescribe.AnimationType);
+
+    //内联音频:引用帧载荷的一段,未指定范围时使用整个载荷
+    if (Payload.IsValid() && Payload->Num() > 0)
+    {
+        int32 PayloadOffset = 0;
+        int32 PayloadSize = Payload->Num();
+        JsonObject->TryGetNumberField(TEXT("payload_offset"), PayloadOffset);
+        JsonObject->TryGetNumberField(TEXT("payload_size"), PayloadSize);
+        if (PayloadOffset < 0 || PayloadSize < 0 || PayloadOffset > Payload->Num() - PayloadSize)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Command payload range out of bounds (offset %d, size %d, payload %d)"), PayloadOffset, PayloadSize, Payload->Num());
+            return false;
+        }
+        OutCommandDescribe.InlinePayload = Payload;
+        OutCommandDescribe.InlinePayloadOffset = PayloadOffset;
+        OutCommandDescribe.InlinePayloadSize = PayloadSize;
+    }
+    return true;
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,373 @@
+#include "CommandTransport.h"
+#include "CommandSystem.h"
+
+#include "Async/Async.h"
+#include "Common/TcpSocketBuilder.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace
+{
+    bool SendAll(FSocket* Socket, const uint8* Data, int32 Size)
+    {
+        int32 TotalSent = 0;
+        while (TotalSent < Size)
+        {
+            int32 BytesSent = 0;
+            if (!Socket->Send(Data + TotalSent, Size - TotalSent, BytesSent))
+            {
+                if (ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() != SE_EWOULDBLOCK)
+                {
+                    return false;
+                }
+                FPlatformProcess::Sleep(0.f);
+                continue;
+            }
+            TotalSent += BytesSent;
+        }
+        return true;
+    }
+
+    bool RecvAll(FSocket* Socket, uint8* Data, int32 Size)
+    {
+        int32 TotalRead = 0;
+        while (TotalRead < Size)
+        {
+            int32 BytesRead = 0;
+            if (!Socket->Recv(Data + TotalRead, Size - TotalRead, BytesRead, ESocketReceiveFlags::WaitAll) || BytesRead <= 0)
+            {
+                return false;
+            }
+            TotalRead += BytesRead;
+        }
+        return true;
+    }
+
+    FAutoConsoleCommand LoopbackBenchmarkCommand(
+        TEXT("CommandSystem.LoopbackBenchmark"),
+        TEXT("Measures framed command transport throughput/latency over loopback. Args: [NumFrames=200] [CommandsPerFrame=10] [PayloadKBPerCommand=64]"),
+        FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+        {
+            const int32 NumFrames = Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : 200;
+            const int32 CommandsPerFrame = Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : 10;
+            const int32 PayloadKBPerCommand = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 64;
+            const int32 Port = GetDefault<UCommandSystem>()->GetFramedServerPort();
+            //在后台执行,避免阻塞游戏线程
+            Async(EAsyncExecution::Thread, [Port, NumFrames, CommandsPerFrame, PayloadKBPerCommand]()
+            {
+                CommandTransport::RunLoopbackBenchmark(Port, NumFrames, CommandsPerFrame, PayloadKBPerCommand);
+            });
+        }));
+}
+
+FFramedCommandServer::FFramedCommandServer(int32 Port)
+    : ServerPort(Port)
+{
+    ListenSocket = FTcpSocketBuilder(TEXT("FramedCommandServer"))
+        .AsReusable()
+        .AsNonBlocking()
+        .BoundToPort(ServerPort)
+        .Listening(8)
+        .Build();
+
+    if (!ListenSocket)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create framed command server on port %d"), ServerPort);
+    }
+    Thread = FRunnableThread::Create(this, TEXT("FramedCommandServerThread"));
+}
+
+FFramedCommandServer::~FFramedCommandServer()
+{
+    Stop();
+    if (Thread)
+    {
+        Thread->Kill(true);
+        delete Thread;
+        Thread = nullptr;
+    }
+    for (FClientConnection& Client : Clients)
+    {
+        CloseClient(Client);
+    }
+    if (ListenSocket)
+    {
+        ListenSocket->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(ListenSocket);
+        ListenSocket = nullptr;
+    }
+}
+
+uint32 FFramedCommandServer::Run()
+{
+    while (bRunning)
+    {
+        bool bDidWork = false;
+
+        //接受新连接
+        bool bHasPendingConnection = false;
+        if (ListenSocket && ListenSocket->HasPendingConnection(bHasPendingConnection) && bHasPendingConnection)
+        {
+            if (FSocket* ClientSocket = ListenSocket->Accept(TEXT("FramedCommandClient")))
+            {
+                ClientSocket->SetNonBlocking(true);
+                ClientSocket->SetNoDelay(true);
+                FClientConnection& Client = Clients.AddDefaulted_GetRef();
+                Client.Socket = ClientSocket;
+                bDidWork = true;
+            }
+        }
+
+        for (int32 ClientIndex = Clients.Num() - 1; ClientIndex >= 0; --ClientIndex)
+        {
+            if (!ReadFromClient(Clients[ClientIndex], bDidWork))
+            {
+                CloseClient(Clients[ClientIndex]);
+                Clients.RemoveAtSwap(ClientIndex);
+            }
+        }
+
+        if (!bDidWork)
+        {
+            if (Clients.Num() == 0 && ListenSocket)
+            {
+                ListenSocket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(100));
+            }
+            else
+            {
+                FPlatformProcess::Sleep(0.001f);
+            }
+        }
+    }
+    return 0;
+}
+
+void FFramedCommandServer::Stop()
+{
+    bRunning = false;
+}
+
+bool FFramedCommandServer::ReadFromClient(FClientConnection& Client, bool& bOutReceivedData)
+{
+    while (bRunning)
+    {
+        //按状态决定读取目标,载荷直接读入最终的共享缓冲区,不做中间拷贝
+        uint8* Destination = nullptr;
+        int32 BytesWanted = 0;
+        if (Client.HeaderBytesRead < CommandTransport::FrameHeaderSize)
+        {
+            Destination = Client.Header + Client.HeaderBytesRead;
+            BytesWanted = CommandTransport::FrameHeaderSize - Client.HeaderBytesRead;
+        }
+        else if (Client.JsonBytesRead < Client.JsonBuffer.Num())
+        {
+            Destination = Client.JsonBuffer.GetData() + Client.JsonBytesRead;
+            BytesWanted = Client.JsonBuffer.Num() - Client.JsonBytesRead;
+        }
+        else if (Client.Payload.IsValid() && Client.PayloadBytesRead < Client.PayloadSize)
+        {
+            //缓冲区已写满但帧还没收完时扩容,避免仅凭帧头就分配最大载荷
+            if (Client.PayloadBytesRead == Client.Payload->Num())
+            {
+                Client.Payload->SetNumUninitialized(FMath::Min(Client.PayloadSize, FMath::Max(Client.Payload->Num() * 2, CommandTransport::InitialPayloadBufferSize)));
+            }
+            Destination = Client.Payload->GetData() + Client.PayloadBytesRead;
+            BytesWanted = Client.Payload->Num() - Client.PayloadBytesRead;
+        }
+
+        if (BytesWanted > 0)
+        {
+            int32 BytesRead = 0;
+            if (!Client.Socket->Recv(Destination, BytesWanted, BytesRead))
+            {
+                //只有EWOULDBLOCK以外的错误才视为断开
+                return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EWOULDBLOCK;
+            }
+            if (BytesRead <= 0)
+            {
+                //非阻塞套接字读到0字节表示暂无数据,下次循环再读
+                return true;
+            }
+            bOutReceivedData = true;
+
+            if (Client.HeaderBytesRead < CommandTransport::FrameHeaderSize)
+            {
+                Client.HeaderBytesRead += BytesRead;
+                if (Client.HeaderBytesRead < CommandTransport::FrameHeaderSize)
+                {
+                    continue;
+                }
+
+                uint32 JsonSize = 0;
+                uint32 PayloadSize = 0;
+                FMemory::Memcpy(&Client.FrameId, Client.Header, sizeof(uint32));
+                FMemory::Memcpy(&JsonSize, Client.Header + 4, sizeof(uint32));
+                FMemory::Memcpy(&PayloadSize, Client.Header + 8, sizeof(uint32));
+                if (JsonSize > CommandTransport::MaxJsonSize || PayloadSize > CommandTransport::MaxPayloadSize)
+                {
+                    UE_LOG(LogTemp, Error, TEXT("Framed command too large (json %u bytes, payload %u bytes), closing connection"), JsonSize, PayloadSize);
+                    return false;
+                }
+                Client.JsonBuffer.SetNumUninitialized(JsonSize);
+                Client.JsonBytesRead = 0;
+                Client.Payload.Reset();
+                Client.PayloadBytesRead = 0;
+                Client.PayloadSize = static_cast<int32>(PayloadSize);
+                if (PayloadSize > 0)
+                {
+                    Client.Payload = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+                    Client.Payload->SetNumUninitialized(FMath::Min(Client.PayloadSize, CommandTransport::InitialPayloadBufferSize));
+                }
+            }
+            else if (Client.JsonBytesRead < Client.JsonBuffer.Num())
+            {
+                Client.JsonBytesRead += BytesRead;
+            }
+            else
+            {
+                Client.PayloadBytesRead += BytesRead;
+            }
+        }
+
+        const bool bFrameComplete = Client.HeaderBytesRead == CommandTransport::FrameHeaderSize
+            && Client.JsonBytesRead == Client.JsonBuffer.Num()
+            && (!Client.Payload.IsValid() || Client.PayloadBytesRead == Client.PayloadSize);
+        if (!bFrameComplete)
+        {
+            continue;
+        }
+        DispatchFrame(Client);
+    }
+    return true;
+}
+
+void FFramedCommandServer::DispatchFrame(FClientConnection& Client)
+{
+    //按长度转换,不依赖结尾的'\0'
+    const FUTF8ToTCHAR JsonConverter(reinterpret_cast<const ANSICHAR*>(Client.JsonBuffer.GetData()), Client.JsonBuffer.Num());
+    const FString Json(JsonConverter.Length(), JsonConverter.Get());
+
+    const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Payload = MoveTemp(Client.Payload);
+    const int32 NumAccepted = OnFrameReceived.IsBound() ? OnFrameReceived.Execute(Json, Payload) : 0;
+
+    uint8 Ack[CommandTransport::AckSize];
+    FMemory::Memcpy(Ack, &Client.FrameId, sizeof(uint32));
+    FMemory::Memcpy(Ack + 4, &NumAccepted, sizeof(int32));
+    SendAll(Client.Socket, Ack, CommandTransport::AckSize);
+
+    Client.HeaderBytesRead = 0;
+    Client.JsonBuffer.Reset();
+    Client.JsonBytesRead = 0;
+    Client.Payload.Reset();
+    Client.PayloadBytesRead = 0;
+    Client.PayloadSize = 0;
+}
+
+void FFramedCommandServer::CloseClient(FClientConnection& Client)
+{
+    if (Client.Socket)
+    {
+        Client.Socket->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Client.Socket);
+        Client.Socket = nullptr;
+    }
+}
+
+void CommandTransport::RunLoopbackBenchmark(int32 Port, int32 NumFrames, int32 CommandsPerFrame, int32 PayloadKBPerCommand)
+{
+    NumFrames = FMath::Max(NumFrames, 1);
+    CommandsPerFrame = FMath::Max(CommandsPerFrame, 1);
+    const int32 PayloadBytesPerCommand = FMath::Max(PayloadKBPerCommand, 0) * 1024;
+
+    ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    FSocket* Socket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("CommandLoopbackBenchmark"), false);
+    if (!Socket)
+    {
+        UE_LOG(LogTemp, Error, TEXT("LoopbackBenchmark: failed to create socket"));
+        return;
+    }
+    Socket->SetNoDelay(true);
+
+    const TSharedRef<FInternetAddr> Address = SocketSubsystem->CreateInternetAddr();
+    Address->SetLoopbackAddress();
+    Address->SetPort(Port);
+    if (!Socket->Connect(*Address))
+    {
+        UE_LOG(LogTemp, Error, TEXT("LoopbackBenchmark: failed to connect to port %d"), Port);
+        SocketSubsystem->DestroySocket(Socket);
+        return;
+    }
+
+    //批量帧:一个Json数组 + 所有命令共享的载荷
+    FString Json = TEXT("[");
+    for (int32 CommandIndex = 0; CommandIndex < CommandsPerFrame; ++CommandIndex)
+    {
+        Json += FString::Printf(TEXT("%s{\"cmd_type\":\"Command_LoopbackBenchmark\",\"payload_offset\":%d,\"payload_size\":%d}"),
+            CommandIndex > 0 ? TEXT(",") : TEXT(""), CommandIndex * PayloadBytesPerCommand, PayloadBytesPerCommand);
+    }
+    Json += TEXT("]");
+    const FTCHARToUTF8 JsonUTF8(*Json);
+    const uint32 JsonSize = JsonUTF8.Length();
+    const uint32 PayloadSize = static_cast<uint32>(PayloadBytesPerCommand) * CommandsPerFrame;
+
+    TArray<uint8> Frame;
+    Frame.SetNumUninitialized(FrameHeaderSize + JsonSize + PayloadSize);
+    FMemory::Memcpy(Frame.GetData() + 4, &JsonSize, sizeof(uint32));
+    FMemory::Memcpy(Frame.GetData() + 8, &PayloadSize, sizeof(uint32));
+    FMemory::Memcpy(Frame.GetData() + FrameHeaderSize, JsonUTF8.Get(), JsonSize);
+    for (uint32 ByteIndex = 0; ByteIndex < PayloadSize; ++ByteIndex)
+    {
+        Frame[FrameHeaderSize + JsonSize + ByteIndex] = static_cast<uint8>(ByteIndex * 31);
+    }
+
+    TArray<double> Latencies;
+    Latencies.Reserve(NumFrames);
+    int64 TotalAccepted = 0;
+    const double StartTime = FPlatformTime::Seconds();
+    for (uint32 FrameId = 0; FrameId < static_cast<uint32>(NumFrames); ++FrameId)
+    {
+        FMemory::Memcpy(Frame.GetData(), &FrameId, sizeof(uint32));
+        const double SendTime = FPlatformTime::Seconds();
+        uint8 Ack[AckSize];
+        if (!SendAll(Socket, Frame.GetData(), Frame.Num()) || !RecvAll(Socket, Ack, AckSize))
+        {
+            UE_LOG(LogTemp, Error, TEXT("LoopbackBenchmark: connection lost at frame %u"), FrameId);
+            break;
+        }
+        Latencies.Add((FPlatformTime::Seconds() - SendTime) * 1000.0);
+
+        uint32 AckFrameId = 0;
+        int32 NumAccepted = 0;
+        FMemory::Memcpy(&AckFrameId, Ack, sizeof(uint32));
+        FMemory::Memcpy(&NumAccepted, Ack + 4, sizeof(int32));
+        if (AckFrameId != FrameId)
+        {
+            UE_LOG(LogTemp, Error, TEXT("LoopbackBenchmark: out of order ack %u (expected %u)"), AckFrameId, FrameId);
+        }
+        TotalAccepted += NumAccepted;
+    }
+    const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+    Socket->Close();
+    SocketSubsystem->DestroySocket(Socket);
+
+    if (Latencies.Num() == 0)
+    {
+        return;
+    }
+    Latencies.Sort();
+    double SumLatency = 0.0;
+    for (const double Latency : Latencies)
+    {
+        SumLatency += Latency;
+    }
+    const double TotalMB = static_cast<double>(Frame.Num()) * Latencies.Num() / (1024.0 * 1024.0);
+    UE_LOG(LogTemp, Display, TEXT("LoopbackBenchmark: %d frames x %d commands x %d KB in %.3f s | %.1f MB/s | %.0f commands/s | accepted %lld"),
+        Latencies.Num(), CommandsPerFrame, PayloadKBPerCommand, ElapsedSeconds, TotalMB / ElapsedSeconds,
+        static_cast<double>(Latencies.Num()) * CommandsPerFrame / ElapsedSeconds, TotalAccepted);
+    UE_LOG(LogTemp, Display, TEXT("LoopbackBenchmark: frame round trip ms avg %.3f | p50 %.3f | p95 %.3f | max %.3f"),
+        SumLatency / Latencies.Num(), Latencies[Latencies.Num() / 2], Latencies[FMath::Min(Latencies.Num() - 1, Latencies.Num() * 95 / 100)], Latencies.Last());
+}
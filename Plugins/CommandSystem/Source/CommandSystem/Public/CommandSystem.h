@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CommandSystemDefine.h"
+#include "CommandTransport.h"
 #include "Modules/ModuleManager.h"
 #include "CommandSystem.generated.h"
 
@@ -42,6 +43,10 @@ private:
 
 //todo 使用GameAbilitySystem?
 
+//命令执行分为两个阶段:
+//1.PrepareCommand_AnyThread 在后台线程池执行,用于文件读取等耗时IO,只能访问命令自身的非UObject数据
+//2.ApplyCommand 在游戏线程执行,按命令到达顺序调用
+//命令对象由UCommandSystem池化复用,归还前调用ResetCommand
 UCLASS()
 class COMMANDSYSTEM_API UCommandBase : public UObject
 {
@@ -50,10 +55,54 @@ public:
 	UCommandBase();
 	virtual void ProcessCommand(const FCommandDescribe& CommandDesc) {};
 
+	//是否有需要在后台执行的IO阶段
+	virtual bool HasAsyncPhase() const { return false; }
+
+	//后台IO阶段
+	virtual void PrepareCommand_AnyThread(const FCommandDescribe& CommandDesc) {}
+
+	//游戏线程应用阶段,默认直接调用ProcessCommand
+	virtual void ApplyCommand(const FCommandDescribe& CommandDesc) { ProcessCommand(CommandDesc); }
+
+	//归还对象池前清理状态
+	virtual void ResetCommand() {}
+
 	//todo 
 	virtual bool HandleJsonParam(TSharedPtr<FJsonObject> JsonObject) { return false; };
 };
 
+//回环测试命令,走完整的入队/对象池/应用流程但不做任何事,cmd_type为"Command_LoopbackBenchmark"
+UCLASS()
+class COMMANDSYSTEM_API UCommand_LoopbackBenchmark : public UCommandBase
+{
+	GENERATED_BODY()
+public:
+	virtual void ApplyCommand(const FCommandDescribe& CommandDesc) override {}
+};
+
+USTRUCT()
+struct FCommandObjectPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<UCommandBase*> FreeObjects;
+};
+
+//执行中的命令
+USTRUCT()
+struct FInFlightCommand
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	UCommandBase* Command = nullptr;
+
+	FCommandDescribe CommandDesc;
+
+	bool bReadyToApply = false;
+};
+
 class FCommandBaseFactory
 {
 	friend class UCommandSystem;
@@ -79,16 +128,60 @@ public:
 	virtual void Tick(float DeltaTime) override;
 
 	void PushCommandByString(const FString& JsonParam);
+
+	int32 GetFramedServerPort() const { return FramedServerPort; }
 protected:
 	UPROPERTY(EditAnywhere,Config)
 	TMap<FName,TSubclassOf<UCommandBase>> CommandFactoryMap;
+
+	//UDP命令端口
+	UPROPERTY(EditAnywhere,Config)
+	int32 UdpServerPort = 7751;
+
+	//TCP分帧命令端口,支持批量命令和内联音频
+	UPROPERTY(EditAnywhere,Config)
+	bool bEnableFramedServer = true;
+
+	UPROPERTY(EditAnywhere,Config)
+	int32 FramedServerPort = 7752;
+
+	//每个命令类型池中保留的空闲对象上限
+	UPROPERTY(EditAnywhere,Config)
+	int32 MaxPooledObjectsPerType = 16;
 private:
 
 	//线程安全.
 	void OnReceiveCommand_ThreadSafe(const FString& CommandDesc);
+	int32 OnReceiveFrame_ThreadSafe(const FString& Json, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Payload);
+
+	//解析单个命令或命令数组并入队,返回入队的命令数
+	int32 EnqueueCommandsFromJson(const FString& Json, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Payload);
+	static bool ParseCommandObject(const TSharedPtr<FJsonObject>& JsonObject, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& Payload, FCommandDescribe& OutCommandDescribe);
+
+	UCommandBase* AcquireCommandObject(FName CommandType);
+	void ReleaseCommandObject(UCommandBase* CommandBase);
+
+	//按到达顺序应用已完成IO阶段的命令
+	void ApplyReadyCommands();
 	
 	//FStallingTaskQueue<FCommandDescribe,PLATFORM_CACHE_LINE_SIZE,1> PendingCommands;
-	TQueue<FCommandDescribe, EQueueMode::Spsc> PendingCommands;
+	//网络线程和游戏线程(PushCommandByString)都会写入
+	TQueue<FCommandDescribe, EQueueMode::Mpsc> PendingCommands;
+
+	//命令对象池
+	UPROPERTY(Transient)
+	TMap<UClass*, FCommandObjectPool> CommandObjectPools;
+
+	//执行中的命令,按序号
+	UPROPERTY(Transient)
+	TMap<uint64, FInFlightCommand> InFlightCommands;
+
+	//后台IO阶段完成的命令序号
+	TQueue<uint64, EQueueMode::Mpsc> CompletedAsyncCommands;
+	FThreadSafeCounter NumRunningAsyncPhases;
+	uint64 NextCommandSequence = 0;
+	uint64 NextApplySequence = 0;
 	
 	FNetworkServer* NetworkServer = nullptr;
+	FFramedCommandServer* FramedServer = nullptr;
 };
@@ -16,4 +16,19 @@ public:
 	FString VoiceSourceFileFullPath;
 	FString ExpressionType;
 	FString AnimationType;
+
+	//内联音频数据(分帧传输时),同一帧的多个命令共享同一块缓冲区,不做拷贝
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> InlinePayload;
+	int32 InlinePayloadOffset = 0;
+	int32 InlinePayloadSize = 0;
+
+	bool HasInlinePayload() const
+	{
+		return InlinePayload.IsValid() && InlinePayloadSize > 0;
+	}
+
+	TArrayView<const uint8> GetInlinePayloadView() const
+	{
+		return HasInlinePayload() ? TArrayView<const uint8>(InlinePayload->GetData() + InlinePayloadOffset, InlinePayloadSize) : TArrayView<const uint8>();
+	}
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+
+class FSocket;
+
+//帧格式(小端):
+//  uint32 FrameId | uint32 JsonSize | uint32 PayloadSize | Json(UTF-8) | Payload(二进制)
+//Json可以是单个命令对象,也可以是命令数组(批量).命令通过payload_offset/payload_size引用Payload中的音频数据
+//服务器每收到一帧回复一个Ack: uint32 FrameId | int32 已接受的命令数
+namespace CommandTransport
+{
+	constexpr int32 FrameHeaderSize = 12;
+	constexpr int32 AckSize = 8;
+	constexpr uint32 MaxJsonSize = 1024 * 1024;
+	constexpr uint32 MaxPayloadSize = 256 * 1024 * 1024;
+	//载荷缓冲区的初始大小,之后随数据到达成倍增长,直到帧头声明的大小
+	constexpr int32 InitialPayloadBufferSize = 1024 * 1024;
+}
+
+//返回该帧中被接受的命令数
+DECLARE_DELEGATE_RetVal_TwoParams(int32, FOnFrameReceivedDelegate, const FString& /*Json*/, const TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>& /*Payload*/);
+
+//基于TCP的长度前缀分帧命令服务器,与UDP服务器并存,用于大数据量和需要可靠送达的命令
+class COMMANDSYSTEM_API FFramedCommandServer : public FRunnable
+{
+public:
+	FFramedCommandServer(int32 Port);
+	virtual ~FFramedCommandServer();
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	FOnFrameReceivedDelegate OnFrameReceived;
+
+	int32 GetPort() const { return ServerPort; }
+
+private:
+	struct FClientConnection
+	{
+		FSocket* Socket = nullptr;
+
+		//当前帧的读取状态
+		uint8 Header[CommandTransport::FrameHeaderSize];
+		int32 HeaderBytesRead = 0;
+		uint32 FrameId = 0;
+		TArray<uint8> JsonBuffer;
+		int32 JsonBytesRead = 0;
+		TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> Payload;
+		int32 PayloadBytesRead = 0;
+		//帧头声明的载荷大小
+		int32 PayloadSize = 0;
+	};
+
+	//读取连接上的可用数据,返回false表示连接需要关闭
+	bool ReadFromClient(FClientConnection& Client, bool& bOutReceivedData);
+	void DispatchFrame(FClientConnection& Client);
+	void CloseClient(FClientConnection& Client);
+
+	FRunnableThread* Thread = nullptr;
+	FSocket* ListenSocket = nullptr;
+	TArray<FClientConnection> Clients;
+	TAtomic<bool> bRunning{true};
+	int32 ServerPort;
+};
+
+//本机回环吞吐/延迟测试,通过控制台命令 CommandSystem.LoopbackBenchmark [帧数] [每帧命令数] [每条音频KB] 调用
+namespace CommandTransport
+{
+	COMMANDSYSTEM_API void RunLoopbackBenchmark(int32 Port, int32 NumFrames, int32 CommandsPerFrame, int32 PayloadKBPerCommand);
+}
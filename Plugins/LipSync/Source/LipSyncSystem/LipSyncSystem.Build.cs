@@ -19,9 +19,13 @@ public class LipSyncSystem : ModuleRules
 			}
 			);
 		
-		const string thirdPartyLibsDir = "$(PluginDir)/Source/ThirdParty/LipSyncSystemLibrary/Win64";
-		const string libName           = "KkLipSync";
-		const string source            = $"{thirdPartyLibsDir}/{libName}.dll";
-		RuntimeDependencies.Add(source);
+		// The OVR lip-sync library only exists for Windows, other platforms use the built-in viseme estimator
+		if (Target.Platform == UnrealTargetPlatform.Win64)
+		{
+			const string thirdPartyLibsDir = "$(PluginDir)/Source/ThirdParty/LipSyncSystemLibrary/Win64";
+			const string libName           = "KkLipSync";
+			const string source            = $"{thirdPartyLibsDir}/{libName}.dll";
+			RuntimeDependencies.Add(source);
+		}
 	}
 }
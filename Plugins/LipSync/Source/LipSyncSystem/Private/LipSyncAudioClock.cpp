@@ -0,0 +1,197 @@
+﻿// Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
+
+#include "LipSyncAudioClock.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogLssClock, Log, All);
+DEFINE_LOG_CATEGORY(LogLssClock);
+
+namespace
+{
+	// Reported positions differing from the estimate by more than this are treated as a seek or a hitch and snapped to
+	constexpr double MaxSlewableError = 0.1;
+
+	// Time over which the difference to a new report is slewed out
+	constexpr double SlewTime = 0.05;
+
+	// The clock stops extrapolating when the reports stop, e.g. when the sound is paused or starving
+	constexpr double MaxExtrapolation = 0.1;
+
+	// MeasureDrift thresholds. The jitter of the clock must stay below this fraction of the buffer duration,
+	// and the clock may lag the raw reports by at most this many seconds on average
+	constexpr double MaxJitterPerBuffer = 0.3;
+	constexpr double MaxAddedLatency = 0.001;
+
+	FAutoConsoleCommand LssMeasureDriftCommand(
+		TEXT("lss.Clock.MeasureDrift"),
+		TEXT("Simulates lip-sync clock drift. Arguments: [BufferMs=21.3] [FrameMs=16.7] [DurationSec=60]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const double BufferMs = Args.Num() > 0 ? FCString::Atod(*Args[0]) : 1024.0 / 48.0;
+			const double FrameMs = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 1000.0 / 60.0;
+			const double DurationSec = Args.Num() > 2 ? FCString::Atod(*Args[2]) : 60.0;
+			if (!FLipSyncAudioClock::MeasureDrift(BufferMs, FrameMs, DurationSec))
+			{
+				UE_LOG(LogLssClock, Error, TEXT("lss.Clock.MeasureDrift. FAILED"));
+			}
+			else
+			{
+				UE_LOG(LogLssClock, Display, TEXT("lss.Clock.MeasureDrift. PASSED"));
+			}
+		}));
+}
+
+void FLipSyncAudioClock::Reset()
+{
+	bHasPosition = false;
+	AnchorAudioTime = 0.0;
+	AnchorWallTime = 0.0;
+	Correction = 0.0;
+	LastPlaybackTime = 0.0;
+}
+
+double FLipSyncAudioClock::EstimateAt(double WallTime) const
+{
+	const double Elapsed = FMath::Max(WallTime - AnchorWallTime, 0.0);
+	const double Decay = FMath::Max(1.0 - Elapsed / SlewTime, 0.0);
+	return AnchorAudioTime + FMath::Min(Elapsed, MaxExtrapolation) * Rate + Correction * Decay;
+}
+
+void FLipSyncAudioClock::OnAudioPosition(double AudioTime, double WallTime)
+{
+	if (!bHasPosition)
+	{
+		bHasPosition = true;
+		Correction = 0.0;
+		LastPlaybackTime = AudioTime;
+	}
+	else
+	{
+		// Keep the estimate continuous, the error to the report is slewed out instead of jumping
+		Correction = EstimateAt(WallTime) - AudioTime;
+		if (FMath::Abs(Correction) > MaxSlewableError)
+		{
+			Correction = 0.0;
+			LastPlaybackTime = AudioTime;
+		}
+	}
+	AnchorAudioTime = AudioTime;
+	AnchorWallTime = WallTime;
+}
+
+double FLipSyncAudioClock::GetPlaybackTime(double WallTime)
+{
+	if (!bHasPosition)
+	{
+		return 0.0;
+	}
+	LastPlaybackTime = FMath::Max(LastPlaybackTime, EstimateAt(WallTime));
+	return LastPlaybackTime;
+}
+
+bool FLipSyncAudioClock::MeasureDrift(double BufferDurationMs, double FrameDurationMs, double DurationSec)
+{
+	if (BufferDurationMs <= 0.0 || FrameDurationMs <= 0.0 || DurationSec <= 0.0)
+	{
+		UE_LOG(LogLssClock, Error, TEXT("MeasureDrift. Invalid arguments"));
+		return false;
+	}
+
+	// Fixed seed, so runs with the same arguments are comparable
+	FRandomStream Random(1234);
+	const double BufferDuration = BufferDurationMs / 1000.0;
+	const double FrameDuration = FrameDurationMs / 1000.0;
+
+	FLipSyncAudioClock Clock;
+	double LastReportedTime = 0.0;
+	int32 NumOfReportedBuffers = 0;
+
+	// Each buffer is delivered to the game thread after a variable delay, drawn once when the buffer is rendered
+	double NextDeliveryTime = BufferDuration + Random.FRandRange(0.f, 0.5f) * BufferDuration;
+
+	// Errors are measured against the true position, the constant part is the reporting latency and is reported separately
+	double ClockErrorSum = 0.0, ClockErrorSquaredSum = 0.0, ClockMaxError = -DBL_MAX, ClockMinError = DBL_MAX;
+	double RawErrorSum = 0.0, RawErrorSquaredSum = 0.0, RawMaxError = -DBL_MAX, RawMinError = DBL_MAX;
+	int32 NumOfClockFrameMismatches = 0, NumOfRawFrameMismatches = 0, NumOfFrames = 0;
+
+	for (double WallTime = 0.0; WallTime < DurationSec; WallTime += FrameDuration * Random.FRandRange(0.8f, 1.2f))
+	{
+		// Buffers rendered by the mixer are delivered to the game thread at the first frame after their delivery time
+		while (NextDeliveryTime <= WallTime)
+		{
+			++NumOfReportedBuffers;
+			LastReportedTime = NumOfReportedBuffers * BufferDuration;
+			Clock.OnAudioPosition(LastReportedTime, WallTime);
+			NextDeliveryTime = (NumOfReportedBuffers + 1) * BufferDuration + Random.FRandRange(0.f, 0.5f) * BufferDuration;
+		}
+		if (!Clock.HasPosition())
+		{
+			continue;
+		}
+
+		const double ClockError = Clock.GetPlaybackTime(WallTime) - WallTime;
+		const double RawError = LastReportedTime - WallTime;
+
+		ClockErrorSum += ClockError;
+		ClockErrorSquaredSum += ClockError * ClockError;
+		ClockMaxError = FMath::Max(ClockMaxError, ClockError);
+		ClockMinError = FMath::Min(ClockMinError, ClockError);
+		RawErrorSum += RawError;
+		RawErrorSquaredSum += RawError * RawError;
+		RawMaxError = FMath::Max(RawMaxError, RawError);
+		RawMinError = FMath::Min(RawMinError, RawError);
+
+		// Frames of the 10 ms lip-sync sequence that differ from the one at the true position
+		const int32 TrueFrame = FMath::FloorToInt(WallTime * 100.0);
+		NumOfClockFrameMismatches += FMath::FloorToInt(Clock.GetPlaybackTime(WallTime) * 100.0) != TrueFrame ? 1 : 0;
+		NumOfRawFrameMismatches += FMath::FloorToInt(LastReportedTime * 100.0) != TrueFrame ? 1 : 0;
+		++NumOfFrames;
+	}
+
+	if (NumOfFrames == 0)
+	{
+		UE_LOG(LogLssClock, Warning, TEXT("MeasureDrift. No frames were simulated"));
+		return false;
+	}
+
+	auto LogStats = [NumOfFrames](const TCHAR* Name, double Sum, double SquaredSum, double MinError, double MaxError, int32 NumOfMismatches)
+	{
+		const double Mean = Sum / NumOfFrames;
+		const double StdDev = FMath::Sqrt(FMath::Max(SquaredSum / NumOfFrames - Mean * Mean, 0.0));
+		UE_LOG(LogLssClock, Display, TEXT("%s: latency %.2f ms, jitter %.2f ms (std dev), range %.2f..%.2f ms, wrong sequence frame %.1f%%"),
+			Name, -Mean * 1000.0, StdDev * 1000.0, MinError * 1000.0, MaxError * 1000.0, 100.0 * NumOfMismatches / NumOfFrames);
+	};
+
+	UE_LOG(LogLssClock, Display, TEXT("MeasureDrift. Buffer %.2f ms, frame %.2f ms, %d frames"), BufferDurationMs, FrameDurationMs, NumOfFrames);
+	LogStats(TEXT("Raw reports"), RawErrorSum, RawErrorSquaredSum, RawMinError, RawMaxError, NumOfRawFrameMismatches);
+	LogStats(TEXT("Audio clock"), ClockErrorSum, ClockErrorSquaredSum, ClockMinError, ClockMaxError, NumOfClockFrameMismatches);
+
+	auto GetJitter = [NumOfFrames](double Sum, double SquaredSum)
+	{
+		const double Mean = Sum / NumOfFrames;
+		return FMath::Sqrt(FMath::Max(SquaredSum / NumOfFrames - Mean * Mean, 0.0));
+	};
+	const double ClockJitter = GetJitter(ClockErrorSum, ClockErrorSquaredSum);
+	const double RawJitter = GetJitter(RawErrorSum, RawErrorSquaredSum);
+	const double AddedLatency = (RawErrorSum - ClockErrorSum) / NumOfFrames;
+
+	bool bPassed = true;
+	if (ClockJitter >= RawJitter)
+	{
+		UE_LOG(LogLssClock, Error, TEXT("MeasureDrift. The clock jitter %.2f ms is not lower than the raw jitter %.2f ms"), ClockJitter * 1000.0, RawJitter * 1000.0);
+		bPassed = false;
+	}
+	if (ClockJitter > MaxJitterPerBuffer * BufferDuration)
+	{
+		UE_LOG(LogLssClock, Error, TEXT("MeasureDrift. The clock jitter %.2f ms exceeds %.2f ms"), ClockJitter * 1000.0, MaxJitterPerBuffer * BufferDuration * 1000.0);
+		bPassed = false;
+	}
+	if (AddedLatency > MaxAddedLatency)
+	{
+		UE_LOG(LogLssClock, Error, TEXT("MeasureDrift. The clock adds %.2f ms of latency to the raw reports"), AddedLatency * 1000.0);
+		bPassed = false;
+	}
+	return bPassed;
+}
@@ -0,0 +1,298 @@
+﻿// Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
+
+#include "LipSyncSequenceCache.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/Archive.h"
+#include "Templates/UniquePtr.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogLssCache, Log, All);
+DEFINE_LOG_CATEGORY(LogLssCache);
+
+namespace
+{
+	constexpr uint32 CACHE_FILE_MAGIC{0x4353534C}; // "LSSC"
+	constexpr int32 CACHE_FILE_VERSION{1};
+
+	FAutoConsoleCommand LssCacheStatsCommand(
+		TEXT("lss.Cache.Stats"),
+		TEXT("Prints lip-sync sequence cache hit/miss counters"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			UE_LOG(LogLssCache, Display, TEXT("%s"), *FLipSyncSequenceCache::Get().GetStats().ToString());
+		}));
+
+	FAutoConsoleCommand LssCacheClearCommand(
+		TEXT("lss.Cache.Clear"),
+		TEXT("Clears the lip-sync sequence cache (memory and disk)"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FLipSyncSequenceCache::Get().Clear(true);
+		}));
+}
+
+FString FLipSyncSequenceCacheStats::ToString() const
+{
+	return FString::Printf(TEXT("LipSync cache: lookups %lld, memory hits %lld, disk hits %lld, misses %lld, stores %lld, hit ratio %.1f%%, disk %lld entries / %.1f MB, disk evictions %lld"),
+		Lookups(), MemoryHits, DiskHits, Misses, Stores, HitRatio() * 100.f, DiskEntries, DiskBytes / (1024.0 * 1024.0), DiskEvictions);
+}
+
+FLipSyncSequenceCache& FLipSyncSequenceCache::Get()
+{
+	static FLipSyncSequenceCache Instance;
+	return Instance;
+}
+
+FLipSyncSequenceCache::FLipSyncSequenceCache()
+	: CacheDir(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LipSyncCache")))
+	, MemoryCache(MaxMemoryEntries)
+{
+}
+
+FString FLipSyncSequenceCache::MakeKey(const uint8* PCMData, int64 PCMDataSize, int32 NumChannels, uint32 SampleRate, const FString& ModelVersion)
+{
+	FSHA1 Sha;
+	Sha.Update(PCMData, PCMDataSize);
+	Sha.Update(reinterpret_cast<const uint8*>(&NumChannels), sizeof(NumChannels));
+	Sha.Update(reinterpret_cast<const uint8*>(&SampleRate), sizeof(SampleRate));
+	Sha.UpdateWithString(*ModelVersion, ModelVersion.Len());
+	Sha.Final();
+
+	FSHAHash Hash;
+	Sha.GetHash(Hash.Hash);
+	return Hash.ToString();
+}
+
+FString FLipSyncSequenceCache::GetModelVersion(const FString& ModelPath)
+{
+	const FMD5Hash ModelHash = FMD5Hash::HashFile(*ModelPath);
+	return ModelHash.IsValid() ? LexToString(ModelHash) : FString();
+}
+
+bool FLipSyncSequenceCache::Find(const FString& Key, TArray<FLipSyncFrame>& OutFrames)
+{
+	{
+		FScopeLock Lock(&MemoryCacheGuard);
+		if (const TArray<FLipSyncFrame>* Cached = MemoryCache.FindAndTouch(Key))
+		{
+			OutFrames = *Cached;
+			MemoryHits.Increment();
+			return true;
+		}
+	}
+
+	if (LoadFromDisk(Key, OutFrames))
+	{
+		TouchDiskEntry(Key);
+		FScopeLock Lock(&MemoryCacheGuard);
+		MemoryCache.Add(Key, OutFrames);
+		DiskHits.Increment();
+		return true;
+	}
+
+	Misses.Increment();
+	return false;
+}
+
+void FLipSyncSequenceCache::Add(const FString& Key, const TArray<FLipSyncFrame>& Frames)
+{
+	if (Frames.Num() == 0)
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&MemoryCacheGuard);
+		MemoryCache.Add(Key, Frames);
+	}
+
+	if (SaveToDisk(Key, Frames))
+	{
+		FScopeLock Lock(&DiskIndexGuard);
+		BuildDiskIndex_Locked();
+		AddDiskEntry_Locked(Key, IFileManager::Get().FileSize(*GetCacheFilePath(Key)));
+	}
+	else
+	{
+		UE_LOG(LogLssCache, Warning, TEXT("Failed to write lip-sync cache entry %s"), *Key);
+	}
+	Stores.Increment();
+}
+
+void FLipSyncSequenceCache::Clear(bool bClearDisk)
+{
+	{
+		FScopeLock Lock(&MemoryCacheGuard);
+		MemoryCache.Empty(MaxMemoryEntries);
+	}
+
+	if (bClearDisk)
+	{
+		FScopeLock Lock(&DiskIndexGuard);
+		IFileManager::Get().DeleteDirectory(*CacheDir, false, true);
+		DiskIndex.Reset();
+		DiskIndexBytes = 0;
+	}
+}
+
+FLipSyncSequenceCacheStats FLipSyncSequenceCache::GetStats() const
+{
+	FLipSyncSequenceCacheStats Stats;
+	Stats.MemoryHits = MemoryHits.GetValue();
+	Stats.DiskHits = DiskHits.GetValue();
+	Stats.Misses = Misses.GetValue();
+	Stats.Stores = Stores.GetValue();
+	Stats.DiskEvictions = DiskEvictions.GetValue();
+	{
+		FScopeLock Lock(&DiskIndexGuard);
+		Stats.DiskEntries = DiskIndex.Num();
+		Stats.DiskBytes = DiskIndexBytes;
+	}
+	return Stats;
+}
+
+FString FLipSyncSequenceCache::GetCacheFilePath(const FString& Key) const
+{
+	// Two-character fan-out keeps directories small
+	return FPaths::Combine(CacheDir, Key.Left(2), Key + TEXT(".lss"));
+}
+
+bool FLipSyncSequenceCache::LoadFromDisk(const FString& Key, TArray<FLipSyncFrame>& OutFrames) const
+{
+	const FString FilePath = GetCacheFilePath(Key);
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath, FILEREAD_Silent));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 NumFrames = 0;
+	*Reader << Magic << Version << NumFrames;
+	if (Magic != CACHE_FILE_MAGIC || Version != CACHE_FILE_VERSION || NumFrames <= 0)
+	{
+		UE_LOG(LogLssCache, Warning, TEXT("Ignoring stale lip-sync cache file %s"), *FilePath);
+		return false;
+	}
+
+	TArray<FLipSyncFrame> Frames;
+	Frames.SetNum(NumFrames);
+	for (FLipSyncFrame& Frame : Frames)
+	{
+		*Reader << Frame.VisemeScores << Frame.LaughterScore;
+	}
+
+	if (Reader->IsError())
+	{
+		UE_LOG(LogLssCache, Warning, TEXT("Corrupted lip-sync cache file %s"), *FilePath);
+		return false;
+	}
+
+	OutFrames = MoveTemp(Frames);
+	return true;
+}
+
+bool FLipSyncSequenceCache::SaveToDisk(const FString& Key, const TArray<FLipSyncFrame>& Frames) const
+{
+	const FString FilePath = GetCacheFilePath(Key);
+	const FString TempFilePath = FilePath + TEXT(".tmp");
+	{
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilePath));
+		if (!Writer)
+		{
+			return false;
+		}
+
+		uint32 Magic = CACHE_FILE_MAGIC;
+		int32 Version = CACHE_FILE_VERSION;
+		int32 NumFrames = Frames.Num();
+		*Writer << Magic << Version << NumFrames;
+		for (const FLipSyncFrame& Frame : Frames)
+		{
+			TArray<float> VisemeScores = Frame.VisemeScores;
+			float LaughterScore = Frame.LaughterScore;
+			*Writer << VisemeScores << LaughterScore;
+		}
+
+		if (!Writer->Close())
+		{
+			return false;
+		}
+	}
+
+	// Write-then-rename so a crash never leaves a half written entry behind
+	return IFileManager::Get().Move(*FilePath, *TempFilePath, true, true);
+}
+
+void FLipSyncSequenceCache::BuildDiskIndex_Locked()
+{
+	if (bDiskIndexBuilt)
+	{
+		return;
+	}
+	bDiskIndexBuilt = true;
+
+	IFileManager::Get().IterateDirectoryStatRecursively(*CacheDir, [this](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		if (!StatData.bIsDirectory && FPaths::GetExtension(Path) == TEXT("lss"))
+		{
+			FDiskEntry& Entry = DiskIndex.Add(FPaths::GetBaseFilename(Path));
+			Entry.Size = StatData.FileSize;
+			Entry.LastAccess = StatData.ModificationTime;
+			DiskIndexBytes += Entry.Size;
+		}
+		return true;
+	});
+
+	// The bounds may have been lowered since the entries were written
+	EvictDiskEntries_Locked();
+}
+
+void FLipSyncSequenceCache::AddDiskEntry_Locked(const FString& Key, int64 Size)
+{
+	FDiskEntry& Entry = DiskIndex.FindOrAdd(Key);
+	DiskIndexBytes += FMath::Max<int64>(Size, 0) - Entry.Size;
+	Entry.Size = FMath::Max<int64>(Size, 0);
+	Entry.LastAccess = FDateTime::UtcNow();
+
+	EvictDiskEntries_Locked();
+}
+
+void FLipSyncSequenceCache::EvictDiskEntries_Locked()
+{
+	if (DiskIndex.Num() <= MaxDiskEntries && DiskIndexBytes <= MaxDiskBytes)
+	{
+		return;
+	}
+
+	// Oldest first, so the loop below drops entries from the front
+	DiskIndex.ValueSort([](const FDiskEntry& A, const FDiskEntry& B)
+	{
+		return A.LastAccess < B.LastAccess;
+	});
+
+	for (auto It = DiskIndex.CreateIterator(); It && (DiskIndex.Num() > MaxDiskEntries || DiskIndexBytes > MaxDiskBytes); ++It)
+	{
+		IFileManager::Get().Delete(*GetCacheFilePath(It.Key()), false, false, true);
+		DiskIndexBytes -= It.Value().Size;
+		It.RemoveCurrent();
+		DiskEvictions.Increment();
+	}
+}
+
+void FLipSyncSequenceCache::TouchDiskEntry(const FString& Key)
+{
+	const FDateTime Now = FDateTime::UtcNow();
+	FScopeLock Lock(&DiskIndexGuard);
+	BuildDiskIndex_Locked();
+	if (FDiskEntry* Entry = DiskIndex.Find(Key))
+	{
+		Entry->LastAccess = Now;
+		IFileManager::Get().SetTimeStamp(*GetCacheFilePath(Key), Now);
+	}
+}
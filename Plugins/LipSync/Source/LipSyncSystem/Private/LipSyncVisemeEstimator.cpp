@@ -0,0 +1,174 @@
+﻿// Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
+
+#include "LipSyncVisemeEstimator.h"
+
+namespace
+{
+	// Same order as the OVR viseme enumeration
+	enum EViseme : int32
+	{
+		Sil, PP, FF, TH, DD, Kk, CH, SS, Nn, RR, Aa, E, Ih, Oh, Ou
+	};
+
+	// Band centers cover F1 (250-1000 Hz), F2 (1500-2300 Hz), F3 (3500 Hz) and fricative noise (5500 Hz)
+	constexpr float BandCenters[] = {250.0f, 450.0f, 700.0f, 1000.0f, 1500.0f, 2300.0f, 3500.0f, 5500.0f};
+	constexpr float BandQ = 1.4f;
+
+	// Loudness maps -60..-15 dBFS onto 0..1
+	constexpr float SilenceDb = -60.0f;
+	constexpr float LoudnessRangeDb = 45.0f;
+
+	// Per-frame smoothing, fast attack so that plosives are not swallowed
+	constexpr float LoudnessAttack = 0.7f;
+	constexpr float LoudnessRelease = 0.3f;
+	constexpr float VisemeSmoothing = 0.5f;
+
+	float Clamp01(float Value)
+	{
+		return FMath::Clamp(Value, 0.0f, 1.0f);
+	}
+
+	/** Peaks at 1 when Value equals Center and falls to 0 at Center +- HalfWidth */
+	float Triangle(float Value, float Center, float HalfWidth)
+	{
+		return Clamp01(1.0f - FMath::Abs(Value - Center) / HalfWidth);
+	}
+}
+
+void FLipSyncVisemeEstimator::Init(int32 InSampleRate)
+{
+	SampleRate = FMath::Max(InSampleRate, 1);
+	const float Nyquist = SampleRate * 0.5f;
+	const float LogLowest = FMath::Loge(BandCenters[0]);
+	const float LogRange = FMath::Loge(BandCenters[NumBands - 1]) - LogLowest;
+
+	for (int32 Band = 0; Band < NumBands; ++Band)
+	{
+		BandPosition[Band] = (FMath::Loge(BandCenters[Band]) - LogLowest) / LogRange;
+		Z1[Band] = Z2[Band] = 0.0f;
+
+		// Bands above the Nyquist frequency (e.g. 5.5 kHz at 8 kHz sample rate) stay silent
+		if (BandCenters[Band] >= Nyquist * 0.9f)
+		{
+			B0[Band] = A1[Band] = A2[Band] = 0.0f;
+			continue;
+		}
+
+		// RBJ band-pass with 0 dB peak gain, b1 is zero and b2 is -b0
+		const float W0 = 2.0f * PI * BandCenters[Band] / SampleRate;
+		const float Alpha = FMath::Sin(W0) / (2.0f * BandQ);
+		const float A0 = 1.0f + Alpha;
+		B0[Band] = Alpha / A0;
+		A1[Band] = -2.0f * FMath::Cos(W0) / A0;
+		A2[Band] = (1.0f - Alpha) / A0;
+	}
+
+	LastSample = 0.0f;
+	Loudness = PrevLoudness = 0.0f;
+	FMemory::Memzero(SmoothedVisemes, sizeof(SmoothedVisemes));
+	SmoothedVisemes[Sil] = 1.0f;
+}
+
+void FLipSyncVisemeEstimator::ProcessFrame(const int16_t* Data, int32 NumFrames, TArray<float>& Visemes, bool bStereo)
+{
+	if (Visemes.Num() != NumVisemes)
+	{
+		Visemes.SetNumZeroed(NumVisemes);
+	}
+	if (SampleRate <= 0)
+	{
+		Init(48000);
+	}
+
+	alignas(16) float BandEnergy[NumBands] = {};
+	float TotalEnergy = 0.0f;
+	int32 NumZeroCrossings = 0;
+
+	const int32 Stride = bStereo ? 2 : 1;
+	constexpr float SampleScale = 1.0f / 32768.0f;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const float Sample = bStereo
+			? (Data[Frame * Stride] + Data[Frame * Stride + 1]) * (0.5f * SampleScale)
+			: Data[Frame] * SampleScale;
+
+		TotalEnergy += Sample * Sample;
+		NumZeroCrossings += (Sample >= 0.0f) != (LastSample >= 0.0f) ? 1 : 0;
+		LastSample = Sample;
+
+		// Branch-free fixed-count loop over the bands, vectorized by the compiler
+		for (int32 Band = 0; Band < NumBands; ++Band)
+		{
+			const float Output = B0[Band] * Sample + Z1[Band];
+			Z1[Band] = Z2[Band] - A1[Band] * Output;
+			Z2[Band] = -B0[Band] * Sample - A2[Band] * Output;
+			BandEnergy[Band] += Output * Output;
+		}
+	}
+
+	// Loudness with a fast attack and a slower release
+	const float MeanEnergy = NumFrames > 0 ? TotalEnergy / NumFrames : 0.0f;
+	const float LevelDb = 10.0f * FMath::LogX(10.0f, MeanEnergy + 1e-10f);
+	const float TargetLoudness = Clamp01((LevelDb - SilenceDb) / LoudnessRangeDb);
+	PrevLoudness = Loudness;
+	Loudness += (TargetLoudness - Loudness) * (TargetLoudness > Loudness ? LoudnessAttack : LoudnessRelease);
+
+	// Normalized band distribution and spectral centroid on the log-frequency axis
+	float BandSum = 1e-10f;
+	for (int32 Band = 0; Band < NumBands; ++Band)
+	{
+		BandSum += BandEnergy[Band];
+	}
+	float Centroid = 0.0f;
+	for (int32 Band = 0; Band < NumBands; ++Band)
+	{
+		BandEnergy[Band] /= BandSum;
+		Centroid += BandEnergy[Band] * BandPosition[Band];
+	}
+
+	const float Low = BandEnergy[0] + BandEnergy[1];
+	const float Mid = BandEnergy[2] + BandEnergy[3];
+	const float F2 = BandEnergy[4] + BandEnergy[5];
+	const float Hiss = BandEnergy[7] + 0.5f * BandEnergy[6];
+	const float ZeroCrossingRate = NumFrames > 0 ? static_cast<float>(NumZeroCrossings) / NumFrames : 0.0f;
+
+	// Fricatives are noisy and carry their energy high up, vowels are voiced and carry it in the formant bands
+	const float Frication = Clamp01(0.6f * Clamp01((Hiss - 0.15f) / 0.5f) + 0.4f * Clamp01((ZeroCrossingRate - 0.1f) / 0.3f));
+	const float Voicing = 1.0f - Frication;
+	const float Openness = Clamp01(Mid / (Low + Mid + 1e-6f));
+	const float Frontness = Clamp01(F2 / (Mid + F2 + 1e-6f));
+	const float Closed = 1.0f - Openness;
+	const float Back = 1.0f - Frontness;
+	const float Onset = Clamp01((Loudness - PrevLoudness) * 4.0f);
+
+	const float Vowel = Loudness * Voicing;
+	const float Consonant = Loudness * Frication;
+
+	float Scores[NumVisemes];
+	Scores[Sil] = 1.0f - Loudness;
+	Scores[Aa] = Vowel * Openness * Back;
+	Scores[E] = Vowel * Openness * Frontness;
+	Scores[Ih] = Vowel * Closed * Frontness;
+	Scores[Oh] = Vowel * Triangle(Openness, 0.5f, 0.5f) * Back;
+	Scores[Ou] = Vowel * Closed * Back;
+	Scores[Nn] = Vowel * Closed * Clamp01((Low - 0.5f) * 2.0f);
+	Scores[RR] = 0.5f * Vowel * Closed * Triangle(Frontness, 0.5f, 0.5f);
+	Scores[SS] = Consonant * Clamp01((Centroid - 0.6f) * 2.5f);
+	Scores[CH] = Consonant * Triangle(Centroid, 0.5f, 0.3f);
+	Scores[FF] = Consonant * Clamp01(1.0f - Centroid * 1.5f);
+	Scores[TH] = 0.5f * Scores[FF];
+	Scores[PP] = Onset * Clamp01(1.0f - Centroid * 2.0f);
+	Scores[DD] = Onset * Triangle(Centroid, 0.45f, 0.3f);
+	Scores[Kk] = Onset * Triangle(Centroid, 0.3f, 0.2f) * Back;
+
+	float ScoreSum = 1e-6f;
+	for (int32 Viseme = 0; Viseme < NumVisemes; ++Viseme)
+	{
+		ScoreSum += Scores[Viseme];
+	}
+	for (int32 Viseme = 0; Viseme < NumVisemes; ++Viseme)
+	{
+		SmoothedVisemes[Viseme] += (Scores[Viseme] / ScoreSum - SmoothedVisemes[Viseme]) * VisemeSmoothing;
+		Visemes[Viseme] = SmoothedVisemes[Viseme];
+	}
+}
@@ -1,12 +1,21 @@
 // Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
 #include "LipSyncWrapper.h"
 #include "Interfaces/IPluginManager.h"
+#include "HAL/IConsoleManager.h"
 
 #include <Core.h>
 
 DECLARE_LOG_CATEGORY_EXTERN(LogLssWrapper, Log, All);
 DEFINE_LOG_CATEGORY(LogLssWrapper);
 
+namespace
+{
+	TAutoConsoleVariable<bool> CVarForceBuiltInEstimator(
+		TEXT("lss.ForceBuiltInEstimator"),
+		false,
+		TEXT("Use the built-in viseme estimator instead of the OVR lip-sync library even if the library is available"));
+}
+
 typedef struct {
 	int frameNumber;
 	int frameDelay;
@@ -109,6 +118,7 @@ DEFINE_DLL_METHOD(LipSync_DestroyContext, int32, uint32 context);
 
 bool ULipSyncWrapper::LoadDll()
 {
+#if PLATFORM_WINDOWS
 	const FString BaseDir = IPluginManager::Get().FindPlugin("LipSyncSystem")->GetBaseDir();
 	
 	const FString LibraryPath = FPaths::ConvertRelativePathToFull(
@@ -122,19 +132,28 @@ bool ULipSyncWrapper::LoadDll()
 		) : nullptr;
 	if (!LibraryHandle)
 	{
-		UE_LOG(LogLssWrapper, Error, TEXT("Error on load LSS library!"));
+		UE_LOG(LogLssWrapper, Error, TEXT("Error on load LSS library! Falling back to the built-in viseme estimator"));
 		return false;
 	}
-	LipSync_Initialize_ = (_LipSync_Initialize)FPlatformProcess::GetDllExport(LibraryHandle, L"ovrLipSyncDll_Initialize");
-	LipSync_CreateContextWithModelFile_ = (_LipSync_CreateContextWithModelFile)FPlatformProcess::GetDllExport(LibraryHandle, L"ovrLipSyncDll_CreateContextWithModelFile");
-	LipSync_ProcessFrameEx_ = (_LipSync_ProcessFrameEx)FPlatformProcess::GetDllExport(LibraryHandle, L"ovrLipSyncDll_ProcessFrameEx");
-	LipSync_DestroyContext_ = (_LipSync_DestroyContext)FPlatformProcess::GetDllExport(LibraryHandle, L"ovrLipSyncDll_DestroyContext");
+	LipSync_Initialize_ = (_LipSync_Initialize)FPlatformProcess::GetDllExport(LibraryHandle, TEXT("ovrLipSyncDll_Initialize"));
+	LipSync_CreateContextWithModelFile_ = (_LipSync_CreateContextWithModelFile)FPlatformProcess::GetDllExport(LibraryHandle, TEXT("ovrLipSyncDll_CreateContextWithModelFile"));
+	LipSync_ProcessFrameEx_ = (_LipSync_ProcessFrameEx)FPlatformProcess::GetDllExport(LibraryHandle, TEXT("ovrLipSyncDll_ProcessFrameEx"));
+	LipSync_DestroyContext_ = (_LipSync_DestroyContext)FPlatformProcess::GetDllExport(LibraryHandle, TEXT("ovrLipSyncDll_DestroyContext"));
 	bIsDllLoaded = LipSync_Initialize_ && LipSync_CreateContextWithModelFile_ && LipSync_ProcessFrameEx_ && LipSync_DestroyContext_;
 	if (!bIsDllLoaded)
 	{
 		UE_LOG(LogLssWrapper, Error, TEXT("Error on load methods from the LSS library!"));
 	}
 	return bIsDllLoaded;
+#else
+	UE_LOG(LogLssWrapper, Log, TEXT("LSS library is only available on Windows, using the built-in viseme estimator"));
+	return false;
+#endif
+}
+
+bool ULipSyncWrapper::ShouldUseBuiltInEstimator()
+{
+	return !bIsDllLoaded || CVarForceBuiltInEstimator.GetValueOnAnyThread();
 }
 
 bool ULipSyncWrapper::Init(	LipSyncContextProvider ProviderKind,
@@ -143,10 +162,11 @@ bool ULipSyncWrapper::Init(	LipSyncContextProvider ProviderKind,
 	FString ModelPath,
 	bool EnableAcceleration)
 {
-	if (!ULipSyncWrapper::bIsDllLoaded)
+	if (ShouldUseBuiltInEstimator())
 	{
-		UE_LOG(LogLssWrapper, Error, TEXT("Error on load LSS library!"));
-		return false;
+		Estimator = MakeUnique<FLipSyncVisemeEstimator>();
+		Estimator->Init(SampleRate);
+		return true;
 	}
 	auto rc = LipSync_Initialize_(SampleRate, BufferSize);
 	if (rc != Success)
@@ -176,7 +196,7 @@ bool ULipSyncWrapper::Init(	LipSyncContextProvider ProviderKind,
 
 ULipSyncWrapper::~ULipSyncWrapper()
 {
-	if (!ULipSyncWrapper::bIsDllLoaded)
+	if (!ULipSyncWrapper::bIsDllLoaded || Estimator.IsValid())
 	{
 		return;
 	}
@@ -186,6 +206,13 @@ ULipSyncWrapper::~ULipSyncWrapper()
 void ULipSyncWrapper::ProcessFrame(const int16_t *AudioBuffer, int AudioBufferSize, TArray<float> &Visemes,
 											 float &LaughterScore, int32_t &FrameDelay, bool Stereo)
 {
+	if (Estimator.IsValid())
+	{
+		Estimator->ProcessFrame(AudioBuffer, AudioBufferSize, Visemes, Stereo);
+		LaughterScore = 0.0f;
+		FrameDelay = 0;
+		return;
+	}
 	if (!ULipSyncWrapper::bIsDllLoaded)
 	{
 		UE_LOG(LogLssWrapper, Error, TEXT("Error on load LSS library!"));
@@ -8,6 +8,28 @@
 DECLARE_LOG_CATEGORY_EXTERN(LogLssComponent, Log, All);
 DEFINE_LOG_CATEGORY(LogLssComponent);
 
+namespace
+{
+	// The mixer reports the playback percent as the number of frames it has rendered divided by the number of frames of the wave,
+	// so the rendered frame count is recovered from the same frame count instead of scaling the rounded duration
+	double GetRenderedAudioTime(const USoundWave* SoundWave, float Percent)
+	{
+		const double WaveSampleRate = SoundWave->GetSampleRateForCurrentPlatform();
+		if (WaveSampleRate <= 0.0)
+		{
+			return SoundWave->Duration * Percent;
+		}
+		int64 NumTotalFrames = SoundWave->NumChannels > 0 ? SoundWave->RawPCMDataSize / (SoundWave->NumChannels * sizeof(int16)) : 0;
+		if (NumTotalFrames <= 0)
+		{
+			// Procedural waves have no decompressed size, their length is only known as a duration
+			NumTotalFrames = FMath::RoundToInt64(SoundWave->Duration * WaveSampleRate);
+		}
+		const int64 NumRenderedFrames = FMath::RoundToInt64(static_cast<double>(Percent) * NumTotalFrames);
+		return NumRenderedFrames / WaveSampleRate;
+	}
+}
+
 ULipSystemComponent::ULipSystemComponent():
 	LaughterScore{0.0f},
 	bAdditionalFramesAdded{false},
@@ -89,6 +111,8 @@ void ULipSystemComponent::Start(UAudioComponent* InAudioComponent, ULipSyncFrame
 	AdditionalFrames.Empty();
 	bAudioFinished = false;
 	IntPos = 0;
+	AudioClock.Reset();
+	AudioClock.SetRate(AudioComponent->PitchMultiplier);
 	AudioComponent->Play();
 }
 
@@ -101,6 +125,7 @@ void ULipSystemComponent::Stop()
 	AudioComponent->OnAudioPlaybackPercentNative.Remove(PlaybackPercentHandle);
 	AudioComponent->OnAudioFinishedNative.Remove(PlaybackFinishedHandle);
 	AudioComponent = nullptr;
+	AudioClock.Reset();
 	InitNeutralPose();
 }
 
@@ -121,40 +146,54 @@ void ULipSystemComponent::OnAudioPlaybackPercent(const UAudioComponent*, const U
 		InitNeutralPose();
 		return;
 	}
-	if (IntPos == 0 && static_cast<unsigned>(roundf(Percent)) == 1)
+	if (!AudioClock.HasPosition() && static_cast<unsigned>(roundf(Percent)) == 1)
 	{
 		Percent = 0.0f;	
 	}
 	CurrentPercent = Percent;
-	
-	const auto PlayPos = SoundWave->Duration * Percent;
-	const auto IntPosTmp = static_cast<unsigned>(roundf(PlayPos * 100.f));
-	if (IntPosTmp <= IntPos && IntPosTmp != 0)
-	{
-		IntPos++;
-	}
-	else
+
+	// Only the clock is fed here, the visemes are sampled once per tick at the frame time
+	AudioClock.OnAudioPosition(GetRenderedAudioTime(SoundWave, Percent), FPlatformTime::Seconds());
+
+	if (static_cast<int32>(Percent) == 1)
 	{
-		IntPos = IntPosTmp;
+		bAudioFinished = true;
 	}
+}
+
+void ULipSystemComponent::SampleSequence(double PlaybackTime)
+{
+	const int32 NumFrames = Sequence->FrameSequence.Num();
+	const double FramePos = PlaybackTime * ULipSyncFrameSequence::FramesPerSecond;
+	const int32 FrameIndex = FMath::Max(FMath::FloorToInt(FramePos), 0);
 #if UE_BUILD_DEVELOPMENT
-	UE_LOG(LogLssComponent, Verbose, TEXT("--> %d/%d %f"), IntPos, Sequence->Num(), Percent);
+	UE_LOG(LogLssComponent, Verbose, TEXT("--> %f %d/%d"), PlaybackTime, FrameIndex, NumFrames);
 #endif
-	if (IntPos >= Sequence->Num())
+	if (FrameIndex >= NumFrames)
 	{
-		UE_LOG(LogLssComponent, Verbose, TEXT("OnAudioPlaybackPercent. IntPos >= Sequence->Num - InitNeutralPose"))
+		UE_LOG(LogLssComponent, Verbose, TEXT("SampleSequence. FrameIndex >= Sequence->Num - InitNeutralPose"))
+		IntPos = NumFrames;
 		InitNeutralPose();
 		return;
 	}
-	const auto &Frame = (*Sequence)[IntPos];
-	LaughterScore = Frame.LaughterScore;
-	Visemes = Frame.VisemeScores;
-	OnVisemesReady.Broadcast();
+	IntPos = FrameIndex;
 
-	if (static_cast<int32>(Percent) == 1)
+	const FLipSyncFrame &Frame = Sequence->FrameSequence[FrameIndex];
+	const FLipSyncFrame &NextFrame = Sequence->FrameSequence[FMath::Min(FrameIndex + 1, NumFrames - 1)];
+	const float Alpha = FMath::Clamp(static_cast<float>(FramePos - FrameIndex), 0.0f, 1.0f);
+	const int32 NumVisemes = FMath::Min(Frame.VisemeScores.Num(), NextFrame.VisemeScores.Num());
+
+	// Blend in place, the visemes array keeps its allocation between frames
+	if (Visemes.Num() != NumVisemes)
 	{
-		bAudioFinished = true;
+		Visemes.SetNumZeroed(NumVisemes);
 	}
+	for (int32 Idx = 0; Idx < NumVisemes; ++Idx)
+	{
+		Visemes[Idx] = FMath::Lerp(Frame.VisemeScores[Idx], NextFrame.VisemeScores[Idx], Alpha);
+	}
+	LaughterScore = FMath::Lerp(Frame.LaughterScore, NextFrame.LaughterScore, Alpha);
+	OnVisemesReady.Broadcast();
 }
 
 void ULipSystemComponent::BeginPlay()
@@ -231,7 +270,12 @@ void ULipSystemComponent::TickComponent(float DeltaTime, ELevelTick TickType,
                                         FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-	if (bAudioFinished)
+	if (!bAudioFinished && Sequence && AudioClock.HasPosition())
+	{
+		SampleSequence(AudioClock.GetPlaybackTime(FPlatformTime::Seconds()));
+		return;
+	}
+	if (bAudioFinished && Sequence)
 	{
 		if (IntPos < Sequence->Num())
 		{
@@ -4,6 +4,7 @@
 
 #include "AudioDecompress.h"
 #include "AudioDevice.h"
+#include "LipSyncSequenceCache.h"
 #include "LipSyncWrapper.h"
 #include "Templates/UniquePtr.h"
 #include "Misc/Paths.h"
@@ -126,12 +127,19 @@ uint32 FSequenceConverterRunnable::Run()
 			TEXT("LSS"),
 			TEXT("lipsync_model.pb")
 		));
-	if (!FPaths::FileExists(ModelPath))
+	// The built-in estimator needs no model, its version keys the cache so that its sequences never mix with the OVR ones
+	const bool bUseBuiltInEstimator = ULipSyncWrapper::ShouldUseBuiltInEstimator();
+	if (!bUseBuiltInEstimator && !FPaths::FileExists(ModelPath))
 	{
 		UE_LOG(LogLss, Error, TEXT("File %s not found!"), *ModelPath);
 		return ERROR_CODE;
 	}
+	const FString ModelVersion = bUseBuiltInEstimator
+		? FString(FLipSyncVisemeEstimator::GetVersion())
+		: FLipSyncSequenceCache::GetModelVersion(ModelPath);
+	FLipSyncSequenceCache& SequenceCache = FLipSyncSequenceCache::Get();
 	TUniquePtr<ULipSyncWrapper> Context;
+	uint32 ContextSampleRate = 0;
 	while (bThreadInProcess_)
 	{
 		TArray<uint8> AudioData;
@@ -141,13 +149,29 @@ uint32 FSequenceConverterRunnable::Run()
 			if (WaveInfo.ReadWaveInfo(AudioData.GetData(), AudioData.Num()))
 			{
 				const uint32 SampleRate = *WaveInfo.pSamplesPerSec;
-				if (!Context.IsValid())
+				const FString CacheKey = FLipSyncSequenceCache::MakeKey(
+					WaveInfo.SampleDataStart,
+					WaveInfo.SampleDataSize,
+					*WaveInfo.pChannels,
+					SampleRate,
+					ModelVersion);
+				TArray<FLipSyncFrame> CachedFrames;
+				if (SequenceCache.Find(CacheKey, CachedFrames))
+				{
+					auto Sequence = NewObject<ULipSyncFrameSequence>();
+					Sequence->FrameSequence = MoveTemp(CachedFrames);
+					ResultsSeqQueue_.Enqueue(Sequence);
+					UE_LOG(LogLss, Verbose, TEXT("Lip-sync cache hit %s. %s"), *CacheKey, *SequenceCache.GetStats().ToString());
+					continue;
+				}
+				if (!Context.IsValid() || ContextSampleRate != SampleRate)
 				{
 					Context = MakeUnique<ULipSyncWrapper>();
 					if (!Context->Init(Original, SampleRate,4096, ModelPath))
 					{
 						return ERROR_CODE;
 					}
+					ContextSampleRate = SampleRate;
 				}
 				auto Sequence = MakePlaybackSequence(
 					const_cast<uint8 *>(WaveInfo.SampleDataStart),
@@ -157,6 +181,7 @@ uint32 FSequenceConverterRunnable::Run()
 					*Context);
 				if (Sequence->Num())
 				{
+					SequenceCache.Add(CacheKey, Sequence->FrameSequence);
 					ResultsSeqQueue_.Enqueue(Sequence);	
 				}
 				else
@@ -0,0 +1,58 @@
+﻿// Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Playback clock of a sound, driven by the positions reported by the audio mixer.
+ * The mixer reports the number of rendered frames once per audio buffer, and the reports reach
+ * the game thread in bursts, so the raw position advances in coarse, irregular steps.
+ * The clock extrapolates the last reported position with the wall clock and slews out the
+ * difference to each new report, which gives a smooth, monotonic time at any frame rate.
+ */
+class LIPSYNCSYSTEM_API FLipSyncAudioClock
+{
+public:
+	void Reset();
+
+	/** Playback rate, e.g. the pitch multiplier of the audio component */
+	void SetRate(double InRate) { Rate = FMath::Max(InRate, 0.0); }
+
+	/**
+	 * Feeds a playback position reported by the mixer.
+	 *
+	 * @param AudioTime Position of the sound in seconds, derived from the frames rendered by the mixer
+	 * @param WallTime Time the report was received at, in FPlatformTime::Seconds
+	 */
+	void OnAudioPosition(double AudioTime, double WallTime);
+
+	/** Estimated playback position at the given wall time. Never goes backwards between reports */
+	double GetPlaybackTime(double WallTime);
+
+	bool HasPosition() const { return bHasPosition; }
+
+	/**
+	 * Simulates the mixer reports and the game frames and logs how far the clock drifts from the
+	 * true playback position, compared to using the last reported position directly.
+	 *
+	 * @param BufferDurationMs Duration of an audio buffer, i.e. the interval between mixer reports
+	 * @param FrameDurationMs Duration of a game frame
+	 * @param DurationSec Simulated playback duration
+	 * @return Whether the clock has less jitter than the raw reports, within a fraction of the buffer duration, without adding latency
+	 */
+	static bool MeasureDrift(double BufferDurationMs, double FrameDurationMs, double DurationSec);
+
+private:
+	double EstimateAt(double WallTime) const;
+
+	bool bHasPosition = false;
+	double Rate = 1.0;
+	double AnchorAudioTime = 0.0;
+	double AnchorWallTime = 0.0;
+
+	/** Difference between the estimate and the report at the anchor, decays to zero over the slew time */
+	double Correction = 0.0;
+
+	double LastPlaybackTime = 0.0;
+};
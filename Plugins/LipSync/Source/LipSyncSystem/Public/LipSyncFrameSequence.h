@@ -28,8 +28,18 @@ class LIPSYNCSYSTEM_API ULipSyncFrameSequence : public UObject
 {
 	GENERATED_BODY()
 public:
+	/** Sequences hold one frame per 10 ms of audio */
+	static constexpr float FramesPerSecond = 100.f;
+
 	UPROPERTY()
 	TArray<FLipSyncFrame> FrameSequence;
+
+#if WITH_EDITORONLY_DATA
+	/** Hash of the sound wave and of the model the sequence was baked from, the sequence is rebaked when it changes */
+	UPROPERTY(AssetRegistrySearchable)
+	FString SourceHash;
+#endif
+
 	unsigned Num() const { return FrameSequence.Num(); }
 	void Add(const TArray<float> &Visemes, float LaughterScore) { FrameSequence.Emplace(Visemes, LaughterScore); }
 	const FLipSyncFrame &operator[](unsigned idx) const { return FrameSequence[idx]; }
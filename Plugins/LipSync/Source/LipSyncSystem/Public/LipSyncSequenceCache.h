@@ -0,0 +1,112 @@
+﻿// Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LipSyncFrameSequence.h"
+#include "Containers/LruCache.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+/** Hit/miss counters of the lip-sync sequence cache */
+struct LIPSYNCSYSTEM_API FLipSyncSequenceCacheStats
+{
+	int64 MemoryHits = 0;
+	int64 DiskHits = 0;
+	int64 Misses = 0;
+	int64 Stores = 0;
+	int64 DiskEvictions = 0;
+	int64 DiskEntries = 0;
+	int64 DiskBytes = 0;
+
+	int64 Lookups() const { return MemoryHits + DiskHits + Misses; }
+	float HitRatio() const { return Lookups() > 0 ? static_cast<float>(MemoryHits + DiskHits) / Lookups() : 0.0f; }
+	FString ToString() const;
+};
+
+/**
+ * Content-addressed cache of generated lip-sync frame sequences.
+ * The key is a hash of the PCM data, its format and the lip-sync model version, so the same
+ * audio spoken twice (greetings, FAQ answers, repeated TTS sentences) skips the model entirely.
+ * Two tiers: an in-memory LRU and a binary file per sequence under Saved/LipSyncCache.
+ * The disk tier is an LRU too, bounded by entry count and size; file timestamps keep its order across sessions.
+ * Thread safe, used from the sequence converter thread.
+ */
+class LIPSYNCSYSTEM_API FLipSyncSequenceCache
+{
+public:
+	static FLipSyncSequenceCache& Get();
+
+	/**
+	 * Builds the cache key for a chunk of PCM data
+	 *
+	 * @param PCMData 16-bit interleaved PCM data
+	 * @param PCMDataSize PCM data size in bytes
+	 * @param NumChannels Number of channels
+	 * @param SampleRate Sample rate
+	 * @param ModelVersion Version string of the lip-sync model (see GetModelVersion)
+	 */
+	static FString MakeKey(const uint8* PCMData, int64 PCMDataSize, int32 NumChannels, uint32 SampleRate, const FString& ModelVersion);
+
+	/** Returns the version string of the model file, derived from its content hash. Empty if the file can't be read */
+	static FString GetModelVersion(const FString& ModelPath);
+
+	/** Looks the key up in memory first, then on disk. Disk hits are promoted to memory */
+	bool Find(const FString& Key, TArray<FLipSyncFrame>& OutFrames);
+
+	/** Stores the frames in both tiers */
+	void Add(const FString& Key, const TArray<FLipSyncFrame>& Frames);
+
+	/** Drops the memory tier and optionally deletes the disk tier */
+	void Clear(bool bClearDisk);
+
+	FLipSyncSequenceCacheStats GetStats() const;
+
+	/** Maximum number of sequences kept in memory */
+	static constexpr int32 MaxMemoryEntries = 64;
+
+	/** Maximum number of sequences and total size of the files kept on disk */
+	static constexpr int32 MaxDiskEntries = 4096;
+	static constexpr int64 MaxDiskBytes = 256 * 1024 * 1024;
+
+private:
+	FLipSyncSequenceCache();
+
+	FString GetCacheFilePath(const FString& Key) const;
+	bool LoadFromDisk(const FString& Key, TArray<FLipSyncFrame>& OutFrames) const;
+	bool SaveToDisk(const FString& Key, const TArray<FLipSyncFrame>& Frames) const;
+
+	/** Scans the cache directory on first use. DiskIndexGuard must be held */
+	void BuildDiskIndex_Locked();
+
+	/** Records a written entry and evicts the least recently used ones past the bounds. DiskIndexGuard must be held */
+	void AddDiskEntry_Locked(const FString& Key, int64 Size);
+
+	/** Deletes the least recently used files until the disk tier is within its bounds. DiskIndexGuard must be held */
+	void EvictDiskEntries_Locked();
+
+	/** Marks an entry as recently used, on disk too so the order survives restarts */
+	void TouchDiskEntry(const FString& Key);
+
+	FString CacheDir;
+
+	struct FDiskEntry
+	{
+		int64 Size = 0;
+		FDateTime LastAccess;
+	};
+
+	mutable FCriticalSection DiskIndexGuard;
+	TMap<FString, FDiskEntry> DiskIndex;
+	int64 DiskIndexBytes = 0;
+	bool bDiskIndexBuilt = false;
+
+	mutable FCriticalSection MemoryCacheGuard;
+	TLruCache<FString, TArray<FLipSyncFrame>> MemoryCache;
+
+	FThreadSafeCounter64 MemoryHits;
+	FThreadSafeCounter64 DiskHits;
+	FThreadSafeCounter64 Misses;
+	FThreadSafeCounter64 Stores;
+	FThreadSafeCounter64 DiskEvictions;
+};
@@ -0,0 +1,55 @@
+﻿// Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Lightweight viseme estimator that does not depend on the OVRLipSync library.
+ * Splits each frame into formant bands with a bank of band-pass biquads and maps the
+ * loudness, voicing, spectral centroid and F1/F2 band balance onto the 15 OVR visemes.
+ * The output is less precise than the neural model, but it runs on every platform and
+ * costs a few dozen operations per sample, so dozens of streams fit on a single core.
+ * The filter state carries over between frames, so one estimator must be used per stream.
+ */
+class LIPSYNCSYSTEM_API FLipSyncVisemeEstimator
+{
+public:
+	static constexpr int32 NumVisemes = 15;
+
+	/** Identifies the estimator output in cache keys, bump whenever the mapping changes */
+	static const TCHAR* GetVersion() { return TEXT("BuiltInEstimator-1"); }
+
+	void Init(int32 InSampleRate);
+
+	/**
+	 * Estimates the viseme scores of a frame of 16-bit PCM.
+	 * The scores sum up to one, same as the OVR output.
+	 *
+	 * @param Data Interleaved PCM samples
+	 * @param NumFrames Number of sample frames (samples per channel)
+	 * @param Visemes Receives the scores, resized to NumVisemes
+	 * @param bStereo Whether the data is interleaved stereo
+	 */
+	void ProcessFrame(const int16_t* Data, int32 NumFrames, TArray<float>& Visemes, bool bStereo);
+
+private:
+	/** Band count is a multiple of 4 so the per-sample band loop maps onto SIMD lanes */
+	static constexpr int32 NumBands = 8;
+
+	// Biquad coefficients and transposed direct form II state per band, stored as structure of arrays
+	alignas(16) float B0[NumBands] = {};
+	alignas(16) float A1[NumBands] = {};
+	alignas(16) float A2[NumBands] = {};
+	alignas(16) float Z1[NumBands] = {};
+	alignas(16) float Z2[NumBands] = {};
+
+	/** Position of each band center on a log-frequency axis, 0 for the lowest band and 1 for the highest */
+	float BandPosition[NumBands] = {};
+
+	int32 SampleRate = 0;
+	float LastSample = 0.0f;
+	float Loudness = 0.0f;
+	float PrevLoudness = 0.0f;
+	float SmoothedVisemes[NumVisemes] = {};
+};
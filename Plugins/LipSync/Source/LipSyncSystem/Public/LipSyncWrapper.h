@@ -1,6 +1,7 @@
 // Copyright 2022 Stendhal Syndrome Studio. All Rights Reserved.
 #pragma once
 #include "CoreMinimal.h"
+#include "LipSyncVisemeEstimator.h"
 
 typedef enum {
 	Original,
@@ -29,8 +30,13 @@ public:
 	static bool LoadDll();
 	static void UnloadDll();
 
+	// The built-in estimator is used when the OVR library is not available (e.g. on Linux) or lss.ForceBuiltInEstimator is set
+	static bool ShouldUseBuiltInEstimator();
+	bool IsUsingBuiltInEstimator() const { return Estimator.IsValid(); }
+
 private:
 	uint32 LipSyncContext{EnhancedWithLaughter};
+	TUniquePtr<FLipSyncVisemeEstimator> Estimator;
 	inline static void* LibraryHandle{nullptr};
 	inline static bool bIsDllLoaded{false};
 };
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "LipSyncFrameSequence.h"
+#include "LipSyncAudioClock.h"
 
 #include "CoreMinimal.h"
 #include "Components/AudioComponent.h"
@@ -82,6 +83,9 @@ private:
 	void InitNeutralPose();
 	void AppendShutYourMouthSeq(int32 LastIndex);
 
+	// Interpolates the visemes between the two sequence frames around PlaybackTime
+	void SampleSequence(double PlaybackTime);
+
 	float LaughterScore;
 	TArray<float> Visemes;
 	
@@ -95,6 +99,9 @@ private:
 	bool bAudioFinished;
 	
 	unsigned IntPos;
+
+	// Playback position driven by the frames rendered by the mixer
+	FLipSyncAudioClock AudioClock;
 	
 	float CurrentPercent  = 0;
 };
@@ -18,6 +18,7 @@ public class LipSyncSystemEditor : ModuleRules
         PrivateDependencyModuleNames.AddRange(
             new string[]
             {
+                "AssetRegistry",
                 "CoreUObject",
                 "Engine",
                 "Slate",
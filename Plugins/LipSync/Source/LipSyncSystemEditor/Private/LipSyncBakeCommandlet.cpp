@@ -0,0 +1,119 @@
+﻿// Copyright 2023 Stendhal Syndrome Studio. All Rights Reserved.
+
+#include "LipSyncBakeCommandlet.h"
+
+#include "LipSyncBakeService.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "Sound/SoundWave.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectGlobals.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogLssBakeCommandlet, Log, All);
+DEFINE_LOG_CATEGORY(LogLssBakeCommandlet);
+
+namespace
+{
+	constexpr float BakeProgressInterval = 5.0f;
+
+	// Number of finished sound waves between garbage collections, which release the saved sequences and the sound waves loaded for them
+	constexpr int32 GarbageCollectionInterval = 64;
+
+	bool SaveSequencePackage(UPackage* Package)
+	{
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.Error = GWarn;
+		return UPackage::SavePackage(Package, nullptr, *Filename, SaveArgs);
+	}
+}
+
+ULipSyncBakeCommandlet::ULipSyncBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 ULipSyncBakeCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	TArray<FString> ContentPaths;
+	const FString* PathParam = ParamValues.Find(TEXT("Path"));
+	(PathParam ? *PathParam : FString(TEXT("/Game"))).ParseIntoArray(ContentPaths, TEXT("+"));
+
+	FLipSyncBakeSettings Settings;
+	Settings.NumWorkers = FCString::Atoi(*ParamValues.FindRef(TEXT("Workers")));
+	Settings.bForce = Switches.Contains(TEXT("Force"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(USoundWave::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.bRecursivePaths = true;
+	for (const FString& ContentPath : ContentPaths)
+	{
+		Filter.PackagePaths.Add(*ContentPath);
+	}
+
+	TArray<FAssetData> SoundWaveAssets;
+	AssetRegistry.GetAssets(Filter, SoundWaveAssets);
+	UE_LOG(LogLssBakeCommandlet, Display, TEXT("Found %d sound waves under %s"), SoundWaveAssets.Num(), *FString::Join(ContentPaths, TEXT(", ")));
+
+	FLipSyncBakeService BakeService(SoundWaveAssets, Settings);
+	if (!BakeService.Start())
+	{
+		return 1;
+	}
+
+	// Sequences are saved as they come in and collected periodically, so that they don't pile up in memory
+	int32 NumOfFailedSaves = 0;
+	int32 NumOfDoneAtLastCollection = 0;
+	double LastProgressTime = FPlatformTime::Seconds();
+	bool bDone = false;
+	while (!bDone)
+	{
+		bDone = BakeService.Tick();
+
+		for (UPackage* Package : BakeService.GetDirtyPackages())
+		{
+			if (!SaveSequencePackage(Package))
+			{
+				UE_LOG(LogLssBakeCommandlet, Error, TEXT("Failed to save %s"), *Package->GetName());
+				++NumOfFailedSaves;
+			}
+			// Detaches the package from its file, so that it can be collected
+			ResetLoaders(Package);
+		}
+		BakeService.ResetDirtyPackages();
+
+		// Standalone objects are not kept, since the saved sequences and the loaded sound waves are standalone assets
+		if (BakeService.GetNumOfDone() - NumOfDoneAtLastCollection >= GarbageCollectionInterval)
+		{
+			CollectGarbage(RF_NoFlags);
+			NumOfDoneAtLastCollection = BakeService.GetNumOfDone();
+		}
+
+		if (!bDone)
+		{
+			if (FPlatformTime::Seconds() - LastProgressTime > BakeProgressInterval)
+			{
+				UE_LOG(LogLssBakeCommandlet, Display, TEXT("Baked %d / %d"), BakeService.GetNumOfDone(), BakeService.GetNumOfJobs());
+				LastProgressTime = FPlatformTime::Seconds();
+			}
+			FPlatformProcess::Sleep(0.05f);
+		}
+	}
+
+	UE_LOG(LogLssBakeCommandlet, Display, TEXT("Lip-sync bake finished: %d baked, %d up to date, %d failed, %d failed to save"),
+		BakeService.GetNumOfBaked(), BakeService.GetNumOfSkipped(), BakeService.GetNumOfFailed(), NumOfFailedSaves);
+	return BakeService.GetNumOfFailed() + NumOfFailedSaves > 0 ? 1 : 0;
+}
@@ -0,0 +1,370 @@
+﻿// Copyright 2023 Stendhal Syndrome Studio. All Rights Reserved.
+
+#include "LipSyncBakeService.h"
+
+#include "Audio.h"
+#include "LipSyncSequenceCache.h"
+#include "LipSyncVisemeEstimator.h"
+#include "LipSyncWrapper.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Sound/SoundWave.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogLssBake, Log, All);
+DEFINE_LOG_CATEGORY(LogLssBake);
+
+namespace
+{
+	constexpr auto LipSyncSequenceUpdateFrequency = 100;
+	constexpr auto LipSyncSequenceDuration = 1.0f / LipSyncSequenceUpdateFrequency;
+
+	// The library is initialized globally when a context is created, so contexts are created one at a time
+	FCriticalSection ContextInitGuard;
+
+	// Sound waves are loaded synchronously in Tick, so the loading is spread over several ticks when many of them are up to date
+	constexpr double MaxLoadTimePerTick = 0.02;
+
+	/**
+	 * Runs the context over the interleaved 16-bit PCM in 10 ms chunks, reading the chunks in place.
+	 * Only the last chunk and the chunks covering the context delay are copied into a zero padded buffer
+	 */
+	bool BakeFrames(const int16* PCMData, int64 NumOfSamples, int32 NumChannels, int32 SampleRate, ULipSyncWrapper& Context, const std::atomic<bool>& bCancelled, TArray<FLipSyncFrame>& OutFrames)
+	{
+		const int32 ChunkNumOfFrames = static_cast<int32>(SampleRate * LipSyncSequenceDuration);
+		const int32 ChunkNumOfSamples = NumChannels * ChunkNumOfFrames;
+		if (ChunkNumOfSamples <= 0)
+		{
+			return false;
+		}
+		const bool bStereo = NumChannels > 1;
+
+		float LaughterScore = 0.0f;
+		int32_t FrameDelayInMs = 0;
+		TArray<float> Visemes;
+
+		TArray<int16_t> Samples;
+		Samples.SetNumZeroed(ChunkNumOfSamples);
+		Context.ProcessFrame(Samples.GetData(), ChunkNumOfFrames, Visemes, LaughterScore, FrameDelayInMs, bStereo);
+
+		const int64 FrameOffset = static_cast<int64>(FrameDelayInMs * SampleRate / 1000 * NumChannels);
+
+		OutFrames.Reset();
+		OutFrames.Reserve(static_cast<int32>((NumOfSamples + FrameOffset) / ChunkNumOfSamples + 1));
+		for (int64 Offset = 0; Offset < NumOfSamples + FrameOffset; Offset += ChunkNumOfSamples)
+		{
+			if (bCancelled)
+			{
+				return false;
+			}
+
+			const int64 NumOfRemainingSamples = NumOfSamples - Offset;
+			const int16* Chunk = Samples.GetData();
+			if (NumOfRemainingSamples >= ChunkNumOfSamples)
+			{
+				Chunk = PCMData + Offset;
+			}
+			else
+			{
+				const int64 NumOfCopiedSamples = FMath::Max<int64>(NumOfRemainingSamples, 0);
+				if (NumOfCopiedSamples > 0)
+				{
+					FMemory::Memcpy(Samples.GetData(), PCMData + Offset, NumOfCopiedSamples * sizeof(int16));
+				}
+				FMemory::Memzero(Samples.GetData() + NumOfCopiedSamples, (ChunkNumOfSamples - NumOfCopiedSamples) * sizeof(int16));
+			}
+
+			Context.ProcessFrame(Chunk, ChunkNumOfFrames, Visemes, LaughterScore, FrameDelayInMs, bStereo);
+			if (Offset >= FrameOffset)
+			{
+				OutFrames.Emplace(Visemes, LaughterScore);
+			}
+		}
+		return true;
+	}
+}
+
+FLipSyncBakeService::FLipSyncBakeService(const TArray<FAssetData>& InSoundWaveAssets, const FLipSyncBakeSettings& InSettings)
+	: SoundWaveAssets(InSoundWaveAssets)
+	, Settings(InSettings)
+{
+}
+
+FLipSyncBakeService::~FLipSyncBakeService()
+{
+	Cancel();
+	Wait();
+}
+
+bool FLipSyncBakeService::Start()
+{
+	check(IsInGameThread());
+
+	ModelPath = FPaths::ConvertRelativePathToFull(
+		FPaths::Combine(
+			FPaths::ProjectContentDir(),
+			TEXT("3rdparty"),
+			TEXT("LSS"),
+			TEXT("lipsync_model.pb")
+		));
+	// Same as in the sequence converter, the built-in estimator version keeps its sequences apart from the OVR ones
+	const bool bUseBuiltInEstimator = ULipSyncWrapper::ShouldUseBuiltInEstimator();
+	if (!bUseBuiltInEstimator && !FPaths::FileExists(ModelPath))
+	{
+		UE_LOG(LogLssBake, Error, TEXT("Model file not found: %s"), *ModelPath);
+		return false;
+	}
+	ModelVersion = bUseBuiltInEstimator
+		? FString(FLipSyncVisemeEstimator::GetVersion())
+		: FLipSyncSequenceCache::GetModelVersion(ModelPath);
+
+	// The sound waves are loaded in Tick, as workers become free
+	Jobs.Reserve(SoundWaveAssets.Num());
+	for (int32 AssetIndex = 0; AssetIndex < SoundWaveAssets.Num(); ++AssetIndex)
+	{
+		const FAssetData& SoundWaveAsset = SoundWaveAssets[AssetIndex];
+		FJob& Job = Jobs.AddDefaulted_GetRef();
+		Job.AssetIndex = AssetIndex;
+		Job.PackageName = *FString::Printf(TEXT("%s_LipSyncSequence"), *SoundWaveAsset.PackageName.ToString());
+		Job.AssetName = *FString::Printf(TEXT("%s_LipSyncSequence"), *SoundWaveAsset.AssetName.ToString());
+	}
+
+	NumOfWorkers = FMath::Clamp(Settings.NumWorkers > 0 ? Settings.NumWorkers : FTaskGraphInterface::Get().GetNumBackgroundThreads(), 1, FMath::Max(Jobs.Num(), 1));
+	UE_LOG(LogLssBake, Log, TEXT("Baking up to %d lip-sync sequences on %d workers"), Jobs.Num(), NumOfWorkers);
+	return true;
+}
+
+bool FLipSyncBakeService::Tick()
+{
+	check(IsInGameThread());
+
+	// Checked before draining, so that nothing is enqueued after the last drain
+	Workers.RemoveAll([](const UE::Tasks::FTask& Worker) { return Worker.IsCompleted(); });
+	const bool bDone = Workers.Num() == 0 && (bCancelled || NextJobIndex >= Jobs.Num());
+
+	FResult Result;
+	while (Results.Dequeue(Result))
+	{
+		FJob& Job = Jobs[Result.JobIndex];
+		if (Result.bSuccess && Result.Frames.Num() > 0)
+		{
+			StoreSequence(Job, MoveTemp(Result.Frames));
+			++NumOfBaked;
+		}
+		else
+		{
+			UE_LOG(LogLssBake, Error, TEXT("Failed to bake %s"), *Job.PackageName.ToString());
+			++NumOfFailed;
+		}
+
+		// Nothing needs the sound wave anymore, so it can be garbage collected
+		Job.SoundWave = nullptr;
+	}
+
+	const double LoadStartTime = FPlatformTime::Seconds();
+	while (!bCancelled && NextJobIndex < Jobs.Num() && Workers.Num() < NumOfWorkers && FPlatformTime::Seconds() - LoadStartTime < MaxLoadTimePerTick)
+	{
+		const int32 JobIndex = NextJobIndex++;
+		if (PrepareJob(Jobs[JobIndex]))
+		{
+			Workers.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, JobIndex]()
+			{
+				RunJob(JobIndex);
+			}, UE::Tasks::ETaskPriority::BackgroundNormal));
+		}
+	}
+
+	return bDone;
+}
+
+bool FLipSyncBakeService::PrepareJob(FJob& Job)
+{
+	const FAssetData& SoundWaveAsset = SoundWaveAssets[Job.AssetIndex];
+	USoundWave* SoundWave = Cast<USoundWave>(SoundWaveAsset.GetAsset());
+	if (!SoundWave)
+	{
+		UE_LOG(LogLssBake, Error, TEXT("Can't get SoundWave data of %s"), *SoundWaveAsset.GetObjectPathString());
+		++NumOfFailed;
+		return false;
+	}
+	if (SoundWave->NumChannels > 2)
+	{
+		UE_LOG(LogLssBake, Error, TEXT("Can't process %s: only mono and stereo streams are supported"), *SoundWaveAsset.GetObjectPathString());
+		++NumOfFailed;
+		return false;
+	}
+
+	// The payload id is the hash of the imported audio, so it is known without loading the audio
+	Job.SourceHash = FString::Printf(TEXT("%s-%s"), *LexToString(SoundWave->RawData.GetPayloadId()), *ModelVersion);
+
+	if (!Settings.bForce)
+	{
+		// Sequences already in memory may have been baked after the asset registry saw them
+		const FSoftObjectPath SequencePath(FTopLevelAssetPath(Job.PackageName, Job.AssetName));
+		FString SequenceSourceHash;
+		if (const ULipSyncFrameSequence* Sequence = Cast<ULipSyncFrameSequence>(SequencePath.ResolveObject()))
+		{
+			SequenceSourceHash = Sequence->SourceHash;
+		}
+		else
+		{
+			IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+			AssetRegistry.GetAssetByObjectPath(SequencePath).GetTagValue(GET_MEMBER_NAME_CHECKED(ULipSyncFrameSequence, SourceHash), SequenceSourceHash);
+		}
+
+		if (SequenceSourceHash == Job.SourceHash)
+		{
+			UE_LOG(LogLssBake, Verbose, TEXT("%s is up to date"), *Job.PackageName.ToString());
+			++NumOfSkipped;
+			return false;
+		}
+	}
+
+	Job.SoundWave = SoundWave;
+	return true;
+}
+
+void FLipSyncBakeService::Wait()
+{
+	UE::Tasks::Wait(Workers);
+}
+
+void FLipSyncBakeService::Cancel()
+{
+	bCancelled = true;
+}
+
+void FLipSyncBakeService::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (FJob& Job : Jobs)
+	{
+		Collector.AddReferencedObject(Job.SoundWave);
+	}
+}
+
+void FLipSyncBakeService::RunJob(int32 JobIndex)
+{
+	if (bCancelled)
+	{
+		return;
+	}
+
+	// No more jobs run at once than there are workers, so the pool holds at most one context per worker
+	FContext Context;
+	{
+		FScopeLock Lock(&FreeContextsGuard);
+		if (FreeContexts.Num() > 0)
+		{
+			Context = FreeContexts.Pop();
+		}
+	}
+
+	FResult Result;
+	Result.JobIndex = JobIndex;
+	Result.bSuccess = BakeJob(Jobs[JobIndex], Context.Wrapper, Context.SampleRate, Result.Frames);
+
+	{
+		FScopeLock Lock(&FreeContextsGuard);
+		FreeContexts.Add(MoveTemp(Context));
+	}
+
+	if (!bCancelled)
+	{
+		Results.Enqueue(MoveTemp(Result));
+	}
+}
+
+bool FLipSyncBakeService::BakeJob(const FJob& Job, TUniquePtr<ULipSyncWrapper>& Context, uint32& ContextSampleRate, TArray<FLipSyncFrame>& OutFrames) const
+{
+	// The imported payload is usually 16-bit PCM, which is fed to the context in place
+	// It is read as a whole, since the editor bulk data can't be read partially, and released when the job is done
+	const FSharedBuffer Payload = Job.SoundWave->RawData.GetPayload().Get();
+	FWaveModInfo WaveInfo;
+	const bool bIsPCM16 = !Payload.IsNull()
+		&& WaveInfo.ReadWaveInfo(static_cast<const uint8*>(Payload.GetData()), static_cast<int32>(Payload.GetSize()))
+		&& *WaveInfo.pFormatTag == FWaveModInfo::WAVE_INFO_FORMAT_PCM
+		&& *WaveInfo.pBitsPerSample == 16;
+
+	// Other formats are decoded by the sound wave as a whole, there is no incremental decoding of the imported audio
+	TArray<uint8> ConvertedPCMData;
+	const uint8* PCMData = nullptr;
+	int64 PCMDataSize = 0;
+	uint32 SampleRate = 0;
+	uint16 NumChannels = 0;
+	if (bIsPCM16)
+	{
+		PCMData = WaveInfo.SampleDataStart;
+		PCMDataSize = WaveInfo.SampleDataSize;
+		SampleRate = *WaveInfo.pSamplesPerSec;
+		NumChannels = *WaveInfo.pChannels;
+	}
+	else if (Job.SoundWave->GetImportedSoundWaveData(ConvertedPCMData, SampleRate, NumChannels))
+	{
+		PCMData = ConvertedPCMData.GetData();
+		PCMDataSize = ConvertedPCMData.Num();
+	}
+
+	if (!PCMData || PCMDataSize <= 0 || SampleRate == 0)
+	{
+		UE_LOG(LogLssBake, Error, TEXT("Can't read the audio of %s"), *Job.SoundWave->GetPathName());
+		return false;
+	}
+	if (NumChannels == 0 || NumChannels > 2)
+	{
+		UE_LOG(LogLssBake, Error, TEXT("Can't process %s: only mono and stereo streams are supported"), *Job.SoundWave->GetPathName());
+		return false;
+	}
+
+	// The context is kept across sound waves of the same sample rate, as in the sequence converter
+	if (!Context.IsValid() || ContextSampleRate != SampleRate)
+	{
+		FScopeLock Lock(&ContextInitGuard);
+		Context = MakeUnique<ULipSyncWrapper>();
+		if (!Context->Init(Original, SampleRate, 4096, ModelPath))
+		{
+			Context.Reset();
+			return false;
+		}
+		ContextSampleRate = SampleRate;
+	}
+
+	return BakeFrames(reinterpret_cast<const int16*>(PCMData), PCMDataSize / sizeof(int16), NumChannels, SampleRate, *Context, bCancelled, OutFrames);
+}
+
+void FLipSyncBakeService::StoreSequence(const FJob& Job, TArray<FLipSyncFrame>&& Frames)
+{
+	const FString PackageName = Job.PackageName.ToString();
+	UPackage* Package = FindPackage(nullptr, *PackageName);
+	if (!Package && FPackageName::DoesPackageExist(PackageName))
+	{
+		Package = LoadPackage(nullptr, *PackageName, LOAD_None);
+	}
+	if (!Package)
+	{
+		Package = CreatePackage(*PackageName);
+	}
+
+	// Existing sequences are updated in place, so that references to them stay valid
+	ULipSyncFrameSequence* Sequence = FindObject<ULipSyncFrameSequence>(Package, *Job.AssetName.ToString());
+	const bool bCreated = !Sequence;
+	if (bCreated)
+	{
+		Sequence = NewObject<ULipSyncFrameSequence>(Package, Job.AssetName, RF_Public | RF_Standalone);
+	}
+	else
+	{
+		Sequence->Modify();
+	}
+
+	Sequence->FrameSequence = MoveTemp(Frames);
+	Sequence->SourceHash = Job.SourceHash;
+
+	if (bCreated)
+	{
+		FAssetRegistryModule::AssetCreated(Sequence);
+	}
+	Sequence->MarkPackageDirty();
+	DirtyPackages.AddUnique(Package);
+}
@@ -2,12 +2,11 @@
 
 #include "LipSyncSystemEditor.h"
 
-#include "AudioDecompress.h"
-#include "AudioDevice.h"
 #include "ContentBrowserModule.h"
-#include "LipSyncFrameSequence.h"
-#include "LipSyncWrapper.h"
-#include "AssetRegistry/AssetRegistryModule.h"
+#include "LipSyncBakeService.h"
+#include "Containers/Ticker.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
 
 #define LOCTEXT_NAMESPACE "FLipSyncSystemEditorModule"
 
@@ -16,138 +15,60 @@ DEFINE_LOG_CATEGORY(LogLssEditor);
 
 namespace
 {
-	constexpr auto LipSyncSequenceUpdateFrequency = 100;
-	constexpr auto LipSyncSequenceDuration = 1.0f / LipSyncSequenceUpdateFrequency;
-	
-	TArray<uint8> SoundWaveToBytes(const USoundWave* Audio)
-	{
-		TArray<uint8> BytesArr;
-		if (IsValid(Audio))
-		{
-			TArray<uint8> AudioBytes;
-			TArray<uint8> AudioHeader;
-			uint32 SampleRate;
-			uint16 Channels;
-
-			if (Audio->GetImportedSoundWaveData(AudioBytes, SampleRate, Channels))
-			{
-				BytesArr.Append(AudioBytes);
-			}
-		}
-		return BytesArr;
-	}
-	
-	bool LipSyncProcessSoundWave(const FAssetData &SoundWaveAsset)
+	void LipSyncSystemCreateSequence(const TArray<FAssetData> SelectedSoundAssets)
 	{
-		auto SoundWave = Cast<USoundWave>(SoundWaveAsset.GetAsset());
-		if (!SoundWave)
-		{
-			UE_LOG(LogLssEditor, Error, TEXT("Can't get SoundWave data"));
-			return false;
-		}
-		if (SoundWave->NumChannels > 2)
+		// Baking runs on background workers, the sequence assets are created from the core ticker as the workers finish them
+		TSharedRef<FLipSyncBakeService> BakeService = MakeShared<FLipSyncBakeService>(SelectedSoundAssets, FLipSyncBakeSettings());
+		if (!BakeService->Start())
 		{
-			UE_LOG(LogLssEditor, Error, TEXT("Can't process SoundWave: only mono and stereo streams are supported"));
-			return false;
+			return;
 		}
 
-		auto SequenceName = FString::Printf(TEXT("%s_LipSyncSequence"), *SoundWaveAsset.AssetName.ToString());
-		auto SequencePath = FString::Printf(TEXT("%s_LipSyncSequence"), *SoundWaveAsset.PackageName.ToString());
-		auto SequencePackage = CreatePackage(*SequencePath);
-		auto Sequence = NewObject<ULipSyncFrameSequence>(SequencePackage, *SequenceName, RF_Public | RF_Standalone);
-
-		auto SoundData = SoundWaveToBytes(SoundWave);
-		
-		auto NumChannels = SoundWave->NumChannels;
-		auto SampleRate = SoundWave->GetSampleRateForCurrentPlatform();
-		auto PCMDataSize = SoundData.Num() / sizeof(int16_t);
-		auto PCMData = reinterpret_cast<int16_t *>(SoundData.GetData());
-		auto ChunkSizeSamples = static_cast<int>(SampleRate * LipSyncSequenceDuration);
-		auto ChunkSize = NumChannels * ChunkSizeSamples;
-		
-		const FString ModelPath = FPaths::ConvertRelativePathToFull(
-				FPaths::Combine(
-				FPaths::ProjectContentDir(),
-				TEXT("3rdparty"),
-				TEXT("LSS"),
-				TEXT("lipsync_model.pb")
-			));
-		ULipSyncWrapper Context;
-		if (!Context.Init(LipSyncContextProvider::Original, SampleRate, 4096, ModelPath))
+		FNotificationInfo Info(NSLOCTEXT("NSLT_LipSyncPlugin", "GeneratingLipSyncSequences", "Generating LipSync sequences..."));
+		Info.bFireAndForget = false;
+		Info.ExpireDuration = 3.0f;
+		Info.ButtonDetails.Add(FNotificationButtonInfo(
+			NSLOCTEXT("NSLT_LipSyncPlugin", "CancelLipSyncSequences", "Cancel"),
+			FText(),
+			FSimpleDelegate::CreateLambda([WeakBakeService = TWeakPtr<FLipSyncBakeService>(BakeService)]()
+			{
+				if (const TSharedPtr<FLipSyncBakeService> PinnedBakeService = WeakBakeService.Pin())
+				{
+					PinnedBakeService->Cancel();
+				}
+			}),
+			SNotificationItem::CS_Pending));
+		TSharedPtr<SNotificationItem> Notification = FSlateNotificationManager::Get().AddNotification(Info);
+		if (Notification.IsValid())
 		{
-			return false;
+			Notification->SetCompletionState(SNotificationItem::CS_Pending);
 		}
 
-		float LaughterScore = 0.0f;
-		int32_t FrameDelayInMs = 0;
-		TArray<float> Visemes;
-
-		TArray<int16_t> Samples;
-		Samples.SetNumZeroed(ChunkSize);
-		Context.ProcessFrame(Samples.GetData(), ChunkSizeSamples, Visemes, LaughterScore, FrameDelayInMs, NumChannels > 1);
-
-		int32 FrameOffset = (int32)(FrameDelayInMs * SampleRate / 1000 * NumChannels);
-
-		FScopedSlowTask SlowTask(
-			PCMDataSize + FrameOffset,
-			FText::Format(
-				NSLOCTEXT("NSLT_LipSyncPlugin", "GeneratingLipSyncSequence", "Generating LipSync sequence for {0}..."),
-				FText::FromName(SoundWaveAsset.AssetName)
-				));
-		SlowTask.MakeDialog();
-		for (int32 Offs = 0; Offs < PCMDataSize + FrameOffset; Offs += ChunkSize)
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([BakeService, Notification](float DeltaTime)
 		{
-			int32 RemainingSamples = PCMDataSize - Offs;
-			if (RemainingSamples >= ChunkSize)
+			const bool bDone = BakeService->Tick();
+			if (!Notification.IsValid())
 			{
-				Context.ProcessFrame(
-					PCMData + Offs,
-					ChunkSizeSamples,
-					Visemes,
-					LaughterScore,
-					FrameDelayInMs,
-					NumChannels > 1);
-			}
-			else
-			{
-				if (RemainingSamples > 0)
-				{
-					memcpy(Samples.GetData(), PCMData + Offs, sizeof(int16_t) * RemainingSamples);
-					memset(Samples.GetData() + RemainingSamples, 0, ChunkSize - RemainingSamples);
-				}
-				else
-				{
-					memset(Samples.GetData(), 0, ChunkSize);
-				}
-				Context.ProcessFrame(
-					Samples.GetData(),
-					ChunkSizeSamples,
-					Visemes,
-					LaughterScore,
-					FrameDelayInMs,
-					NumChannels > 1);
+				return !bDone;
 			}
 
-			SlowTask.EnterProgressFrame(ChunkSize);
-			if (SlowTask.ShouldCancel())
-			{
-				return false;
-			}
-			if (Offs >= FrameOffset)
+			if (!bDone)
 			{
-				Sequence->Add(Visemes, LaughterScore);
+				Notification->SetText(FText::Format(
+					NSLOCTEXT("NSLT_LipSyncPlugin", "GeneratingLipSyncSequencesProgress", "Generating LipSync sequences ({0}/{1})..."),
+					BakeService->GetNumOfDone(), BakeService->GetNumOfJobs()));
+				return true;
 			}
-		}
-		FAssetRegistryModule::AssetCreated(Sequence);
-		return Sequence->MarkPackageDirty();
-	}
-	
-	void LipSyncSystemCreateSequence(const TArray<FAssetData> SelectedSoundAssets)
-	{
-		for (auto &SoundWaveAsset : SelectedSoundAssets)
-		{
-			LipSyncProcessSoundWave(SoundWaveAsset);
-		}
+
+			UE_LOG(LogLssEditor, Log, TEXT("LipSync sequences: %d generated, %d up to date, %d failed"),
+				BakeService->GetNumOfBaked(), BakeService->GetNumOfSkipped(), BakeService->GetNumOfFailed());
+			Notification->SetText(FText::Format(
+				NSLOCTEXT("NSLT_LipSyncPlugin", "GeneratedLipSyncSequences", "LipSync sequences: {0} generated, {1} up to date, {2} failed"),
+				BakeService->GetNumOfBaked(), BakeService->GetNumOfSkipped(), BakeService->GetNumOfFailed()));
+			Notification->SetCompletionState(BakeService->GetNumOfFailed() > 0 ? SNotificationItem::CS_Fail : SNotificationItem::CS_Success);
+			Notification->ExpireAndFadeout();
+			return false;
+		}));
 	}
 
 	void LipSyncSystemContextMenuExtension(FMenuBuilder &MenuBuilder, const TArray<FAssetData> SelectedSoundWavesPath)
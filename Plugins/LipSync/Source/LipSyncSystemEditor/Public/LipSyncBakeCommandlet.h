@@ -0,0 +1,26 @@
+﻿// Copyright 2023 Stendhal Syndrome Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LipSyncBakeCommandlet.generated.h"
+
+/**
+ * Bakes lip-sync sequences for all sound waves under the given content paths and saves them.
+ * Sound waves whose sequences are up to date are skipped.
+ *
+ * Usage: UnrealEditor-Cmd.exe <Project> -run=LipSyncBake [-Path=/Game/VO+/Game/Cinematics] [-Workers=N] [-Force]
+ */
+UCLASS()
+class ULipSyncBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULipSyncBakeCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
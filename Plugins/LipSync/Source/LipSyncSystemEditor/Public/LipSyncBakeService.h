@@ -0,0 +1,126 @@
+﻿// Copyright 2023 Stendhal Syndrome Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "Containers/Queue.h"
+#include "LipSyncFrameSequence.h"
+#include "Tasks/Task.h"
+#include "UObject/GCObject.h"
+#include <atomic>
+
+class ULipSyncWrapper;
+class USoundWave;
+
+struct FLipSyncBakeSettings
+{
+	/** Number of concurrent workers, each owning one lip-sync context. 0 picks one per task graph worker */
+	int32 NumWorkers = 0;
+
+	/** Bakes the sound waves even if their sequences are up to date */
+	bool bForce = false;
+};
+
+/**
+ * Bakes lip-sync sequence assets for many sound waves at once.
+ * Sound waves are processed concurrently on a bounded set of workers, reusing a pool of lip-sync contexts,
+ * and the 16-bit PCM is fed to the context in 10 ms chunks straight from the imported payload.
+ * Sound waves are loaded in Tick only as workers become free, and released once their sequence is stored,
+ * so at most one sound wave per worker is held in memory.
+ * The audio of a sound wave is read as a whole, since the imported payload can't be read partially and formats other than
+ * 16-bit PCM are decoded by the sound wave in one go, so the peak memory is about the number of workers times the largest decoded sound wave.
+ * Sequences store the hash of the source audio and of the model they were baked with, and are skipped while it matches.
+ * Assets are created on the game thread in Tick, so the editor stays responsive while baking.
+ */
+class LIPSYNCSYSTEMEDITOR_API FLipSyncBakeService : public FGCObject
+{
+public:
+	FLipSyncBakeService(const TArray<FAssetData>& InSoundWaveAssets, const FLipSyncBakeSettings& InSettings);
+	virtual ~FLipSyncBakeService() override;
+
+	/** Resolves the model and prepares the jobs, without loading the sound waves. Game thread only */
+	bool Start();
+
+	/**
+	 * Creates or updates the sequence assets baked so far, then loads the next sound waves for the free workers,
+	 * skipping the up to date ones. Game thread only. Returns true once everything is done
+	 */
+	bool Tick();
+
+	/** Blocks until the running jobs are done. Tick still has to be called afterwards to create the remaining assets */
+	void Wait();
+
+	/** Stops the workers after their current chunk. Sound waves not baked yet are left untouched */
+	void Cancel();
+
+	int32 GetNumOfJobs() const { return SoundWaveAssets.Num(); }
+	int32 GetNumOfBaked() const { return NumOfBaked; }
+	int32 GetNumOfSkipped() const { return NumOfSkipped; }
+	int32 GetNumOfFailed() const { return NumOfFailed; }
+	int32 GetNumOfDone() const { return NumOfBaked + NumOfSkipped + NumOfFailed; }
+
+	/** Packages of the created or updated sequences */
+	const TArray<UPackage*>& GetDirtyPackages() const { return DirtyPackages; }
+
+	/** Forgets the dirty packages, e.g. once they are saved, so that they are not accessed after being garbage collected */
+	void ResetDirtyPackages() { DirtyPackages.Reset(); }
+
+	//~ Begin FGCObject Interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FLipSyncBakeService"); }
+	//~ End FGCObject Interface
+
+private:
+	struct FJob
+	{
+		/** Set while the job is being baked */
+		TObjectPtr<USoundWave> SoundWave;
+		int32 AssetIndex = INDEX_NONE;
+		FName PackageName;
+		FName AssetName;
+		FString SourceHash;
+	};
+
+	struct FContext
+	{
+		TUniquePtr<ULipSyncWrapper> Wrapper;
+		uint32 SampleRate = 0;
+	};
+
+	struct FResult
+	{
+		int32 JobIndex = INDEX_NONE;
+		bool bSuccess = false;
+		TArray<FLipSyncFrame> Frames;
+	};
+
+	/** Loads the sound wave of the job and checks whether it has to be baked. Game thread only */
+	bool PrepareJob(FJob& Job);
+
+	void RunJob(int32 JobIndex);
+	bool BakeJob(const FJob& Job, TUniquePtr<ULipSyncWrapper>& Context, uint32& ContextSampleRate, TArray<FLipSyncFrame>& OutFrames) const;
+	void StoreSequence(const FJob& Job, TArray<FLipSyncFrame>&& Frames);
+
+	TArray<FAssetData> SoundWaveAssets;
+	FLipSyncBakeSettings Settings;
+
+	FString ModelPath;
+	FString ModelVersion;
+
+	TArray<FJob> Jobs;
+	int32 NextJobIndex = 0;
+	int32 NumOfWorkers = 1;
+	std::atomic<bool> bCancelled{false};
+	TArray<UE::Tasks::FTask> Workers;
+	TQueue<FResult, EQueueMode::Mpsc> Results;
+
+	/** Contexts not used by a running job. Creating a context is expensive, so they are reused by the following jobs */
+	TArray<FContext> FreeContexts;
+	FCriticalSection FreeContextsGuard;
+
+	int32 NumOfBaked = 0;
+	int32 NumOfSkipped = 0;
+	int32 NumOfFailed = 0;
+	TArray<UPackage*> DirtyPackages;
+};
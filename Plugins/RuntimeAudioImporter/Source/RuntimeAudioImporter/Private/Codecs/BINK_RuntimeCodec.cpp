@@ -84,12 +84,12 @@ namespace
 
 namespace
 {
-	bool EarlyOutIfAudioDataIsTooSmall(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+	bool EarlyOutIfAudioDataIsTooSmall(FRuntimeAudioDataView AudioData)
 	{
 		// BinkAudioFileHeader is only available with the encoding support
 #if WITH_RUNTIMEAUDIOIMPORTER_BINK_ENCODE_SUPPORT
 		// Early out if the audio data is too small to contain the header (otherwise it will crash upon assertion check in FBinkAudioInfo::ParseHeader)
-		if (AudioData.GetView().Num() < sizeof(BinkAudioFileHeader))
+		if (AudioData.Num() < sizeof(BinkAudioFileHeader))
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to read BINK compressed info since the audio data is too small"));
 			return false;
@@ -101,7 +101,7 @@ namespace
 	}
 }
 
-bool FBINK_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+bool FBINK_RuntimeCodec::CheckAudioFormat(FRuntimeAudioDataView AudioData)
 {
 #if WITH_RUNTIMEAUDIOIMPORTER_BINK_DECODE_SUPPORT
 	if (!EarlyOutIfAudioDataIsTooSmall(AudioData))
@@ -112,7 +112,7 @@ bool FBINK_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& A
 	FBinkAudioInfo AudioInfo;
 	FSoundQualityInfo SoundQualityInfo;
 
-	if (!AudioInfo.ReadCompressedInfo(AudioData.GetView().GetData(), AudioData.GetView().Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
+	if (!AudioInfo.ReadCompressedInfo(AudioData.GetData(), AudioData.Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
 	{
 		return false;
 	}
@@ -124,7 +124,7 @@ bool FBINK_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& A
 #endif
 }
 
-bool FBINK_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
+bool FBINK_RuntimeCodec::GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Retrieving header information for the BINK audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -140,7 +140,7 @@ bool FBINK_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntime
 	FBinkAudioInfo AudioInfo;
 	FSoundQualityInfo SoundQualityInfo;
 
-	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
+	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to read BINK compressed info"));
 		return false;
@@ -162,7 +162,7 @@ bool FBINK_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntime
 #endif
 }
 
-bool FBINK_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
+bool FBINK_RuntimeCodec::Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Encoding uncompressed audio data to BINK audio format.\nDecoded audio info: %s.\nQuality: %d"), *DecodedData.ToString(), Quality);
 
@@ -170,8 +170,8 @@ bool FBINK_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioSt
 	const uint8 CompressionLevel = GetCompressionLevelFromQualityIndex(Quality);
 
 	int16* TempInt16Buffer;
-	FRAW_RuntimeCodec::TranscodeRAWData<float, int16>(DecodedData.PCMInfo.PCMData.GetView().GetData(), DecodedData.PCMInfo.PCMData.GetView().Num(), TempInt16Buffer);
-	const int64 NumOfSamplesInBytes = DecodedData.PCMInfo.PCMData.GetView().Num() * sizeof(int16);
+	FRAW_RuntimeCodec::TranscodeRAWData<float, int16>(DecodedData.PCMData.GetData(), DecodedData.PCMData.Num(), TempInt16Buffer);
+	const int64 NumOfSamplesInBytes = DecodedData.PCMData.Num() * sizeof(int16);
 
 #if UE_VERSION_NEWER_THAN(5, 2, 9)
 	// If we're going to embed the seek-table in the stream, use -1 to give the largest table we can produce
@@ -207,7 +207,7 @@ bool FBINK_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioSt
 #endif
 }
 
-bool FBINK_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData)
+bool FBINK_RuntimeCodec::Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Decoding BINK audio data to uncompressed audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -224,31 +224,34 @@ bool FBINK_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioSt
 	FSoundQualityInfo SoundQualityInfo;
 
 	// Parse the audio header for the relevant information
-	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), &SoundQualityInfo))
+	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), &SoundQualityInfo))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to read BINK compressed info"));
 		return false;
 	}
 
-	TArray64<uint8> PCMData;
+	const int64 NumOfSamples = SoundQualityInfo.SampleDataSize / sizeof(int16);
 
-	// Decompress all the sample data
-	PCMData.Empty(SoundQualityInfo.SampleDataSize);
-	PCMData.AddZeroed(SoundQualityInfo.SampleDataSize);
-	AudioInfo.ExpandFile(PCMData.GetData(), &SoundQualityInfo);
-
-	// Getting the number of frames
-	DecodedData.PCMInfo.PCMNumOfFrames = PCMData.Num() / SoundQualityInfo.NumChannels / sizeof(int16);
-
-	const int64 NumOfSamples = PCMData.Num() / sizeof(int16);
+	// Allocating the final float buffer once, reusing the caller's buffer if there is one
+	if (!DecodedData.PCMInfo.PCMData.SetNumUninitialized(NumOfSamples))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate memory for BINK Decoder"));
+		return false;
+	}
 
-	// Transcoding int16 to float format
+	// Decompressing the 16-bit samples into the second half of the float buffer and widening them in place,
+	// so that the 16-bit and float PCM data never occupy separate allocations
 	{
-		float* TempFloatBuffer;
-		FRAW_RuntimeCodec::TranscodeRAWData<int16, float>(reinterpret_cast<int16*>(PCMData.GetData()), NumOfSamples, TempFloatBuffer);
-		DecodedData.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(TempFloatBuffer, NumOfSamples);
+		uint8* PCMBuffer = reinterpret_cast<uint8*>(DecodedData.PCMInfo.PCMData.GetView().GetData());
+		uint8* Int16PCMData = PCMBuffer + NumOfSamples * (sizeof(float) - sizeof(int16));
+		FMemory::Memzero(Int16PCMData, NumOfSamples * sizeof(int16));
+		AudioInfo.ExpandFile(Int16PCMData, &SoundQualityInfo);
+		FRAW_RuntimeCodec::TranscodeRAWDataInPlace<int16, float>(PCMBuffer, NumOfSamples);
 	}
 
+	// Getting the number of frames
+	DecodedData.PCMInfo.PCMNumOfFrames = NumOfSamples / SoundQualityInfo.NumChannels;
+
 	// Getting basic audio information
 	{
 		DecodedData.SoundWaveBasicInfo.Duration = SoundQualityInfo.Duration;
@@ -0,0 +1,48 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Codecs/BaseRuntimeCodec.h"
+#include "RuntimeAudioImporterDefines.h"
+
+namespace
+{
+	/** Sources larger than this are not loaded into memory as a whole just to read the header */
+	constexpr int64 MaxNumOfHeaderFallbackBytes = 256 * 1024 * 1024;
+}
+
+bool FBaseRuntimeCodec::GetHeaderInfoFromStream(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source, FRuntimeAudioHeaderInfo& HeaderInfo)
+{
+	// Opening a streaming decoder parses only the header (and, for some formats, the last page) instead of the whole stream
+	if (Source->Seek(0))
+	{
+		if (TUniquePtr<FRuntimeStreamingDecoder> StreamingDecoder = CreateStreamingDecoder(Source))
+		{
+			if (StreamingDecoder->Open() == ERuntimeStreamingDecodeResult::Succeeded && StreamingDecoder->GetTotalNumOfFrames() >= 0)
+			{
+				HeaderInfo.Duration = static_cast<float>(StreamingDecoder->GetTotalNumOfFrames()) / StreamingDecoder->GetSampleRate();
+				HeaderInfo.NumOfChannels = StreamingDecoder->GetNumOfChannels();
+				HeaderInfo.SampleRate = StreamingDecoder->GetSampleRate();
+				HeaderInfo.PCMDataSize = StreamingDecoder->GetTotalNumOfFrames() * StreamingDecoder->GetNumOfChannels();
+				HeaderInfo.AudioFormat = GetAudioFormat();
+				return true;
+			}
+		}
+	}
+
+	// Falling back to reading the whole source, which is only acceptable for sources of a reasonable size
+	const int64 SourceSize = Source->GetSize();
+	if (!Source->IsComplete() || SourceSize <= 0 || SourceSize > MaxNumOfHeaderFallbackBytes || !Source->Seek(0))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to retrieve %s header information from the stream of %lld bytes without decoding it"), *UEnum::GetValueAsString(GetAudioFormat()), SourceSize);
+		return false;
+	}
+
+	TArray64<uint8> AudioData;
+	AudioData.SetNumUninitialized(SourceSize);
+	if (Source->Read(AudioData.GetData(), SourceSize) != SourceSize)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to read %lld bytes from the stream to retrieve the header information"), SourceSize);
+		return false;
+	}
+
+	return GetHeaderInfo(FEncodedAudioView(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()), GetAudioFormat()), HeaderInfo);
+}
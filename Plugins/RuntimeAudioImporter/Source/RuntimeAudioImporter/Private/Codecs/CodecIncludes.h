@@ -52,6 +52,12 @@ THIRD_PARTY_INCLUDES_START
 #include "vorbis/vorbisenc.h"
 #pragma pack(pop)
 #endif
+#if WITH_OGGVORBIS
+#define OV_EXCLUDE_STATIC_CALLBACKS
+#pragma pack(push, 8)
+#include "vorbis/vorbisfile.h"
+#pragma pack(pop)
+#endif
 #endif
 
 #if WITH_RUNTIMEAUDIOIMPORTER_BINK_ENCODE_SUPPORT
@@ -9,9 +9,9 @@
 #include "CodecIncludes.h"
 #undef INCLUDE_FLAC
 
-bool FFLAC_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+bool FFLAC_RuntimeCodec::CheckAudioFormat(FRuntimeAudioDataView AudioData)
 {
-	drflac* FLAC = drflac_open_memory(AudioData.GetView().GetData(), AudioData.GetView().Num(), nullptr);
+	drflac* FLAC = drflac_open_memory(AudioData.GetData(), AudioData.Num(), nullptr);
 
 	if (!FLAC)
 	{
@@ -22,14 +22,14 @@ bool FFLAC_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& A
 	return true;
 }
 
-bool FFLAC_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
+bool FFLAC_RuntimeCodec::GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Retrieving header information for FLAC audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
 	ensureAlwaysMsgf(EncodedData.AudioFormat == GetAudioFormat(), TEXT("Attempting to retrieve audio header information in the '%s' codec, but the data format is encoded in '%s'"),
 	                 *UEnum::GetValueAsString(GetAudioFormat()), *UEnum::GetValueAsString(EncodedData.AudioFormat));
 
-	drflac* FLAC = drflac_open_memory(EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), nullptr);
+	drflac* FLAC = drflac_open_memory(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), nullptr);
 	if (!FLAC)
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to initialize FLAC Decoder"));
@@ -49,13 +49,13 @@ bool FFLAC_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntime
 	return true;
 }
 
-bool FFLAC_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
+bool FFLAC_RuntimeCodec::Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
 {
 	ensureMsgf(false, TEXT("FLAC codec does not support encoding at the moment"));
 	return false;
 }
 
-bool FFLAC_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData)
+bool FFLAC_RuntimeCodec::Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Decoding FLAC audio data to uncompressed audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -63,7 +63,7 @@ bool FFLAC_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioSt
 	                 *UEnum::GetValueAsString(GetAudioFormat()), *UEnum::GetValueAsString(EncodedData.AudioFormat));
 
 	// Initializing FLAC codec
-	drflac* FLAC_Decoder = drflac_open_memory(EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), nullptr);
+	drflac* FLAC_Decoder = drflac_open_memory(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), nullptr);
 
 	if (!FLAC_Decoder)
 	{
@@ -71,10 +71,8 @@ bool FFLAC_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioSt
 		return false;
 	}
 
-	// Allocating memory for PCM data
-	float* TempPCMData = static_cast<float*>(FMemory::Malloc(FLAC_Decoder->totalPCMFrameCount * FLAC_Decoder->channels * sizeof(float)));
-
-	if (!TempPCMData)
+	// Allocating memory for PCM data, reusing the caller's buffer if there is one
+	if (!DecodedData.PCMInfo.PCMData.SetNumUninitialized(static_cast<int64>(FLAC_Decoder->totalPCMFrameCount * FLAC_Decoder->channels)))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate memory for FLAC Decoder"));
 		drflac_close(FLAC_Decoder);
@@ -82,12 +80,10 @@ bool FFLAC_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioSt
 	}
 
 	// Filling in PCM data and getting the number of frames
-	DecodedData.PCMInfo.PCMNumOfFrames = drflac_read_pcm_frames_f32(FLAC_Decoder, FLAC_Decoder->totalPCMFrameCount, TempPCMData);
-
-	// Getting PCM data size
-	const int64 TempPCMDataSize = static_cast<int64>(DecodedData.PCMInfo.PCMNumOfFrames * FLAC_Decoder->channels);
+	DecodedData.PCMInfo.PCMNumOfFrames = drflac_read_pcm_frames_f32(FLAC_Decoder, FLAC_Decoder->totalPCMFrameCount, DecodedData.PCMInfo.PCMData.GetView().GetData());
 
-	DecodedData.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(TempPCMData, TempPCMDataSize);
+	// Trimming the PCM data in case fewer frames were decoded than declared in the header
+	DecodedData.PCMInfo.PCMData.SetNumUninitialized(static_cast<int64>(DecodedData.PCMInfo.PCMNumOfFrames * FLAC_Decoder->channels));
 
 	// Getting basic audio information
 	{
@@ -101,3 +97,82 @@ bool FFLAC_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioSt
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully decoded FLAC audio data to uncompressed audio format.\nDecoded audio info: %s"), *DecodedData.ToString());
 	return true;
 }
+
+namespace
+{
+	/**
+	 * Streaming FLAC decoder pulling the encoded data through dr_flac callbacks
+	 */
+	class FFLAC_StreamingDecoder : public FRuntimeStreamingDecoder
+	{
+	public:
+		using FRuntimeStreamingDecoder::FRuntimeStreamingDecoder;
+
+		virtual ~FFLAC_StreamingDecoder() override
+		{
+			Close();
+		}
+
+	protected:
+		//~ Begin FRuntimeStreamingDecoder Interface
+		virtual bool Open_Internal() override
+		{
+			FLAC = drflac_open(&OnRead, &OnSeek, this, nullptr);
+			if (!FLAC)
+			{
+				return false;
+			}
+
+			NumOfChannels = FLAC->channels;
+			SampleRate = FLAC->sampleRate;
+			TotalNumOfFrames = FLAC->totalPCMFrameCount > 0 ? static_cast<int64>(FLAC->totalPCMFrameCount) : -1;
+			return true;
+		}
+
+		virtual int64 DecodeFrames_Internal(float* OutPCMData, int64 MaxNumOfFrames) override
+		{
+			return static_cast<int64>(drflac_read_pcm_frames_f32(FLAC, MaxNumOfFrames, OutPCMData));
+		}
+
+		virtual bool Seek_Internal(int64 FrameIndex) override
+		{
+			return drflac_seek_to_pcm_frame(FLAC, FrameIndex) == DRFLAC_TRUE;
+		}
+
+		virtual void Close_Internal() override
+		{
+			if (FLAC)
+			{
+				drflac_close(FLAC);
+				FLAC = nullptr;
+			}
+		}
+
+		virtual int64 GetMinNumOfBytesAhead() const override
+		{
+			// Covers the metadata blocks (including embedded pictures of moderate size) and the largest frames of common encoder settings
+			return 256 * 1024;
+		}
+		//~ End FRuntimeStreamingDecoder Interface
+
+	private:
+		static size_t OnRead(void* UserData, void* BufferOut, size_t BytesToRead)
+		{
+			return static_cast<size_t>(static_cast<FFLAC_StreamingDecoder*>(UserData)->Source->Read(static_cast<uint8*>(BufferOut), BytesToRead));
+		}
+
+		static drflac_bool32 OnSeek(void* UserData, int Offset, drflac_seek_origin Origin)
+		{
+			FRuntimeAudioStreamSource& StreamSource = *static_cast<FFLAC_StreamingDecoder*>(UserData)->Source;
+			const int64 Position = Origin == drflac_seek_origin_current ? StreamSource.Tell() + Offset : Offset;
+			return StreamSource.Seek(Position) ? DRFLAC_TRUE : DRFLAC_FALSE;
+		}
+
+		drflac* FLAC = nullptr;
+	};
+}
+
+TUniquePtr<FRuntimeStreamingDecoder> FFLAC_RuntimeCodec::CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source)
+{
+	return MakeUnique<FFLAC_StreamingDecoder>(MoveTemp(Source));
+}
@@ -1,25 +1,158 @@
 ﻿// Georgy Treshchev 2024.
 
 #include "Codecs/MP3_RuntimeCodec.h"
+#include "Codecs/MP3_RuntimeEncoder.h"
 #include "RuntimeAudioImporterDefines.h"
 #include "RuntimeAudioImporterTypes.h"
 #include "HAL/UnrealMemory.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
 
 #define INCLUDE_MP3
 #include "CodecIncludes.h"
 #undef INCLUDE_MP3
 
-bool FMP3_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+namespace
+{
+	/**
+	 * Minimum SNR of the round trip of the whole signal and of its first and last frames, dB
+	 * The encoder reaches about 36 dB on the whole signal and 30 dB on the edges at the lowest quality, at every supported sample rate
+	 */
+	constexpr double MinRoundTripSNR = 30.;
+	constexpr double MinRoundTripEdgeSNR = 25.;
+
+	/**
+	 * Encode a synthetic test signal with the MP3 codec, decode it again and log the signal-to-noise ratio and the compression ratio
+	 * The signal mixes tones, a chirp and a decaying note over a low noise floor, which exercises the masking, the mid/side decision and the lowpass
+	 * The round trip fails if the SNR is below MinRoundTripSNR, or below MinRoundTripEdgeSNR on the first or the last frame
+	 * Usage: RuntimeAudioImporter.MP3.RoundTrip [Quality=40] [NumOfChannels=2] [SampleRate=44100] [DurationSec=5]
+	 */
+	FAutoConsoleCommand MP3RoundTripCommand(
+		TEXT("RuntimeAudioImporter.MP3.RoundTrip"),
+		TEXT("Encodes a test signal to MP3, decodes it and logs the SNR and size. Usage: RuntimeAudioImporter.MP3.RoundTrip [Quality=40] [NumOfChannels=2] [SampleRate=44100] [DurationSec=5]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const uint8 Quality = static_cast<uint8>(FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 40, 0, 100));
+			const uint32 NumOfChannels = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 2, 1, 8);
+			const uint32 SampleRate = FMath::Clamp(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 44100, 8000, 192000);
+			const float DurationSec = FMath::Clamp(Args.Num() > 3 ? FCString::Atof(*Args[3]) : 5.f, 0.1f, 600.f);
+
+			const uint32 NumOfFrames = static_cast<uint32>(DurationSec * SampleRate);
+			TArray<float> PCMData;
+			PCMData.SetNumUninitialized(NumOfFrames * NumOfChannels);
+
+			// Fixed seed, so runs with the same arguments are comparable
+			FRandomStream Random(1234);
+			for (uint32 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+			{
+				const double Time = static_cast<double>(FrameIndex) / SampleRate;
+				for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+				{
+					const double Tones = 0.2 * FMath::Sin(2 * PI * 440 * Time + ChannelIndex) + 0.1 * FMath::Sin(2 * PI * 1234.5 * Time);
+					const double Chirp = 0.05 * FMath::Sin(2 * PI * 3000 * Time * (1 + Time * 0.2));
+					const double Note = 0.3 * FMath::Sin(2 * PI * 220 * (1 + ChannelIndex * 0.01) * Time) * FMath::Exp(-FMath::Fmod(Time, 0.5) * 6);
+					PCMData[FrameIndex * NumOfChannels + ChannelIndex] = static_cast<float>(Tones + Chirp + Note + 0.003 * Random.FRandRange(-1.f, 1.f));
+				}
+			}
+
+			FDecodedAudioStruct SourceData;
+			SourceData.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(PCMData);
+			SourceData.PCMInfo.PCMNumOfFrames = NumOfFrames;
+			SourceData.SoundWaveBasicInfo.NumOfChannels = NumOfChannels;
+			SourceData.SoundWaveBasicInfo.SampleRate = SampleRate;
+			SourceData.SoundWaveBasicInfo.Duration = DurationSec;
+
+			FMP3_RuntimeCodec Codec;
+			FEncodedAudioStruct EncodedData;
+			double StartTime = FPlatformTime::Seconds();
+			if (!Codec.Encode(FDecodedAudioView(SourceData), EncodedData, Quality))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("MP3 round trip: encoding failed"));
+				return;
+			}
+			const double EncodingTime = FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			FDecodedAudioStruct DecodedData;
+			if (!Codec.Decode(FEncodedAudioView(EncodedData), DecodedData))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("MP3 round trip: decoding failed"));
+				return;
+			}
+			const double DecodingTime = FPlatformTime::Seconds() - StartTime;
+
+			const uint32 NumOfDecodedChannels = DecodedData.SoundWaveBasicInfo.NumOfChannels;
+			const int64 NumOfEncodedBytes = EncodedData.AudioData.GetView().Num();
+			const double CompressionRatio = static_cast<double>(NumOfFrames) * NumOfChannels * sizeof(int16) / FMath::Max<int64>(NumOfEncodedBytes, 1);
+
+			UE_LOG(LogRuntimeAudioImporter, Display, TEXT("MP3 round trip: quality %d, %d channels at %d Hz -> %d channels at %d Hz, %u -> %u frames, %lld bytes (%.1fx smaller than 16-bit PCM), encoding %.3f sec, decoding %.3f sec"),
+			       Quality, NumOfChannels, SampleRate, NumOfDecodedChannels, DecodedData.SoundWaveBasicInfo.SampleRate, NumOfFrames, DecodedData.PCMInfo.PCMNumOfFrames,
+			       NumOfEncodedBytes, CompressionRatio, EncodingTime, DecodingTime);
+
+			if (NumOfDecodedChannels != NumOfChannels || DecodedData.SoundWaveBasicInfo.SampleRate != SampleRate)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Display, TEXT("MP3 round trip: the layout was converted by the encoder, so the SNR is not measured"));
+				return;
+			}
+
+			// Decoders not aware of the Info tag output the tag frame and the encoder delay, so the alignment with the input is searched for
+			const float* DecodedPCMData = DecodedData.PCMInfo.PCMData.GetView().GetData();
+			const int64 NumOfDecodedFrames = DecodedData.PCMInfo.PCMNumOfFrames;
+			auto GetSNR = [&PCMData, DecodedPCMData, NumOfDecodedFrames, NumOfChannels](int64 Offset, int64 FirstFrame, int64 EndFrame)
+			{
+				double SignalEnergy = 0, NoiseEnergy = 0;
+				for (int64 FrameIndex = FirstFrame; FrameIndex < EndFrame; ++FrameIndex)
+				{
+					for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+					{
+						const double Source = PCMData[FrameIndex * NumOfChannels + ChannelIndex];
+						const double Decoded = FrameIndex + Offset < NumOfDecodedFrames ? DecodedPCMData[(FrameIndex + Offset) * NumOfChannels + ChannelIndex] : 0;
+						SignalEnergy += Source * Source;
+						NoiseEnergy += (Source - Decoded) * (Source - Decoded);
+					}
+				}
+				return 10 * FMath::LogX(10., FMath::Max(SignalEnergy, DBL_MIN) / FMath::Max(NoiseEnergy, DBL_MIN));
+			};
+
+			double BestSNR = -DBL_MAX;
+			int64 BestOffset = 0;
+			for (const int64 Offset : {0, 1152 + FMP3_RuntimeEncoder::GetEncoderDelay()})
+			{
+				const double SNR = GetSNR(Offset, 0, NumOfFrames);
+				if (SNR > BestSNR)
+				{
+					BestSNR = SNR;
+					BestOffset = Offset;
+				}
+			}
+
+			// The edges are reported separately, since losses there (e.g. a wrong encoder delay) barely affect the SNR of the whole signal
+			const int64 NumOfEdgeFrames = FMath::Min<int64>(1152, NumOfFrames);
+			const double FirstFrameSNR = GetSNR(BestOffset, 0, NumOfEdgeFrames);
+			const double LastFrameSNR = GetSNR(BestOffset, NumOfFrames - NumOfEdgeFrames, NumOfFrames);
+
+			UE_LOG(LogRuntimeAudioImporter, Display, TEXT("MP3 round trip: SNR %.2f dB (first frame %.2f dB, last frame %.2f dB) at an offset of %lld frames"), BestSNR, FirstFrameSNR, LastFrameSNR, BestOffset);
+
+			if (BestSNR < MinRoundTripSNR || FMath::Min(FirstFrameSNR, LastFrameSNR) < MinRoundTripEdgeSNR)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("MP3 round trip: FAILED, the SNR must be at least %.0f dB and at least %.0f dB on the first and the last frame"), MinRoundTripSNR, MinRoundTripEdgeSNR);
+				return;
+			}
+			UE_LOG(LogRuntimeAudioImporter, Display, TEXT("MP3 round trip: PASSED"));
+		}));
+}
+
+bool FMP3_RuntimeCodec::CheckAudioFormat(FRuntimeAudioDataView AudioData)
 {
 #if DR_MP3_IMPLEMENTATION
 	drmp3 MP3;
-	if (!drmp3_init_memory(&MP3, AudioData.GetView().GetData(), AudioData.GetView().Num(), nullptr))
+	if (!drmp3_init_memory(&MP3, AudioData.GetData(), AudioData.Num(), nullptr))
 	{
 		return false;
 	}
 	drmp3_uninit(&MP3);
 #elif MINIMP3_IMPLEMENTATION
-	if (mp3dec_detect_buf(AudioData.GetView().GetData(), AudioData.GetView().Num()) != 0)
+	if (mp3dec_detect_buf(AudioData.GetData(), AudioData.Num()) != 0)
 	{
 		return false;
 	}
@@ -27,7 +160,7 @@ bool FMP3_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& Au
 	return true;
 }
 
-bool FMP3_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
+bool FMP3_RuntimeCodec::GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Retrieving header information for MP3 audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -36,7 +169,7 @@ bool FMP3_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeA
 
 #if DR_MP3_IMPLEMENTATION
 	drmp3 MP3;
-	if (!drmp3_init_memory(&MP3, EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), nullptr))
+	if (!drmp3_init_memory(&MP3, EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), nullptr))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to initialize MP3 Decoder"));
 		return false;
@@ -54,36 +187,112 @@ bool FMP3_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeA
 
 	drmp3_uninit(&MP3);
 #elif MINIMP3_IMPLEMENTATION
-	mp3dec_t MP3;
-	mp3dec_file_info_t SoundInfo;
+	// Walking the frame headers instead of decoding the whole file, so no PCM buffer is allocated
+	struct FMP3HeaderScan
+	{
+		uint64 NumOfFrames = 0;
+		int32 NumOfChannels = 0;
+		int32 SampleRate = 0;
+		bool bFirstFrame = true;
+	} HeaderScan;
+
+	const int ScanResult = mp3dec_iterate_buf(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), [](void* UserData, const uint8_t* Frame, int FrameSize, int FreeFormatBytes, size_t BufSize, uint64_t Offset, mp3dec_frame_info_t* FrameInfo) -> int
+	{
+		FMP3HeaderScan& Scan = *static_cast<FMP3HeaderScan*>(UserData);
+		Scan.NumOfChannels = FrameInfo->channels;
+		Scan.SampleRate = FrameInfo->hz;
+
+		if (Scan.bFirstFrame)
+		{
+			Scan.bFirstFrame = false;
+
+			// Matching the samples produced by the full decode, which skips the Xing/Info tag frame, the encoder delay and the padding
+			uint32_t NumOfTaggedFrames = 0;
+			int Delay = 0, Padding = 0;
+			if (FrameInfo->layer == 3 && mp3dec_check_vbrtag(Frame, FrameSize, &NumOfTaggedFrames, &Delay, &Padding) > 0)
+			{
+				const uint64 NumOfTaggedSamples = static_cast<uint64>(hdr_frame_samples(Frame)) * NumOfTaggedFrames;
+				const uint64 NumOfSkippedSamples = static_cast<uint64>(FMath::Max(Delay, 0)) + static_cast<uint64>(FMath::Max(Padding, 0));
+				Scan.NumOfFrames = NumOfTaggedSamples > NumOfSkippedSamples ? NumOfTaggedSamples - NumOfSkippedSamples : 0;
+				return MP3D_E_USER;
+			}
+		}
+
+		Scan.NumOfFrames += hdr_frame_samples(Frame);
+		return 0;
+	}, &HeaderScan);
 
-	if (mp3dec_load_buf(&MP3, EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), &SoundInfo, nullptr, nullptr) != 0)
+	if ((ScanResult < 0 && ScanResult != MP3D_E_USER) || HeaderScan.NumOfFrames == 0 || HeaderScan.SampleRate <= 0)
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to load MP3 data"));
 		return false;
 	}
 
 	{
-		HeaderInfo.Duration = static_cast<float>(SoundInfo.samples) / static_cast<float>(SoundInfo.hz) / static_cast<float>(SoundInfo.channels);
-		HeaderInfo.NumOfChannels = SoundInfo.channels;
-		HeaderInfo.SampleRate = SoundInfo.hz;
-		HeaderInfo.PCMDataSize = SoundInfo.samples;
+		HeaderInfo.Duration = static_cast<float>(HeaderScan.NumOfFrames) / static_cast<float>(HeaderScan.SampleRate);
+		HeaderInfo.NumOfChannels = HeaderScan.NumOfChannels;
+		HeaderInfo.SampleRate = HeaderScan.SampleRate;
+		HeaderInfo.PCMDataSize = HeaderScan.NumOfFrames * HeaderScan.NumOfChannels;
 		HeaderInfo.AudioFormat = GetAudioFormat();
 	}
-
-	FMemory::Free(SoundInfo.buffer);
 #endif
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully retrieved header information for MP3 audio format.\nHeader info: %s"), *HeaderInfo.ToString());
 	return true;
 }
 
-bool FMP3_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
+bool FMP3_RuntimeCodec::Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
 {
-	ensureMsgf(false, TEXT("MP3 codec does not support encoding at the moment"));
-	return false;
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Encoding uncompressed audio data to MP3 audio format.\nDecoded audio info: %s.\nQuality: %d"), *DecodedData.ToString(), Quality);
+
+	const uint32 NumOfChannels = DecodedData.SoundWaveBasicInfo.NumOfChannels;
+
+	FMP3_RuntimeEncoder Encoder;
+	if (!Encoder.Init(NumOfChannels, DecodedData.SoundWaveBasicInfo.SampleRate, Quality))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to initialize MP3 encoder"));
+		return false;
+	}
+
+	TArray64<uint8> EncodedAudioData;
+
+	// Reserving the size of the constant bitrate stream up front (a frame of 1152 samples at the encoded sample rate)
+	const double Duration = static_cast<double>(DecodedData.PCMNumOfFrames) / DecodedData.SoundWaveBasicInfo.SampleRate;
+	EncodedAudioData.Reserve(static_cast<int64>((Duration + 0.1) * Encoder.GetBitrate() * 1000 / 8) + 2 * 1441);
+
+	// Fed block by block, so that the encoder does not hold a deinterleaved copy of the whole input
+	constexpr int64 NumOfFramesPerBlock = 65536;
+	for (int64 FrameIndex = 0; FrameIndex < DecodedData.PCMNumOfFrames; FrameIndex += NumOfFramesPerBlock)
+	{
+		const int64 NumOfBlockFrames = FMath::Min<int64>(NumOfFramesPerBlock, DecodedData.PCMNumOfFrames - FrameIndex);
+		if (!Encoder.EncodeFrames(DecodedData.PCMData.GetData() + FrameIndex * NumOfChannels, NumOfBlockFrames, EncodedAudioData))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to encode MP3 frames"));
+			return false;
+		}
+	}
+
+	if (!Encoder.Flush(EncodedAudioData))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to encode MP3 frames"));
+		return false;
+	}
+
+	// Completing the Info tag frame written at the beginning of the stream
+	TArray64<uint8> InfoFrame;
+	Encoder.GetInfoFrame(InfoFrame);
+	FMemory::Memcpy(EncodedAudioData.GetData(), InfoFrame.GetData(), InfoFrame.Num());
+
+	// Populating the encoded audio data
+	{
+		EncodedData.AudioData = FRuntimeBulkDataBuffer<uint8>(EncodedAudioData);
+		EncodedData.AudioFormat = ERuntimeAudioFormat::Mp3;
+	}
+
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully encoded uncompressed audio data to MP3 audio format at %d kbps.\nEncoded audio info: %s"), Encoder.GetBitrate(), *EncodedData.ToString());
+	return true;
 }
 
-bool FMP3_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData)
+bool FMP3_RuntimeCodec::Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Decoding MP3 audio data to uncompressed audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -94,7 +303,7 @@ bool FMP3_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 	drmp3 MP3_Decoder;
 
 	// Initializing MP3 codec
-	if (!drmp3_init_memory(&MP3_Decoder, EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), nullptr))
+	if (!drmp3_init_memory(&MP3_Decoder, EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), nullptr))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize MP3 Decoder"));
 		return false;
@@ -102,10 +311,8 @@ bool FMP3_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 
 	const drmp3_uint64 PCMFrameCount = drmp3_get_pcm_frame_count(&MP3_Decoder);
 
-	// Allocating memory for PCM data
-	float* TempPCMData = static_cast<float*>(FMemory::Malloc(PCMFrameCount * MP3_Decoder.channels * sizeof(float)));
-
-	if (!TempPCMData)
+	// Allocating memory for PCM data, reusing the caller's buffer if there is one
+	if (!DecodedData.PCMInfo.PCMData.SetNumUninitialized(static_cast<int64>(PCMFrameCount * MP3_Decoder.channels)))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate memory for MP3 Decoder"));
 		drmp3_uninit(&MP3_Decoder);
@@ -113,12 +320,10 @@ bool FMP3_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 	}
 
 	// Filling in PCM data and getting the number of frames
-	DecodedData.PCMInfo.PCMNumOfFrames = drmp3_read_pcm_frames_f32(&MP3_Decoder, PCMFrameCount, TempPCMData);
-
-	// Getting PCM data size
-	const int64 TempPCMDataSize = static_cast<int64>(DecodedData.PCMInfo.PCMNumOfFrames * MP3_Decoder.channels);
+	DecodedData.PCMInfo.PCMNumOfFrames = drmp3_read_pcm_frames_f32(&MP3_Decoder, PCMFrameCount, DecodedData.PCMInfo.PCMData.GetView().GetData());
 
-	DecodedData.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(TempPCMData, TempPCMDataSize);
+	// Trimming the PCM data in case fewer frames were decoded than counted
+	DecodedData.PCMInfo.PCMData.SetNumUninitialized(static_cast<int64>(DecodedData.PCMInfo.PCMNumOfFrames * MP3_Decoder.channels));
 
 	// Getting basic audio information
 	{
@@ -139,7 +344,7 @@ bool FMP3_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 	mp3dec_t MP3_Decoder;
 	mp3dec_file_info_t SoundInfo;
 
-	if (mp3dec_load_buf(&MP3_Decoder, EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), &SoundInfo, nullptr, nullptr) != 0)
+	if (mp3dec_load_buf(&MP3_Decoder, EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), &SoundInfo, nullptr, nullptr) != 0)
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to load MP3 data"));
 		return false;
@@ -165,3 +370,491 @@ bool FMP3_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully decoded MP3 audio data to uncompressed audio format.\nDecoded audio info: %s"), *DecodedData.ToString());
 	return true;
 }
+
+namespace
+{
+#if DR_MP3_IMPLEMENTATION
+	/**
+	 * Streaming MP3 decoder pulling the encoded data through dr_mp3 callbacks
+	 */
+	class FMP3_StreamingDecoder : public FRuntimeStreamingDecoder
+	{
+	public:
+		using FRuntimeStreamingDecoder::FRuntimeStreamingDecoder;
+
+		virtual ~FMP3_StreamingDecoder() override
+		{
+			Close();
+		}
+
+	protected:
+		//~ Begin FRuntimeStreamingDecoder Interface
+		virtual bool Open_Internal() override
+		{
+			if (!drmp3_init(&MP3, &OnRead, &OnSeek, this, nullptr))
+			{
+				return false;
+			}
+			bInitialized = true;
+
+			NumOfChannels = MP3.channels;
+			SampleRate = MP3.sampleRate;
+
+			// The frame count is not stored in the stream, so it can only be counted if the whole stream is available
+			if (Source->IsSeekable())
+			{
+				TotalNumOfFrames = static_cast<int64>(drmp3_get_pcm_frame_count(&MP3));
+			}
+			return true;
+		}
+
+		virtual int64 DecodeFrames_Internal(float* OutPCMData, int64 MaxNumOfFrames) override
+		{
+			const int64 NumOfDecodedFrames = static_cast<int64>(drmp3_read_pcm_frames_f32(&MP3, MaxNumOfFrames, OutPCMData));
+
+			// dr_mp3 latches the end of the stream on a short read, which is only final once the source is complete
+			if (NumOfDecodedFrames == 0 && !Source->IsComplete())
+			{
+				MP3.atEnd = DRMP3_FALSE;
+			}
+			return NumOfDecodedFrames;
+		}
+
+		virtual bool Seek_Internal(int64 FrameIndex) override
+		{
+			return drmp3_seek_to_pcm_frame(&MP3, FrameIndex) == DRMP3_TRUE;
+		}
+
+		virtual void Close_Internal() override
+		{
+			if (bInitialized)
+			{
+				drmp3_uninit(&MP3);
+				bInitialized = false;
+			}
+		}
+
+		virtual int64 GetMinNumOfBytesAhead() const override
+		{
+			// dr_mp3 refills its internal buffer in chunks of 16 KB
+			return 32 * 1024;
+		}
+		//~ End FRuntimeStreamingDecoder Interface
+
+	private:
+		static size_t OnRead(void* UserData, void* BufferOut, size_t BytesToRead)
+		{
+			return static_cast<size_t>(static_cast<FMP3_StreamingDecoder*>(UserData)->Source->Read(static_cast<uint8*>(BufferOut), BytesToRead));
+		}
+
+		static drmp3_bool32 OnSeek(void* UserData, int Offset, drmp3_seek_origin Origin)
+		{
+			FRuntimeAudioStreamSource& StreamSource = *static_cast<FMP3_StreamingDecoder*>(UserData)->Source;
+			const int64 Position = Origin == drmp3_seek_origin_current ? StreamSource.Tell() + Offset : Offset;
+			return StreamSource.Seek(Position) ? DRMP3_TRUE : DRMP3_FALSE;
+		}
+
+		drmp3 MP3;
+		bool bInitialized = false;
+	};
+#elif MINIMP3_IMPLEMENTATION
+	/**
+	 * Streaming MP3 decoder feeding minimp3 frame by frame from a small input window
+	 */
+	class FMP3_StreamingDecoder : public FRuntimeStreamingDecoder
+	{
+	public:
+		using FRuntimeStreamingDecoder::FRuntimeStreamingDecoder;
+
+		virtual ~FMP3_StreamingDecoder() override
+		{
+			Close();
+		}
+
+	protected:
+		//~ Begin FRuntimeStreamingDecoder Interface
+		virtual bool Open_Internal() override
+		{
+			ResetDecoder();
+			NumOfDelayFrames = 0;
+			NumOfOutputFrames = INDEX_NONE;
+
+			// Skipping the ID3v2 tag, since its contents may resemble frame headers
+			uint8 TagHeader[10];
+			const size_t TagSize = Source->Read(TagHeader, sizeof(TagHeader)) == sizeof(TagHeader) ? mp3dec_skip_id3v2(TagHeader, sizeof(TagHeader)) : 0;
+			if (!Source->Seek(static_cast<int64>(TagSize)))
+			{
+				return false;
+			}
+			DataStartPosition = Source->Tell();
+
+			if (!SkipVBRTag())
+			{
+				return false;
+			}
+
+			// Decoding the first frame to retrieve the stream parameters, keeping its samples for the first read
+			const int32 NumOfFrameSamples = DecodeNextFrame(true);
+			if (NumOfFrameSamples <= 0)
+			{
+				return false;
+			}
+
+			NumOfChannels = FrameInfo.channels;
+			SampleRate = FrameInfo.hz;
+			StartPendingFrame(NumOfFrameSamples);
+
+			// The tag holds the frame count. Otherwise it is counted by walking the frame headers if the whole stream is available
+			if (NumOfOutputFrames >= 0)
+			{
+				TotalNumOfFrames = NumOfOutputFrames;
+			}
+			else if (Source->IsSeekable())
+			{
+				int64 NumOfFrames = NumOfFrameSamples;
+				for (int32 NumOfNextFrameSamples = DecodeNextFrame(false); NumOfNextFrameSamples > 0; NumOfNextFrameSamples = DecodeNextFrame(false))
+				{
+					NumOfFrames += NumOfNextFrameSamples;
+				}
+				TotalNumOfFrames = NumOfFrames;
+				return Seek_Internal(0);
+			}
+			return true;
+		}
+
+		virtual int64 DecodeFrames_Internal(float* OutPCMData, int64 MaxNumOfFrames) override
+		{
+			int64 NumOfDecodedFrames = 0;
+			while (NumOfDecodedFrames < MaxNumOfFrames)
+			{
+				// The padding at the end of a tagged stream is not returned
+				if (NumOfOutputFrames >= 0 && OutputPosition >= NumOfOutputFrames)
+				{
+					break;
+				}
+
+				if (NumOfPendingFrames == 0)
+				{
+					const int32 NumOfFrameSamples = DecodeNextFrame(true);
+					if (NumOfFrameSamples <= 0)
+					{
+						break;
+					}
+
+					// Frames with a different layout than the stream header are dropped rather than corrupting the interleaved output
+					if (static_cast<uint32>(FrameInfo.channels) != NumOfChannels)
+					{
+						NextRawFrameIndex += NumOfFrameSamples;
+						continue;
+					}
+
+					StartPendingFrame(NumOfFrameSamples);
+					continue;
+				}
+
+				int64 NumOfFramesToCopy = FMath::Min<int64>(NumOfPendingFrames, MaxNumOfFrames - NumOfDecodedFrames);
+				if (NumOfOutputFrames >= 0)
+				{
+					NumOfFramesToCopy = FMath::Min<int64>(NumOfFramesToCopy, NumOfOutputFrames - OutputPosition);
+				}
+				FMemory::Memcpy(OutPCMData + NumOfDecodedFrames * NumOfChannels, FramePCMData + PendingFrameOffset * NumOfChannels, NumOfFramesToCopy * NumOfChannels * sizeof(float));
+				NumOfDecodedFrames += NumOfFramesToCopy;
+				NumOfPendingFrames -= NumOfFramesToCopy;
+				PendingFrameOffset += NumOfFramesToCopy;
+				OutputPosition += NumOfFramesToCopy;
+			}
+			return NumOfDecodedFrames;
+		}
+
+		virtual bool Seek_Internal(int64 FrameIndex) override
+		{
+			if (!Source->Seek(DataStartPosition))
+			{
+				return false;
+			}
+			ResetDecoder();
+
+			// The encoder delay of a tagged stream precedes the first returned frame
+			const int64 RawFrameIndex = FrameIndex + NumOfDelayFrames;
+
+			// Walking the frame headers without synthesis up to at least one whole frame before the target,
+			// so that the bit reservoir is refilled by decoding that frame before the target is reached
+			while (NextRawFrameIndex + MINIMP3_MAX_SAMPLES_PER_FRAME <= RawFrameIndex)
+			{
+				const int32 NumOfFrameSamples = DecodeNextFrame(false);
+				if (NumOfFrameSamples <= 0)
+				{
+					return false;
+				}
+				NextRawFrameIndex += NumOfFrameSamples;
+			}
+
+			while (true)
+			{
+				const int32 NumOfFrameSamples = DecodeNextFrame(true);
+				if (NumOfFrameSamples <= 0)
+				{
+					// Seeking exactly to the end of the stream is valid
+					OutputPosition = FrameIndex;
+					return NextRawFrameIndex == RawFrameIndex;
+				}
+
+				if (NextRawFrameIndex + NumOfFrameSamples > RawFrameIndex)
+				{
+					PendingFrameOffset = RawFrameIndex - NextRawFrameIndex;
+					NumOfPendingFrames = NumOfFrameSamples - PendingFrameOffset;
+					NextRawFrameIndex += NumOfFrameSamples;
+					OutputPosition = FrameIndex;
+					return true;
+				}
+				NextRawFrameIndex += NumOfFrameSamples;
+			}
+		}
+
+		virtual void Close_Internal() override
+		{
+			ResetDecoder();
+			InputData.Empty();
+		}
+
+		virtual int64 GetMinNumOfBytesAhead() const override
+		{
+			// minimp3 needs the header of the following frame to stay in sync, and the input window is refilled in 16 KB chunks
+			return 2 * InputChunkSize;
+		}
+		//~ End FRuntimeStreamingDecoder Interface
+
+	private:
+		void ResetDecoder()
+		{
+			mp3dec_init(&MP3Decoder);
+			InputData.Reset();
+			InputOffset = 0;
+			NumOfPendingFrames = 0;
+			PendingFrameOffset = 0;
+			NextRawFrameIndex = 0;
+			OutputPosition = 0;
+		}
+
+		/**
+		 * Skip the Xing/Info tag frame at the start of the stream, as the full decode does, and read the encoder delay and padding from it
+		 * The tag frame decodes to silence, so DataStartPosition is moved past it
+		 *
+		 * @return False if the source failed, true otherwise, whether a tag was found or not
+		 */
+		bool SkipVBRTag()
+		{
+			while (InputData.Num() - InputOffset < 2 * InputChunkSize && RefillInput())
+			{
+			}
+
+			int FreeFormatBytes = 0, FrameSize = 0;
+			const int FrameOffset = mp3d_find_frame(InputData.GetData() + InputOffset, InputData.Num() - InputOffset, &FreeFormatBytes, &FrameSize);
+			if (FrameSize <= 0)
+			{
+				ResetDecoder();
+				return Source->Seek(DataStartPosition);
+			}
+
+			// Layer III only, the tag is stored in place of the main data
+			const uint8* Frame = InputData.GetData() + InputOffset + FrameOffset;
+			uint32_t NumOfTaggedFrames = 0;
+			int Delay = 0, Padding = 0;
+			const int TagResult = HDR_GET_LAYER(Frame) == 1 ? mp3dec_check_vbrtag(Frame, FrameSize, &NumOfTaggedFrames, &Delay, &Padding) : 0;
+			if (TagResult > 0)
+			{
+				NumOfDelayFrames = FMath::Max(Delay, 0);
+				const int64 NumOfTaggedSamples = static_cast<int64>(hdr_frame_samples(Frame)) * NumOfTaggedFrames;
+				NumOfOutputFrames = FMath::Max<int64>(NumOfTaggedSamples - NumOfDelayFrames - FMath::Max(Padding, 0), 0);
+			}
+
+			ResetDecoder();
+			if (TagResult != 0)
+			{
+				DataStartPosition += FrameOffset + FrameSize;
+			}
+			return Source->Seek(DataStartPosition);
+		}
+
+		/**
+		 * Make the samples of the frame just decoded pending, dropping the ones within the encoder delay
+		 */
+		void StartPendingFrame(int32 NumOfFrameSamples)
+		{
+			const int64 FrameStart = NextRawFrameIndex;
+			NextRawFrameIndex += NumOfFrameSamples;
+			PendingFrameOffset = FMath::Clamp<int64>(NumOfDelayFrames - FrameStart, 0, NumOfFrameSamples);
+			NumOfPendingFrames = NumOfFrameSamples - PendingFrameOffset;
+		}
+
+		/**
+		 * Read the next chunk from the source into the input window, dropping the data already consumed
+		 */
+		bool RefillInput()
+		{
+			if (InputOffset > 0)
+			{
+				InputData.RemoveAt(0, InputOffset);
+				InputOffset = 0;
+			}
+
+			const int32 PreviousNum = InputData.Num();
+			InputData.AddUninitialized(InputChunkSize);
+			const int64 NumOfBytesRead = Source->Read(InputData.GetData() + PreviousNum, InputChunkSize);
+			InputData.SetNum(PreviousNum + static_cast<int32>(NumOfBytesRead));
+			return NumOfBytesRead > 0;
+		}
+
+		/**
+		 * Decode the next frame into FramePCMData, or only parse its header if bSynthesize is false
+		 *
+		 * @return The number of samples per channel in the frame, or zero if no complete frame is available
+		 */
+		int32 DecodeNextFrame(bool bSynthesize)
+		{
+			while (true)
+			{
+				while (InputData.Num() - InputOffset < InputChunkSize && RefillInput())
+				{
+				}
+
+				const int32 NumOfInputBytes = InputData.Num() - InputOffset;
+				if (NumOfInputBytes <= 0)
+				{
+					return 0;
+				}
+
+				const int32 NumOfFrameSamples = mp3dec_decode_frame(&MP3Decoder, InputData.GetData() + InputOffset, NumOfInputBytes, bSynthesize ? FramePCMData : nullptr, &FrameInfo);
+
+				// Not enough data for a whole frame. What is left can only be discarded once no more data will come
+				if (FrameInfo.frame_bytes == 0)
+				{
+					if (Source->IsComplete())
+					{
+						InputOffset = InputData.Num();
+					}
+					return 0;
+				}
+
+				InputOffset += FrameInfo.frame_bytes;
+
+				// Zero samples with a non-zero number of bytes means that invalid data was skipped
+				if (NumOfFrameSamples > 0)
+				{
+					return NumOfFrameSamples;
+				}
+			}
+		}
+
+		static constexpr int32 InputChunkSize = 16 * 1024;
+
+		mp3dec_t MP3Decoder;
+		mp3dec_frame_info_t FrameInfo;
+
+		/** Window of encoded data not yet consumed by the decoder */
+		TArray<uint8> InputData;
+		int32 InputOffset = 0;
+
+		/** Samples of the last decoded frame that have not been returned yet */
+		float FramePCMData[MINIMP3_MAX_SAMPLES_PER_FRAME];
+		int64 NumOfPendingFrames = 0;
+		int64 PendingFrameOffset = 0;
+
+		/** Position of the first frame, after the ID3v2 tag and the Xing/Info tag frame */
+		int64 DataStartPosition = 0;
+
+		/** Encoder delay and number of frames to return, read from the Xing/Info tag. INDEX_NONE frames if the stream has no tag */
+		int64 NumOfDelayFrames = 0;
+		int64 NumOfOutputFrames = INDEX_NONE;
+
+		/** Index of the next frame to be decoded within the stream, counting the encoder delay */
+		int64 NextRawFrameIndex = 0;
+
+		/** Index of the next frame to be returned */
+		int64 OutputPosition = 0;
+	};
+#endif
+}
+
+TUniquePtr<FRuntimeStreamingDecoder> FMP3_RuntimeCodec::CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source)
+{
+#if DR_MP3_IMPLEMENTATION || MINIMP3_IMPLEMENTATION
+	return MakeUnique<FMP3_StreamingDecoder>(MoveTemp(Source));
+#else
+	return nullptr;
+#endif
+}
+
+bool FMP3_RuntimeCodec::GetHeaderInfoFromStream(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source, FRuntimeAudioHeaderInfo& HeaderInfo)
+{
+#if MINIMP3_IMPLEMENTATION
+	if (Source->IsComplete() && Source->IsSeekable())
+	{
+		/**
+		 * Reading the first frame through a fixed-size window to check for a Xing/Info (LAME) tag, which gives the exact frame count
+		 * Untagged streams are scanned frame by frame, but only the window is held in memory at any time
+		 */
+		struct FMP3StreamHeaderScan
+		{
+			uint64 NumOfFrames = 0;
+			int32 NumOfChannels = 0;
+			int32 SampleRate = 0;
+			bool bFirstFrame = true;
+		} HeaderScan;
+
+		mp3dec_io_t IO;
+		IO.read = [](void* Buffer, size_t Size, void* UserData) -> size_t
+		{
+			return static_cast<size_t>(static_cast<FRuntimeAudioStreamSource*>(UserData)->Read(static_cast<uint8*>(Buffer), static_cast<int64>(Size)));
+		};
+		IO.read_data = &Source.Get();
+		IO.seek = [](uint64_t Position, void* UserData) -> int
+		{
+			return static_cast<FRuntimeAudioStreamSource*>(UserData)->Seek(static_cast<int64>(Position)) ? 0 : -1;
+		};
+		IO.seek_data = &Source.Get();
+
+		TArray<uint8> ScanBuffer;
+		ScanBuffer.SetNumUninitialized(MINIMP3_IO_SIZE);
+
+		const int ScanResult = IO.seek(0, IO.seek_data) != 0 ? MP3D_E_IOERROR : mp3dec_iterate_cb(&IO, ScanBuffer.GetData(), ScanBuffer.Num(), [](void* UserData, const uint8_t* Frame, int FrameSize, int FreeFormatBytes, size_t BufSize, uint64_t Offset, mp3dec_frame_info_t* FrameInfo) -> int
+		{
+			FMP3StreamHeaderScan& Scan = *static_cast<FMP3StreamHeaderScan*>(UserData);
+			Scan.NumOfChannels = FrameInfo->channels;
+			Scan.SampleRate = FrameInfo->hz;
+
+			if (Scan.bFirstFrame)
+			{
+				Scan.bFirstFrame = false;
+
+				uint32_t NumOfTaggedFrames = 0;
+				int Delay = 0, Padding = 0;
+				if (FrameInfo->layer == 3 && mp3dec_check_vbrtag(Frame, FrameSize, &NumOfTaggedFrames, &Delay, &Padding) > 0)
+				{
+					// Matching the samples produced by the full decode, which skips the encoder delay and padding
+					const uint64 NumOfTaggedSamples = static_cast<uint64>(hdr_frame_samples(Frame)) * NumOfTaggedFrames;
+					const uint64 NumOfSkippedSamples = static_cast<uint64>(FMath::Max(Delay, 0)) + static_cast<uint64>(FMath::Max(Padding, 0));
+					Scan.NumOfFrames = NumOfTaggedSamples > NumOfSkippedSamples ? NumOfTaggedSamples - NumOfSkippedSamples : 0;
+					return MP3D_E_USER;
+				}
+			}
+
+			Scan.NumOfFrames += hdr_frame_samples(Frame);
+			return 0;
+		}, &HeaderScan);
+
+		if ((ScanResult == 0 || ScanResult == MP3D_E_USER) && HeaderScan.NumOfFrames > 0 && HeaderScan.SampleRate > 0)
+		{
+			HeaderInfo.Duration = static_cast<float>(HeaderScan.NumOfFrames) / static_cast<float>(HeaderScan.SampleRate);
+			HeaderInfo.NumOfChannels = HeaderScan.NumOfChannels;
+			HeaderInfo.SampleRate = HeaderScan.SampleRate;
+			HeaderInfo.PCMDataSize = HeaderScan.NumOfFrames * HeaderScan.NumOfChannels;
+			HeaderInfo.AudioFormat = GetAudioFormat();
+			UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully retrieved header information for MP3 audio format from the stream (%s).\nHeader info: %s"),
+			       ScanResult == MP3D_E_USER ? TEXT("VBR tag") : TEXT("frame scan"), *HeaderInfo.ToString());
+			return true;
+		}
+	}
+#endif
+	return FBaseRuntimeCodec::GetHeaderInfoFromStream(MoveTemp(Source), HeaderInfo);
+}
@@ -0,0 +1,1286 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Codecs/MP3_RuntimeEncoder.h"
+#include "Codecs/RAW_RuntimeCodec.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "MP3_RuntimeEncoderTables.h"
+#include "Misc/EngineVersionComparison.h"
+
+namespace
+{
+	using namespace MP3EncoderTables;
+
+	constexpr int32 NumOfFrameSamples = 1152;
+	constexpr int32 NumOfGranuleSamples = 576;
+	constexpr int32 NumOfSubbands = 32;
+	constexpr int32 NumOfSubbandSamples = 18;
+	constexpr int32 NumOfFilterbankTaps = 512;
+
+	/** Number of scalefactor bands of a long block, of which all but the last one carry a scalefactor */
+	constexpr int32 NumOfScalefactorBands = 22;
+
+	/** Number of input samples the analysis of a frame needs, the window of the last subband sample reaching past the end of the frame */
+	constexpr int32 NumOfFrameInputSamples = NumOfFrameSamples + NumOfFilterbankTaps - NumOfSubbands;
+
+	/** Filterbank history preceding the first input sample, so that the analysis window of the first subband sample ends at the start of the input */
+	constexpr int32 NumOfFilterbankHistorySamples = NumOfFilterbankTaps - NumOfSubbands;
+
+	/** Delay of the decoded output relative to the input: the filterbank history, plus a granule since the MDCT of a granule completes the output of the previous one */
+	constexpr int32 EncoderDelay = NumOfFilterbankHistorySamples + NumOfGranuleSamples;
+
+	/** Decoder delay assumed by the Info tag, which is subtracted from the stored encoder delay and added to the stored padding */
+	constexpr int32 InfoTagDecoderDelay = 528 + 1;
+
+	/** Largest quantized value that can be coded, using table 23 or 31 with 13 linbits */
+	constexpr int32 MaxQuantizedValue = 15 + 8191;
+
+	/** Largest number of bits of a granule of a channel that part2_3_length can hold */
+	constexpr int32 MaxPart23Length = 4095;
+
+	/** Largest scalefactors with 4 bits for bands 0-10 and 3 bits for bands 11-20 */
+	constexpr int32 MaxScalefactors[2] = {15, 7};
+
+	/** Number of iterations of the noise shaping (outer) loop */
+	constexpr int32 MaxNumOfNoiseShapingIterations = 12;
+
+	/** Rounding offset of the quantization, lower than 0.5 because the distribution of the spectral values is peaked at zero */
+	constexpr float QuantizationRoundingOffset = 0.4054f;
+
+	/** Noise allowed in a scalefactor band relative to its energy, and the masking spread to the neighbouring bands above and below */
+	constexpr float MaskingRatio = 0.05f;
+	constexpr float MaskingSpreadUp = 0.15f;
+	constexpr float MaskingSpreadDown = 0.03f;
+
+	/** Noise allowed per spectral line regardless of the signal, about 96 dB below a full scale sine */
+	constexpr float AbsoluteThreshold = 1e-6f;
+
+	/** Frames are coded with mid/side stereo if the weaker of mid and side has less than this fraction of the energy of the weaker of left and right */
+	constexpr float MidSideEnergyRatio = 0.5f;
+
+	/**
+	 * Tables derived from the constants once
+	 */
+	struct FEncoderTables
+	{
+		/** Analysis window, scaled so that the filterbank of the decoder reconstructs the input */
+		float Window[NumOfFilterbankTaps];
+
+		/** Cosine modulation of the polyphase filterbank */
+		float Modulation[NumOfSubbands][64];
+
+		/** Windowed MDCT basis of long blocks */
+		float MDCT[NumOfSubbandSamples][36];
+
+		/** Alias reduction butterflies */
+		float AliasCs[8];
+		float AliasCa[8];
+
+		/** Quantized values raised to the power of 4/3 */
+		float Pow43[MaxQuantizedValue + 1];
+
+		FEncoderTables()
+		{
+			for (int32 Index = 0; Index < NumOfFilterbankTaps; ++Index)
+			{
+				Window[Index] = static_cast<float>(FilterbankWindow[Index]) / (65536.f * 64.f);
+			}
+			for (int32 Subband = 0; Subband < NumOfSubbands; ++Subband)
+			{
+				for (int32 Index = 0; Index < 64; ++Index)
+				{
+					Modulation[Subband][Index] = static_cast<float>(FMath::Cos((2 * Subband + 1) * (Index + 16) * PI / 64.));
+				}
+			}
+			for (int32 Line = 0; Line < NumOfSubbandSamples; ++Line)
+			{
+				for (int32 Index = 0; Index < 36; ++Index)
+				{
+					MDCT[Line][Index] = static_cast<float>(FMath::Sin(PI / 36. * (Index + 0.5)) * FMath::Cos(PI / 72. * (2 * Index + 19) * (2 * Line + 1)) * 2. / 9.);
+				}
+			}
+			for (int32 Index = 0; Index < 8; ++Index)
+			{
+				const float Norm = FMath::Sqrt(1.f + AliasReductionCoefficients[Index] * AliasReductionCoefficients[Index]);
+				AliasCs[Index] = 1.f / Norm;
+				AliasCa[Index] = -AliasReductionCoefficients[Index] / Norm;
+			}
+			for (int32 Value = 0; Value <= MaxQuantizedValue; ++Value)
+			{
+				Pow43[Value] = FMath::Pow(static_cast<float>(Value), 4.f / 3.f);
+			}
+		}
+	};
+
+	const FEncoderTables& GetEncoderTables()
+	{
+		static const FEncoderTables Tables;
+		return Tables;
+	}
+
+	/**
+	 * Writer of big-endian bit fields into a zero-initialized buffer
+	 */
+	class FBitWriter
+	{
+	public:
+		explicit FBitWriter(uint8* InData)
+			: Data(InData)
+			, Position(0)
+		{
+		}
+
+		void Write(uint32 Value, int32 NumOfBits)
+		{
+			for (int32 BitIndex = NumOfBits - 1; BitIndex >= 0; --BitIndex)
+			{
+				if ((Value >> BitIndex) & 1)
+				{
+					Data[Position >> 3] |= static_cast<uint8>(0x80 >> (Position & 7));
+				}
+				++Position;
+			}
+		}
+
+		int64 GetPosition() const { return Position; }
+
+	private:
+		uint8* Data;
+		int64 Position;
+	};
+
+	/**
+	 * Coding parameters of a granule of a channel, written to the side information
+	 */
+	struct FGranuleInfo
+	{
+		int32 Part23Length = 0;
+		int32 BigValues = 0;
+		int32 GlobalGain = 0;
+		int32 ScalefacCompress = 0;
+		int32 TableSelect[3] = {0, 0, 0};
+		int32 Region0Count = 0;
+		int32 Region1Count = 0;
+		int32 Count1Table = 0;
+
+		/** End of the count1 region, after which all values are zero */
+		int32 Count1End = 0;
+
+		/** Number of bits of the scalefactors */
+		int32 Part2Length = 0;
+
+		int32 Scalefactors[NumOfScalefactorBands - 1] = {};
+	};
+
+	/**
+	 * Spectrum of a granule of a channel and its quantization
+	 */
+	struct FGranuleData
+	{
+		float Spectrum[NumOfGranuleSamples];
+
+		/** Absolute values of the spectrum raised to the power of 3/4, the domain the quantization is done in */
+		float Spectrum34[NumOfGranuleSamples];
+
+		/** Absolute quantized values, the signs are taken from the spectrum */
+		int32 Quantized[NumOfGranuleSamples];
+
+		float Energy[NumOfScalefactorBands];
+		float AllowedNoise[NumOfScalefactorBands];
+
+		FGranuleInfo Info;
+	};
+
+	struct FScalefactorBands
+	{
+		int32 Start[NumOfScalefactorBands + 1];
+
+		explicit FScalefactorBands(int32 SampleRateIndex)
+		{
+			Start[0] = 0;
+			for (int32 Band = 0; Band < NumOfScalefactorBands; ++Band)
+			{
+				Start[Band + 1] = Start[Band] + ScalefactorBandWidths[SampleRateIndex][Band];
+			}
+		}
+	};
+
+	/**
+	 * Count the bits of the pairs of values in the range using the specified table
+	 */
+	int32 CountPairBits(const int32* Quantized, int32 Start, int32 End, int32 TableIndex)
+	{
+		const FHuffmanTable& Table = HuffmanTables[TableIndex];
+		int32 NumOfBits = 0;
+		if (Table.NumOfLinbits > 0)
+		{
+			for (int32 Index = Start; Index < End; Index += 2)
+			{
+				const int32 X = Quantized[Index], Y = Quantized[Index + 1];
+				NumOfBits += Table.Lengths[FMath::Min(X, 15) * 16 + FMath::Min(Y, 15)];
+				NumOfBits += (X > 0) + (Y > 0) + (X >= 15 ? Table.NumOfLinbits : 0) + (Y >= 15 ? Table.NumOfLinbits : 0);
+			}
+		}
+		else
+		{
+			for (int32 Index = Start; Index < End; Index += 2)
+			{
+				const int32 X = Quantized[Index], Y = Quantized[Index + 1];
+				NumOfBits += Table.Lengths[X * Table.Size + Y] + (X > 0) + (Y > 0);
+			}
+		}
+		return NumOfBits;
+	}
+
+	/**
+	 * Choose the table coding the pairs of values in the range with the fewest bits
+	 *
+	 * @return The number of bits of the range with the chosen table
+	 */
+	int32 ChooseTable(const int32* Quantized, int32 Start, int32 End, int32& OutTableIndex)
+	{
+		int32 MaxValue = 0;
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			MaxValue = FMath::Max(MaxValue, Quantized[Index]);
+		}
+
+		OutTableIndex = 0;
+		if (MaxValue == 0)
+		{
+			return 0;
+		}
+
+		int32 Candidates[3] = {0, 0, 0};
+		if (MaxValue < 15)
+		{
+			// The smallest tables able to code the value, larger tables spend more bits on small values
+			static const int32 CandidatesByMaxValue[15][3] = {
+				{0, 0, 0}, {1, 0, 0}, {2, 3, 0}, {5, 6, 0}, {7, 8, 9}, {7, 8, 9}, {10, 11, 12}, {10, 11, 12},
+				{13, 15, 0}, {13, 15, 0}, {13, 15, 0}, {13, 15, 0}, {13, 15, 0}, {13, 15, 0}, {13, 15, 0}
+			};
+			FMemory::Memcpy(Candidates, CandidatesByMaxValue[MaxValue], sizeof(Candidates));
+		}
+		else
+		{
+			// The tables with the fewest linbits that can hold the value from each of the two code tables
+			const int32 NumOfLinbits = MaxValue > 15 ? FMath::CeilLogTwo(static_cast<uint32>(MaxValue - 15 + 1)) : 0;
+			for (int32 TableIndex = 16; TableIndex < 24; ++TableIndex)
+			{
+				if (HuffmanTables[TableIndex].NumOfLinbits >= NumOfLinbits)
+				{
+					Candidates[0] = TableIndex;
+					break;
+				}
+			}
+			for (int32 TableIndex = 24; TableIndex < 32; ++TableIndex)
+			{
+				if (HuffmanTables[TableIndex].NumOfLinbits >= NumOfLinbits)
+				{
+					Candidates[1] = TableIndex;
+					break;
+				}
+			}
+		}
+
+		int32 MinNumOfBits = MAX_int32;
+		for (const int32 Candidate : Candidates)
+		{
+			if (Candidate == 0)
+			{
+				continue;
+			}
+			const int32 NumOfBits = CountPairBits(Quantized, Start, End, Candidate);
+			if (NumOfBits < MinNumOfBits)
+			{
+				MinNumOfBits = NumOfBits;
+				OutTableIndex = Candidate;
+			}
+		}
+		return MinNumOfBits;
+	}
+
+	/**
+	 * Split the quantized values into the big values, count1 and zero regions and count the bits of the Huffman coded part
+	 *
+	 * @param bBestRegions Whether to search for the region boundaries giving the fewest bits, or to use a fixed subdivision of the big values
+	 * @return The number of bits of part3
+	 */
+	int32 CountHuffmanBits(const int32* Quantized, const FScalefactorBands& Bands, FGranuleInfo& Info, bool bBestRegions)
+	{
+		int32 End = NumOfGranuleSamples;
+		while (End > 0 && Quantized[End - 1] == 0 && Quantized[End - 2] == 0)
+		{
+			End -= 2;
+		}
+		Info.Count1End = End;
+
+		// Quadruples of values not greater than one are coded in the count1 region with either of the two count1 tables
+		int32 Count1BitsA = 0, Count1BitsB = 0;
+		int32 BigValuesEnd = End;
+		while (BigValuesEnd >= 4)
+		{
+			const int32* Quadruple = Quantized + BigValuesEnd - 4;
+			if ((Quadruple[0] | Quadruple[1] | Quadruple[2] | Quadruple[3]) > 1)
+			{
+				break;
+			}
+			const int32 Index = Quadruple[0] * 8 + Quadruple[1] * 4 + Quadruple[2] * 2 + Quadruple[3];
+			const int32 NumOfSignBits = Quadruple[0] + Quadruple[1] + Quadruple[2] + Quadruple[3];
+			Count1BitsA += Count1Lengths[Index] + NumOfSignBits;
+			Count1BitsB += 4 + NumOfSignBits;
+			BigValuesEnd -= 4;
+		}
+		Info.Count1Table = Count1BitsB < Count1BitsA ? 1 : 0;
+		Info.BigValues = BigValuesEnd / 2;
+
+		int32 NumOfBits = FMath::Min(Count1BitsA, Count1BitsB);
+
+		// Number of scalefactor bands reached by the big values region
+		int32 NumOfBigValuesBands = 0;
+		while (NumOfBigValuesBands < NumOfScalefactorBands && Bands.Start[NumOfBigValuesBands] < BigValuesEnd)
+		{
+			++NumOfBigValuesBands;
+		}
+
+		auto GetBoundary = [&Bands, BigValuesEnd](int32 Band)
+		{
+			return FMath::Min(Bands.Start[FMath::Min(Band, NumOfScalefactorBands)], BigValuesEnd);
+		};
+
+		if (!bBestRegions)
+		{
+			// About a third of the bands in each of the first two regions
+			Info.Region0Count = FMath::Clamp((NumOfBigValuesBands + 1) / 3 - 1, 0, 15);
+			Info.Region1Count = FMath::Clamp((NumOfBigValuesBands + 1) / 3, 0, 7);
+			const int32 Region1Start = GetBoundary(Info.Region0Count + 1);
+			const int32 Region2Start = GetBoundary(Info.Region0Count + Info.Region1Count + 2);
+			NumOfBits += ChooseTable(Quantized, 0, Region1Start, Info.TableSelect[0]);
+			NumOfBits += ChooseTable(Quantized, Region1Start, Region2Start, Info.TableSelect[1]);
+			NumOfBits += ChooseTable(Quantized, Region2Start, BigValuesEnd, Info.TableSelect[2]);
+			return NumOfBits;
+		}
+
+		// The regions start at band boundaries, so the bits of each region only depend on its first and last band and are cached
+		int32 RegionBits[NumOfScalefactorBands + 2][NumOfScalefactorBands + 2];
+		int32 RegionTables[NumOfScalefactorBands + 2][NumOfScalefactorBands + 2];
+		for (int32 Index = 0; Index < NumOfScalefactorBands + 2; ++Index)
+		{
+			for (int32 OtherIndex = 0; OtherIndex < NumOfScalefactorBands + 2; ++OtherIndex)
+			{
+				RegionBits[Index][OtherIndex] = -1;
+			}
+		}
+
+		auto GetRegionBits = [&](int32 StartBand, int32 EndBand)
+		{
+			int32& CachedBits = RegionBits[StartBand][EndBand];
+			if (CachedBits < 0)
+			{
+				CachedBits = ChooseTable(Quantized, GetBoundary(StartBand), EndBand > NumOfScalefactorBands ? BigValuesEnd : GetBoundary(EndBand), RegionTables[StartBand][EndBand]);
+			}
+			return CachedBits;
+		};
+
+		int32 MinNumOfBits = MAX_int32;
+		for (int32 Region0Count = 0; Region0Count < 16; ++Region0Count)
+		{
+			for (int32 Region1Count = 0; Region1Count < 8; ++Region1Count)
+			{
+				const int32 Region1Band = FMath::Min(Region0Count + 1, NumOfScalefactorBands);
+				const int32 Region2Band = FMath::Min(Region0Count + Region1Count + 2, NumOfScalefactorBands);
+				const int32 RegionsBits = GetRegionBits(0, Region1Band) + GetRegionBits(Region1Band, Region2Band) + GetRegionBits(Region2Band, NumOfScalefactorBands + 1);
+				if (RegionsBits < MinNumOfBits)
+				{
+					MinNumOfBits = RegionsBits;
+					Info.Region0Count = Region0Count;
+					Info.Region1Count = Region1Count;
+					Info.TableSelect[0] = RegionTables[0][Region1Band];
+					Info.TableSelect[1] = RegionTables[Region1Band][Region2Band];
+					Info.TableSelect[2] = RegionTables[Region2Band][NumOfScalefactorBands + 1];
+				}
+			}
+		}
+		return NumOfBits + MinNumOfBits;
+	}
+
+	/**
+	 * Choose the smallest scalefac_compress able to hold the scalefactors
+	 */
+	void ChooseScalefacCompress(FGranuleInfo& Info)
+	{
+		int32 MaxScalefactors[2] = {0, 0};
+		for (int32 Band = 0; Band < NumOfScalefactorBands - 1; ++Band)
+		{
+			int32& MaxScalefactor = MaxScalefactors[Band < 11 ? 0 : 1];
+			MaxScalefactor = FMath::Max(MaxScalefactor, Info.Scalefactors[Band]);
+		}
+
+		Info.Part2Length = MAX_int32;
+		for (int32 Index = 0; Index < 16; ++Index)
+		{
+			const int32 NumOfBits = 11 * ScalefactorLengths[Index][0] + 10 * ScalefactorLengths[Index][1];
+			if (MaxScalefactors[0] < (1 << ScalefactorLengths[Index][0]) && MaxScalefactors[1] < (1 << ScalefactorLengths[Index][1]) && NumOfBits < Info.Part2Length)
+			{
+				Info.Part2Length = NumOfBits;
+				Info.ScalefacCompress = Index;
+			}
+		}
+	}
+
+	/**
+	 * Quantize the spectrum with the specified global gain and the scalefactors of the granule info
+	 *
+	 * @return False if a value is too large to be coded
+	 */
+	bool Quantize(FGranuleData& Data, const FScalefactorBands& Bands, int32 GlobalGain)
+	{
+		for (int32 Band = 0; Band < NumOfScalefactorBands; ++Band)
+		{
+			const int32 Scalefactor = Band < NumOfScalefactorBands - 1 ? Data.Info.Scalefactors[Band] : 0;
+			const float StepMultiplier = FMath::Pow(2.f, -0.1875f * (GlobalGain - 210) + 0.375f * Scalefactor);
+			for (int32 Index = Bands.Start[Band]; Index < Bands.Start[Band + 1]; ++Index)
+			{
+				const float Value = Data.Spectrum34[Index] * StepMultiplier;
+				if (Value > MaxQuantizedValue)
+				{
+					return false;
+				}
+				Data.Quantized[Index] = static_cast<int32>(Value + QuantizationRoundingOffset);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Find the smallest global gain (the finest quantization) for which the granule fits the available bits (the inner loop)
+	 *
+	 * @return The number of bits of the granule
+	 */
+	int32 QuantizeToBitBudget(FGranuleData& Data, const FScalefactorBands& Bands, int32 NumOfAvailableBits)
+	{
+		ChooseScalefacCompress(Data.Info);
+
+		int32 LowGain = 0, HighGain = 255;
+		while (LowGain < HighGain)
+		{
+			const int32 Gain = (LowGain + HighGain) / 2;
+			if (Quantize(Data, Bands, Gain) && Data.Info.Part2Length + CountHuffmanBits(Data.Quantized, Bands, Data.Info, false) <= NumOfAvailableBits)
+			{
+				HighGain = Gain;
+			}
+			else
+			{
+				LowGain = Gain + 1;
+			}
+		}
+
+		Data.Info.GlobalGain = HighGain;
+		if (!Quantize(Data, Bands, HighGain))
+		{
+			FMemory::Memzero(Data.Quantized, sizeof(Data.Quantized));
+		}
+
+		const int32 NumOfBits = Data.Info.Part2Length + CountHuffmanBits(Data.Quantized, Bands, Data.Info, false);
+		if (NumOfBits > NumOfAvailableBits)
+		{
+			// Only possible with very few available bits, in which case the granule is left silent
+			FMemory::Memzero(Data.Quantized, sizeof(Data.Quantized));
+			FMemory::Memzero(Data.Info.Scalefactors, sizeof(Data.Info.Scalefactors));
+			ChooseScalefacCompress(Data.Info);
+			return CountHuffmanBits(Data.Quantized, Bands, Data.Info, false);
+		}
+		return NumOfBits;
+	}
+
+	/**
+	 * Compute the quantization noise of each band relative to the allowed noise
+	 *
+	 * @return The largest noise to allowed noise ratio
+	 */
+	float ComputeNoiseRatios(const FGranuleData& Data, const FScalefactorBands& Bands, float* OutNoiseRatios)
+	{
+		const FEncoderTables& Tables = GetEncoderTables();
+		float MaxNoiseRatio = 0.f;
+		for (int32 Band = 0; Band < NumOfScalefactorBands; ++Band)
+		{
+			const int32 Scalefactor = Band < NumOfScalefactorBands - 1 ? Data.Info.Scalefactors[Band] : 0;
+			const float Step = FMath::Pow(2.f, 0.25f * (Data.Info.GlobalGain - 210) - 0.5f * Scalefactor);
+			float Noise = 0.f;
+			for (int32 Index = Bands.Start[Band]; Index < Bands.Start[Band + 1]; ++Index)
+			{
+				const float Error = FMath::Abs(Data.Spectrum[Index]) - Tables.Pow43[Data.Quantized[Index]] * Step;
+				Noise += Error * Error;
+			}
+			OutNoiseRatios[Band] = Noise / Data.AllowedNoise[Band];
+			MaxNoiseRatio = FMath::Max(MaxNoiseRatio, OutNoiseRatios[Band]);
+		}
+		return MaxNoiseRatio;
+	}
+
+	/**
+	 * Quantize the granule within the available bits, amplifying the bands whose noise exceeds the allowed noise via the scalefactors (the outer loop)
+	 *
+	 * @return The number of bits of the granule
+	 */
+	int32 QuantizeGranule(FGranuleData& Data, const FScalefactorBands& Bands, int32 NumOfAvailableBits)
+	{
+		FMemory::Memzero(Data.Info.Scalefactors, sizeof(Data.Info.Scalefactors));
+
+		float MaxSpectrum34 = 0.f;
+		for (int32 Index = 0; Index < NumOfGranuleSamples; ++Index)
+		{
+			MaxSpectrum34 = FMath::Max(MaxSpectrum34, Data.Spectrum34[Index]);
+		}
+		if (MaxSpectrum34 <= 0.f)
+		{
+			FMemory::Memzero(Data.Quantized, sizeof(Data.Quantized));
+			ChooseScalefacCompress(Data.Info);
+			Data.Info.GlobalGain = 0;
+			return CountHuffmanBits(Data.Quantized, Bands, Data.Info, true);
+		}
+
+		FGranuleInfo BestInfo;
+		int32 BestQuantized[NumOfGranuleSamples];
+		float BestMaxNoiseRatio = MAX_flt;
+
+		for (int32 Iteration = 0; Iteration < MaxNumOfNoiseShapingIterations; ++Iteration)
+		{
+			QuantizeToBitBudget(Data, Bands, NumOfAvailableBits);
+
+			float NoiseRatios[NumOfScalefactorBands];
+			const float MaxNoiseRatio = ComputeNoiseRatios(Data, Bands, NoiseRatios);
+			if (MaxNoiseRatio < BestMaxNoiseRatio)
+			{
+				BestMaxNoiseRatio = MaxNoiseRatio;
+				BestInfo = Data.Info;
+				FMemory::Memcpy(BestQuantized, Data.Quantized, sizeof(BestQuantized));
+			}
+			if (MaxNoiseRatio <= 1.f)
+			{
+				break;
+			}
+
+			// Amplifying all bands at once would only be compensated by the global gain
+			bool bAmplified = false, bAllAmplified = true;
+			for (int32 Band = 0; Band < NumOfScalefactorBands - 1; ++Band)
+			{
+				if (NoiseRatios[Band] > 1.f && Data.Info.Scalefactors[Band] < MaxScalefactors[Band < 11 ? 0 : 1])
+				{
+					++Data.Info.Scalefactors[Band];
+					bAmplified = true;
+				}
+				else if (Data.Energy[Band] > 0.f)
+				{
+					bAllAmplified = false;
+				}
+			}
+			if (!bAmplified || bAllAmplified)
+			{
+				break;
+			}
+		}
+
+		Data.Info = BestInfo;
+		FMemory::Memcpy(Data.Quantized, BestQuantized, sizeof(BestQuantized));
+		return Data.Info.Part2Length + CountHuffmanBits(Data.Quantized, Bands, Data.Info, true);
+	}
+
+	/**
+	 * Compute the energy and the allowed noise of each band from a simple masking model:
+	 * a fixed signal-to-mask ratio with spreading to the neighbouring bands, limited by an absolute threshold
+	 */
+	void ComputeAllowedNoise(FGranuleData& Data, const FScalefactorBands& Bands)
+	{
+		for (int32 Band = 0; Band < NumOfScalefactorBands; ++Band)
+		{
+			float Energy = 0.f;
+			for (int32 Index = Bands.Start[Band]; Index < Bands.Start[Band + 1]; ++Index)
+			{
+				Energy += Data.Spectrum[Index] * Data.Spectrum[Index];
+			}
+			Data.Energy[Band] = Energy;
+			Data.AllowedNoise[Band] = Energy * MaskingRatio;
+		}
+		for (int32 Band = 1; Band < NumOfScalefactorBands; ++Band)
+		{
+			Data.AllowedNoise[Band] = FMath::Max(Data.AllowedNoise[Band], Data.AllowedNoise[Band - 1] * MaskingSpreadUp);
+		}
+		for (int32 Band = NumOfScalefactorBands - 2; Band >= 0; --Band)
+		{
+			Data.AllowedNoise[Band] = FMath::Max(Data.AllowedNoise[Band], Data.AllowedNoise[Band + 1] * MaskingSpreadDown);
+		}
+		for (int32 Band = 0; Band < NumOfScalefactorBands; ++Band)
+		{
+			Data.AllowedNoise[Band] = FMath::Max(Data.AllowedNoise[Band], AbsoluteThreshold * (Bands.Start[Band + 1] - Bands.Start[Band]));
+		}
+	}
+
+	/**
+	 * Estimate the number of bits the granule needs from its perceptual entropy, used to distribute the bits of a frame
+	 */
+	float EstimateNumOfNeededBits(const FGranuleData& Data, const FScalefactorBands& Bands)
+	{
+		float NumOfBits = 0.f;
+		for (int32 Band = 0; Band < NumOfScalefactorBands; ++Band)
+		{
+			if (Data.Energy[Band] > Data.AllowedNoise[Band])
+			{
+				NumOfBits += 0.5f * (Bands.Start[Band + 1] - Bands.Start[Band]) * FMath::Log2(Data.Energy[Band] / Data.AllowedNoise[Band]);
+			}
+		}
+		return NumOfBits;
+	}
+
+	/**
+	 * Write the scalefactors and the Huffman coded values of the granule
+	 */
+	void WriteMainData(FBitWriter& Writer, const FGranuleData& Data, const FScalefactorBands& Bands)
+	{
+		const FGranuleInfo& Info = Data.Info;
+		for (int32 Band = 0; Band < NumOfScalefactorBands - 1; ++Band)
+		{
+			Writer.Write(Info.Scalefactors[Band], ScalefactorLengths[Info.ScalefacCompress][Band < 11 ? 0 : 1]);
+		}
+
+		auto IsNegative = [&Data](int32 Index)
+		{
+			return Data.Spectrum[Index] < 0.f ? 1u : 0u;
+		};
+
+		const int32 BigValuesEnd = Info.BigValues * 2;
+		const int32 RegionStarts[4] = {
+			0,
+			FMath::Min(Bands.Start[FMath::Min(Info.Region0Count + 1, NumOfScalefactorBands)], BigValuesEnd),
+			FMath::Min(Bands.Start[FMath::Min(Info.Region0Count + Info.Region1Count + 2, NumOfScalefactorBands)], BigValuesEnd),
+			BigValuesEnd
+		};
+
+		for (int32 Region = 0; Region < 3; ++Region)
+		{
+			const FHuffmanTable& Table = HuffmanTables[Info.TableSelect[Region]];
+			if (Table.Size == 0)
+			{
+				continue;
+			}
+			for (int32 Index = RegionStarts[Region]; Index < RegionStarts[Region + 1]; Index += 2)
+			{
+				const int32 X = Data.Quantized[Index], Y = Data.Quantized[Index + 1];
+				if (Table.NumOfLinbits > 0)
+				{
+					const int32 CodeIndex = FMath::Min(X, 15) * 16 + FMath::Min(Y, 15);
+					Writer.Write(Table.Codes[CodeIndex], Table.Lengths[CodeIndex]);
+					if (X >= 15)
+					{
+						Writer.Write(X - 15, Table.NumOfLinbits);
+					}
+					if (X > 0)
+					{
+						Writer.Write(IsNegative(Index), 1);
+					}
+					if (Y >= 15)
+					{
+						Writer.Write(Y - 15, Table.NumOfLinbits);
+					}
+					if (Y > 0)
+					{
+						Writer.Write(IsNegative(Index + 1), 1);
+					}
+				}
+				else
+				{
+					const int32 CodeIndex = X * Table.Size + Y;
+					Writer.Write(Table.Codes[CodeIndex], Table.Lengths[CodeIndex]);
+					if (X > 0)
+					{
+						Writer.Write(IsNegative(Index), 1);
+					}
+					if (Y > 0)
+					{
+						Writer.Write(IsNegative(Index + 1), 1);
+					}
+				}
+			}
+		}
+
+		for (int32 Index = BigValuesEnd; Index < Info.Count1End; Index += 4)
+		{
+			const int32* Quadruple = Data.Quantized + Index;
+			const int32 CodeIndex = Quadruple[0] * 8 + Quadruple[1] * 4 + Quadruple[2] * 2 + Quadruple[3];
+			if (Info.Count1Table == 0)
+			{
+				Writer.Write(Count1Codes[CodeIndex], Count1Lengths[CodeIndex]);
+			}
+			else
+			{
+				Writer.Write(15 - CodeIndex, 4);
+			}
+			for (int32 ValueIndex = 0; ValueIndex < 4; ++ValueIndex)
+			{
+				if (Quadruple[ValueIndex] > 0)
+				{
+					Writer.Write(IsNegative(Index + ValueIndex), 1);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Write the 4-byte frame header
+	 */
+	void WriteFrameHeader(FBitWriter& Writer, int32 BitrateIndex, int32 SampleRateIndex, bool bPadding, uint32 NumOfChannels, bool bMidSide)
+	{
+		Writer.Write(0x7FF, 11); // Frame sync
+		Writer.Write(3, 2); // MPEG-1
+		Writer.Write(1, 2); // Layer III
+		Writer.Write(1, 1); // No CRC
+		Writer.Write(BitrateIndex, 4);
+		Writer.Write(SampleRateIndex, 2);
+		Writer.Write(bPadding ? 1 : 0, 1);
+		Writer.Write(0, 1); // Private bit
+		Writer.Write(NumOfChannels == 1 ? 3 : (bMidSide ? 1 : 0), 2); // Mono, joint stereo or stereo
+		Writer.Write(bMidSide ? 2 : 0, 2); // Mode extension, mid/side stereo without intensity stereo
+		Writer.Write(0, 1); // Copyright
+		Writer.Write(1, 1); // Original
+		Writer.Write(0, 2); // No emphasis
+	}
+
+	int32 GetSideInfoSize(uint32 NumOfChannels)
+	{
+		return NumOfChannels == 1 ? 17 : 32;
+	}
+
+	/**
+	 * Get the index of the first spectral line above the lowpass frequency, which leaves the bits to the audible range at low bitrates
+	 */
+	int32 GetLowpassLine(int32 Bitrate, uint32 NumOfChannels, uint32 SampleRate)
+	{
+		static const struct
+		{
+			int32 BitratePerChannel;
+			float Frequency;
+		} LowpassFrequencies[] = {{16, 5500.f}, {24, 8000.f}, {32, 11000.f}, {48, 13500.f}, {64, 16000.f}, {80, 17000.f}, {96, 18000.f}, {112, 19000.f}, {128, 19500.f}, {160, 20000.f}};
+
+		const int32 BitratePerChannel = Bitrate / static_cast<int32>(NumOfChannels);
+		float Frequency = 20500.f;
+		for (const auto& Entry : LowpassFrequencies)
+		{
+			if (BitratePerChannel <= Entry.BitratePerChannel)
+			{
+				Frequency = Entry.Frequency;
+				break;
+			}
+		}
+		return FMath::Clamp(FMath::RoundToInt(Frequency / (SampleRate / 2.f) * NumOfGranuleSamples), 0, NumOfGranuleSamples);
+	}
+}
+
+FMP3_RuntimeEncoder::FMP3_RuntimeEncoder()
+	: NumOfInputChannels(0)
+	, InputSampleRate(0)
+	, NumOfChannels(0)
+	, SampleRate(0)
+	, Bitrate(0)
+	, SampleRateIndex(0)
+	, BitrateIndex(0)
+	, LowpassLine(NumOfGranuleSamples)
+	, InputReadOffset(0)
+	, FrameSizeRemainder(0)
+	, InfoFrameSize(0)
+	, NumOfInputFrames(0)
+	, NumOfEncodedFrames(0)
+	, NumOfEncodedBytes(0)
+	, bInfoFrameWritten(false)
+	, bFlushed(false)
+{
+}
+
+bool FMP3_RuntimeEncoder::Init(uint32 InNumOfChannels, uint32 InSampleRate, uint8 Quality)
+{
+	NumOfChannels = 0;
+
+	if (InNumOfChannels == 0 || InSampleRate == 0)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the MP3 encoder with %d channels and a sample rate of %d"), InNumOfChannels, InSampleRate);
+		return false;
+	}
+
+	NumOfInputChannels = InNumOfChannels;
+	InputSampleRate = InSampleRate;
+	SampleRate = GetEncodedSampleRate(InSampleRate);
+
+	if (SampleRate != InputSampleRate)
+	{
+		if (!Resampler.Init(FMath::Min<int32>(NumOfInputChannels, 2), InputSampleRate, SampleRate, ERuntimeResamplingQuality::BestSinc))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the MP3 encoder because the resampler from %d to %d failed to initialize"), InputSampleRate, SampleRate);
+			return false;
+		}
+		UE_LOG(LogRuntimeAudioImporter, Log, TEXT("The sample rate of %d is not supported by MP3, the audio data will be resampled to %d"), InputSampleRate, SampleRate);
+	}
+
+	SampleRateIndex = 0;
+	while (SampleRates[SampleRateIndex] != SampleRate)
+	{
+		++SampleRateIndex;
+	}
+
+	const uint32 NumOfEncodedChannels = FMath::Min<uint32>(NumOfInputChannels, 2);
+	Bitrate = GetBitrateFromQuality(Quality, NumOfEncodedChannels);
+	BitrateIndex = 1;
+	while (Bitrates[BitrateIndex] != Bitrate)
+	{
+		++BitrateIndex;
+	}
+	LowpassLine = GetLowpassLine(Bitrate, NumOfEncodedChannels, SampleRate);
+
+	for (uint32 ChannelIndex = 0; ChannelIndex < 2; ++ChannelIndex)
+	{
+		InputBuffers[ChannelIndex].Reset();
+		InputBuffers[ChannelIndex].AddZeroed(NumOfFilterbankHistorySamples);
+		PreviousSubbandSamples[ChannelIndex].SetNumZeroed(NumOfGranuleSamples);
+	}
+	InputReadOffset = 0;
+
+	FrameSizeRemainder = 0;
+	InfoFrameSize = 144000 * Bitrate / SampleRate;
+	NumOfInputFrames = 0;
+	NumOfEncodedFrames = 0;
+	NumOfEncodedBytes = 0;
+	bInfoFrameWritten = false;
+	bFlushed = false;
+
+	// The tables are built on first use, outside of the encoding of the first frame
+	GetEncoderTables();
+
+	NumOfChannels = NumOfEncodedChannels;
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Initialized the MP3 encoder with %d channels at %d Hz and %d kbps (quality %d)"), NumOfChannels, SampleRate, Bitrate, Quality);
+	return true;
+}
+
+bool FMP3_RuntimeEncoder::EncodeFrames(const float* PCMData, int64 NumOfFrames, TArray64<uint8>& OutEncodedData)
+{
+	if (!IsInitialized() || bFlushed)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to encode MP3 data because the encoder is not initialized or has already been flushed"));
+		return false;
+	}
+
+	if (!bInfoFrameWritten)
+	{
+		// Placeholder of the Info tag frame, completed once the number of frames is known
+		TArray64<uint8> InfoFrame;
+		GetInfoFrame(InfoFrame);
+		OutEncodedData.Append(InfoFrame);
+		NumOfEncodedBytes += InfoFrame.Num();
+		bInfoFrameWritten = true;
+	}
+
+	if (NumOfFrames > 0 && !AppendInput(PCMData, NumOfFrames))
+	{
+		return false;
+	}
+
+	EncodeAvailableFrames(OutEncodedData);
+	return true;
+}
+
+bool FMP3_RuntimeEncoder::Flush(TArray64<uint8>& OutEncodedData)
+{
+	if (!EncodeFrames(nullptr, 0, OutEncodedData))
+	{
+		return false;
+	}
+
+	if (SampleRate != InputSampleRate)
+	{
+		ResampledBuffer.Reset();
+		Resampler.Flush(ResampledBuffer);
+		const int64 NumOfResampledFrames = ResampledBuffer.Num() / FMath::Min<int32>(NumOfInputChannels, 2);
+		if (NumOfResampledFrames > 0)
+		{
+			TArray<float> FlushedData(ResampledBuffer.GetData(), ResampledBuffer.Num());
+			ResampledBuffer.Reset();
+			AppendDeinterleaved(FlushedData.GetData(), NumOfResampledFrames, FMath::Min<int32>(NumOfInputChannels, 2));
+		}
+	}
+
+	// Padding the input with silence up to the last frame needed to output all input samples past the encoder delay, which includes the lookahead of the filterbank
+	const int64 NumOfRequiredFrames = FMath::DivideAndRoundUp<int64>(NumOfInputFrames + EncoderDelay, NumOfFrameSamples);
+	while (NumOfEncodedFrames < NumOfRequiredFrames)
+	{
+		for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+		{
+			TArray<float>& InputBuffer = InputBuffers[ChannelIndex];
+			if (InputBuffer.Num() - InputReadOffset < NumOfFrameInputSamples)
+			{
+				InputBuffer.AddZeroed(NumOfFrameInputSamples - (InputBuffer.Num() - InputReadOffset));
+			}
+		}
+		EncodeFrame(OutEncodedData);
+	}
+
+	bFlushed = true;
+	return true;
+}
+
+void FMP3_RuntimeEncoder::GetInfoFrame(TArray64<uint8>& OutFrame) const
+{
+	OutFrame.SetNumZeroed(InfoFrameSize);
+
+	FBitWriter Writer(OutFrame.GetData());
+	WriteFrameHeader(Writer, BitrateIndex, SampleRateIndex, false, NumOfChannels, false);
+
+	// The side information is left empty, so decoders not aware of the tag decode the frame as silence
+	uint8* Tag = OutFrame.GetData() + 4 + GetSideInfoSize(NumOfChannels);
+
+	auto WriteUInt32 = [](uint8* Destination, uint32 Value)
+	{
+		Destination[0] = static_cast<uint8>(Value >> 24);
+		Destination[1] = static_cast<uint8>(Value >> 16);
+		Destination[2] = static_cast<uint8>(Value >> 8);
+		Destination[3] = static_cast<uint8>(Value);
+	};
+
+	// "Info" marks a constant bitrate stream, followed by the flags of the present fields (number of frames and number of bytes)
+	FMemory::Memcpy(Tag, "Info", 4);
+	WriteUInt32(Tag + 4, 0x3);
+	WriteUInt32(Tag + 8, static_cast<uint32>(NumOfEncodedFrames));
+	WriteUInt32(Tag + 12, static_cast<uint32>(NumOfEncodedBytes));
+
+	// Extension in the layout of the LAME tag, of which the encoder delay and padding are used by decoders
+	uint8* Extension = Tag + 16;
+	FMemory::Memcpy(Extension, "RAIMP3", 6);
+	Extension[9] = 0x01; // Constant bitrate
+	Extension[10] = static_cast<uint8>(FMath::Min<int32>(FMath::RoundToInt(LowpassLine * (SampleRate / 2.f) / NumOfGranuleSamples / 100.f), 255));
+	Extension[20] = static_cast<uint8>(FMath::Min(Bitrate, 255));
+
+	const int64 NumOfPaddingFrames = FMath::Max<int64>(NumOfEncodedFrames * NumOfFrameSamples - EncoderDelay - NumOfInputFrames, 0);
+	const int32 StoredDelay = EncoderDelay - InfoTagDecoderDelay;
+	const int32 StoredPadding = static_cast<int32>(FMath::Min<int64>(NumOfPaddingFrames + InfoTagDecoderDelay, 0xFFF));
+	Extension[21] = static_cast<uint8>(StoredDelay >> 4);
+	Extension[22] = static_cast<uint8>(((StoredDelay & 0xF) << 4) | (StoredPadding >> 8));
+	Extension[23] = static_cast<uint8>(StoredPadding & 0xFF);
+}
+
+int32 FMP3_RuntimeEncoder::GetBitrateFromQuality(uint8 Quality, uint32 NumOfChannels)
+{
+	// Nominal stereo bitrates of the Vorbis quality levels 0-10, which the quality maps to in the Vorbis codec, limited by the largest MP3 bitrate
+	static const int32 VorbisNominalBitrates[11] = {64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 320};
+
+	const float QualityLevel = FMath::Clamp<int32>(Quality, 0, 100) / 10.f;
+	const int32 LowerLevel = FMath::FloorToInt(QualityLevel);
+	const int32 UpperLevel = FMath::Min(LowerLevel + 1, 10);
+	const float StereoBitrate = FMath::Lerp(static_cast<float>(VorbisNominalBitrates[LowerLevel]), static_cast<float>(VorbisNominalBitrates[UpperLevel]), QualityLevel - LowerLevel);
+	const float TargetBitrate = NumOfChannels == 1 ? StereoBitrate / 2.f : StereoBitrate;
+
+	// The nearest bitrate of the format, but not below 32 kbps (the smallest one) or 64 kbps for stereo
+	int32 NearestBitrate = NumOfChannels == 1 ? Bitrates[1] : Bitrates[5];
+	for (int32 BitrateIndex = 1; BitrateIndex < 15; ++BitrateIndex)
+	{
+		if (FMath::Abs(Bitrates[BitrateIndex] - TargetBitrate) < FMath::Abs(NearestBitrate - TargetBitrate) && (NumOfChannels == 1 || Bitrates[BitrateIndex] >= 64))
+		{
+			NearestBitrate = Bitrates[BitrateIndex];
+		}
+	}
+	return NearestBitrate;
+}
+
+uint32 FMP3_RuntimeEncoder::GetEncodedSampleRate(uint32 InSampleRate)
+{
+	if (InSampleRate <= 32000)
+	{
+		return 32000;
+	}
+	if (InSampleRate <= 44100)
+	{
+		return 44100;
+	}
+	return 48000;
+}
+
+int32 FMP3_RuntimeEncoder::GetEncoderDelay()
+{
+	return EncoderDelay;
+}
+
+bool FMP3_RuntimeEncoder::AppendInput(const float* PCMData, int64 NumOfFrames)
+{
+	int32 NumOfMixedChannels = NumOfInputChannels;
+	const float* MixedData = PCMData;
+
+	// The format holds up to two channels
+	if (NumOfInputChannels > 2)
+	{
+		Audio::FAlignedFloatBuffer InputBuffer(PCMData, NumOfFrames * NumOfInputChannels);
+		if (!FRAW_RuntimeCodec::MixChannelsRAWData(InputBuffer, InputSampleRate, NumOfInputChannels, 2, MixedBuffer))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to encode MP3 data because the audio data could not be mixed from %d to 2 channels"), NumOfInputChannels);
+			return false;
+		}
+		NumOfMixedChannels = 2;
+		MixedData = MixedBuffer.GetData();
+	}
+
+	if (SampleRate != InputSampleRate)
+	{
+		ResampledBuffer.Reset();
+		if (!Resampler.ProcessAudio(MixedData, NumOfFrames, ResampledBuffer))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to encode MP3 data because the audio data could not be resampled from %d to %d"), InputSampleRate, SampleRate);
+			return false;
+		}
+		AppendDeinterleaved(ResampledBuffer.GetData(), ResampledBuffer.Num() / NumOfMixedChannels, NumOfMixedChannels);
+		return true;
+	}
+
+	AppendDeinterleaved(MixedData, NumOfFrames, NumOfMixedChannels);
+	return true;
+}
+
+void FMP3_RuntimeEncoder::AppendDeinterleaved(const float* PCMData, int64 NumOfFrames, int32 NumOfDataChannels)
+{
+	for (int32 ChannelIndex = 0; ChannelIndex < NumOfDataChannels; ++ChannelIndex)
+	{
+		TArray<float>& InputBuffer = InputBuffers[ChannelIndex];
+		const int32 PreviousNum = InputBuffer.Num();
+		InputBuffer.AddUninitialized(NumOfFrames);
+		for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+		{
+			InputBuffer[PreviousNum + FrameIndex] = PCMData[FrameIndex * NumOfDataChannels + ChannelIndex];
+		}
+	}
+	NumOfInputFrames += NumOfFrames;
+}
+
+void FMP3_RuntimeEncoder::EncodeAvailableFrames(TArray64<uint8>& OutEncodedData)
+{
+	while (InputBuffers[0].Num() - InputReadOffset >= NumOfFrameInputSamples)
+	{
+		EncodeFrame(OutEncodedData);
+	}
+
+	// Less than a frame of input is left, so moving it to the beginning of the buffers is cheap
+	if (InputReadOffset > 0)
+	{
+		for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+		{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+			InputBuffers[ChannelIndex].RemoveAt(0, InputReadOffset, false);
+#else
+			InputBuffers[ChannelIndex].RemoveAt(0, InputReadOffset, EAllowShrinking::No);
+#endif
+		}
+		InputReadOffset = 0;
+	}
+}
+
+void FMP3_RuntimeEncoder::EncodeFrame(TArray64<uint8>& OutEncodedData)
+{
+	const FEncoderTables& Tables = GetEncoderTables();
+	const FScalefactorBands Bands(SampleRateIndex);
+
+	// The granules of both channels are kept on the heap, since they are too large for the stack of the worker threads
+	TArray<FGranuleData> Granules;
+	Granules.SetNum(2 * NumOfChannels);
+
+	for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+	{
+		const float* Input = InputBuffers[ChannelIndex].GetData() + InputReadOffset;
+		float* PreviousSamples = PreviousSubbandSamples[ChannelIndex].GetData();
+
+		for (int32 GranuleIndex = 0; GranuleIndex < 2; ++GranuleIndex)
+		{
+			// Polyphase analysis into 18 samples of each of the 32 subbands, stored by subband
+			float SubbandSamples[NumOfGranuleSamples];
+			for (int32 SlotIndex = 0; SlotIndex < NumOfSubbandSamples; ++SlotIndex)
+			{
+				const float* SlotInput = Input + (GranuleIndex * NumOfSubbandSamples + SlotIndex) * NumOfSubbands;
+
+				float Folded[64];
+				for (int32 Index = 0; Index < 64; ++Index)
+				{
+					float Sum = 0.f;
+					for (int32 Block = 0; Block < 8; ++Block)
+					{
+						const int32 TapIndex = Index + Block * 64;
+						const float Tap = Tables.Window[TapIndex] * SlotInput[TapIndex];
+						Sum += (Block & 1) ? -Tap : Tap;
+					}
+					Folded[Index] = Sum;
+				}
+
+				for (int32 Subband = 0; Subband < NumOfSubbands; ++Subband)
+				{
+					float Sum = 0.f;
+					for (int32 Index = 0; Index < 64; ++Index)
+					{
+						Sum += Tables.Modulation[Subband][Index] * Folded[Index];
+					}
+
+					// The decoder inverts every other sample of the odd subbands
+					SubbandSamples[Subband * NumOfSubbandSamples + SlotIndex] = (Subband & 1) && (SlotIndex & 1) ? -Sum : Sum;
+				}
+			}
+
+			// MDCT over the previous and the current granule of each subband
+			float* Spectrum = Granules[GranuleIndex * NumOfChannels + ChannelIndex].Spectrum;
+			for (int32 Subband = 0; Subband < NumOfSubbands; ++Subband)
+			{
+				const float* Previous = PreviousSamples + Subband * NumOfSubbandSamples;
+				const float* Current = SubbandSamples + Subband * NumOfSubbandSamples;
+				for (int32 Line = 0; Line < NumOfSubbandSamples; ++Line)
+				{
+					float Sum = 0.f;
+					for (int32 Index = 0; Index < NumOfSubbandSamples; ++Index)
+					{
+						Sum += Tables.MDCT[Line][Index] * Previous[Index] + Tables.MDCT[Line][Index + NumOfSubbandSamples] * Current[Index];
+					}
+					Spectrum[Subband * NumOfSubbandSamples + Line] = Sum;
+				}
+			}
+			FMemory::Memcpy(PreviousSamples, SubbandSamples, sizeof(SubbandSamples));
+
+			// Alias reduction, inverse of the butterflies applied by the decoder
+			for (int32 Subband = 1; Subband < NumOfSubbands; ++Subband)
+			{
+				for (int32 Index = 0; Index < 8; ++Index)
+				{
+					float& Upper = Spectrum[Subband * NumOfSubbandSamples + Index];
+					float& Lower = Spectrum[Subband * NumOfSubbandSamples - 1 - Index];
+					const float UpperValue = Upper, LowerValue = Lower;
+					Upper = UpperValue * Tables.AliasCs[Index] + LowerValue * Tables.AliasCa[Index];
+					Lower = LowerValue * Tables.AliasCs[Index] - UpperValue * Tables.AliasCa[Index];
+				}
+			}
+
+			for (int32 Line = LowpassLine; Line < NumOfGranuleSamples; ++Line)
+			{
+				Spectrum[Line] = 0.f;
+			}
+		}
+	}
+
+	// Mid/side stereo is used if the channels are similar enough for one of mid and side to be much weaker than either channel
+	bool bMidSide = false;
+	if (NumOfChannels == 2)
+	{
+		double LeftEnergy = 0., RightEnergy = 0., MidEnergy = 0., SideEnergy = 0.;
+		for (int32 GranuleIndex = 0; GranuleIndex < 2; ++GranuleIndex)
+		{
+			const float* Left = Granules[GranuleIndex * 2].Spectrum;
+			const float* Right = Granules[GranuleIndex * 2 + 1].Spectrum;
+			for (int32 Line = 0; Line < LowpassLine; ++Line)
+			{
+				LeftEnergy += Left[Line] * Left[Line];
+				RightEnergy += Right[Line] * Right[Line];
+				MidEnergy += 0.5 * (Left[Line] + Right[Line]) * (Left[Line] + Right[Line]);
+				SideEnergy += 0.5 * (Left[Line] - Right[Line]) * (Left[Line] - Right[Line]);
+			}
+		}
+		bMidSide = FMath::Min(MidEnergy, SideEnergy) < MidSideEnergyRatio * FMath::Min(LeftEnergy, RightEnergy);
+
+		if (bMidSide)
+		{
+			for (int32 GranuleIndex = 0; GranuleIndex < 2; ++GranuleIndex)
+			{
+				float* Left = Granules[GranuleIndex * 2].Spectrum;
+				float* Right = Granules[GranuleIndex * 2 + 1].Spectrum;
+				for (int32 Line = 0; Line < LowpassLine; ++Line)
+				{
+					const float Mid = (Left[Line] + Right[Line]) * UE_INV_SQRT_2;
+					const float Side = (Left[Line] - Right[Line]) * UE_INV_SQRT_2;
+					Left[Line] = Mid;
+					Right[Line] = Side;
+				}
+			}
+		}
+	}
+
+	// Frame size, with an extra byte in some of the frames if the average frame size is not a whole number of bytes
+	const int64 FrameSizeNumerator = 144000 * static_cast<int64>(Bitrate);
+	int32 FrameSize = static_cast<int32>(FrameSizeNumerator / SampleRate);
+	FrameSizeRemainder += FrameSizeNumerator % SampleRate;
+	const bool bPadding = FrameSizeRemainder >= SampleRate;
+	if (bPadding)
+	{
+		FrameSizeRemainder -= SampleRate;
+		++FrameSize;
+	}
+
+	const int32 SideInfoSize = GetSideInfoSize(NumOfChannels);
+	int32 NumOfRemainingBits = (FrameSize - 4 - SideInfoSize) * 8;
+
+	// Distributing the bits of the frame between the granules according to their estimated needs
+	float NeededBits[4];
+	float TotalNeededBits = 0.f;
+	for (int32 Index = 0; Index < Granules.Num(); ++Index)
+	{
+		FGranuleData& Granule = Granules[Index];
+		for (int32 Line = 0; Line < NumOfGranuleSamples; ++Line)
+		{
+			Granule.Spectrum34[Line] = FMath::Pow(FMath::Abs(Granule.Spectrum[Line]), 0.75f);
+		}
+		ComputeAllowedNoise(Granule, Bands);
+		NeededBits[Index] = EstimateNumOfNeededBits(Granule, Bands);
+		TotalNeededBits += NeededBits[Index];
+	}
+
+	for (int32 Index = 0; Index < Granules.Num(); ++Index)
+	{
+		const int32 NumOfRemainingGranules = Granules.Num() - Index;
+		int32 NumOfAvailableBits = NumOfRemainingBits / NumOfRemainingGranules;
+		if (TotalNeededBits > 0.f)
+		{
+			// Each granule gets at least a quarter of the even share
+			const float Share = FMath::Max(NeededBits[Index] / TotalNeededBits, 0.25f / NumOfRemainingGranules);
+			NumOfAvailableBits = FMath::Min(static_cast<int32>(NumOfRemainingBits * Share), NumOfRemainingBits);
+		}
+		TotalNeededBits -= NeededBits[Index];
+
+		FGranuleData& Granule = Granules[Index];
+		Granule.Info.Part23Length = QuantizeGranule(Granule, Bands, FMath::Min(NumOfAvailableBits, MaxPart23Length));
+		NumOfRemainingBits -= Granule.Info.Part23Length;
+	}
+
+	// Writing the frame
+	const int64 FrameOffset = OutEncodedData.Num();
+	OutEncodedData.AddZeroed(FrameSize);
+	FBitWriter Writer(OutEncodedData.GetData() + FrameOffset);
+
+	WriteFrameHeader(Writer, BitrateIndex, SampleRateIndex, bPadding, NumOfChannels, bMidSide);
+
+	Writer.Write(0, 9); // main_data_begin, the bit reservoir is not used
+	Writer.Write(0, NumOfChannels == 1 ? 5 : 3); // Private bits
+	Writer.Write(0, 4 * NumOfChannels); // scfsi, the scalefactors are not shared between the granules
+
+	for (const FGranuleData& Granule : Granules)
+	{
+		const FGranuleInfo& Info = Granule.Info;
+		Writer.Write(Info.Part23Length, 12);
+		Writer.Write(Info.BigValues, 9);
+		Writer.Write(Info.GlobalGain, 8);
+		Writer.Write(Info.ScalefacCompress, 4);
+		Writer.Write(0, 1); // Long blocks only
+		Writer.Write(Info.TableSelect[0], 5);
+		Writer.Write(Info.TableSelect[1], 5);
+		Writer.Write(Info.TableSelect[2], 5);
+		Writer.Write(Info.Region0Count, 4);
+		Writer.Write(Info.Region1Count, 3);
+		Writer.Write(0, 1); // preflag
+		Writer.Write(0, 1); // scalefac_scale
+		Writer.Write(Info.Count1Table, 1);
+	}
+
+	for (const FGranuleData& Granule : Granules)
+	{
+		const int64 StartPosition = Writer.GetPosition();
+		WriteMainData(Writer, Granule, Bands);
+		ensureMsgf(Writer.GetPosition() - StartPosition == Granule.Info.Part23Length, TEXT("The number of written bits does not match the counted bits of the granule"));
+	}
+
+	// Consuming the input of the frame
+	InputReadOffset += NumOfFrameSamples;
+
+	++NumOfEncodedFrames;
+	NumOfEncodedBytes += FrameSize;
+}
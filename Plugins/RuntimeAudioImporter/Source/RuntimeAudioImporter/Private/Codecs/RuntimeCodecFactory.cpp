@@ -4,30 +4,224 @@
 #include "Codecs/BaseRuntimeCodec.h"
 #include "Features/IModularFeatures.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
 
 #include "RuntimeAudioImporterDefines.h"
 
-TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs()
+namespace
 {
+	/**
+	 * Signature identifying an audio container by up to two byte sequences at fixed offsets
+	 */
+	struct FRuntimeAudioMagicBytes
+	{
+		ERuntimeAudioFormat AudioFormat;
+
+		int32 Offset;
+		const char* Bytes;
+		int32 NumOfBytes;
+
+		/** Optional second sequence that must also match, e.g. the form type of a RIFF container */
+		int32 SecondaryOffset;
+		const char* SecondaryBytes;
+		int32 SecondaryNumOfBytes;
+
+		/** Whether the signature is specific enough to skip validating the data with the codec */
+		bool bConclusive;
+
+		bool Matches(FRuntimeAudioDataView AudioData) const
+		{
+			auto MatchesAt = [&AudioData](int32 InOffset, const char* InBytes, int32 InNumOfBytes)
+			{
+				return AudioData.Num() >= InOffset + InNumOfBytes && FMemory::Memcmp(AudioData.GetData() + InOffset, InBytes, InNumOfBytes) == 0;
+			};
+			return MatchesAt(Offset, Bytes, NumOfBytes) && (SecondaryBytes == nullptr || MatchesAt(SecondaryOffset, SecondaryBytes, SecondaryNumOfBytes));
+		}
+	};
+
+	const FRuntimeAudioMagicBytes MagicBytesTable[] =
+	{
+		{ERuntimeAudioFormat::Wav, 0, "RIFF", 4, 8, "WAVE", 4, true},
+		{ERuntimeAudioFormat::Wav, 0, "RIFX", 4, 8, "WAVE", 4, true},
+		{ERuntimeAudioFormat::Wav, 0, "RF64", 4, 8, "WAVE", 4, true},
+		// Sony Wave64, the RIFF chunk is identified by a GUID starting with "riff"
+		{ERuntimeAudioFormat::Wav, 0, "riff\x2E\x91\xCF\x11", 8, 0, nullptr, 0, true},
+		{ERuntimeAudioFormat::Wav, 0, "FORM", 4, 8, "AIFF", 4, true},
+		{ERuntimeAudioFormat::Wav, 0, "FORM", 4, 8, "AIFC", 4, true},
+		{ERuntimeAudioFormat::Flac, 0, "fLaC", 4, 0, nullptr, 0, true},
+		// The Vorbis identification header follows the page header and the single-entry segment table of the first Ogg page
+		{ERuntimeAudioFormat::OggVorbis, 0, "OggS", 4, 28, "\x01vorbis", 7, true},
+		// An ID3v2 tag is most commonly followed by MPEG audio, but it can prefix other formats as well
+		{ERuntimeAudioFormat::Mp3, 0, "ID3", 3, 0, nullptr, 0, false},
+	};
+
+	/**
+	 * Cached codec lookups shared by all codec factories
+	 * The cache is versioned by a generation counter which is bumped whenever a codec is registered or unregistered
+	 */
+	class FRuntimeCodecRegistry
+	{
+	public:
+		static FRuntimeCodecRegistry& Get()
+		{
+			static FRuntimeCodecRegistry Registry;
+			return Registry;
+		}
+
+		void Startup()
+		{
+			if (RegisteredHandle.IsValid())
+			{
+				return;
+			}
+			RegisteredHandle = IModularFeatures::Get().OnModularFeatureRegistered().AddRaw(this, &FRuntimeCodecRegistry::OnModularFeatureChanged);
+			UnregisteredHandle = IModularFeatures::Get().OnModularFeatureUnregistered().AddRaw(this, &FRuntimeCodecRegistry::OnModularFeatureChanged);
+			Invalidate();
+		}
+
+		void Shutdown()
+		{
+			if (RegisteredHandle.IsValid())
+			{
+				IModularFeatures::Get().OnModularFeatureRegistered().Remove(RegisteredHandle);
+				IModularFeatures::Get().OnModularFeatureUnregistered().Remove(UnregisteredHandle);
+				RegisteredHandle.Reset();
+				UnregisteredHandle.Reset();
+			}
+
+			FWriteScopeLock WriteLock(Lock);
+			Codecs.Empty();
+			FormatCodecs.Empty();
+			ExtensionCodecs.Empty();
+			BuiltGeneration = 0;
+			Generation.Increment();
+		}
+
+		TArray<FBaseRuntimeCodec*> GetCodecs()
+		{
+			FReadScopeLock ReadLock(EnsureUpToDate());
+			return Codecs;
+		}
+
+		TArray<FBaseRuntimeCodec*> GetCodecs(ERuntimeAudioFormat AudioFormat)
+		{
+			FReadScopeLock ReadLock(EnsureUpToDate());
+			if (const TArray<FBaseRuntimeCodec*>* FoundCodecs = FormatCodecs.Find(AudioFormat))
+			{
+				return *FoundCodecs;
+			}
+			return TArray<FBaseRuntimeCodec*>();
+		}
+
+		TArray<FBaseRuntimeCodec*> GetCodecs(const FString& Extension)
+		{
+			// Codecs only expose a predicate for the extensions, so the lookup is memoized per extension
+			const FString ExtensionKey = Extension.ToLower();
+			{
+				FReadScopeLock ReadLock(EnsureUpToDate());
+				if (const TArray<FBaseRuntimeCodec*>* FoundCodecs = ExtensionCodecs.Find(ExtensionKey))
+				{
+					return *FoundCodecs;
+				}
+			}
+
+			FWriteScopeLock WriteLock(Lock);
+			if (const TArray<FBaseRuntimeCodec*>* FoundCodecs = ExtensionCodecs.Find(ExtensionKey))
+			{
+				return *FoundCodecs;
+			}
+			TArray<FBaseRuntimeCodec*>& MatchingCodecs = ExtensionCodecs.Add(ExtensionKey);
+			for (FBaseRuntimeCodec* Codec : Codecs)
+			{
+				if (Codec->IsExtensionSupported(Extension))
+				{
+					MatchingCodecs.Add(Codec);
+				}
+			}
+			return MatchingCodecs;
+		}
+
+	private:
+		FRuntimeCodecRegistry() = default;
+
+		void OnModularFeatureChanged(const FName& Type, IModularFeature* ModularFeature)
+		{
+			if (Type == FRuntimeCodecFactory::GetModularFeatureName())
+			{
+				Invalidate();
+			}
+		}
+
+		/**
+		 * Mark the cached lookups as outdated
+		 * Only touches the counter, since the modular feature list may be locked by the caller while broadcasting
+		 */
+		void Invalidate()
+		{
+			Generation.Increment();
+		}
+
+		/**
+		 * Rebuild the cached lookups if the registered codecs have changed since they were last built
+		 *
+		 * @return The lock guarding the cached lookups, to be read-locked by the caller
+		 */
+		FRWLock& EnsureUpToDate()
+		{
+			{
+				FReadScopeLock ReadLock(Lock);
+				if (BuiltGeneration == Generation.GetValue())
+				{
+					return Lock;
+				}
+			}
+
+			const int32 TargetGeneration = Generation.GetValue();
+
+			TArray<FBaseRuntimeCodec*> RegisteredCodecs;
+			{
 #if UE_VERSION_NEWER_THAN(5, 1, 0)
-	IModularFeatures::FScopedLockModularFeatureList ScopedLockModularFeatureList;
+				IModularFeatures::FScopedLockModularFeatureList ScopedLockModularFeatureList;
 #endif
-	TArray<FBaseRuntimeCodec*> AvailableCodecs = IModularFeatures::Get().GetModularFeatureImplementations<FBaseRuntimeCodec>(GetModularFeatureName());
-	return AvailableCodecs;
+				RegisteredCodecs = IModularFeatures::Get().GetModularFeatureImplementations<FBaseRuntimeCodec>(FRuntimeCodecFactory::GetModularFeatureName());
+			}
+
+			FWriteScopeLock WriteLock(Lock);
+			Codecs = MoveTemp(RegisteredCodecs);
+			FormatCodecs.Reset();
+			ExtensionCodecs.Reset();
+			for (FBaseRuntimeCodec* Codec : Codecs)
+			{
+				FormatCodecs.FindOrAdd(Codec->GetAudioFormat()).Add(Codec);
+			}
+
+			// A registration that happened while the list was being gathered leaves the generation ahead, so the next lookup rebuilds again
+			BuiltGeneration = TargetGeneration;
+			UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Rebuilt the codec registry with %d codecs"), Codecs.Num());
+			return Lock;
+		}
+
+		FRWLock Lock;
+		TArray<FBaseRuntimeCodec*> Codecs;
+		TMap<ERuntimeAudioFormat, TArray<FBaseRuntimeCodec*>> FormatCodecs;
+		TMap<FString, TArray<FBaseRuntimeCodec*>> ExtensionCodecs;
+
+		FThreadSafeCounter Generation{1};
+		int32 BuiltGeneration = 0;
+
+		FDelegateHandle RegisteredHandle;
+		FDelegateHandle UnregisteredHandle;
+	};
 }
 
-TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(const FString& FilePath)
+TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs()
 {
-	TArray<FBaseRuntimeCodec*> Codecs;
-	const FString Extension = FPaths::GetExtension(FilePath, false);
+	return FRuntimeCodecRegistry::Get().GetCodecs();
+}
 
-	for (FBaseRuntimeCodec* Codec : GetCodecs())
-	{
-		if (Codec->IsExtensionSupported(Extension))
-		{
-			Codecs.Add(Codec);
-		}
-	}
+TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(const FString& FilePath)
+{
+	TArray<FBaseRuntimeCodec*> Codecs = FRuntimeCodecRegistry::Get().GetCodecs(FPaths::GetExtension(FilePath, false));
 
 	if (Codecs.Num() == 0)
 	{
@@ -39,14 +233,7 @@ TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(const FString& FilePa
 
 TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(ERuntimeAudioFormat AudioFormat)
 {
-	TArray<FBaseRuntimeCodec*> Codecs;
-	for (FBaseRuntimeCodec* Codec : GetCodecs())
-	{
-		if (Codec->GetAudioFormat() == AudioFormat)
-		{
-			Codecs.Add(Codec);
-		}
-	}
+	TArray<FBaseRuntimeCodec*> Codecs = FRuntimeCodecRegistry::Get().GetCodecs(AudioFormat);
 
 	if (Codecs.Num() == 0)
 	{
@@ -57,8 +244,33 @@ TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(ERuntimeAudioFormat A
 }
 
 TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+{
+	return GetCodecs(FRuntimeAudioDataView(AudioData.GetView()));
+}
+
+TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(FRuntimeAudioDataView AudioData)
 {
 	TArray<FBaseRuntimeCodec*> Codecs;
+
+	bool bConclusive = false;
+	const ERuntimeAudioFormat SniffedFormat = SniffAudioFormat(AudioData, bConclusive);
+	if (SniffedFormat != ERuntimeAudioFormat::Invalid)
+	{
+		for (FBaseRuntimeCodec* Codec : FRuntimeCodecRegistry::Get().GetCodecs(SniffedFormat))
+		{
+			if (bConclusive || Codec->CheckAudioFormat(AudioData))
+			{
+				Codecs.Add(Codec);
+			}
+		}
+
+		if (Codecs.Num() > 0)
+		{
+			return Codecs;
+		}
+		UE_LOG(LogRuntimeAudioImporter, Log, TEXT("The audio data looks like %s, but no codec accepted it. Probing all codecs"), *UEnum::GetValueAsString(SniffedFormat));
+	}
+
 	for (FBaseRuntimeCodec* Codec : GetCodecs())
 	{
 		if (Codec->CheckAudioFormat(AudioData))
@@ -69,8 +281,45 @@ TArray<FBaseRuntimeCodec*> FRuntimeCodecFactory::GetCodecs(const FRuntimeBulkDat
 
 	if (Codecs.Num() == 0)
 	{
-		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to determine the audio codec based on the audio data of size %lld bytes"), static_cast<int64>(AudioData.GetView().Num()));
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to determine the audio codec based on the audio data of size %lld bytes"), static_cast<int64>(AudioData.Num()));
 	}
 
 	return Codecs;
 }
+
+ERuntimeAudioFormat FRuntimeCodecFactory::SniffAudioFormat(FRuntimeAudioDataView AudioData, bool& bOutConclusive)
+{
+	bOutConclusive = false;
+	if (AudioData.GetData() == nullptr)
+	{
+		return ERuntimeAudioFormat::Invalid;
+	}
+
+	for (const FRuntimeAudioMagicBytes& MagicBytes : MagicBytesTable)
+	{
+		if (MagicBytes.Matches(AudioData))
+		{
+			bOutConclusive = MagicBytes.bConclusive;
+			return MagicBytes.AudioFormat;
+		}
+	}
+
+	// A raw MPEG audio stream starts with an 11-bit frame sync followed by a non-reserved version and layer, which is too weak to be conclusive
+	if (AudioData.Num() >= 2 && AudioData.GetData()[0] == 0xFF && (AudioData.GetData()[1] & 0xE0) == 0xE0
+		&& (AudioData.GetData()[1] & 0x18) != 0x08 && (AudioData.GetData()[1] & 0x06) != 0x00)
+	{
+		return ERuntimeAudioFormat::Mp3;
+	}
+
+	return ERuntimeAudioFormat::Invalid;
+}
+
+void FRuntimeCodecFactory::StartupCodecRegistry()
+{
+	FRuntimeCodecRegistry::Get().Startup();
+}
+
+void FRuntimeCodecFactory::ShutdownCodecRegistry()
+{
+	FRuntimeCodecRegistry::Get().Shutdown();
+}
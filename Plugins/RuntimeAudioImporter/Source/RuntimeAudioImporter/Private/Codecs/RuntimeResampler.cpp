@@ -0,0 +1,366 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Codecs/RuntimeResampler.h"
+#include "RuntimeAudioImporterDefines.h"
+
+namespace
+{
+	/** Maximum number of rows in a filter bank. Ratios with a larger interpolation factor interpolate between the rows */
+	constexpr int32 MaxNumOfPhases = 256;
+
+	/** Maximum number of input frames per output frame, which limits the filter length for large decimation factors */
+	constexpr int32 MaxNumOfTaps = 1024;
+
+	/** Largest decimation factor for which the sinc filters keep their quality without exceeding MaxNumOfTaps */
+	constexpr int64 MaxDecimationFactor = 8;
+
+	/** Filter parameters of the sinc quality tiers. Rolloff is relative to the lower of the two Nyquist frequencies */
+	constexpr int32 PolyphaseNumOfTaps = 32;
+	constexpr float PolyphaseRolloff = 0.85f;
+	constexpr float PolyphaseKaiserBeta = 7.f;
+
+	constexpr int32 BestSincNumOfTaps = 128;
+	constexpr float BestSincRolloff = 0.91f;
+	constexpr float BestSincKaiserBeta = 10.f;
+
+	/** Zeroth order modified Bessel function of the first kind, used by the Kaiser window */
+	double BesselI0(double Value)
+	{
+		double Sum = 1.;
+		double Term = 1.;
+		const double HalfValueSquared = Value * Value * 0.25;
+		for (int32 Index = 1; Index < 64 && Term > Sum * 1e-12; ++Index)
+		{
+			Term *= HalfValueSquared / (Index * Index);
+			Sum += Term;
+		}
+		return Sum;
+	}
+
+	/** Catmull-Rom cubic interpolation kernel */
+	float CubicKernel(float Position)
+	{
+		const float X = FMath::Abs(Position);
+		if (X < 1.f)
+		{
+			return (1.5f * X - 2.5f) * X * X + 1.f;
+		}
+		if (X < 2.f)
+		{
+			return ((-0.5f * X + 2.5f) * X - 4.f) * X + 2.f;
+		}
+		return 0.f;
+	}
+
+	int64 GreatestCommonDivisor(int64 A, int64 B)
+	{
+		while (B != 0)
+		{
+			const int64 Remainder = A % B;
+			A = B;
+			B = Remainder;
+		}
+		return A;
+	}
+}
+
+FRuntimeResampler::FRuntimeResampler()
+	: NumOfChannels(0)
+  , SourceSampleRate(0)
+  , DestinationSampleRate(0)
+  , Quality(ERuntimeResamplingQuality::BestSinc)
+  , Interpolation(1)
+  , Decimation(1)
+  , NumOfTaps(0)
+  , NumOfPhases(0)
+  , NextFrameIndex(0)
+  , NextPhase(0)
+  , TotalInputFrames(0)
+  , TotalOutputFrames(0)
+{
+}
+
+bool FRuntimeResampler::Init(int32 InNumOfChannels, uint32 InSourceSampleRate, uint32 InDestinationSampleRate, ERuntimeResamplingQuality InQuality)
+{
+	NumOfChannels = 0;
+
+	if (InNumOfChannels <= 0)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the resampler because the number of channels is invalid (%d)"), InNumOfChannels);
+		return false;
+	}
+	if (InSourceSampleRate <= 0 || InDestinationSampleRate <= 0)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the resampler because the sample rate is invalid (source: %d, destination: %d)"), InSourceSampleRate, InDestinationSampleRate);
+		return false;
+	}
+
+	SourceSampleRate = InSourceSampleRate;
+	DestinationSampleRate = InDestinationSampleRate;
+	Quality = InQuality;
+
+	const int64 Divisor = GreatestCommonDivisor(InSourceSampleRate, InDestinationSampleRate);
+	Interpolation = InDestinationSampleRate / Divisor;
+	Decimation = InSourceSampleRate / Divisor;
+
+	FilterBank.Reset();
+	NumOfPhases = 0;
+
+	switch (Quality)
+	{
+	case ERuntimeResamplingQuality::Linear:
+		NumOfTaps = 2;
+		break;
+	case ERuntimeResamplingQuality::Cubic:
+		NumOfTaps = 4;
+		break;
+	case ERuntimeResamplingQuality::Polyphase:
+		BuildFilterBank(PolyphaseNumOfTaps, PolyphaseRolloff, PolyphaseKaiserBeta);
+		break;
+	case ERuntimeResamplingQuality::BestSinc:
+	default:
+		BuildFilterBank(BestSincNumOfTaps, BestSincRolloff, BestSincKaiserBeta);
+		break;
+	}
+
+	Coefficients.SetNumZeroed(NumOfTaps);
+	NumOfChannels = InNumOfChannels;
+	Reset();
+
+	UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Initialized the resampler from %d to %d (ratio %lld/%lld, %d taps, %d phases)"),
+	       SourceSampleRate, DestinationSampleRate, Interpolation, Decimation, NumOfTaps, NumOfPhases);
+	return true;
+}
+
+void FRuntimeResampler::Reset()
+{
+	// The history starts out silent, and the first output frame is aligned with the first input frame
+	const int32 NumOfHistoryFrames = NumOfTaps - 1;
+	WorkBuffer.Reset();
+	WorkBuffer.SetNumZeroed(NumOfHistoryFrames * NumOfChannels);
+	NextFrameIndex = NumOfHistoryFrames + NumOfTaps / 2;
+	NextPhase = 0;
+	TotalInputFrames = 0;
+	TotalOutputFrames = 0;
+}
+
+bool FRuntimeResampler::IsConfiguredFor(int32 InNumOfChannels, uint32 InSourceSampleRate, uint32 InDestinationSampleRate, ERuntimeResamplingQuality InQuality) const
+{
+	return IsInitialized() && NumOfChannels == InNumOfChannels && SourceSampleRate == InSourceSampleRate && DestinationSampleRate == InDestinationSampleRate && Quality == InQuality;
+}
+
+bool FRuntimeResampler::IsExactRatio(uint32 SourceSampleRate, uint32 DestinationSampleRate)
+{
+	if (SourceSampleRate <= 0 || DestinationSampleRate <= 0)
+	{
+		return false;
+	}
+	const int64 Divisor = GreatestCommonDivisor(SourceSampleRate, DestinationSampleRate);
+	const int64 ReducedInterpolation = DestinationSampleRate / Divisor;
+	const int64 ReducedDecimation = SourceSampleRate / Divisor;
+	return ReducedInterpolation <= MaxNumOfPhases && ReducedDecimation <= ReducedInterpolation * MaxDecimationFactor;
+}
+
+int64 FRuntimeResampler::GetNumOfOutputFrames(int64 NumOfInputFrames) const
+{
+	return (NumOfInputFrames * Interpolation + Decimation - 1) / Decimation;
+}
+
+void FRuntimeResampler::BuildFilterBank(int32 BaseNumOfTaps, float Rolloff, float KaiserBeta)
+{
+	// When downsampling, the cutoff follows the destination Nyquist frequency and the filter has to be proportionally longer
+	const double Bandwidth = FMath::Min(1., static_cast<double>(Interpolation) / Decimation);
+	const double Cutoff = Rolloff * Bandwidth;
+
+	NumOfTaps = FMath::Clamp(FMath::CeilToInt(BaseNumOfTaps / Bandwidth), 4, MaxNumOfTaps);
+	NumOfTaps = Align(NumOfTaps, 4);
+	NumOfPhases = static_cast<int32>(FMath::Min<int64>(Interpolation, MaxNumOfPhases));
+
+	const double HalfWidth = NumOfTaps * 0.5;
+	const double WindowNormalization = 1. / BesselI0(KaiserBeta);
+
+	FilterBank.SetNumUninitialized((NumOfPhases + 1) * NumOfTaps);
+	for (int32 PhaseIndex = 0; PhaseIndex <= NumOfPhases; ++PhaseIndex)
+	{
+		const double Fraction = static_cast<double>(PhaseIndex) / NumOfPhases;
+		float* Row = FilterBank.GetData() + PhaseIndex * NumOfTaps;
+
+		double RowSum = 0.;
+		for (int32 TapIndex = 0; TapIndex < NumOfTaps; ++TapIndex)
+		{
+			// Distance between the output position and the input frame of the tap, the oldest frame comes first
+			const double Distance = HalfWidth - 1. - TapIndex + Fraction;
+			const double NormalizedDistance = Distance / HalfWidth;
+			if (FMath::Abs(NormalizedDistance) >= 1.)
+			{
+				Row[TapIndex] = 0.f;
+				continue;
+			}
+
+			const double SincArgument = PI * Cutoff * Distance;
+			const double Sinc = FMath::Abs(SincArgument) < 1e-9 ? 1. : FMath::Sin(SincArgument) / SincArgument;
+			const double Window = BesselI0(KaiserBeta * FMath::Sqrt(1. - NormalizedDistance * NormalizedDistance)) * WindowNormalization;
+			const double Coefficient = Cutoff * Sinc * Window;
+
+			Row[TapIndex] = static_cast<float>(Coefficient);
+			RowSum += Coefficient;
+		}
+
+		// Normalize each row to unity gain at DC, so that the gain does not ripple between the phases
+		if (RowSum > 0.)
+		{
+			const float RowScale = static_cast<float>(1. / RowSum);
+			for (int32 TapIndex = 0; TapIndex < NumOfTaps; ++TapIndex)
+			{
+				Row[TapIndex] *= RowScale;
+			}
+		}
+	}
+}
+
+const float* FRuntimeResampler::GetCoefficients(int64 Phase)
+{
+	float* Result = Coefficients.GetData();
+
+	switch (Quality)
+	{
+	case ERuntimeResamplingQuality::Linear:
+		{
+			const float Fraction = static_cast<float>(Phase) / Interpolation;
+			Result[0] = 1.f - Fraction;
+			Result[1] = Fraction;
+			return Result;
+		}
+	case ERuntimeResamplingQuality::Cubic:
+		{
+			const float Fraction = static_cast<float>(Phase) / Interpolation;
+			Result[0] = CubicKernel(1.f + Fraction);
+			Result[1] = CubicKernel(Fraction);
+			Result[2] = CubicKernel(1.f - Fraction);
+			Result[3] = CubicKernel(2.f - Fraction);
+			return Result;
+		}
+	default:
+		break;
+	}
+
+	// Exact ratios address the filter bank rows directly
+	if (NumOfPhases == Interpolation)
+	{
+		return FilterBank.GetData() + Phase * NumOfTaps;
+	}
+
+	const double Position = static_cast<double>(Phase) * NumOfPhases / Interpolation;
+	const int32 RowIndex = FMath::Min(static_cast<int32>(Position), NumOfPhases - 1);
+	const float Alpha = static_cast<float>(Position - RowIndex);
+	const float* Row = FilterBank.GetData() + RowIndex * NumOfTaps;
+	const float* NextRow = Row + NumOfTaps;
+	for (int32 TapIndex = 0; TapIndex < NumOfTaps; ++TapIndex)
+	{
+		Result[TapIndex] = Row[TapIndex] + (NextRow[TapIndex] - Row[TapIndex]) * Alpha;
+	}
+	return Result;
+}
+
+bool FRuntimeResampler::ProcessAudio(const float* InData, int64 NumOfFrames, Audio::FAlignedFloatBuffer& OutData)
+{
+	if (!IsInitialized())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to resample audio data because the resampler is not initialized"));
+		return false;
+	}
+	if (NumOfFrames <= 0)
+	{
+		return true;
+	}
+
+	// Same sample rates, nothing to filter
+	if (Interpolation == Decimation)
+	{
+		OutData.Append(InData, NumOfFrames * NumOfChannels);
+		TotalInputFrames += NumOfFrames;
+		TotalOutputFrames += NumOfFrames;
+		return true;
+	}
+
+	WorkBuffer.Append(InData, NumOfFrames * NumOfChannels);
+	const int64 NumOfWorkFrames = WorkBuffer.Num() / NumOfChannels;
+	const float* WorkData = WorkBuffer.GetData();
+
+	const int64 NumOfOutputFramesEstimate = (NumOfFrames * Interpolation) / Decimation + 1;
+	OutData.Reserve(OutData.Num() + NumOfOutputFramesEstimate * NumOfChannels);
+
+	int64 NumOfProducedFrames = 0;
+	while (NextFrameIndex < NumOfWorkFrames)
+	{
+		const float* Taps = GetCoefficients(NextPhase);
+		const float* FirstFrame = WorkData + (NextFrameIndex - NumOfTaps + 1) * NumOfChannels;
+
+		if (NumOfChannels == 1)
+		{
+			float Sum = 0.f;
+			for (int32 TapIndex = 0; TapIndex < NumOfTaps; ++TapIndex)
+			{
+				Sum += Taps[TapIndex] * FirstFrame[TapIndex];
+			}
+			OutData.Add(Sum);
+		}
+		else
+		{
+			const int32 OutputIndex = OutData.AddZeroed(NumOfChannels);
+			float* OutputFrame = OutData.GetData() + OutputIndex;
+			for (int32 TapIndex = 0; TapIndex < NumOfTaps; ++TapIndex)
+			{
+				const float Tap = Taps[TapIndex];
+				const float* InputFrame = FirstFrame + TapIndex * NumOfChannels;
+				for (int32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+				{
+					OutputFrame[ChannelIndex] += Tap * InputFrame[ChannelIndex];
+				}
+			}
+		}
+		++NumOfProducedFrames;
+
+		NextPhase += Decimation;
+		NextFrameIndex += NextPhase / Interpolation;
+		NextPhase %= Interpolation;
+	}
+
+	// Keep only the history needed by the next output frames
+	const int32 NumOfHistoryFrames = NumOfTaps - 1;
+	const int64 KeepStartFrame = NumOfWorkFrames - NumOfHistoryFrames;
+	FMemory::Memmove(WorkBuffer.GetData(), WorkBuffer.GetData() + KeepStartFrame * NumOfChannels, NumOfHistoryFrames * NumOfChannels * sizeof(float));
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+	WorkBuffer.SetNum(NumOfHistoryFrames * NumOfChannels, false);
+#else
+	WorkBuffer.SetNum(NumOfHistoryFrames * NumOfChannels, EAllowShrinking::No);
+#endif
+	NextFrameIndex -= KeepStartFrame;
+
+	TotalInputFrames += NumOfFrames;
+	TotalOutputFrames += NumOfProducedFrames;
+	return true;
+}
+
+void FRuntimeResampler::Flush(Audio::FAlignedFloatBuffer& OutData)
+{
+	if (!IsInitialized() || Interpolation == Decimation)
+	{
+		Reset();
+		return;
+	}
+
+	const int64 NumOfRemainingFrames = GetNumOfOutputFrames(TotalInputFrames) - TotalOutputFrames;
+	if (NumOfRemainingFrames > 0)
+	{
+		// Push silence through the filter to release the held back frames, then drop whatever the silence itself produced
+		Audio::FAlignedFloatBuffer Silence;
+		Silence.SetNumZeroed(NumOfTaps * NumOfChannels);
+
+		Audio::FAlignedFloatBuffer Tail;
+		ProcessAudio(Silence.GetData(), NumOfTaps, Tail);
+		OutData.Append(Tail.GetData(), FMath::Min<int64>(NumOfRemainingFrames * NumOfChannels, Tail.Num()));
+	}
+
+	Reset();
+}
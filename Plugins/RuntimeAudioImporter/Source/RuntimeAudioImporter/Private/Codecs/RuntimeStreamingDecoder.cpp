@@ -0,0 +1,315 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Codecs/RuntimeStreamingDecoder.h"
+#include "Codecs/RuntimeCodecFactory.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "Misc/ScopeLock.h"
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#endif
+
+namespace
+{
+	/** Consumed data is released in batches of at least this size to avoid shifting the buffer on every decoded block */
+	constexpr int64 MinNumOfBytesToRelease = 256 * 1024;
+
+	/** If the header cannot be parsed after buffering this much data, the stream is considered invalid */
+	constexpr int64 MaxNumOfHeaderBytes = 4 * 1024 * 1024;
+}
+
+void FRuntimeAudioMemoryStreamSource::Append(FRuntimeAudioDataView AudioData)
+{
+	FScopeLock Lock(&DataGuard);
+	if (bComplete)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Appending %lld bytes to a stream source that has already been marked as complete"), static_cast<int64>(AudioData.Num()));
+	}
+	Buffer.Append(AudioData.GetData(), AudioData.Num());
+}
+
+void FRuntimeAudioMemoryStreamSource::MarkComplete()
+{
+	FScopeLock Lock(&DataGuard);
+	bComplete = true;
+}
+
+void FRuntimeAudioMemoryStreamSource::CopyBufferedData(TArray64<uint8>& OutAudioData) const
+{
+	FScopeLock Lock(&DataGuard);
+	OutAudioData = Buffer;
+}
+
+int64 FRuntimeAudioMemoryStreamSource::Read(uint8* Destination, int64 NumOfBytes)
+{
+	FScopeLock Lock(&DataGuard);
+	const int64 BufferOffset = ReadPosition - BufferStartPosition;
+	const int64 NumOfBytesToRead = FMath::Clamp<int64>(Buffer.Num() - BufferOffset, 0, NumOfBytes);
+	if (NumOfBytesToRead > 0)
+	{
+		FMemory::Memcpy(Destination, Buffer.GetData() + BufferOffset, NumOfBytesToRead);
+		ReadPosition += NumOfBytesToRead;
+	}
+	return NumOfBytesToRead;
+}
+
+bool FRuntimeAudioMemoryStreamSource::Seek(int64 Position)
+{
+	FScopeLock Lock(&DataGuard);
+	if (Position < BufferStartPosition || Position > BufferStartPosition + Buffer.Num())
+	{
+		return false;
+	}
+	ReadPosition = Position;
+	return true;
+}
+
+int64 FRuntimeAudioMemoryStreamSource::Tell() const
+{
+	FScopeLock Lock(&DataGuard);
+	return ReadPosition;
+}
+
+int64 FRuntimeAudioMemoryStreamSource::GetSize() const
+{
+	FScopeLock Lock(&DataGuard);
+	return bComplete ? BufferStartPosition + Buffer.Num() : -1;
+}
+
+int64 FRuntimeAudioMemoryStreamSource::GetNumOfAvailableBytes() const
+{
+	FScopeLock Lock(&DataGuard);
+	return BufferStartPosition + Buffer.Num() - ReadPosition;
+}
+
+bool FRuntimeAudioMemoryStreamSource::IsComplete() const
+{
+	FScopeLock Lock(&DataGuard);
+	return bComplete;
+}
+
+bool FRuntimeAudioMemoryStreamSource::IsSeekable() const
+{
+	FScopeLock Lock(&DataGuard);
+	// Only the whole stream can be revisited, which is the case as long as nothing has been released yet
+	return bComplete && BufferStartPosition == 0;
+}
+
+void FRuntimeAudioMemoryStreamSource::ReleaseConsumedData(int64 NumOfBytesToKeep)
+{
+	FScopeLock Lock(&DataGuard);
+	const int64 NumOfBytesToRelease = ReadPosition - FMath::Max<int64>(NumOfBytesToKeep, 0) - BufferStartPosition;
+	if (NumOfBytesToRelease < MinNumOfBytesToRelease)
+	{
+		return;
+	}
+
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+	Buffer.RemoveAt(0, NumOfBytesToRelease, false);
+#else
+	Buffer.RemoveAt(0, NumOfBytesToRelease, EAllowShrinking::No);
+#endif
+	BufferStartPosition += NumOfBytesToRelease;
+}
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+FRuntimeAudioFileStreamSource::FRuntimeAudioFileStreamSource(const FString& FilePath)
+{
+	RuntimeAudioImporter::CheckAndRequestPermissions();
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the audio file '%s' for streaming"), *FilePath);
+		return;
+	}
+	FileSize = FileHandle->Size();
+}
+
+FRuntimeAudioFileStreamSource::~FRuntimeAudioFileStreamSource() = default;
+
+bool FRuntimeAudioFileStreamSource::IsValid() const
+{
+	return FileHandle.IsValid();
+}
+
+int64 FRuntimeAudioFileStreamSource::Read(uint8* Destination, int64 NumOfBytes)
+{
+	FScopeLock Lock(&DataGuard);
+	if (!FileHandle.IsValid())
+	{
+		return 0;
+	}
+	const int64 NumOfBytesToRead = FMath::Clamp<int64>(FileSize - FileHandle->Tell(), 0, NumOfBytes);
+	if (NumOfBytesToRead <= 0 || !FileHandle->Read(Destination, NumOfBytesToRead))
+	{
+		return 0;
+	}
+	return NumOfBytesToRead;
+}
+
+bool FRuntimeAudioFileStreamSource::Seek(int64 Position)
+{
+	FScopeLock Lock(&DataGuard);
+	return FileHandle.IsValid() && Position >= 0 && Position <= FileSize && FileHandle->Seek(Position);
+}
+
+int64 FRuntimeAudioFileStreamSource::Tell() const
+{
+	FScopeLock Lock(&DataGuard);
+	return FileHandle.IsValid() ? FileHandle->Tell() : 0;
+}
+
+int64 FRuntimeAudioFileStreamSource::GetSize() const
+{
+	return FileSize;
+}
+
+int64 FRuntimeAudioFileStreamSource::GetNumOfAvailableBytes() const
+{
+	return FileSize - Tell();
+}
+#endif
+
+FRuntimeStreamingDecoder::FRuntimeStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> InSource)
+	: Source(MoveTemp(InSource))
+{
+}
+
+TUniquePtr<FRuntimeStreamingDecoder> FRuntimeStreamingDecoder::Create(ERuntimeAudioFormat AudioFormat, TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> InSource)
+{
+	FRuntimeCodecFactory CodecFactory;
+	for (FBaseRuntimeCodec* Codec : CodecFactory.GetCodecs(AudioFormat))
+	{
+		if (TUniquePtr<FRuntimeStreamingDecoder> Decoder = Codec->CreateStreamingDecoder(InSource))
+		{
+			return Decoder;
+		}
+	}
+
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("No streaming decoder is available for the %s format"), *UEnum::GetValueAsString(AudioFormat));
+	return nullptr;
+}
+
+ERuntimeStreamingDecodeResult FRuntimeStreamingDecoder::Open()
+{
+	if (bOpen)
+	{
+		return ERuntimeStreamingDecodeResult::Succeeded;
+	}
+
+	// The header is always parsed from the beginning of the stream, which is retained until the decoder is opened
+	if (!Source->Seek(0))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the streaming decoder since the beginning of the stream is no longer available"));
+		return ERuntimeStreamingDecodeResult::Failed;
+	}
+
+	if (!HasEnoughDataAhead())
+	{
+		return ERuntimeStreamingDecodeResult::NeedMoreData;
+	}
+
+	NumOfChannels = 0;
+	SampleRate = 0;
+	TotalNumOfFrames = -1;
+	FramePosition = 0;
+
+	if (!Open_Internal() || NumOfChannels == 0 || SampleRate == 0)
+	{
+		Close_Internal();
+		Source->Seek(0);
+
+		// The header may simply be incomplete, so waiting for more data unless there is no more to come or it is unreasonably large
+		if (!Source->IsComplete() && Source->GetNumOfAvailableBytes() < MaxNumOfHeaderBytes)
+		{
+			return ERuntimeStreamingDecodeResult::NeedMoreData;
+		}
+
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to parse the header of the audio stream"));
+		return ERuntimeStreamingDecodeResult::Failed;
+	}
+
+	bOpen = true;
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Opened streaming decoder (sample rate: %u, number of channels: %u, number of frames: %lld)"), SampleRate, NumOfChannels, TotalNumOfFrames);
+	return ERuntimeStreamingDecodeResult::Succeeded;
+}
+
+ERuntimeStreamingDecodeResult FRuntimeStreamingDecoder::DecodeFrames(float* OutPCMData, int64 MaxNumOfFrames, int64& OutNumOfFrames)
+{
+	OutNumOfFrames = 0;
+
+	if (!bOpen)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to decode frames since the streaming decoder is not open"));
+		return ERuntimeStreamingDecodeResult::Failed;
+	}
+
+	// Decoding in steps so that the amount of buffered data is checked before every read the underlying library may issue
+	while (OutNumOfFrames < MaxNumOfFrames && HasEnoughDataAhead())
+	{
+		const int64 NumOfFramesToDecode = FMath::Min<int64>(MaxNumOfFrames - OutNumOfFrames, GetMaxNumOfFramesPerStep());
+		const int64 NumOfDecodedFrames = DecodeFrames_Internal(OutPCMData + OutNumOfFrames * NumOfChannels, NumOfFramesToDecode);
+		if (NumOfDecodedFrames <= 0)
+		{
+			break;
+		}
+		OutNumOfFrames += NumOfDecodedFrames;
+	}
+
+	FramePosition += OutNumOfFrames;
+
+	// Keeping some of the consumed data, since the libraries may step back slightly when resynchronizing
+	Source->ReleaseConsumedData(GetMinNumOfBytesAhead());
+
+	if (OutNumOfFrames > 0)
+	{
+		return ERuntimeStreamingDecodeResult::Succeeded;
+	}
+	return Source->IsComplete() ? ERuntimeStreamingDecodeResult::EndOfStream : ERuntimeStreamingDecodeResult::NeedMoreData;
+}
+
+bool FRuntimeStreamingDecoder::Seek(int64 FrameIndex)
+{
+	if (!bOpen)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to seek since the streaming decoder is not open"));
+		return false;
+	}
+
+	if (!Source->IsSeekable())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to seek since the stream source is not seekable"));
+		return false;
+	}
+
+	FrameIndex = FMath::Max<int64>(FrameIndex, 0);
+	if (TotalNumOfFrames >= 0)
+	{
+		FrameIndex = FMath::Min<int64>(FrameIndex, TotalNumOfFrames);
+	}
+
+	if (!Seek_Internal(FrameIndex))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to seek the streaming decoder to frame %lld"), FrameIndex);
+		return false;
+	}
+
+	FramePosition = FrameIndex;
+	return true;
+}
+
+void FRuntimeStreamingDecoder::Close()
+{
+	if (bOpen)
+	{
+		Close_Internal();
+		bOpen = false;
+	}
+	FramePosition = 0;
+}
+
+bool FRuntimeStreamingDecoder::HasEnoughDataAhead() const
+{
+	return Source->IsComplete() || Source->GetNumOfAvailableBytes() >= GetMinNumOfBytesAhead();
+}
@@ -21,13 +21,13 @@
 #include "CodecIncludes.h"
 #undef INCLUDE_VORBIS
 
-bool FVORBIS_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+bool FVORBIS_RuntimeCodec::CheckAudioFormat(FRuntimeAudioDataView AudioData)
 {
 #if WITH_OGGVORBIS
 	FVorbisAudioInfo AudioInfo;
 	FSoundQualityInfo SoundQualityInfo;
 
-	if (!AudioInfo.ReadCompressedInfo(AudioData.GetView().GetData(), AudioData.GetView().Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
+	if (!AudioInfo.ReadCompressedInfo(AudioData.GetData(), AudioData.Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
 	{
 		return false;
 	}
@@ -39,7 +39,7 @@ bool FVORBIS_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>&
 #endif
 }
 
-bool FVORBIS_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
+bool FVORBIS_RuntimeCodec::GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Retrieving header information for VORBIS audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -50,7 +50,7 @@ bool FVORBIS_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRunti
 	FVorbisAudioInfo AudioInfo;
 	FSoundQualityInfo SoundQualityInfo;
 
-	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
+	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), &SoundQualityInfo) || SoundQualityInfo.SampleDataSize == 0)
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to read VORBIS compressed info"));
 		return false;
@@ -72,14 +72,14 @@ bool FVORBIS_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRunti
 #endif
 }
 
-bool FVORBIS_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
+bool FVORBIS_RuntimeCodec::Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Encoding uncompressed audio data to VORBIS audio format.\nDecoded audio info: %s.\nQuality: %d"), *DecodedData.ToString(), Quality);
 
 #if PLATFORM_SUPPORTS_VORBIS_CODEC
 	TArray<uint8> EncodedAudioData;
 
-	const uint32 NumOfFrames = DecodedData.PCMInfo.PCMNumOfFrames;
+	const uint32 NumOfFrames = DecodedData.PCMNumOfFrames;
 	const uint32 NumOfChannels = DecodedData.SoundWaveBasicInfo.NumOfChannels;
 	const uint32 SampleRate = DecodedData.SoundWaveBasicInfo.SampleRate;
 
@@ -159,7 +159,7 @@ bool FVORBIS_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudio
 				FramesToEncode = FramesSplitCount;
 			}
 
-			if (!DecodedData.PCMInfo.PCMData.GetView().GetData() || !AnalysisBuffer)
+			if (!DecodedData.PCMData.GetData() || !AnalysisBuffer)
 			{
 				CleanUpVORBIS();
 				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to create VORBIS analysis buffers"));
@@ -169,7 +169,7 @@ bool FVORBIS_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudio
 			// Deinterleave for the encoder
 			for (uint32 FrameIndex = 0; FrameIndex < FramesToEncode; ++FrameIndex)
 			{
-				const float* Frame = DecodedData.PCMInfo.PCMData.GetView().GetData() + (FrameIndex + FramesEncoded) * NumOfChannels;
+				const float* Frame = DecodedData.PCMData.GetData() + (FrameIndex + FramesEncoded) * NumOfChannels;
 
 				for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
 				{
@@ -242,7 +242,7 @@ bool FVORBIS_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudio
 #endif
 }
 
-bool FVORBIS_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData)
+bool FVORBIS_RuntimeCodec::Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Decoding VORBIS audio data to uncompressed audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -254,31 +254,34 @@ bool FVORBIS_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudio
 	FSoundQualityInfo SoundQualityInfo;
 
 	// Parse the audio header for the relevant information
-	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), &SoundQualityInfo))
+	if (!AudioInfo.ReadCompressedInfo(EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), &SoundQualityInfo))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to read VORBIS compressed info"));
 		return false;
 	}
 
-	TArray64<uint8> PCMData;
+	const int64 NumOfSamples = SoundQualityInfo.SampleDataSize / sizeof(int16);
 
-	// Decompress all the sample data
-	PCMData.Empty(SoundQualityInfo.SampleDataSize);
-	PCMData.AddZeroed(SoundQualityInfo.SampleDataSize);
-	AudioInfo.ExpandFile(PCMData.GetData(), &SoundQualityInfo);
-
-	// Getting the number of frames
-	DecodedData.PCMInfo.PCMNumOfFrames = PCMData.Num() / SoundQualityInfo.NumChannels / sizeof(int16);
-
-	const int64 NumOfSamples = PCMData.Num() / sizeof(int16);
+	// Allocating the final float buffer once, reusing the caller's buffer if there is one
+	if (!DecodedData.PCMInfo.PCMData.SetNumUninitialized(NumOfSamples))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate memory for VORBIS Decoder"));
+		return false;
+	}
 
-	// Transcoding int16 to float format
+	// Decompressing the 16-bit samples into the second half of the float buffer and widening them in place,
+	// so that the 16-bit and float PCM data never occupy separate allocations
 	{
-		float* TempFloatBuffer;
-		FRAW_RuntimeCodec::TranscodeRAWData<int16, float>(reinterpret_cast<int16*>(PCMData.GetData()), NumOfSamples, TempFloatBuffer);
-		DecodedData.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(TempFloatBuffer, NumOfSamples);
+		uint8* PCMBuffer = reinterpret_cast<uint8*>(DecodedData.PCMInfo.PCMData.GetView().GetData());
+		uint8* Int16PCMData = PCMBuffer + NumOfSamples * (sizeof(float) - sizeof(int16));
+		FMemory::Memzero(Int16PCMData, NumOfSamples * sizeof(int16));
+		AudioInfo.ExpandFile(Int16PCMData, &SoundQualityInfo);
+		FRAW_RuntimeCodec::TranscodeRAWDataInPlace<int16, float>(PCMBuffer, NumOfSamples);
 	}
 
+	// Getting the number of frames
+	DecodedData.PCMInfo.PCMNumOfFrames = NumOfSamples / SoundQualityInfo.NumChannels;
+
 	// Getting basic audio information
 	{
 		DecodedData.SoundWaveBasicInfo.Duration = SoundQualityInfo.Duration;
@@ -293,3 +296,159 @@ bool FVORBIS_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudio
 	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Your platform (%hs) does not support VORBIS decoding"), FPlatformProperties::IniPlatformName());
 #endif
 }
+
+#if WITH_OGGVORBIS
+namespace
+{
+	/**
+	 * Streaming VORBIS decoder pulling the encoded data through libvorbisfile callbacks
+	 */
+	class FVORBIS_StreamingDecoder : public FRuntimeStreamingDecoder
+	{
+	public:
+		using FRuntimeStreamingDecoder::FRuntimeStreamingDecoder;
+
+		virtual ~FVORBIS_StreamingDecoder() override
+		{
+			Close();
+		}
+
+	protected:
+		//~ Begin FRuntimeStreamingDecoder Interface
+		virtual bool Open_Internal() override
+		{
+			ov_callbacks Callbacks;
+			{
+				Callbacks.read_func = &OnRead;
+				Callbacks.seek_func = &OnSeek;
+				Callbacks.close_func = nullptr;
+				Callbacks.tell_func = &OnTell;
+			}
+
+			if (ov_open_callbacks(this, &VorbisFile, nullptr, 0, Callbacks) < 0)
+			{
+				return false;
+			}
+			bInitialized = true;
+
+			const vorbis_info* VorbisInfo = ov_info(&VorbisFile, -1);
+			if (!VorbisInfo)
+			{
+				return false;
+			}
+
+			NumOfChannels = VorbisInfo->channels;
+			SampleRate = VorbisInfo->rate;
+
+			// The total length is only known if the stream could be scanned up to its last page, which requires a seekable source
+			const ogg_int64_t PCMTotal = ov_pcm_total(&VorbisFile, -1);
+			TotalNumOfFrames = PCMTotal >= 0 ? static_cast<int64>(PCMTotal) : -1;
+			return true;
+		}
+
+		virtual int64 DecodeFrames_Internal(float* OutPCMData, int64 MaxNumOfFrames) override
+		{
+			int64 NumOfDecodedFrames = 0;
+			while (NumOfDecodedFrames < MaxNumOfFrames)
+			{
+				float** ChannelsPCMData = nullptr;
+				int BitstreamIndex = 0;
+				const long NumOfReadFrames = ov_read_float(&VorbisFile, &ChannelsPCMData, static_cast<int>(MaxNumOfFrames - NumOfDecodedFrames), &BitstreamIndex);
+
+				// A hole in the data is not fatal, the decoder resynchronizes on the next page
+				if (NumOfReadFrames == OV_HOLE)
+				{
+					continue;
+				}
+				if (NumOfReadFrames <= 0)
+				{
+					break;
+				}
+
+				// Interleaving the planar output of the decoder
+				for (long FrameIndex = 0; FrameIndex < NumOfReadFrames; ++FrameIndex)
+				{
+					float* Frame = OutPCMData + (NumOfDecodedFrames + FrameIndex) * NumOfChannels;
+					for (uint32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+					{
+						Frame[ChannelIndex] = ChannelsPCMData[ChannelIndex][FrameIndex];
+					}
+				}
+				NumOfDecodedFrames += NumOfReadFrames;
+			}
+			return NumOfDecodedFrames;
+		}
+
+		virtual bool Seek_Internal(int64 FrameIndex) override
+		{
+			return ov_pcm_seek(&VorbisFile, FrameIndex) == 0;
+		}
+
+		virtual void Close_Internal() override
+		{
+			if (bInitialized)
+			{
+				ov_clear(&VorbisFile);
+				bInitialized = false;
+			}
+		}
+
+		virtual int64 GetMinNumOfBytesAhead() const override
+		{
+			// libvorbisfile reads in chunks of 64 KB, and a single Ogg page may be almost as large
+			return 128 * 1024;
+		}
+		//~ End FRuntimeStreamingDecoder Interface
+
+	private:
+		static size_t OnRead(void* Destination, size_t Size, size_t NumOfItems, void* UserData)
+		{
+			if (Size == 0)
+			{
+				return 0;
+			}
+			return static_cast<size_t>(static_cast<FVORBIS_StreamingDecoder*>(UserData)->Source->Read(static_cast<uint8*>(Destination), Size * NumOfItems)) / Size;
+		}
+
+		static int OnSeek(void* UserData, ogg_int64_t Offset, int Origin)
+		{
+			FRuntimeAudioStreamSource& StreamSource = *static_cast<FVORBIS_StreamingDecoder*>(UserData)->Source;
+
+			// Reporting the source as unseekable makes libvorbisfile decode it sequentially, without scanning for the last page
+			if (!StreamSource.IsSeekable())
+			{
+				return -1;
+			}
+
+			int64 Position = Offset;
+			if (Origin == SEEK_CUR)
+			{
+				Position += StreamSource.Tell();
+			}
+			else if (Origin == SEEK_END)
+			{
+				Position += StreamSource.GetSize();
+			}
+			return StreamSource.Seek(Position) ? 0 : -1;
+		}
+
+		static long OnTell(void* UserData)
+		{
+			return static_cast<long>(static_cast<FVORBIS_StreamingDecoder*>(UserData)->Source->Tell());
+		}
+
+		OggVorbis_File VorbisFile;
+		bool bInitialized = false;
+	};
+}
+#endif
+
+TUniquePtr<FRuntimeStreamingDecoder> FVORBIS_RuntimeCodec::CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source)
+{
+#if WITH_OGGVORBIS
+	return MakeUnique<FVORBIS_StreamingDecoder>(MoveTemp(Source));
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Your platform (%hs) does not support VORBIS decoding"), FPlatformProperties::IniPlatformName());
+	return nullptr;
+#endif
+}
@@ -10,80 +10,11 @@
 #include "Codecs/RAW_RuntimeCodec.h"
 #undef INCLUDE_WAV
 
-namespace
-{
-	/**
-	 * Check and fix the WAV audio data with the correct byte size in the RIFF container
-	 * Made by https://github.com/kass-kass
-	 */
-	bool CheckAndFixWavDurationErrors(const FRuntimeBulkDataBuffer<uint8>& WavData)
-	{
-		drwav WAV;
-
-		// Initializing WAV codec
-		if (!drwav_init_memory(&WAV, WavData.GetView().GetData(), WavData.GetView().Num(), nullptr))
-		{
-			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize WAV Decoder"));
-			return false;
-		}
-
-		// Check if the container is RIFF (not Wave64 or any other containers)
-		if (WAV.container != drwav_container_riff)
-		{
-			drwav_uninit(&WAV);
-			return true;
-		}
-
-		// Get 4-byte field at byte 4, which is the overall file size as uint32, according to RIFF specification.
-		// If the field is set to nothing (hex FFFFFFFF), replace the incorrectly set field with the actual size.
-		// The field should be (size of file - 8 bytes), as the chunk identifier for the whole file (4 bytes spelling out RIFF at the start of the file), and the chunk length (4 bytes that we're replacing) are excluded.
-		if (BytesToHex(WavData.GetView().GetData() + 4, 4) == "FFFFFFFF")
-		{
-			const int32 ActualFileSize = WavData.GetView().Num() - 8;
-			FMemory::Memcpy(WavData.GetView().GetData() + 4, &ActualFileSize, 4);
-		}
-
-		// Search for the place in the file after the chunk id "data", which is where the data length is stored.
-		// First 36 bytes are skipped, as they're always "RIFF", 4 bytes filesize, "WAVE", "fmt ", and 20 bytes of format data.
-		uint32 DataSizeLocation = INDEX_NONE;
-		for (uint32 Index = 36; Index < static_cast<uint32>(WavData.GetView().Num()) - 4; ++Index)
-		{
-			// "64617461" - hex for string "data"
-			if (BytesToHex(WavData.GetView().GetData() + Index, 4) == "64617461")
-			{
-				DataSizeLocation = Index + 4;
-				break;
-			}
-		}
-
-		// Should never happen, but just in case
-		if (DataSizeLocation == INDEX_NONE)
-		{
-			drwav_uninit(&WAV);
-			return false;
-		}
-
-		// Same process as replacing full file size, except DataSize counts bytes from end of DataSize int to end of file.
-		if (BytesToHex(WavData.GetView().GetData() + DataSizeLocation, 4) == "FFFFFFFF")
-		{
-			// -4 to not include the DataSize int itself
-			const uint32 ActualDataSize = WavData.GetView().Num() - DataSizeLocation - 4;
-
-			FMemory::Memcpy(WavData.GetView().GetData() + DataSizeLocation, &ActualDataSize, 4);
-		}
-
-		drwav_uninit(&WAV);
-		return true;
-	}
-}
-
-bool FWAV_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+bool FWAV_RuntimeCodec::CheckAudioFormat(FRuntimeAudioDataView AudioData)
 {
 	drwav WAV;
 
-	CheckAndFixWavDurationErrors(AudioData);
-
-	if (!drwav_init_memory(&WAV, AudioData.GetView().GetData(), AudioData.GetView().Num(), nullptr))
+	if (!drwav_init_memory(&WAV, AudioData.GetData(), AudioData.Num(), nullptr))
 	{
 		return false;
 	}
@@ -92,7 +23,7 @@ bool FWAV_RuntimeCodec::CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& Au
 	return true;
 }
 
-bool FWAV_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
+bool FWAV_RuntimeCodec::GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Retrieving header information for WAV audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
@@ -100,7 +31,7 @@ bool FWAV_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeA
 	                 *UEnum::GetValueAsString(GetAudioFormat()), *UEnum::GetValueAsString(EncodedData.AudioFormat));
 
 	drwav WAV;
-	if (!drwav_init_memory(&WAV, EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), nullptr))
+	if (!drwav_init_memory(&WAV, EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), nullptr))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to initialize WAV Decoder"));
 		return false;
@@ -119,7 +50,7 @@ bool FWAV_RuntimeCodec::GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeA
 	return true;
 }
 
-bool FWAV_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
+bool FWAV_RuntimeCodec::Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Encoding uncompressed audio data to WAV audio format.\nDecoded audio info: %s."), *DecodedData.ToString());
 
@@ -144,9 +75,9 @@ bool FWAV_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStr
 	}
 
 	int16* TempInt16BBuffer;
-	FRAW_RuntimeCodec::TranscodeRAWData<float, int16>(DecodedData.PCMInfo.PCMData.GetView().GetData(), DecodedData.PCMInfo.PCMData.GetView().Num(), TempInt16BBuffer);
+	FRAW_RuntimeCodec::TranscodeRAWData<float, int16>(DecodedData.PCMData.GetData(), DecodedData.PCMData.Num(), TempInt16BBuffer);
 
-	drwav_write_pcm_frames(&WAV_Encoder, DecodedData.PCMInfo.PCMNumOfFrames, TempInt16BBuffer);
+	drwav_write_pcm_frames(&WAV_Encoder, DecodedData.PCMNumOfFrames, TempInt16BBuffer);
 	drwav_uninit(&WAV_Encoder);
 	FMemory::Free(TempInt16BBuffer);
 
@@ -160,31 +91,49 @@ bool FWAV_RuntimeCodec::Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStr
 	return true;
 }
 
-bool FWAV_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData)
+void FWAV_RuntimeCodec::WriteHeader(FArchive& Writer, uint16 NumOfChannels, uint32 SampleRate, uint32 DataSize)
+{
+	auto WriteTag = [&Writer](const ANSICHAR* Tag)
+	{
+		Writer.Serialize(const_cast<ANSICHAR*>(Tag), 4);
+	};
+
+	uint32 RIFFSize = HeaderSize - 8 + DataSize;
+	uint32 FormatChunkSize = 16;
+	uint16 FormatTag = 1;
+	uint16 BitsPerSample = 16;
+	uint16 BlockAlign = NumOfChannels * BitsPerSample / 8;
+	uint32 ByteRate = SampleRate * BlockAlign;
+
+	WriteTag("RIFF");
+	Writer << RIFFSize;
+	WriteTag("WAVE");
+	WriteTag("fmt ");
+	Writer << FormatChunkSize << FormatTag << NumOfChannels << SampleRate << ByteRate << BlockAlign << BitsPerSample;
+	WriteTag("data");
+	Writer << DataSize;
+}
+
+bool FWAV_RuntimeCodec::Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData)
 {
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Decoding WAV audio data to uncompressed audio format.\nEncoded audio info: %s"), *EncodedData.ToString());
 
 	ensureAlwaysMsgf(EncodedData.AudioFormat == GetAudioFormat(), TEXT("Attempting to decode audio data using the '%s' codec, but the data format is encoded in '%s'"),
 	                 *UEnum::GetValueAsString(GetAudioFormat()), *UEnum::GetValueAsString(EncodedData.AudioFormat));
 
-	if (!CheckAndFixWavDurationErrors(EncodedData.AudioData))
-	{
-		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong while fixing WAV audio data duration error"));
-		return false;
-	}
-
+	// RIFF and data chunk sizes left at 0xFFFFFFFF by streaming writers are resolved by dr_wav itself from the actual data size,
+	// so the borrowed data never needs to be patched
 	drwav WAV_Decoder;
 
 	// Initializing WAV codec
-	if (!drwav_init_memory(&WAV_Decoder, EncodedData.AudioData.GetView().GetData(), EncodedData.AudioData.GetView().Num(), nullptr))
+	if (!drwav_init_memory(&WAV_Decoder, EncodedData.AudioData.GetData(), EncodedData.AudioData.Num(), nullptr))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize WAV Decoder"));
 		return false;
 	}
 
-	// Allocating memory for PCM data
-	float* TempPCMData = static_cast<float*>(FMemory::Malloc(WAV_Decoder.totalPCMFrameCount * WAV_Decoder.channels * sizeof(float)));
-	if (!TempPCMData)
+	// Allocating memory for PCM data, reusing the caller's buffer if there is one
+	if (!DecodedData.PCMInfo.PCMData.SetNumUninitialized(static_cast<int64>(WAV_Decoder.totalPCMFrameCount * WAV_Decoder.channels)))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate memory for WAV Decoder"));
 		drwav_uninit(&WAV_Decoder);
@@ -192,12 +141,10 @@ bool FWAV_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 	}
 
 	// Filling PCM data and getting the number of frames
-	DecodedData.PCMInfo.PCMNumOfFrames = drwav_read_pcm_frames_f32(&WAV_Decoder, WAV_Decoder.totalPCMFrameCount, TempPCMData);
-
-	// Getting PCM data size
-	const int64 TempPCMDataSize = static_cast<int64>(DecodedData.PCMInfo.PCMNumOfFrames * WAV_Decoder.channels);
+	DecodedData.PCMInfo.PCMNumOfFrames = drwav_read_pcm_frames_f32(&WAV_Decoder, WAV_Decoder.totalPCMFrameCount, DecodedData.PCMInfo.PCMData.GetView().GetData());
 
-	DecodedData.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(TempPCMData, TempPCMDataSize);
+	// Trimming the PCM data in case fewer frames were decoded than declared in the header
+	DecodedData.PCMInfo.PCMData.SetNumUninitialized(static_cast<int64>(DecodedData.PCMInfo.PCMNumOfFrames * WAV_Decoder.channels));
 
 	// Getting basic audio information
 	{
@@ -211,3 +158,90 @@ bool FWAV_RuntimeCodec::Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStr
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully decoded WAV audio data to uncompressed audio format.\nDecoded audio info: %s"), *DecodedData.ToString());
 	return true;
 }
+
+namespace
+{
+	/**
+	 * Streaming WAV decoder pulling the encoded data through dr_wav callbacks
+	 */
+	class FWAV_StreamingDecoder : public FRuntimeStreamingDecoder
+	{
+	public:
+		using FRuntimeStreamingDecoder::FRuntimeStreamingDecoder;
+
+		virtual ~FWAV_StreamingDecoder() override
+		{
+			Close();
+		}
+
+	protected:
+		//~ Begin FRuntimeStreamingDecoder Interface
+		virtual bool Open_Internal() override
+		{
+			if (!drwav_init(&WAV, &OnRead, &OnSeek, this, nullptr))
+			{
+				return false;
+			}
+			bInitialized = true;
+
+			NumOfChannels = WAV.channels;
+			SampleRate = WAV.sampleRate;
+			TotalNumOfFrames = WAV.totalPCMFrameCount > 0 ? static_cast<int64>(WAV.totalPCMFrameCount) : -1;
+			return true;
+		}
+
+		virtual int64 DecodeFrames_Internal(float* OutPCMData, int64 MaxNumOfFrames) override
+		{
+			return static_cast<int64>(drwav_read_pcm_frames_f32(&WAV, MaxNumOfFrames, OutPCMData));
+		}
+
+		virtual bool Seek_Internal(int64 FrameIndex) override
+		{
+			return drwav_seek_to_pcm_frame(&WAV, FrameIndex) == DRWAV_TRUE;
+		}
+
+		virtual void Close_Internal() override
+		{
+			if (bInitialized)
+			{
+				drwav_uninit(&WAV);
+				bInitialized = false;
+			}
+		}
+
+		virtual int64 GetMinNumOfBytesAhead() const override
+		{
+			// Before the header is parsed, leave room for the optional chunks that may precede the audio data
+			if (!bInitialized)
+			{
+				return 64 * 1024;
+			}
+
+			// One step worth of samples, plus a whole block for compressed formats such as ADPCM
+			const int64 NumOfBytesPerFrame = FMath::Max<int64>(static_cast<int64>(WAV.bitsPerSample) * WAV.channels / 8, 1);
+			return GetMaxNumOfFramesPerStep() * NumOfBytesPerFrame + WAV.fmt.blockAlign;
+		}
+		//~ End FRuntimeStreamingDecoder Interface
+
+	private:
+		static size_t OnRead(void* UserData, void* BufferOut, size_t BytesToRead)
+		{
+			return static_cast<size_t>(static_cast<FWAV_StreamingDecoder*>(UserData)->Source->Read(static_cast<uint8*>(BufferOut), BytesToRead));
+		}
+
+		static drwav_bool32 OnSeek(void* UserData, int Offset, drwav_seek_origin Origin)
+		{
+			FRuntimeAudioStreamSource& StreamSource = *static_cast<FWAV_StreamingDecoder*>(UserData)->Source;
+			const int64 Position = Origin == drwav_seek_origin_current ? StreamSource.Tell() + Offset : Offset;
+			return StreamSource.Seek(Position) ? DRWAV_TRUE : DRWAV_FALSE;
+		}
+
+		drwav WAV;
+		bool bInitialized = false;
+	};
+}
+
+TUniquePtr<FRuntimeStreamingDecoder> FWAV_RuntimeCodec::CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source)
+{
+	return MakeUnique<FWAV_StreamingDecoder>(MoveTemp(Source));
+}
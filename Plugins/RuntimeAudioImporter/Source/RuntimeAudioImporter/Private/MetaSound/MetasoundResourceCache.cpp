@@ -0,0 +1,155 @@
+﻿// Georgy Treshchev 2024.
+
+#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
+#include "MetaSound/MetasoundResourceCache.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+namespace
+{
+	/** Version of the cached resources, to be incremented whenever the encoding of the resources changes */
+	constexpr uint32 MetasoundResourceCacheVersion = 1;
+
+	int32 MetasoundResourceMemoryBudgetMB = 64;
+	FAutoConsoleVariableRef CVarMetasoundResourceMemoryBudget(
+		TEXT("RuntimeAudioImporter.MetaSounds.ResourceCacheMemoryMB"),
+		MetasoundResourceMemoryBudgetMB,
+		TEXT("Size in MB of the prepared MetaSounds resources kept in memory. The resources are also cached on disk regardless of this budget"));
+
+	FAutoConsoleCommand ClearMetasoundResourceCacheCommand(
+		TEXT("RuntimeAudioImporter.MetaSounds.ClearResourceCache"),
+		TEXT("Removes the prepared MetaSounds resources from memory and from disk"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			RuntimeAudioImporter::FMetasoundResourceCache::Get().Clear(true);
+		}));
+}
+
+namespace RuntimeAudioImporter
+{
+	FMetasoundResourceCache& FMetasoundResourceCache::Get()
+	{
+		static FMetasoundResourceCache Cache;
+		return Cache;
+	}
+
+	FString FMetasoundResourceCache::ComputeContentHash(const FPCMStruct& PCMInfo, uint32 NumOfChannels, uint32 SampleRate, FName Format)
+	{
+		FMD5 MD5;
+
+		const FString FormatString = Format.ToString();
+		uint32 Header[4] = {MetasoundResourceCacheVersion, NumOfChannels, SampleRate, PCMInfo.PCMNumOfFrames};
+		MD5.Update(reinterpret_cast<const uint8*>(Header), sizeof(Header));
+		MD5.Update(reinterpret_cast<const uint8*>(*FormatString), FormatString.Len() * sizeof(TCHAR));
+
+		// Updating in chunks, since the size of a single update is limited to 32 bits
+		const uint8* PCMData = reinterpret_cast<const uint8*>(PCMInfo.PCMData.GetView().GetData());
+		const int64 PCMDataSize = PCMInfo.PCMData.GetView().Num() * sizeof(float);
+		constexpr int64 ChunkSize = 1 << 30;
+		for (int64 Offset = 0; Offset < PCMDataSize; Offset += ChunkSize)
+		{
+			MD5.Update(PCMData + Offset, static_cast<uint64>(FMath::Min(ChunkSize, PCMDataSize - Offset)));
+		}
+
+		FMD5Hash Hash;
+		Hash.Set(MD5);
+		return LexToString(Hash);
+	}
+
+	bool FMetasoundResourceCache::Find(const FString& ContentHash, TArray64<uint8>& OutResourceData)
+	{
+		{
+			FScopeLock Lock(&CacheGuard);
+			if (const TSharedRef<const TArray64<uint8>>* ResourceData = MemoryResources.Find(ContentHash))
+			{
+				OutResourceData = **ResourceData;
+				MemoryResourceOrder.Remove(ContentHash);
+				MemoryResourceOrder.Add(ContentHash);
+				return true;
+			}
+		}
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+		const FString FilePath = GetCacheFilePath(ContentHash);
+		if (FPaths::FileExists(FilePath) && RuntimeAudioImporter::LoadAudioFileToArray(OutResourceData, FilePath) && OutResourceData.Num() > 0)
+		{
+			FScopeLock Lock(&CacheGuard);
+			AddToMemory_Internal(ContentHash, MakeShared<TArray64<uint8>>(OutResourceData));
+			return true;
+		}
+#endif
+		return false;
+	}
+
+	void FMetasoundResourceCache::Add(const FString& ContentHash, const TArray64<uint8>& ResourceData)
+	{
+		{
+			FScopeLock Lock(&CacheGuard);
+			AddToMemory_Internal(ContentHash, MakeShared<TArray64<uint8>>(ResourceData));
+		}
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+		// Writing to a temporary file first, so that an interrupted write does not leave a truncated resource behind
+		const FString FilePath = GetCacheFilePath(ContentHash);
+		const FString TempFilePath = FilePath + TEXT(".part");
+		if (!RuntimeAudioImporter::SaveAudioFileFromArray(ResourceData, TempFilePath) || !IFileManager::Get().Move(*FilePath, *TempFilePath, true))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Unable to store the MetaSounds resource to the cache path '%s'"), *FilePath);
+			IFileManager::Get().Delete(*TempFilePath);
+		}
+#endif
+	}
+
+	void FMetasoundResourceCache::Clear(bool bDeleteFiles)
+	{
+		{
+			FScopeLock Lock(&CacheGuard);
+			MemoryResources.Empty();
+			MemoryResourceOrder.Empty();
+			MemorySize = 0;
+		}
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+		if (bDeleteFiles)
+		{
+			IFileManager::Get().DeleteDirectory(*FPaths::GetPath(GetCacheFilePath(FString())), false, true);
+		}
+#endif
+		UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Cleared the MetaSounds resource cache%s"), bDeleteFiles ? TEXT(" including the files on disk") : TEXT(""));
+	}
+
+	FString FMetasoundResourceCache::GetCacheFilePath(const FString& ContentHash) const
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RuntimeAudioImporter"), TEXT("MetaSoundsCache"), ContentHash + TEXT(".bin"));
+	}
+
+	void FMetasoundResourceCache::AddToMemory_Internal(const FString& ContentHash, TSharedRef<const TArray64<uint8>> ResourceData)
+	{
+		const int64 MemoryBudget = static_cast<int64>(FMath::Max(MetasoundResourceMemoryBudgetMB, 0)) * 1024 * 1024;
+		if (ResourceData->Num() > MemoryBudget)
+		{
+			return;
+		}
+
+		if (const TSharedRef<const TArray64<uint8>>* ExistingResourceData = MemoryResources.Find(ContentHash))
+		{
+			MemorySize -= (*ExistingResourceData)->Num();
+			MemoryResourceOrder.Remove(ContentHash);
+		}
+
+		MemorySize += ResourceData->Num();
+		MemoryResources.Add(ContentHash, MoveTemp(ResourceData));
+		MemoryResourceOrder.Add(ContentHash);
+
+		while (MemorySize > MemoryBudget && MemoryResourceOrder.Num() > 0)
+		{
+			const FString EvictedContentHash = MemoryResourceOrder[0];
+			MemoryResourceOrder.RemoveAt(0);
+			MemorySize -= MemoryResources.FindAndRemoveChecked(EvictedContentHash)->Num();
+		}
+	}
+}
+#endif
@@ -1,12 +1,205 @@
 // Georgy Treshchev 2024.
 
 #include "PreImportedSoundAsset.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "Codecs/RAW_RuntimeCodec.h"
+#include "Serialization/CustomVersion.h"
+#if WITH_EDITOR
+#include "RuntimeAudioImporterLibrary.h"
+#endif
+
+namespace
+{
+	/** Versions of the pre-imported sound asset serialization */
+	struct FPreImportedSoundAssetVersion
+	{
+		enum Type
+		{
+			InitialVersion = 0,
+
+			// Audio data decoded at cook time
+			CookedAudioData,
+
+			VersionPlusOne,
+			LatestVersion = VersionPlusOne - 1
+		};
 
+		static const FGuid GUID;
+	};
+
+	const FGuid FPreImportedSoundAssetVersion::GUID(0x6A1D6E2B, 0x3F0C4B7A, 0x9E215C84, 0xB7D03F19);
+	FCustomVersionRegistration GRegisterPreImportedSoundAssetVersion(FPreImportedSoundAssetVersion::GUID, FPreImportedSoundAssetVersion::LatestVersion, TEXT("PreImportedSoundAssetVer"));
+
+	int64 GetCookedSampleSize(EPreImportedSoundCookedFormat Format)
+	{
+		switch (Format)
+		{
+		case EPreImportedSoundCookedFormat::PCM16:
+			return sizeof(int16);
+		case EPreImportedSoundCookedFormat::Float32:
+			return sizeof(float);
+		default:
+			return 0;
+		}
+	}
+}
 
 UPreImportedSoundAsset::UPreImportedSoundAsset()
 	: AudioFormat(ERuntimeAudioFormat::Mp3)
+	  , CookedFormat(EPreImportedSoundCookedFormat::Original)
 #if WITH_EDITORONLY_DATA
 	  , NumberOfChannels(0), SampleRate(0)
 #endif
+	  , CookedDataFormat(EPreImportedSoundCookedFormat::Original)
+	  , CookedNumOfChannels(0), CookedSampleRate(0)
+{
+}
+
+void UPreImportedSoundAsset::Serialize(FArchive& Ar)
 {
+#if WITH_EDITOR
+	// Cooked packages contain either the encoded or the decoded audio data, never both
+	TArray<uint8> EncodedAudioData;
+	bool bCookDecodedData = false;
+	if (Ar.IsSaving())
+	{
+		FScopeLock Lock(&CookedAudioDataGuard);
+		if (Ar.IsCooking() && CookedFormat != EPreImportedSoundCookedFormat::Original)
+		{
+			bCookDecodedData = CacheCookedAudioData();
+			if (bCookDecodedData)
+			{
+				EncodedAudioData = MoveTemp(AudioDataArray);
+			}
+			else
+			{
+				UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Unable to decode the audio data of the pre-imported sound asset '%s' for cooking, the original encoded data will be cooked instead"), *GetPathName());
+			}
+		}
+
+		// The cooked audio data is derived from the encoded data and is only stored in cooked packages
+		if (!bCookDecodedData)
+		{
+			CookedAudioData.RemoveBulkData();
+			CookedDataFormat = EPreImportedSoundCookedFormat::Original;
+			CookedNumOfChannels = 0;
+			CookedSampleRate = 0;
+		}
+	}
+#endif
+
+	Super::Serialize(Ar);
+
+#if WITH_EDITOR
+	if (bCookDecodedData)
+	{
+		AudioDataArray = MoveTemp(EncodedAudioData);
+	}
+#endif
+
+	Ar.UsingCustomVersion(FPreImportedSoundAssetVersion::GUID);
+	if (Ar.CustomVer(FPreImportedSoundAssetVersion::GUID) < FPreImportedSoundAssetVersion::CookedAudioData)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&CookedAudioDataGuard);
+	Ar << CookedDataFormat;
+	Ar << CookedNumOfChannels;
+	Ar << CookedSampleRate;
+
+	// Stored separately from the export data, so that the payload can be memory-mapped from the package instead of being read into memory on load
+	CookedAudioData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload | BULKDATA_MemoryMappedPayload);
+	CookedAudioData.Serialize(Ar, this);
 }
+
+bool UPreImportedSoundAsset::HasCookedAudioData() const
+{
+	FScopeLock Lock(&CookedAudioDataGuard);
+	return CookedDataFormat != EPreImportedSoundCookedFormat::Original && CookedAudioData.GetBulkDataSize() > 0;
+}
+
+bool UPreImportedSoundAsset::GetCookedAudioData(FDecodedAudioStruct& DecodedAudioInfo) const
+{
+	FScopeLock Lock(&CookedAudioDataGuard);
+
+	const int64 SampleSize = GetCookedSampleSize(CookedDataFormat);
+	const int64 NumOfSamples = SampleSize > 0 ? CookedAudioData.GetBulkDataSize() / SampleSize : 0;
+	if (NumOfSamples <= 0 || CookedNumOfChannels <= 0 || CookedSampleRate <= 0)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("The pre-imported sound asset '%s' does not contain valid cooked audio data"), *GetPathName());
+		return false;
+	}
+
+	float* PCMData = nullptr;
+	if (CookedDataFormat == EPreImportedSoundCookedFormat::Float32)
+	{
+		// Read straight into the buffer the sound wave takes over, either from the mapped region or from the package
+		CookedAudioData.GetCopy(reinterpret_cast<void**>(&PCMData), false);
+	}
+	else
+	{
+		const int16* RAWData = static_cast<const int16*>(CookedAudioData.LockReadOnly());
+		if (RAWData)
+		{
+			FRAW_RuntimeCodec::TranscodeRAWData<int16, float>(RAWData, NumOfSamples, PCMData);
+		}
+		CookedAudioData.Unlock();
+
+		// Only keep the payload resident if it is mapped rather than loaded
+		if (!CookedAudioData.IsDataMemoryMapped())
+		{
+			CookedAudioData.UnloadBulkData();
+		}
+	}
+
+	if (!PCMData)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to read the cooked audio data of the pre-imported sound asset '%s'"), *GetPathName());
+		return false;
+	}
+
+	DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(PCMData, NumOfSamples);
+	DecodedAudioInfo.PCMInfo.PCMNumOfFrames = NumOfSamples / CookedNumOfChannels;
+	DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels = CookedNumOfChannels;
+	DecodedAudioInfo.SoundWaveBasicInfo.SampleRate = CookedSampleRate;
+	DecodedAudioInfo.SoundWaveBasicInfo.Duration = static_cast<float>(DecodedAudioInfo.PCMInfo.PCMNumOfFrames) / CookedSampleRate;
+	DecodedAudioInfo.SoundWaveBasicInfo.AudioFormat = AudioFormat;
+
+	return true;
+}
+
+#if WITH_EDITOR
+bool UPreImportedSoundAsset::CacheCookedAudioData()
+{
+	FDecodedAudioStruct DecodedAudioInfo;
+	if (!URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(AudioDataArray, AudioFormat), DecodedAudioInfo) || !DecodedAudioInfo.IsValid())
+	{
+		return false;
+	}
+
+	const float* PCMData = DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData();
+	const int64 NumOfSamples = DecodedAudioInfo.PCMInfo.PCMData.GetView().Num();
+	const int64 SampleSize = GetCookedSampleSize(CookedFormat);
+
+	CookedAudioData.Lock(LOCK_READ_WRITE);
+	void* CookedData = CookedAudioData.Realloc(NumOfSamples * SampleSize);
+	if (CookedFormat == EPreImportedSoundCookedFormat::Float32)
+	{
+		FMemory::Memcpy(CookedData, PCMData, NumOfSamples * SampleSize);
+	}
+	else
+	{
+		FRAW_RuntimeCodec::TranscodeRAWDataToBuffer<float, int16>(PCMData, NumOfSamples, static_cast<int16*>(CookedData));
+	}
+	CookedAudioData.Unlock();
+
+	CookedDataFormat = CookedFormat;
+	CookedNumOfChannels = DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels;
+	CookedSampleRate = DecodedAudioInfo.SoundWaveBasicInfo.SampleRate;
+
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Cooked the pre-imported sound asset '%s' to %s (%lld bytes, %lld bytes encoded)"),
+		*GetPathName(), *UEnum::GetValueAsString(CookedFormat), NumOfSamples * SampleSize, static_cast<int64>(AudioDataArray.Num()));
+	return true;
+}
+#endif
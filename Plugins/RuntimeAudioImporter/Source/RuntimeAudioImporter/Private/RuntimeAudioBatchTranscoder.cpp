@@ -0,0 +1,435 @@
+﻿// Georgy Treshchev 2024.
+
+#include "RuntimeAudioBatchTranscoder.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "RuntimeAudioTranscoder.h"
+#include "RuntimeAudioUtilities.h"
+#include "Codecs/BaseRuntimeCodec.h"
+#include "Codecs/RuntimeCodecFactory.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	/**
+	 * Get the file extension used for the audio format
+	 */
+	FString GetAudioFormatExtension(ERuntimeAudioFormat AudioFormat)
+	{
+		switch (AudioFormat)
+		{
+		case ERuntimeAudioFormat::Mp3:
+			return TEXT("mp3");
+		case ERuntimeAudioFormat::Wav:
+			return TEXT("wav");
+		case ERuntimeAudioFormat::Flac:
+			return TEXT("flac");
+		case ERuntimeAudioFormat::OggVorbis:
+			return TEXT("ogg");
+		case ERuntimeAudioFormat::Bink:
+			return TEXT("bik");
+		default:
+			return FString();
+		}
+	}
+}
+
+URuntimeAudioBatchTranscoder* URuntimeAudioBatchTranscoder::CreateRuntimeAudioBatchTranscoder(int32 MaxNumOfWorkers)
+{
+	URuntimeAudioBatchTranscoder* BatchTranscoder = NewObject<URuntimeAudioBatchTranscoder>();
+	BatchTranscoder->MaxNumOfWorkers = MaxNumOfWorkers > 0 ? MaxNumOfWorkers : FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+	BatchTranscoder->NextPendingJobIndex = 0;
+	BatchTranscoder->NumOfActiveWorkers = 0;
+	BatchTranscoder->bRunning = false;
+	BatchTranscoder->NumOfFinishedJobs = 0;
+	BatchTranscoder->NumOfRunJobs = 0;
+	BatchTranscoder->RunStartTime = 0;
+	return BatchTranscoder;
+}
+
+int32 URuntimeAudioBatchTranscoder::EnqueueJob(const FRuntimeAudioTranscodeJob& Job)
+{
+	FScopeLock Lock(&JobsGuard);
+	const int32 JobId = Jobs.Add(FJobState{Job});
+	if (bRunning)
+	{
+		++NumOfRunJobs;
+		SpawnWorkers_Internal();
+	}
+	return JobId;
+}
+
+TArray<int32> URuntimeAudioBatchTranscoder::EnqueueDirectory(const FString& DirectoryFrom, bool bRecursive, const FString& DirectoryTo, ERuntimeAudioFormat EncodedFormatTo, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions)
+{
+	TArray<int32> JobIds;
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	const FString ExtensionTo = GetAudioFormatExtension(EncodedFormatTo);
+	if (ExtensionTo.IsEmpty())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to enqueue directory '%s' for transcoding because the format '%s' has no file extension"), *DirectoryFrom, *UEnum::GetValueAsString(EncodedFormatTo));
+		return JobIds;
+	}
+
+	class FDirectoryVisitor_AudioScanner : public IPlatformFile::FDirectoryVisitor
+	{
+	public:
+		TArray<FBaseRuntimeCodec*> Codecs;
+		TArray<FString> AudioFilePaths;
+
+		virtual bool Visit(const TCHAR* FilenameOrDirectory, bool bIsDirectory) override
+		{
+			if (bIsDirectory)
+			{
+				return true;
+			}
+
+			// Checked without logging, since most files in a directory may not be audio
+			const FString Extension = FPaths::GetExtension(FilenameOrDirectory, false);
+			for (const FBaseRuntimeCodec* Codec : Codecs)
+			{
+				if (Codec->IsExtensionSupported(Extension))
+				{
+					AudioFilePaths.Add(FilenameOrDirectory);
+					break;
+				}
+			}
+			return true;
+		}
+	};
+
+	FDirectoryVisitor_AudioScanner DirectoryVisitor;
+	{
+		FRuntimeCodecFactory CodecFactory;
+		DirectoryVisitor.Codecs = CodecFactory.GetCodecs();
+	}
+
+	RuntimeAudioImporter::CheckAndRequestPermissions();
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const bool bIterated = bRecursive
+		                       ? PlatformFile.IterateDirectoryRecursively(*DirectoryFrom, DirectoryVisitor)
+		                       : PlatformFile.IterateDirectory(*DirectoryFrom, DirectoryVisitor);
+	if (!bIterated)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to iterate the directory '%s' for transcoding"), *DirectoryFrom);
+		return JobIds;
+	}
+
+	FString NormalizedDirectoryFrom = DirectoryFrom;
+	FPaths::NormalizeDirectoryName(NormalizedDirectoryFrom);
+
+	for (FString& AudioFilePath : DirectoryVisitor.AudioFilePaths)
+	{
+		FPaths::NormalizeFilename(AudioFilePath);
+		FString RelativeFilePath = AudioFilePath;
+		FPaths::MakePathRelativeTo(RelativeFilePath, *(NormalizedDirectoryFrom / TEXT("")));
+
+		FRuntimeAudioTranscodeJob Job;
+		Job.FilePathFrom = AudioFilePath;
+		Job.FilePathTo = FPaths::ChangeExtension(FPaths::Combine(DirectoryTo, RelativeFilePath), ExtensionTo);
+		Job.EncodedFormatTo = EncodedFormatTo;
+		Job.Quality = Quality;
+		Job.OverrideOptions = OverrideOptions;
+		JobIds.Add(EnqueueJob(Job));
+	}
+
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Enqueued %d audio files from the directory '%s' for transcoding to '%s'"), JobIds.Num(), *DirectoryFrom, *DirectoryTo);
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to enqueue directory '%s' for transcoding because the file operation support is disabled"), *DirectoryFrom);
+#endif
+
+	return JobIds;
+}
+
+bool URuntimeAudioBatchTranscoder::Run(const FOnBatchTranscodeProgress& Progress, const FOnBatchTranscodeResult& Result)
+{
+	return Run(FOnBatchTranscodeProgressNative::CreateLambda([Progress](int32 JobId, ERuntimeAudioTranscodeJobStatus Status, int32 NumOfFinished, int32 NumOfJobs)
+	{
+		Progress.ExecuteIfBound(JobId, Status, NumOfFinished, NumOfJobs);
+	}), FOnBatchTranscodeResultNative::CreateLambda([Result](const FRuntimeAudioBatchTranscodeReport& BatchReport)
+	{
+		Result.ExecuteIfBound(BatchReport);
+	}));
+}
+
+bool URuntimeAudioBatchTranscoder::Run(const FOnBatchTranscodeProgressNative& Progress, const FOnBatchTranscodeResultNative& Result)
+{
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	FScopeLock Lock(&JobsGuard);
+	if (bRunning)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Unable to run the batch transcoding because it is already running"));
+		return false;
+	}
+
+	bRunning = true;
+	ProgressDelegate = Progress;
+	ResultDelegate = Result;
+	Report = FRuntimeAudioBatchTranscodeReport();
+	RunStartTime = FPlatformTime::Seconds();
+	NumOfFinishedJobs = 0;
+	NumOfRunJobs = 0;
+	for (int32 JobIndex = NextPendingJobIndex; JobIndex < Jobs.Num(); ++JobIndex)
+	{
+		NumOfRunJobs += Jobs[JobIndex].Status == ERuntimeAudioTranscodeJobStatus::Pending ? 1 : 0;
+	}
+
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Starting batch transcoding of %d jobs on up to %d workers"), NumOfRunJobs, MaxNumOfWorkers);
+
+	// The last worker to run out of jobs finishes the run, so an empty batch has to be finished here
+	SpawnWorkers_Internal();
+	if (NumOfActiveWorkers > 0)
+	{
+		// The caller may drop its last reference while the workers are running, so the transcoder is rooted until the last worker finishes
+		AddToRoot();
+	}
+	else
+	{
+		bRunning = false;
+		AsyncTask(ENamedThreads::GameThread, [Result, BatchReport = Report]()
+		{
+			Result.ExecuteIfBound(BatchReport);
+		});
+	}
+	return true;
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to run the batch transcoding because the file operation support is disabled"));
+	return false;
+#endif
+}
+
+void URuntimeAudioBatchTranscoder::SpawnWorkers_Internal()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	int32 NumOfPendingJobs = 0;
+	for (int32 JobIndex = NextPendingJobIndex; JobIndex < Jobs.Num() && NumOfActiveWorkers + NumOfPendingJobs < MaxNumOfWorkers; ++JobIndex)
+	{
+		NumOfPendingJobs += Jobs[JobIndex].Status == ERuntimeAudioTranscodeJobStatus::Pending ? 1 : 0;
+	}
+
+	for (; NumOfPendingJobs > 0; --NumOfPendingJobs)
+	{
+		++NumOfActiveWorkers;
+		// Every spawned worker has to run, since it is counted in NumOfActiveWorkers until it runs out of jobs
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this]()
+		{
+			RunWorker();
+		});
+	}
+}
+
+void URuntimeAudioBatchTranscoder::RunWorker()
+{
+	while (true)
+	{
+		int32 JobId = INDEX_NONE;
+		FRuntimeAudioTranscodeJob Job;
+		{
+			FScopeLock Lock(&JobsGuard);
+			for (; NextPendingJobIndex < Jobs.Num(); ++NextPendingJobIndex)
+			{
+				if (Jobs[NextPendingJobIndex].Status == ERuntimeAudioTranscodeJobStatus::Pending)
+				{
+					JobId = NextPendingJobIndex++;
+					Jobs[JobId].Status = ERuntimeAudioTranscodeJobStatus::Running;
+					Job = Jobs[JobId].Job;
+					break;
+				}
+			}
+
+			if (JobId == INDEX_NONE)
+			{
+				if (--NumOfActiveWorkers > 0)
+				{
+					return;
+				}
+
+				// The last worker finishes the run
+				bRunning = false;
+				Report.ElapsedTime = static_cast<float>(FPlatformTime::Seconds() - RunStartTime);
+				if (Report.ElapsedTime > 0)
+				{
+					Report.FilesPerSecond = Report.NumOfSucceededJobs / Report.ElapsedTime;
+					Report.RealtimeFactor = Report.AudioDuration / Report.ElapsedTime;
+				}
+				UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Finished batch transcoding. %s"), *Report.ToString());
+
+				AsyncTask(ENamedThreads::GameThread, [Result = ResultDelegate, BatchReport = Report]()
+				{
+					Result.ExecuteIfBound(BatchReport);
+				});
+
+				// Unrooted under the lock, so that a new run started right after this one cannot be unrooted
+				RemoveFromRoot();
+				return;
+			}
+		}
+
+		float AudioDuration = 0;
+		int64 NumOfBytesRead = 0;
+		int64 NumOfBytesWritten = 0;
+		const ERuntimeAudioTranscodeJobStatus Status = TranscodeJob(JobId, Job, AudioDuration, NumOfBytesRead, NumOfBytesWritten);
+
+		FScopeLock Lock(&JobsGuard);
+		Jobs[JobId].Status = Status;
+		Report.NumOfSucceededJobs += Status == ERuntimeAudioTranscodeJobStatus::Succeeded ? 1 : 0;
+		Report.NumOfFailedJobs += Status == ERuntimeAudioTranscodeJobStatus::Failed ? 1 : 0;
+		Report.NumOfCancelledJobs += Status == ERuntimeAudioTranscodeJobStatus::Cancelled ? 1 : 0;
+		Report.AudioDuration += AudioDuration;
+		Report.NumOfBytesRead += NumOfBytesRead;
+		Report.NumOfBytesWritten += NumOfBytesWritten;
+		++NumOfFinishedJobs;
+
+		AsyncTask(ENamedThreads::GameThread, [Progress = ProgressDelegate, JobId, Status, NumOfFinished = NumOfFinishedJobs, NumOfJobs = NumOfRunJobs]()
+		{
+			Progress.ExecuteIfBound(JobId, Status, NumOfFinished, NumOfJobs);
+		});
+	}
+}
+
+ERuntimeAudioTranscodeJobStatus URuntimeAudioBatchTranscoder::TranscodeJob(int32 JobId, const FRuntimeAudioTranscodeJob& Job, float& AudioDuration, int64& NumOfBytesRead, int64& NumOfBytesWritten)
+{
+	if (IsJobCancelled(JobId))
+	{
+		return ERuntimeAudioTranscodeJobStatus::Cancelled;
+	}
+
+	ERuntimeAudioFormat EncodedFormatTo = Job.EncodedFormatTo;
+	if (EncodedFormatTo == ERuntimeAudioFormat::Auto)
+	{
+		TArray<ERuntimeAudioFormat> AudioFormats = URuntimeAudioUtilities::GetAudioFormats(Job.FilePathTo);
+		EncodedFormatTo = AudioFormats.Num() == 0 ? ERuntimeAudioFormat::Invalid : AudioFormats[0];
+	}
+
+	TArray64<uint8> EncodedDataFrom;
+	if (!RuntimeAudioImporter::LoadAudioFileToArray(EncodedDataFrom, *Job.FilePathFrom))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong when reading audio data on the path '%s' for batch transcoding"), *Job.FilePathFrom);
+		return ERuntimeAudioTranscodeJobStatus::Failed;
+	}
+	NumOfBytesRead = EncodedDataFrom.Num();
+
+	if (IsJobCancelled(JobId))
+	{
+		return ERuntimeAudioTranscodeJobStatus::Cancelled;
+	}
+
+	FEncodedAudioStruct EncodedDataTo;
+	FSoundWaveBasicStruct SourceInfo;
+	if (!URuntimeAudioTranscoder::TranscodeEncodedData_Internal(MoveTemp(EncodedDataFrom), Job.EncodedFormatFrom, EncodedFormatTo, Job.Quality, Job.OverrideOptions, EncodedDataTo, SourceInfo))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong when transcoding audio data on the path '%s' for batch transcoding"), *Job.FilePathFrom);
+		return ERuntimeAudioTranscodeJobStatus::Failed;
+	}
+
+	if (IsJobCancelled(JobId))
+	{
+		return ERuntimeAudioTranscodeJobStatus::Cancelled;
+	}
+
+	// Written from the encoded buffer directly, without copying it into an array first
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Job.FilePathTo));
+	if (!Writer)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong when saving audio data to the path '%s' after batch transcoding"), *Job.FilePathTo);
+		return ERuntimeAudioTranscodeJobStatus::Failed;
+	}
+	Writer->Serialize(const_cast<uint8*>(EncodedDataTo.AudioData.GetView().GetData()), EncodedDataTo.AudioData.GetView().Num());
+	if (!Writer->Close())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong when saving audio data to the path '%s' after batch transcoding"), *Job.FilePathTo);
+		Writer.Reset();
+		IFileManager::Get().Delete(*Job.FilePathTo);
+		return ERuntimeAudioTranscodeJobStatus::Failed;
+	}
+
+	AudioDuration = SourceInfo.Duration;
+	NumOfBytesWritten = EncodedDataTo.AudioData.GetView().Num();
+	return ERuntimeAudioTranscodeJobStatus::Succeeded;
+}
+
+bool URuntimeAudioBatchTranscoder::CancelJob(int32 JobId)
+{
+	FScopeLock Lock(&JobsGuard);
+	if (!Jobs.IsValidIndex(JobId))
+	{
+		return false;
+	}
+
+	FJobState& JobState = Jobs[JobId];
+	if (JobState.Status == ERuntimeAudioTranscodeJobStatus::Pending)
+	{
+		// Never picked up by a worker, so it is finished here
+		JobState.Status = ERuntimeAudioTranscodeJobStatus::Cancelled;
+		if (bRunning)
+		{
+			++Report.NumOfCancelledJobs;
+			++NumOfFinishedJobs;
+		}
+		return true;
+	}
+	if (JobState.Status == ERuntimeAudioTranscodeJobStatus::Running)
+	{
+		JobState.bCancelRequested = true;
+		return true;
+	}
+	return false;
+}
+
+void URuntimeAudioBatchTranscoder::CancelAllJobs()
+{
+	FScopeLock Lock(&JobsGuard);
+	for (int32 JobId = NextPendingJobIndex; JobId < Jobs.Num(); ++JobId)
+	{
+		CancelJob(JobId);
+	}
+
+	// Running jobs may be located before the first pending job
+	for (FJobState& JobState : Jobs)
+	{
+		if (JobState.Status == ERuntimeAudioTranscodeJobStatus::Running)
+		{
+			JobState.bCancelRequested = true;
+		}
+	}
+}
+
+ERuntimeAudioTranscodeJobStatus URuntimeAudioBatchTranscoder::GetJobStatus(int32 JobId) const
+{
+	FScopeLock Lock(&JobsGuard);
+	return Jobs.IsValidIndex(JobId) ? Jobs[JobId].Status : ERuntimeAudioTranscodeJobStatus::Invalid;
+}
+
+bool URuntimeAudioBatchTranscoder::IsRunning() const
+{
+	FScopeLock Lock(&JobsGuard);
+	return bRunning;
+}
+
+void URuntimeAudioBatchTranscoder::BeginDestroy()
+{
+	// Only possible while running if the transcoder is destroyed on exit, in which case the workers are stopped as soon as possible
+	CancelAllJobs();
+	Super::BeginDestroy();
+}
+
+bool URuntimeAudioBatchTranscoder::IsReadyForFinishDestroy()
+{
+	// The workers access the transcoder until they run out of jobs
+	FScopeLock Lock(&JobsGuard);
+	return NumOfActiveWorkers == 0 && Super::IsReadyForFinishDestroy();
+}
+
+bool URuntimeAudioBatchTranscoder::IsJobCancelled(int32 JobId) const
+{
+	FScopeLock Lock(&JobsGuard);
+	return Jobs[JobId].bCancelRequested;
+}
@@ -6,7 +6,297 @@
 #include "RuntimeAudioTranscoder.h"
 #include "RuntimeAudioUtilities.h"
 #include "Codecs/RAW_RuntimeCodec.h"
+#include "Codecs/MP3_RuntimeEncoder.h"
+#include "Codecs/WAV_RuntimeCodec.h"
+#include "Codecs/RuntimeResampler.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+
+#include <atomic>
+
+namespace
+{
+	/** Number of source frames converted per block of the streamed export. Memory usage is bounded by this times the number of blocks encoded in parallel */
+	constexpr int64 StreamedExportBlockNumOfFrames = 65536;
+
+	/** Encodes a block of interleaved 32-bit float samples into the output format, reusing the memory of the encoded block */
+	using FEncodeExportBlock = TFunction<bool(const float* PCMData, int64 NumOfSamples, TArray64<uint8>& EncodedBlock)>;
+
+	template <typename IntegralType>
+	bool EncodeRAWExportBlock(const float* PCMData, int64 NumOfSamples, TArray64<uint8>& EncodedBlock)
+	{
+		EncodedBlock.SetNumUninitialized(NumOfSamples * sizeof(IntegralType));
+		FRAW_RuntimeCodec::TranscodeRAWDataToBuffer<float, IntegralType>(PCMData, NumOfSamples, reinterpret_cast<IntegralType*>(EncodedBlock.GetData()));
+		return true;
+	}
+
+	FEncodeExportBlock GetRAWExportBlockEncoder(ERuntimeRAWAudioFormat RAWFormat)
+	{
+		switch (RAWFormat)
+		{
+		case ERuntimeRAWAudioFormat::Int8:
+			return &EncodeRAWExportBlock<int8>;
+		case ERuntimeRAWAudioFormat::UInt8:
+			return &EncodeRAWExportBlock<uint8>;
+		case ERuntimeRAWAudioFormat::Int16:
+			return &EncodeRAWExportBlock<int16>;
+		case ERuntimeRAWAudioFormat::UInt16:
+			return &EncodeRAWExportBlock<uint16>;
+		case ERuntimeRAWAudioFormat::Int32:
+			return &EncodeRAWExportBlock<int32>;
+		case ERuntimeRAWAudioFormat::UInt32:
+			return &EncodeRAWExportBlock<uint32>;
+		case ERuntimeRAWAudioFormat::Float32:
+		default:
+			return &EncodeRAWExportBlock<float>;
+		}
+	}
+
+	/**
+	 * Convert the PCM data block by block and write the encoded blocks to the archive in order
+	 * Resampling carries the filter state from one block to the next and runs sequentially, while mixing and encoding of the blocks run in parallel
+	 *
+	 * @param bSequentialEncoding Whether the encoder keeps state from one block to the next, in which case the blocks are encoded one after another in order
+	 * @return Number of encoded bytes written, or -1 on failure
+	 */
+	int64 WriteExportBlocks(const FPCMStruct& PCMBuffer, int32 NumOfChannels, uint32 SampleRate, int32 ExportNumOfChannels, uint32 ExportSampleRate, const FEncodeExportBlock& EncodeBlock, bool bSequentialEncoding, FArchive& Writer, TFunctionRef<void(int64)> OnBlocksWritten)
+	{
+		const float* PCMData = PCMBuffer.PCMData.GetView().GetData();
+		const int64 NumOfFrames = PCMBuffer.PCMNumOfFrames;
+		const bool bResample = SampleRate != ExportSampleRate;
+		const bool bMix = NumOfChannels != ExportNumOfChannels;
+
+		FRuntimeResampler Resampler;
+		if (bResample && !Resampler.Init(NumOfChannels, SampleRate, ExportSampleRate, ERuntimeResamplingQuality::BestSinc))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to resample audio data to the overriden sample rate. Resampling failed"));
+			return -1;
+		}
+
+		// One block per worker, the buffers are reused from batch to batch
+		const int32 NumOfBlocksPerBatch = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+		TArray<Audio::FAlignedFloatBuffer> Blocks;
+		TArray<Audio::FAlignedFloatBuffer> MixedBlocks;
+		TArray<TArray64<uint8>> EncodedBlocks;
+		TArray<TPair<const float*, int64>> BlockViews;
+		Blocks.SetNum(NumOfBlocksPerBatch);
+		MixedBlocks.SetNum(NumOfBlocksPerBatch);
+		EncodedBlocks.SetNum(NumOfBlocksPerBatch);
+		BlockViews.SetNum(NumOfBlocksPerBatch);
+
+		int64 NumOfWrittenBytes = 0;
+		int64 NextFrame = 0;
+		while (NextFrame < NumOfFrames)
+		{
+			int32 NumOfBlocks = 0;
+			for (; NumOfBlocks < NumOfBlocksPerBatch && NextFrame < NumOfFrames; ++NumOfBlocks)
+			{
+				const int64 NumOfBlockFrames = FMath::Min(StreamedExportBlockNumOfFrames, NumOfFrames - NextFrame);
+				const float* SourceBlockData = PCMData + NextFrame * NumOfChannels;
+				NextFrame += NumOfBlockFrames;
+
+				Audio::FAlignedFloatBuffer& Block = Blocks[NumOfBlocks];
+				if (bResample)
+				{
+					Block.Reset();
+					if (!Resampler.ProcessAudio(SourceBlockData, NumOfBlockFrames, Block))
+					{
+						UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to resample audio data to the overriden sample rate. Resampling failed"));
+						return -1;
+					}
+					if (NextFrame >= NumOfFrames)
+					{
+						Resampler.Flush(Block);
+					}
+					BlockViews[NumOfBlocks] = TPair<const float*, int64>(Block.GetData(), Block.Num());
+				}
+				else if (bMix)
+				{
+					// Mixing consumes its input, so the block of the sound wave's data is copied
+					Block.Reset();
+					Block.Append(SourceBlockData, NumOfBlockFrames * NumOfChannels);
+					BlockViews[NumOfBlocks] = TPair<const float*, int64>(Block.GetData(), Block.Num());
+				}
+				else
+				{
+					BlockViews[NumOfBlocks] = TPair<const float*, int64>(SourceBlockData, NumOfBlockFrames * NumOfChannels);
+				}
+			}
+
+			std::atomic<bool> bFailed{false};
+			ParallelFor(NumOfBlocks, [&](int32 BlockIndex)
+			{
+				TPair<const float*, int64> BlockView = BlockViews[BlockIndex];
+				if (bMix)
+				{
+					if (!FRAW_RuntimeCodec::MixChannelsRAWData(Blocks[BlockIndex], ExportSampleRate, NumOfChannels, ExportNumOfChannels, MixedBlocks[BlockIndex]))
+					{
+						UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to mix audio channels to the overriden number of channels. Mixing failed"));
+						bFailed = true;
+						return;
+					}
+					BlockView = TPair<const float*, int64>(MixedBlocks[BlockIndex].GetData(), MixedBlocks[BlockIndex].Num());
+				}
+				if (!EncodeBlock(BlockView.Key, BlockView.Value, EncodedBlocks[BlockIndex]))
+				{
+					UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to encode the exported audio data"));
+					bFailed = true;
+				}
+			}, bSequentialEncoding ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+			if (bFailed)
+			{
+				return -1;
+			}
+
+			for (int32 BlockIndex = 0; BlockIndex < NumOfBlocks; ++BlockIndex)
+			{
+				Writer.Serialize(EncodedBlocks[BlockIndex].GetData(), EncodedBlocks[BlockIndex].Num());
+				NumOfWrittenBytes += EncodedBlocks[BlockIndex].Num();
+			}
+
+			if (Writer.IsError())
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to write the exported audio data"));
+				return -1;
+			}
+
+			OnBlocksWritten(NextFrame);
+		}
+
+		return NumOfWrittenBytes;
+	}
+
+	/**
+	 * Export the sound wave to a file block by block. Must be called from a background thread
+	 * The data is written to a temporary file first, so that a failed export does not leave a truncated file at the save path
+	 * WAV is written as 16-bit PCM, the same as the WAV codec encodes, and MP3 is encoded by a single stateful encoder whose Info tag frame is completed at the end
+	 *
+	 * @param AudioFormat The format to export to, one for which IsStreamedExportSupported returns true
+	 * @param Quality The quality of the encoded audio data, from 0 to 100
+	 */
+	bool ExportBlocksToFile(TWeakObjectPtr<UImportedSoundWave> ImportedSoundWavePtr, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportProgressNative& Progress)
+	{
+		if (!ImportedSoundWavePtr.IsValid())
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave as it is invalid"));
+			return false;
+		}
+
+		// The PCM data is referenced rather than copied. Modifications of the sound wave during the export detach it from the referenced buffer
+		TSharedPtr<const FPCMStruct> PCMBuffer;
+		int32 NumOfChannels;
+		int32 SampleRate;
+		{
+			FRAIScopeLock Lock(&*ImportedSoundWavePtr->DataGuard);
+			PCMBuffer = ImportedSoundWavePtr->GetPCMBufferSnapshot_Internal();
+			NumOfChannels = ImportedSoundWavePtr->GetNumOfChannels();
+			SampleRate = ImportedSoundWavePtr->GetSampleRate();
+		}
+
+		if (!PCMBuffer.IsValid() || !PCMBuffer->IsValid() || NumOfChannels <= 0 || SampleRate <= 0)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave as the PCM data is invalid"));
+			return false;
+		}
+
+		const int32 ExportNumOfChannels = OverrideOptions.IsNumOfChannelsOverriden() ? OverrideOptions.NumOfChannels : NumOfChannels;
+		const int32 ExportSampleRate = OverrideOptions.IsSampleRateOverriden() ? OverrideOptions.SampleRate : SampleRate;
+		if (ExportNumOfChannels <= 0 || ExportSampleRate <= 0)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave as the override options are invalid (number of channels: %d, sample rate: %d)"), OverrideOptions.NumOfChannels, OverrideOptions.SampleRate);
+			return false;
+		}
+
+		const FString TempSavePath = SavePath + TEXT(".part");
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempSavePath));
+		if (!Writer)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to create a file to save audio data to the path '%s'"), *SavePath);
+			return false;
+		}
+
+		const bool bWriteWavHeader = AudioFormat == ERuntimeAudioFormat::Wav;
+		FEncodeExportBlock EncodeBlock = &EncodeRAWExportBlock<int16>;
+		FMP3_RuntimeEncoder MP3Encoder;
+
+		if (bWriteWavHeader)
+		{
+			FWAV_RuntimeCodec::WriteHeader(*Writer, static_cast<uint16>(ExportNumOfChannels), ExportSampleRate, 0);
+		}
+		else if (AudioFormat == ERuntimeAudioFormat::Mp3)
+		{
+			if (!MP3Encoder.Init(ExportNumOfChannels, ExportSampleRate, Quality))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the MP3 encoder to export the sound wave"));
+				Writer.Reset();
+				IFileManager::Get().Delete(*TempSavePath);
+				return false;
+			}
+
+			EncodeBlock = [&MP3Encoder, ExportNumOfChannels](const float* PCMData, int64 NumOfSamples, TArray64<uint8>& EncodedBlock)
+			{
+				EncodedBlock.Reset();
+				return MP3Encoder.EncodeFrames(PCMData, NumOfSamples / ExportNumOfChannels, EncodedBlock);
+			};
+		}
+
+		int32 LastPercentage = -1;
+		const int64 NumOfWrittenBytes = WriteExportBlocks(*PCMBuffer, NumOfChannels, SampleRate, ExportNumOfChannels, ExportSampleRate, EncodeBlock, MP3Encoder.IsInitialized(), *Writer, [&LastPercentage, &Progress, &PCMBuffer](int64 NumOfProcessedFrames)
+		{
+			const int32 Percentage = static_cast<int32>(NumOfProcessedFrames * 100 / PCMBuffer->PCMNumOfFrames);
+			if (Percentage != LastPercentage && Progress.IsBound())
+			{
+				LastPercentage = Percentage;
+				AsyncTask(ENamedThreads::GameThread, [Progress, Percentage]()
+				{
+					Progress.ExecuteIfBound(Percentage);
+				});
+			}
+		});
+
+		bool bSucceeded = NumOfWrittenBytes >= 0;
+		if (bSucceeded && bWriteWavHeader)
+		{
+			if (NumOfWrittenBytes > TNumericLimits<uint32>::Max() - (FWAV_RuntimeCodec::HeaderSize - 8))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave to WAV as the audio data (%lld bytes) exceeds the 4 GB limit of the format"), NumOfWrittenBytes);
+				bSucceeded = false;
+			}
+			else
+			{
+				// The sizes are only known once all blocks are written
+				Writer->Seek(0);
+				FWAV_RuntimeCodec::WriteHeader(*Writer, static_cast<uint16>(ExportNumOfChannels), ExportSampleRate, static_cast<uint32>(NumOfWrittenBytes));
+			}
+		}
+		else if (bSucceeded && MP3Encoder.IsInitialized())
+		{
+			// The last frames are held back by the encoder, and the Info tag frame at the beginning is only complete once all frames are written
+			TArray64<uint8> EncodedData;
+			bSucceeded = MP3Encoder.Flush(EncodedData);
+			Writer->Serialize(EncodedData.GetData(), EncodedData.Num());
+
+			MP3Encoder.GetInfoFrame(EncodedData);
+			Writer->Seek(0);
+			Writer->Serialize(EncodedData.GetData(), EncodedData.Num());
+			bSucceeded = bSucceeded && !Writer->IsError();
+		}
+
+		bSucceeded = Writer->Close() && bSucceeded;
+		Writer.Reset();
+
+		if (!bSucceeded || !IFileManager::Get().Move(*SavePath, *TempSavePath, true))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong when saving audio data to the path '%s'"), *SavePath);
+			IFileManager::Get().Delete(*TempSavePath);
+			return false;
+		}
+
+		return true;
+	}
+}
 
 void URuntimeAudioExporter::ExportSoundWaveToFile(UImportedSoundWave* ImportedSoundWave, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportToFileResult& Result)
 {
@@ -28,6 +318,14 @@ void URuntimeAudioExporter::ExportSoundWaveToFile(TWeakObjectPtr<UImportedSoundW
 #if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
 	TArray<ERuntimeAudioFormat> AudioFormats = URuntimeAudioUtilities::GetAudioFormats(SavePath);
 	AudioFormat = AudioFormat == ERuntimeAudioFormat::Auto ? (AudioFormats.Num() == 0 ? ERuntimeAudioFormat::Invalid : AudioFormats[0]) : AudioFormat;
+
+	// Formats that can be encoded block by block do not need the whole encoded file in memory
+	if (IsStreamedExportSupported(AudioFormat))
+	{
+		ExportSoundWaveToFileStreamed(ImportedSoundWavePtr, SavePath, AudioFormat, Quality, OverrideOptions, FOnAudioExportProgressNative(), Result);
+		return;
+	}
+
 	ExportSoundWaveToBuffer(ImportedSoundWavePtr, AudioFormat, Quality, OverrideOptions, FOnAudioExportToBufferResultNative::CreateLambda([Result, SavePath](bool bSucceeded, const TArray64<uint8>& AudioData)
 	{
 		if (!bSucceeded)
@@ -51,6 +349,70 @@ void URuntimeAudioExporter::ExportSoundWaveToFile(TWeakObjectPtr<UImportedSoundW
 #endif
 }
 
+void URuntimeAudioExporter::ExportSoundWaveToFileStreamed(UImportedSoundWave* ImportedSoundWave, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportProgress& Progress, const FOnAudioExportToFileResult& Result)
+{
+	if (!IsValid(ImportedSoundWave))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave as it is invalid"));
+		Result.ExecuteIfBound(false);
+		return;
+	}
+
+	ExportSoundWaveToFileStreamed(ImportedSoundWave, SavePath, AudioFormat, Quality, OverrideOptions, FOnAudioExportProgressNative::CreateLambda([Progress](int32 Percentage)
+	{
+		Progress.ExecuteIfBound(Percentage);
+	}), FOnAudioExportToFileResultNative::CreateLambda([Result](bool bSucceeded)
+	{
+		Result.ExecuteIfBound(bSucceeded);
+	}));
+}
+
+void URuntimeAudioExporter::ExportSoundWaveToFileStreamed(TWeakObjectPtr<UImportedSoundWave> ImportedSoundWavePtr, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportProgressNative& Progress, const FOnAudioExportToFileResultNative& Result)
+{
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	TArray<ERuntimeAudioFormat> AudioFormats = URuntimeAudioUtilities::GetAudioFormats(SavePath);
+	AudioFormat = AudioFormat == ERuntimeAudioFormat::Auto ? (AudioFormats.Num() == 0 ? ERuntimeAudioFormat::Invalid : AudioFormats[0]) : AudioFormat;
+
+	if (!IsStreamedExportSupported(AudioFormat))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Audio format '%s' can only be encoded as a whole, exporting the sound wave '%s' via buffer"), *UEnum::GetValueAsString(AudioFormat), ImportedSoundWavePtr.IsValid() ? *ImportedSoundWavePtr->GetName() : TEXT("None"));
+		ExportSoundWaveToFile(ImportedSoundWavePtr, SavePath, AudioFormat, Quality, OverrideOptions, FOnAudioExportToFileResultNative::CreateLambda([Progress, Result](bool bSucceeded)
+		{
+			if (bSucceeded)
+			{
+				Progress.ExecuteIfBound(100);
+			}
+			Result.ExecuteIfBound(bSucceeded);
+		}));
+		return;
+	}
+
+	if (IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [ImportedSoundWavePtr, SavePath, AudioFormat, Quality, OverrideOptions, Progress, Result]()
+		{
+			ExportSoundWaveToFileStreamed(ImportedSoundWavePtr, SavePath, AudioFormat, Quality, OverrideOptions, Progress, Result);
+		});
+		return;
+	}
+
+	const bool bSucceeded = ExportBlocksToFile(ImportedSoundWavePtr, SavePath, AudioFormat, Quality, OverrideOptions, Progress);
+
+	AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded]()
+	{
+		Result.ExecuteIfBound(bSucceeded);
+	});
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave to file as file operation support is disabled"));
+	Result.ExecuteIfBound(false);
+#endif
+}
+
+bool URuntimeAudioExporter::IsStreamedExportSupported(ERuntimeAudioFormat AudioFormat)
+{
+	return AudioFormat == ERuntimeAudioFormat::Wav || AudioFormat == ERuntimeAudioFormat::Mp3;
+}
+
 void URuntimeAudioExporter::ExportSoundWaveToBuffer(UImportedSoundWave* ImportedSoundWave, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportToBufferResult& Result)
 {
 	if (!IsValid(ImportedSoundWave))
@@ -99,6 +461,8 @@ void URuntimeAudioExporter::ExportSoundWaveToBuffer(TWeakObjectPtr<UImportedSoun
 		return;
 	}
 
+	// The PCM data is referenced rather than copied, since the encoders only read it
+	TSharedPtr<const FPCMStruct> PCMBuffer;
 	FDecodedAudioStruct DecodedAudioInfo;
 	{
 		FRAIScopeLock Lock(&*ImportedSoundWavePtr->DataGuard);
@@ -111,7 +475,7 @@ void URuntimeAudioExporter::ExportSoundWaveToBuffer(TWeakObjectPtr<UImportedSoun
 		}
 
 		{
-			DecodedAudioInfo.PCMInfo = ImportedSoundWavePtr->GetPCMBuffer();
+			PCMBuffer = ImportedSoundWavePtr->GetPCMBufferSnapshot_Internal();
 			FSoundWaveBasicStruct SoundWaveBasicInfo;
 			{
 				SoundWaveBasicInfo.NumOfChannels = ImportedSoundWavePtr->GetNumOfChannels();
@@ -127,10 +491,17 @@ void URuntimeAudioExporter::ExportSoundWaveToBuffer(TWeakObjectPtr<UImportedSoun
 		EncodedAudioInfo.AudioFormat = AudioFormat;
 	}
 
+	FDecodedAudioView DecodedAudioView;
+	{
+		DecodedAudioView.SoundWaveBasicInfo = DecodedAudioInfo.SoundWaveBasicInfo;
+		DecodedAudioView.PCMData = PCMBuffer->PCMData.GetView();
+		DecodedAudioView.PCMNumOfFrames = PCMBuffer->PCMNumOfFrames;
+	}
+
 	// Check if the number of channels and the sampling rate of the sound wave and desired override options are not the same
 	if (OverrideOptions.IsOverriden() && (ImportedSoundWavePtr->GetSampleRate() != OverrideOptions.SampleRate || ImportedSoundWavePtr->GetNumOfChannels() != OverrideOptions.NumOfChannels))
 	{
-		Audio::FAlignedFloatBuffer WaveData(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), DecodedAudioInfo.PCMInfo.PCMData.GetView().Num());
+		Audio::FAlignedFloatBuffer WaveData(PCMBuffer->PCMData.GetView().GetData(), PCMBuffer->PCMData.GetView().Num());
 
 		// Resampling if needed
 		if (OverrideOptions.IsSampleRateOverriden() && ImportedSoundWavePtr->GetSampleRate() != OverrideOptions.SampleRate)
@@ -151,7 +522,7 @@ void URuntimeAudioExporter::ExportSoundWaveToBuffer(TWeakObjectPtr<UImportedSoun
 		if (OverrideOptions.IsNumOfChannelsOverriden() && ImportedSoundWavePtr->GetNumOfChannels() != OverrideOptions.NumOfChannels)
 		{
 			Audio::FAlignedFloatBuffer WaveDataTemp;
-			if (!FRAW_RuntimeCodec::MixChannelsRAWData(WaveData, OverrideOptions.SampleRate, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels, OverrideOptions.NumOfChannels, WaveDataTemp))
+			if (!FRAW_RuntimeCodec::MixChannelsRAWData(WaveData, DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels, OverrideOptions.NumOfChannels, WaveDataTemp))
 			{
 				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to mix audio channels to the overriden number of channels. Mixing failed"));
 				ExecuteResult(false, TArray64<uint8>());
@@ -163,9 +534,10 @@ void URuntimeAudioExporter::ExportSoundWaveToBuffer(TWeakObjectPtr<UImportedSoun
 
 		DecodedAudioInfo.PCMInfo.PCMNumOfFrames = WaveData.Num() / DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels;
 		DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(WaveData);
+		DecodedAudioView = FDecodedAudioView(DecodedAudioInfo);
 	}
 
-	if (!URuntimeAudioImporterLibrary::EncodeAudioData(MoveTemp(DecodedAudioInfo), EncodedAudioInfo, Quality))
+	if (!URuntimeAudioImporterLibrary::EncodeAudioData(DecodedAudioView, EncodedAudioInfo, Quality))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave '%s'"), *ImportedSoundWavePtr->GetName());
 		ExecuteResult(false, TArray64<uint8>());
@@ -193,23 +565,22 @@ void URuntimeAudioExporter::ExportSoundWaveToRAWFile(UImportedSoundWave* Importe
 void URuntimeAudioExporter::ExportSoundWaveToRAWFile(TWeakObjectPtr<UImportedSoundWave> ImportedSoundWavePtr, const FString& SavePath, ERuntimeRAWAudioFormat RAWFormat, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportToFileResultNative& Result)
 {
 #if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
-	ExportSoundWaveToRAWBuffer(ImportedSoundWavePtr, RAWFormat, OverrideOptions, FOnAudioExportToBufferResultNative::CreateLambda([Result, SavePath](bool bSucceeded, const TArray64<uint8>& AudioData)
+	if (IsInGameThread())
 	{
-		if (!bSucceeded)
+		AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [ImportedSoundWavePtr, SavePath, RAWFormat, OverrideOptions, Result]()
 		{
-			Result.ExecuteIfBound(false);
-			return;
-		}
+			ExportSoundWaveToRAWFile(ImportedSoundWavePtr, SavePath, RAWFormat, OverrideOptions, Result);
+		});
+		return;
+	}
 
-		if (!RuntimeAudioImporter::SaveAudioFileFromArray(AudioData, *SavePath))
-		{
-			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong when saving RAW audio data to the path '%s'"), *SavePath);
-			Result.ExecuteIfBound(false);
-			return;
-		}
+	// RAW samples are independent of each other, so the file is written block by block
+	const bool bSucceeded = ExportBlocksToFile(ImportedSoundWavePtr, SavePath, false, GetRAWExportBlockEncoder(RAWFormat), OverrideOptions, FOnAudioExportProgressNative());
 
-		Result.ExecuteIfBound(true);
-	}));
+	AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded]()
+	{
+		Result.ExecuteIfBound(bSucceeded);
+	});
 #else
 	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to export sound wave to RAW file as file operation support is disabled"));
 	Result.ExecuteIfBound(false);
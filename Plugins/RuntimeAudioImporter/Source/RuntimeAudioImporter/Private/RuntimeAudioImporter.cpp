@@ -35,6 +35,9 @@ void FRuntimeAudioImporterModule::StartupModule()
 	FLAC_Codec = MakeShared<FFLAC_RuntimeCodec>();
 	VORBIS_Codec = MakeShared<FVORBIS_RuntimeCodec>();
 	BINK_Codec = MakeShared<FBINK_RuntimeCodec>();
+
+	// Track the codec registrations so that the cached codec lookups stay in sync
+	FRuntimeCodecFactory::StartupCodecRegistry();
 	
 	// Register codecs with the modular feature system
 	IModularFeatures::Get().RegisterModularFeature(FRuntimeCodecFactory::GetModularFeatureName(), MP3_Codec.Get());
@@ -52,6 +55,8 @@ void FRuntimeAudioImporterModule::ShutdownModule()
 	IModularFeatures::Get().UnregisterModularFeature(FRuntimeCodecFactory::GetModularFeatureName(), FLAC_Codec.Get());
 	IModularFeatures::Get().UnregisterModularFeature(FRuntimeCodecFactory::GetModularFeatureName(), VORBIS_Codec.Get());
 	IModularFeatures::Get().UnregisterModularFeature(FRuntimeCodecFactory::GetModularFeatureName(), BINK_Codec.Get());
+
+	FRuntimeCodecFactory::ShutdownCodecRegistry();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -75,7 +75,38 @@ void URuntimeAudioImporterLibrary::ImportAudioFromFile(const FString& FilePath,
 
 void URuntimeAudioImporterLibrary::ImportAudioFromPreImportedSound(UPreImportedSoundAsset* PreImportedSoundAsset)
 {
-	ImportAudioFromBuffer(PreImportedSoundAsset->AudioDataArray, PreImportedSoundAsset->AudioFormat);
+	if (!PreImportedSoundAsset)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to import audio from the pre-imported sound asset because it is invalid"));
+		OnResult_Internal(nullptr, ERuntimeImportStatus::FailedToReadAudioDataArray);
+		return;
+	}
+
+	if (!PreImportedSoundAsset->HasCookedAudioData())
+	{
+		ImportAudioFromBuffer(PreImportedSoundAsset->AudioDataArray, PreImportedSoundAsset->AudioFormat);
+		return;
+	}
+
+	// The audio data was decoded at cook time, so it only has to be read in
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), WeakPreImportedSoundAsset = MakeWeakObjectPtr(PreImportedSoundAsset)]()
+	{
+		if (!WeakThis.IsValid())
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to import audio from the pre-imported sound asset because the RuntimeAudioImporterLibrary object has been destroyed"));
+			return;
+		}
+
+		FDecodedAudioStruct DecodedAudioInfo;
+		if (!WeakPreImportedSoundAsset.IsValid() || !WeakPreImportedSoundAsset->GetCookedAudioData(DecodedAudioInfo))
+		{
+			WeakThis->OnResult_Internal(nullptr, ERuntimeImportStatus::FailedToReadAudioDataArray);
+			return;
+		}
+
+		WeakThis->OnProgress_Internal(65);
+		WeakThis->ImportAudioFromDecodedInfo(MoveTemp(DecodedAudioInfo));
+	});
 }
 
 void URuntimeAudioImporterLibrary::ImportAudioFromBuffer(TArray<uint8> AudioData, ERuntimeAudioFormat AudioFormat)
@@ -111,17 +142,18 @@ void URuntimeAudioImporterLibrary::ImportAudioFromBuffer(TArray64<uint8> AudioDa
 		return;
 	}
 
-	FEncodedAudioStruct EncodedAudioInfo(AudioData, AudioFormat);
-
 	OnProgress_Internal(25);
 
 	FDecodedAudioStruct DecodedAudioInfo;
-	if (!DecodeAudioData(MoveTemp(EncodedAudioInfo), DecodedAudioInfo))
+	if (!DecodeAudioData(FEncodedAudioView(AudioData, AudioFormat), DecodedAudioInfo))
 	{
 		OnResult_Internal(nullptr, ERuntimeImportStatus::FailedToReadAudioDataArray);
 		return;
 	}
 
+	// The encoded data is no longer needed, release it before the imported sound wave takes over the decoded data
+	AudioData.Empty();
+
 	OnProgress_Internal(65);
 
 	ImportAudioFromDecodedInfo(MoveTemp(DecodedAudioInfo));
@@ -253,11 +285,10 @@ void URuntimeAudioImporterLibrary::ConvertRegularToImportedSoundWave(USoundWave*
 
 bool URuntimeAudioImporterLibrary::TryToRetrieveSoundWaveData(USoundWave* SoundWave, FDecodedAudioStruct& OutDecodedAudioInfo)
 {
-	auto TryRetrieveFromCompressedData = [&OutDecodedAudioInfo](FRuntimeBulkDataBuffer<uint8> BulkAudioData) -> bool
+	auto TryRetrieveFromCompressedData = [&OutDecodedAudioInfo](const FRuntimeBulkDataBuffer<uint8>& BulkAudioData) -> bool
 	{
 		FDecodedAudioStruct DecodedAudioInfo;
-		FEncodedAudioStruct EncodedAudioInfo(MoveTemp(BulkAudioData), ERuntimeAudioFormat::Auto);
-		if (!DecodeAudioData(MoveTemp(EncodedAudioInfo), DecodedAudioInfo))
+		if (!DecodeAudioData(FEncodedAudioView(BulkAudioData.GetView(), ERuntimeAudioFormat::Auto), DecodedAudioInfo))
 		{
 			return false;
 		}
@@ -546,6 +577,11 @@ void URuntimeAudioImporterLibrary::ImportAudioFromFloat32Buffer(FRuntimeBulkData
 }
 
 bool URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioStruct&& EncodedAudioInfo, FDecodedAudioStruct& DecodedAudioInfo)
+{
+	return DecodeAudioData(FEncodedAudioView(EncodedAudioInfo), DecodedAudioInfo);
+}
+
+bool URuntimeAudioImporterLibrary::DecodeAudioData(const FEncodedAudioView& EncodedAudioInfo, FDecodedAudioStruct& DecodedAudioInfo)
 {
 	FRuntimeCodecFactory CodecFactory;
 	TArray<FBaseRuntimeCodec*> RuntimeCodecs = [&EncodedAudioInfo, &CodecFactory]()
@@ -559,10 +595,11 @@ bool URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioStruct&& Encoded
 
 	for (FBaseRuntimeCodec* RuntimeCodec : RuntimeCodecs)
 	{
-		EncodedAudioInfo.AudioFormat = RuntimeCodec->GetAudioFormat();
-		if (!RuntimeCodec->Decode(MoveTemp(EncodedAudioInfo), DecodedAudioInfo))
+		// Every candidate codec borrows the same data, so a failed attempt does not consume it
+		const FEncodedAudioView CodecEncodedAudioInfo(EncodedAudioInfo.AudioData, RuntimeCodec->GetAudioFormat());
+		if (!RuntimeCodec->Decode(CodecEncodedAudioInfo, DecodedAudioInfo))
 		{
-			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong while decoding '%s' audio data"), *UEnum::GetValueAsString(EncodedAudioInfo.AudioFormat));
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong while decoding '%s' audio data"), *UEnum::GetValueAsString(CodecEncodedAudioInfo.AudioFormat));
 			continue;
 		}
 		return true;
@@ -573,6 +610,11 @@ bool URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioStruct&& Encoded
 }
 
 bool URuntimeAudioImporterLibrary::EncodeAudioData(FDecodedAudioStruct&& DecodedAudioInfo, FEncodedAudioStruct& EncodedAudioInfo, uint8 Quality)
+{
+	return EncodeAudioData(FDecodedAudioView(DecodedAudioInfo), EncodedAudioInfo, Quality);
+}
+
+bool URuntimeAudioImporterLibrary::EncodeAudioData(const FDecodedAudioView& DecodedAudioInfo, FEncodedAudioStruct& EncodedAudioInfo, uint8 Quality)
 {
 	if (EncodedAudioInfo.AudioFormat == ERuntimeAudioFormat::Auto || EncodedAudioInfo.AudioFormat == ERuntimeAudioFormat::Invalid)
 	{
@@ -584,7 +626,7 @@ bool URuntimeAudioImporterLibrary::EncodeAudioData(FDecodedAudioStruct&& Decoded
 	TArray<FBaseRuntimeCodec*> RuntimeCodecs = CodecFactory.GetCodecs(EncodedAudioInfo.AudioFormat);
 	for (FBaseRuntimeCodec* RuntimeCodec : RuntimeCodecs)
 	{
-		if (!RuntimeCodec->Encode(MoveTemp(DecodedAudioInfo), EncodedAudioInfo, Quality))
+		if (!RuntimeCodec->Encode(DecodedAudioInfo, EncodedAudioInfo, Quality))
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong while encoding '%s' audio data"), *UEnum::GetValueAsString(EncodedAudioInfo.AudioFormat));
 			continue;
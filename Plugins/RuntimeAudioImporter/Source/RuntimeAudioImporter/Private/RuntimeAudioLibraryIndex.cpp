@@ -0,0 +1,365 @@
+﻿// Georgy Treshchev 2024.
+
+#include "RuntimeAudioLibraryIndex.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "RuntimeAudioUtilities.h"
+#include "Codecs/BaseRuntimeCodec.h"
+#include "Codecs/RuntimeCodecFactory.h"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 IndexFileMagic = 0x58494152; // "RAIX"
+	constexpr int32 IndexFileVersion = 1;
+
+	/**
+	 * Whether any of the registered codecs supports the extension. Checked without logging, since most files in a directory may not be audio
+	 */
+	bool IsAudioFileExtension(const TArray<FBaseRuntimeCodec*>& Codecs, const FString& FilePath)
+	{
+		const FString Extension = FPaths::GetExtension(FilePath, false);
+		for (const FBaseRuntimeCodec* Codec : Codecs)
+		{
+			if (Codec->IsExtensionSupported(Extension))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Whether the normalized file path is located in the normalized directory. The directory keeps its trailing separator only when it is the root ("/")
+	 */
+	bool IsFileInDirectory(const FString& FilePath, const FString& Directory, bool bRecursive)
+	{
+		const bool bDirectoryEndsWithSeparator = Directory.EndsWith(TEXT("/"));
+		const int32 RelativePathStart = bDirectoryEndsWithSeparator ? Directory.Len() : Directory.Len() + 1;
+		if (!FilePath.StartsWith(Directory, ESearchCase::IgnoreCase) || FilePath.Len() <= RelativePathStart || (!bDirectoryEndsWithSeparator && FilePath[Directory.Len()] != TEXT('/')))
+		{
+			return false;
+		}
+		int32 SeparatorIndex;
+		return bRecursive || !FilePath.RightChop(RelativePathStart).FindChar(TEXT('/'), SeparatorIndex);
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FRuntimeAudioFileMetadata& Metadata)
+{
+	uint8 AudioFormat = static_cast<uint8>(Metadata.AudioFormat);
+	Ar << Metadata.FilePath;
+	Ar << AudioFormat;
+	Ar << Metadata.Duration;
+	Ar << Metadata.SampleRate;
+	Ar << Metadata.NumOfChannels;
+	Ar << Metadata.ContentHash;
+	Ar << Metadata.FileSize;
+	Ar << Metadata.ModificationTime;
+	Metadata.AudioFormat = static_cast<ERuntimeAudioFormat>(AudioFormat);
+	return Ar;
+}
+
+URuntimeAudioLibraryIndex* URuntimeAudioLibraryIndex::CreateRuntimeAudioLibraryIndex(const FString& IndexFilePath)
+{
+	URuntimeAudioLibraryIndex* LibraryIndex = NewObject<URuntimeAudioLibraryIndex>();
+	LibraryIndex->IndexFilePath = IndexFilePath.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RuntimeAudioImporter"), TEXT("AudioLibraryIndex.bin")) : IndexFilePath;
+	LibraryIndex->LoadIndex();
+	return LibraryIndex;
+}
+
+void URuntimeAudioLibraryIndex::ScanDirectory(const FString& Directory, bool bRecursive, const FOnScanAudioLibraryResult& Result)
+{
+	ScanDirectory(Directory, bRecursive, FOnScanAudioLibraryResultNative::CreateLambda([Result](bool bSucceeded, const TArray<FRuntimeAudioFileMetadata>& AudioFiles)
+	{
+		Result.ExecuteIfBound(bSucceeded, AudioFiles);
+	}));
+}
+
+void URuntimeAudioLibraryIndex::ScanDirectory(const FString& Directory, bool bRecursive, const FOnScanAudioLibraryResultNative& Result)
+{
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), Directory, bRecursive, Result]()
+	{
+		TArray<FRuntimeAudioFileMetadata> AudioFiles;
+		const bool bSucceeded = WeakThis.IsValid() && WeakThis->ScanDirectory_Internal(Directory, bRecursive, AudioFiles);
+
+		AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded, AudioFiles = MoveTemp(AudioFiles)]()
+		{
+			Result.ExecuteIfBound(bSucceeded, AudioFiles);
+		});
+	});
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to scan directory '%s' because the file operation support is disabled"), *Directory);
+	Result.ExecuteIfBound(false, TArray<FRuntimeAudioFileMetadata>());
+#endif
+}
+
+bool URuntimeAudioLibraryIndex::ScanDirectory_Internal(const FString& Directory, bool bRecursive, TArray<FRuntimeAudioFileMetadata>& AudioFiles)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const FString NormalizedDirectory = NormalizePath(Directory);
+
+	// Gathering the candidate files along with their size and modification time in a single pass over the directory
+	class FDirectoryStatVisitor_AudioScanner : public IPlatformFile::FDirectoryStatVisitor
+	{
+	public:
+		TArray<FBaseRuntimeCodec*> Codecs;
+		TArray<FRuntimeAudioFileMetadata> Files;
+
+		virtual bool Visit(const TCHAR* FilenameOrDirectory, const FFileStatData& StatData) override
+		{
+			if (!StatData.bIsDirectory && IsAudioFileExtension(Codecs, FilenameOrDirectory))
+			{
+				FRuntimeAudioFileMetadata& Metadata = Files.AddDefaulted_GetRef();
+				Metadata.FilePath = NormalizePath(FilenameOrDirectory);
+				Metadata.FileSize = StatData.FileSize;
+				Metadata.ModificationTime = StatData.ModificationTime;
+			}
+			return true;
+		}
+	};
+
+	FDirectoryStatVisitor_AudioScanner DirectoryVisitor;
+	{
+		FRuntimeCodecFactory CodecFactory;
+		DirectoryVisitor.Codecs = CodecFactory.GetCodecs();
+	}
+
+	RuntimeAudioImporter::CheckAndRequestPermissions();
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const bool bIterated = bRecursive
+		                       ? PlatformFile.IterateDirectoryStatRecursively(*NormalizedDirectory, DirectoryVisitor)
+		                       : PlatformFile.IterateDirectoryStat(*NormalizedDirectory, DirectoryVisitor);
+	if (!bIterated)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to iterate the directory '%s'"), *NormalizedDirectory);
+		return false;
+	}
+
+	TArray<FRuntimeAudioFileMetadata>& Files = DirectoryVisitor.Files;
+
+	// Reusing the indexed metadata of the files which have not changed since they were indexed
+	TArray<int32> FileIndicesToProbe;
+	{
+		FReadScopeLock ReadLock(EntriesLock);
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			const FRuntimeAudioFileMetadata* IndexedMetadata = Entries.Find(Files[FileIndex].FilePath);
+			if (IndexedMetadata && IndexedMetadata->FileSize == Files[FileIndex].FileSize && IndexedMetadata->ModificationTime == Files[FileIndex].ModificationTime)
+			{
+				Files[FileIndex] = *IndexedMetadata;
+			}
+			else
+			{
+				FileIndicesToProbe.Add(FileIndex);
+			}
+		}
+	}
+
+	ParallelFor(FileIndicesToProbe.Num(), [&Files, &FileIndicesToProbe](int32 ProbeIndex)
+	{
+		FRuntimeAudioFileMetadata& Metadata = Files[FileIndicesToProbe[ProbeIndex]];
+
+		FRuntimeAudioHeaderInfo HeaderInfo;
+		if (URuntimeAudioUtilities::GetAudioHeaderInfoFromFile(Metadata.FilePath, HeaderInfo))
+		{
+			Metadata.AudioFormat = HeaderInfo.AudioFormat;
+			Metadata.Duration = HeaderInfo.Duration;
+			Metadata.SampleRate = HeaderInfo.SampleRate;
+			Metadata.NumOfChannels = HeaderInfo.NumOfChannels;
+			Metadata.ContentHash = LexToString(FMD5Hash::HashFile(*Metadata.FilePath));
+		}
+	});
+
+	// Updating the index with the probed files and dropping the entries of the files that no longer exist in the scanned directory
+	bool bIndexChanged = FileIndicesToProbe.Num() > 0;
+	{
+		FWriteScopeLock WriteLock(EntriesLock);
+
+		TSet<FString> ScannedFilePaths;
+		ScannedFilePaths.Reserve(Files.Num());
+		for (const FRuntimeAudioFileMetadata& Metadata : Files)
+		{
+			ScannedFilePaths.Add(Metadata.FilePath);
+		}
+
+		for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
+		{
+			if (IsFileInDirectory(EntryIt.Key(), NormalizedDirectory, bRecursive) && !ScannedFilePaths.Contains(EntryIt.Key()))
+			{
+				EntryIt.RemoveCurrent();
+				bIndexChanged = true;
+			}
+		}
+
+		for (const int32 FileIndex : FileIndicesToProbe)
+		{
+			Entries.Add(Files[FileIndex].FilePath, Files[FileIndex]);
+		}
+	}
+
+	if (bIndexChanged)
+	{
+		SaveIndex();
+	}
+
+	AudioFiles.Reset(Files.Num());
+	for (FRuntimeAudioFileMetadata& Metadata : Files)
+	{
+		if (Metadata.IsValidAudio())
+		{
+			AudioFiles.Add(MoveTemp(Metadata));
+		}
+	}
+
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Scanned '%s' in %.3f sec: %d audio files, %d of them probed"), *NormalizedDirectory, FPlatformTime::Seconds() - StartTime, AudioFiles.Num(), FileIndicesToProbe.Num());
+	return true;
+}
+
+TArray<FRuntimeAudioFileMetadata> URuntimeAudioLibraryIndex::GetIndexedAudioFiles(const FString& Directory, bool bRecursive) const
+{
+	const FString NormalizedDirectory = NormalizePath(Directory);
+
+	TArray<FRuntimeAudioFileMetadata> AudioFiles;
+	FReadScopeLock ReadLock(EntriesLock);
+	for (const TPair<FString, FRuntimeAudioFileMetadata>& Entry : Entries)
+	{
+		if (Entry.Value.IsValidAudio() && IsFileInDirectory(Entry.Key, NormalizedDirectory, bRecursive))
+		{
+			AudioFiles.Add(Entry.Value);
+		}
+	}
+	return AudioFiles;
+}
+
+bool URuntimeAudioLibraryIndex::FindAudioFileMetadata(const FString& FilePath, FRuntimeAudioFileMetadata& Metadata) const
+{
+	FReadScopeLock ReadLock(EntriesLock);
+	const FRuntimeAudioFileMetadata* IndexedMetadata = Entries.Find(NormalizePath(FilePath));
+	if (!IndexedMetadata || !IndexedMetadata->IsValidAudio())
+	{
+		return false;
+	}
+	Metadata = *IndexedMetadata;
+	return true;
+}
+
+int32 URuntimeAudioLibraryIndex::GetNumOfIndexedAudioFiles() const
+{
+	int32 NumOfAudioFiles = 0;
+	FReadScopeLock ReadLock(EntriesLock);
+	for (const TPair<FString, FRuntimeAudioFileMetadata>& Entry : Entries)
+	{
+		NumOfAudioFiles += Entry.Value.IsValidAudio() ? 1 : 0;
+	}
+	return NumOfAudioFiles;
+}
+
+void URuntimeAudioLibraryIndex::ClearIndex(bool bDeleteIndexFile)
+{
+	{
+		FWriteScopeLock WriteLock(EntriesLock);
+		Entries.Empty();
+	}
+
+	if (bDeleteIndexFile)
+	{
+		FScopeLock SaveLock(&SaveGuard);
+		IFileManager::Get().Delete(*IndexFilePath, false, false, true);
+	}
+}
+
+bool URuntimeAudioLibraryIndex::SaveIndex()
+{
+	TArray<uint8> IndexData;
+	{
+		FMemoryWriter Writer(IndexData);
+		uint32 Magic = IndexFileMagic;
+		int32 Version = IndexFileVersion;
+		Writer << Magic;
+		Writer << Version;
+
+		FReadScopeLock ReadLock(EntriesLock);
+		int32 NumOfEntries = Entries.Num();
+		Writer << NumOfEntries;
+		for (TPair<FString, FRuntimeAudioFileMetadata>& Entry : Entries)
+		{
+			Writer << Entry.Value;
+		}
+	}
+
+	// Writing to a temporary file first, so that an interrupted save does not corrupt the existing index
+	FScopeLock SaveLock(&SaveGuard);
+	const FString TempIndexFilePath = IndexFilePath + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(IndexData, *TempIndexFilePath) || !IFileManager::Get().Move(*IndexFilePath, *TempIndexFilePath, true, true))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to save the audio library index to '%s'"), *IndexFilePath);
+		return false;
+	}
+	return true;
+}
+
+bool URuntimeAudioLibraryIndex::LoadIndex()
+{
+	TArray<uint8> IndexData;
+	if (!FFileHelper::LoadFileToArray(IndexData, *IndexFilePath, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(IndexData);
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 NumOfEntries = 0;
+	Reader << Magic;
+	Reader << Version;
+	Reader << NumOfEntries;
+	if (Reader.IsError() || Magic != IndexFileMagic || Version != IndexFileVersion || NumOfEntries < 0)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Ignoring the audio library index '%s' since it is invalid or has an outdated version"), *IndexFilePath);
+		return false;
+	}
+
+	TMap<FString, FRuntimeAudioFileMetadata> LoadedEntries;
+	LoadedEntries.Reserve(NumOfEntries);
+	for (int32 EntryIndex = 0; EntryIndex < NumOfEntries && !Reader.IsError(); ++EntryIndex)
+	{
+		FRuntimeAudioFileMetadata Metadata;
+		Reader << Metadata;
+		LoadedEntries.Add(Metadata.FilePath, MoveTemp(Metadata));
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Ignoring the audio library index '%s' since it is truncated"), *IndexFilePath);
+		return false;
+	}
+
+	FWriteScopeLock WriteLock(EntriesLock);
+	Entries = MoveTemp(LoadedEntries);
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Loaded the audio library index '%s' with %d entries"), *IndexFilePath, Entries.Num());
+	return true;
+}
+
+FString URuntimeAudioLibraryIndex::NormalizePath(const FString& Path)
+{
+	FString NormalizedPath = FPaths::ConvertRelativePathToFull(Path);
+	FPaths::NormalizeFilename(NormalizedPath);
+	FPaths::RemoveDuplicateSlashes(NormalizedPath);
+	while (NormalizedPath.Len() > 1 && NormalizedPath.EndsWith(TEXT("/")))
+	{
+		NormalizedPath.LeftChopInline(1);
+	}
+	return NormalizedPath;
+}
@@ -149,23 +149,28 @@ void URuntimeAudioTranscoder::TranscodeEncodedDataFromBuffer(TArray64<uint8> Enc
 		return;
 	}
 
-	auto ExecuteResult = [Result](bool bSucceeded, TArray64<uint8>&& AudioData)
+	FEncodedAudioStruct EncodedAudioInfo;
+	FSoundWaveBasicStruct SourceInfo;
+	const bool bSucceeded = TranscodeEncodedData_Internal(MoveTemp(EncodedDataFrom), EncodedFormatFrom, EncodedFormatTo, Quality, OverrideOptions, EncodedAudioInfo, SourceInfo);
+
+	TArray64<uint8> EncodedDataTo = bSucceeded ? TArray64<uint8>(EncodedAudioInfo.AudioData.GetView().GetData(), EncodedAudioInfo.AudioData.GetView().Num()) : TArray64<uint8>();
+	AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded, EncodedDataTo = MoveTemp(EncodedDataTo)]()
 	{
-		AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded, AudioData]()
-		{
-			Result.ExecuteIfBound(bSucceeded, AudioData);
-		});
-	};
+		Result.ExecuteIfBound(bSucceeded, EncodedDataTo);
+	});
+}
 
+bool URuntimeAudioTranscoder::TranscodeEncodedData_Internal(TArray64<uint8>&& EncodedDataFrom, ERuntimeAudioFormat EncodedFormatFrom, ERuntimeAudioFormat EncodedFormatTo, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, FEncodedAudioStruct& EncodedDataTo, FSoundWaveBasicStruct& SourceInfo)
+{
 	FDecodedAudioStruct DecodedAudioInfo;
 	{
-		FEncodedAudioStruct EncodedAudioInfo(MoveTemp(EncodedDataFrom), EncodedFormatFrom);
-		if (!URuntimeAudioImporterLibrary::DecodeAudioData(MoveTemp(EncodedAudioInfo), DecodedAudioInfo))
+		if (!URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(EncodedDataFrom, EncodedFormatFrom), DecodedAudioInfo))
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to decode audio data"));
-			ExecuteResult(false, TArray64<uint8>());
-			return;
+			return false;
 		}
+		EncodedDataFrom.Empty();
+		SourceInfo = DecodedAudioInfo.SoundWaveBasicInfo;
 	}
 
 	// Check if the number of channels and the sampling rate of the sound wave and desired override options are not the same
@@ -180,8 +185,7 @@ void URuntimeAudioTranscoder::TranscodeEncodedDataFromBuffer(TArray64<uint8> Enc
 			if (!FRAW_RuntimeCodec::ResampleRAWData(WaveData, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels, DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, OverrideOptions.SampleRate, ResamplerOutputData))
 			{
 				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to resample audio data to the overriden sample rate. Resampling failed"));
-				ExecuteResult(false, TArray64<uint8>());
-				return;
+				return false;
 			}
 
 			WaveData = MoveTemp(ResamplerOutputData);
@@ -192,11 +196,10 @@ void URuntimeAudioTranscoder::TranscodeEncodedDataFromBuffer(TArray64<uint8> Enc
 		if (OverrideOptions.IsNumOfChannelsOverriden() && DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels != OverrideOptions.NumOfChannels)
 		{
 			Audio::FAlignedFloatBuffer WaveDataTemp;
-			if (!FRAW_RuntimeCodec::MixChannelsRAWData(WaveData, OverrideOptions.SampleRate, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels, OverrideOptions.NumOfChannels, WaveDataTemp))
+			if (!FRAW_RuntimeCodec::MixChannelsRAWData(WaveData, DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels, OverrideOptions.NumOfChannels, WaveDataTemp))
 			{
 				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to mix audio channels to the overriden number of channels. Mixing failed"));
-				ExecuteResult(false, TArray64<uint8>());
-				return;
+				return false;
 			}
 			WaveData = MoveTemp(WaveDataTemp);
 			DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels = OverrideOptions.NumOfChannels;
@@ -206,18 +209,16 @@ void URuntimeAudioTranscoder::TranscodeEncodedDataFromBuffer(TArray64<uint8> Enc
 		DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(WaveData);
 	}
 
-	FEncodedAudioStruct EncodedAudioInfo;
-	EncodedAudioInfo.AudioFormat = EncodedFormatTo;
+	EncodedDataTo.AudioFormat = EncodedFormatTo;
 	{
-		if (!URuntimeAudioImporterLibrary::EncodeAudioData(MoveTemp(DecodedAudioInfo), EncodedAudioInfo, 100))
+		if (!URuntimeAudioImporterLibrary::EncodeAudioData(FDecodedAudioView(DecodedAudioInfo), EncodedDataTo, Quality))
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to encode audio data"));
-			ExecuteResult(false, TArray64<uint8>());
-			return;
+			return false;
 		}
 	}
 
-	ExecuteResult(true, TArray64<uint8>(EncodedAudioInfo.AudioData.GetView().GetData(), EncodedAudioInfo.AudioData.GetView().Num()));
+	return true;
 }
 
 void URuntimeAudioTranscoder::TranscodeEncodedDataFromFile(const FString& FilePathFrom, ERuntimeAudioFormat EncodedFormatFrom, const FString& FilePathTo, ERuntimeAudioFormat EncodedFormatTo, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnEncodedDataTranscodeFromFileResult& Result)
@@ -6,7 +6,81 @@
 #include "Codecs/BaseRuntimeCodec.h"
 #include "Codecs/RuntimeCodecFactory.h"
 #include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
 #include "Async/Async.h"
+#include "RuntimeAudioImporterLibrary.h"
+
+namespace
+{
+	/** Number of leading bytes read from a file to detect its format when the extension is not recognized */
+	constexpr int64 NumOfFormatDetectionBytes = 64 * 1024;
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	/**
+	 * Compare the header information probed from the files against the results of fully decoding them
+	 * Usage: RuntimeAudioImporter.VerifyHeaderProbing <Directory>
+	 */
+	FAutoConsoleCommand VerifyHeaderProbingCommand(
+		TEXT("RuntimeAudioImporter.VerifyHeaderProbing"),
+		TEXT("Compares the header-only probing of all audio files in the directory against a full decode. Usage: RuntimeAudioImporter.VerifyHeaderProbing <Directory>"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() < 1)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Usage: RuntimeAudioImporter.VerifyHeaderProbing <Directory>"));
+				return;
+			}
+
+			TArray<FString> FilePaths;
+			IFileManager::Get().FindFilesRecursive(FilePaths, *Args[0], TEXT("*"), true, false);
+
+			int32 NumOfVerifiedFiles = 0, NumOfMismatches = 0;
+			double ProbingTime = 0, DecodingTime = 0;
+			for (const FString& FilePath : FilePaths)
+			{
+				if (URuntimeAudioUtilities::GetAudioFormats(FilePath).Num() == 0)
+				{
+					continue;
+				}
+
+				double StartTime = FPlatformTime::Seconds();
+				FRuntimeAudioHeaderInfo ProbedHeaderInfo;
+				const bool bProbed = URuntimeAudioUtilities::GetAudioHeaderInfoFromFile(FilePath, ProbedHeaderInfo);
+				ProbingTime += FPlatformTime::Seconds() - StartTime;
+
+				StartTime = FPlatformTime::Seconds();
+				TArray64<uint8> AudioData;
+				FDecodedAudioStruct DecodedAudioInfo;
+				const bool bDecoded = RuntimeAudioImporter::LoadAudioFileToArray(AudioData, FilePath)
+					&& URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(AudioData, ERuntimeAudioFormat::Auto), DecodedAudioInfo);
+				DecodingTime += FPlatformTime::Seconds() - StartTime;
+
+				if (!bProbed || !bDecoded)
+				{
+					UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("'%s': probed: %s, decoded: %s"), *FilePath, bProbed ? TEXT("yes") : TEXT("no"), bDecoded ? TEXT("yes") : TEXT("no"));
+					NumOfMismatches += bProbed != bDecoded;
+					continue;
+				}
+
+				++NumOfVerifiedFiles;
+				const int64 ProbedNumOfFrames = ProbedHeaderInfo.NumOfChannels > 0 ? ProbedHeaderInfo.PCMDataSize / ProbedHeaderInfo.NumOfChannels : 0;
+				if (ProbedHeaderInfo.NumOfChannels != static_cast<int32>(DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels)
+					|| ProbedHeaderInfo.SampleRate != static_cast<int32>(DecodedAudioInfo.SoundWaveBasicInfo.SampleRate)
+					|| ProbedNumOfFrames != DecodedAudioInfo.PCMInfo.PCMNumOfFrames)
+				{
+					UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("'%s': probed %d channels, %d Hz, %lld frames; decoded %u channels, %u Hz, %lld frames"), *FilePath,
+					       ProbedHeaderInfo.NumOfChannels, ProbedHeaderInfo.SampleRate, ProbedNumOfFrames,
+					       DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels, DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, static_cast<int64>(DecodedAudioInfo.PCMInfo.PCMNumOfFrames));
+					++NumOfMismatches;
+				}
+			}
+
+			UE_LOG(LogRuntimeAudioImporter, Display, TEXT("Verified header probing of %d files: %d mismatches. Probing took %.3f sec, full decoding took %.3f sec"),
+			       NumOfVerifiedFiles, NumOfMismatches, ProbingTime, DecodingTime);
+		}));
+#endif
+}
 
 TArray<ERuntimeAudioFormat> URuntimeAudioUtilities::GetAudioFormats(const FString& FilePath)
 {
@@ -23,7 +97,7 @@ TArray<ERuntimeAudioFormat> URuntimeAudioUtilities::GetAudioFormats(const FStrin
 
 TArray<ERuntimeAudioFormat> URuntimeAudioUtilities::GetAudioFormatsAdvanced(const TArray<uint8>& AudioData)
 {
-	return GetAudioFormatsAdvanced(FRuntimeBulkDataBuffer<uint8>(AudioData));
+	return GetAudioFormatsAdvanced(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()));
 }
 
 void URuntimeAudioUtilities::GetAudioHeaderInfoFromFile(const FString& FilePath, const FOnGetAudioHeaderInfoResult& Result)
@@ -47,98 +121,112 @@ void URuntimeAudioUtilities::GetAudioHeaderInfoFromFile(const FString& FilePath,
 			});
 		};
 
-		TArray64<uint8> AudioBuffer;
-		if (!RuntimeAudioImporter::LoadAudioFileToArray(AudioBuffer, *FilePath))
-		{
-			ExecuteResult(false, FRuntimeAudioHeaderInfo());
-			return;
-		}
-
-		{
-			FRuntimeCodecFactory CodecFactory;
-			TArray<FBaseRuntimeCodec*> RuntimeCodecs = CodecFactory.GetCodecs(FilePath);
+		FRuntimeAudioHeaderInfo HeaderInfo;
+		const bool bSucceeded = GetAudioHeaderInfoFromFile(FilePath, HeaderInfo);
+		ExecuteResult(bSucceeded, MoveTemp(HeaderInfo));
+	});
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to get audio header info from file '%s' because the file operation support is disabled."), *FilePath);
+	Result.ExecuteIfBound(false, FRuntimeAudioHeaderInfo());
+#endif
+}
 
-			FRuntimeBulkDataBuffer<uint8> BulkAudioData = FRuntimeBulkDataBuffer<uint8>(AudioBuffer);
+bool URuntimeAudioUtilities::GetAudioHeaderInfoFromFile(const FString& FilePath, FRuntimeAudioHeaderInfo& HeaderInfo)
+{
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	const TSharedRef<FRuntimeAudioFileStreamSource, ESPMode::ThreadSafe> FileSource = MakeShared<FRuntimeAudioFileStreamSource, ESPMode::ThreadSafe>(FilePath);
+	if (!FileSource->IsValid())
+	{
+		return false;
+	}
 
-			FEncodedAudioStruct EncodedData;
-			EncodedData.AudioData = MoveTemp(BulkAudioData);
-			for (FBaseRuntimeCodec* RuntimeCodec : RuntimeCodecs)
-			{
-				EncodedData.AudioFormat = RuntimeCodec->GetAudioFormat();
+	FRuntimeCodecFactory CodecFactory;
+	for (FBaseRuntimeCodec* RuntimeCodec : CodecFactory.GetCodecs(FilePath))
+	{
+		if (RuntimeCodec->GetHeaderInfoFromStream(FileSource, HeaderInfo))
+		{
+			return true;
+		}
+	}
 
-				FRuntimeAudioHeaderInfo HeaderInfo;
-				if (!RuntimeCodec->GetHeaderInfo(MoveTemp(EncodedData), HeaderInfo))
-				{
-					continue;
-				}
+	// Falling back to detecting the format from the leading bytes of the file, which are enough for the magic bytes and most headers
+	TArray<uint8> LeadingData;
+	LeadingData.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(FileSource->GetSize(), NumOfFormatDetectionBytes)));
+	if (!FileSource->Seek(0) || FileSource->Read(LeadingData.GetData(), LeadingData.Num()) != LeadingData.Num())
+	{
+		return false;
+	}
 
-				ExecuteResult(true, MoveTemp(HeaderInfo));
-				return;
-			}
+	for (FBaseRuntimeCodec* RuntimeCodec : CodecFactory.GetCodecs(FRuntimeAudioDataView(LeadingData.GetData(), LeadingData.Num())))
+	{
+		if (RuntimeCodec->GetHeaderInfoFromStream(FileSource, HeaderInfo))
+		{
+			return true;
 		}
+	}
 
-		GetAudioHeaderInfoFromBuffer(MoveTemp(AudioBuffer), FOnGetAudioHeaderInfoResultNative::CreateLambda([Result](bool bSucceeded, FRuntimeAudioHeaderInfo HeaderInfo) mutable
-		{
-			Result.ExecuteIfBound(bSucceeded, MoveTemp(HeaderInfo));
-		}));
-	});
+	return false;
 #else
 	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to get audio header info from file '%s' because the file operation support is disabled."), *FilePath);
-	Result.ExecuteIfBound(false, FRuntimeAudioHeaderInfo());
+	return false;
 #endif
 }
 
 void URuntimeAudioUtilities::GetAudioHeaderInfoFromBuffer(TArray<uint8> AudioData, const FOnGetAudioHeaderInfoResult& Result)
 {
-	GetAudioHeaderInfoFromBuffer(TArray64<uint8>(MoveTemp(AudioData)), FOnGetAudioHeaderInfoResultNative::CreateLambda([Result](bool bSucceeded, const FRuntimeAudioHeaderInfo& HeaderInfo)
+	// Keeping the original array instead of converting it to a 64-bit one, which would copy the data
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [AudioData = MoveTemp(AudioData), Result]
 	{
-		Result.ExecuteIfBound(bSucceeded, HeaderInfo);
-	}));
+		FRuntimeAudioHeaderInfo HeaderInfo;
+		const bool bSucceeded = GetAudioHeaderInfoFromBuffer(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()), HeaderInfo);
+
+		AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded, HeaderInfo = MoveTemp(HeaderInfo)]()
+		{
+			Result.ExecuteIfBound(bSucceeded, HeaderInfo);
+		});
+	});
 }
 
 void URuntimeAudioUtilities::GetAudioHeaderInfoFromBuffer(TArray64<uint8> AudioData, const FOnGetAudioHeaderInfoResultNative& Result)
 {
 	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [AudioData = MoveTemp(AudioData), Result]
 	{
-		auto ExecuteResult = [Result](bool bSucceeded, FRuntimeAudioHeaderInfo&& HeaderInfo)
-		{
-			AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded, HeaderInfo = MoveTemp(HeaderInfo)]() mutable
-			{
-				Result.ExecuteIfBound(bSucceeded, MoveTemp(HeaderInfo));
-			});
-		};
+		FRuntimeAudioHeaderInfo HeaderInfo;
+		const bool bSucceeded = GetAudioHeaderInfoFromBuffer(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()), HeaderInfo);
 
-		FRuntimeBulkDataBuffer<uint8> BulkAudioData = FRuntimeBulkDataBuffer<uint8>(AudioData);
-
-		FRuntimeCodecFactory CodecFactory;
-		TArray<FBaseRuntimeCodec*> RuntimeCodecs = CodecFactory.GetCodecs(BulkAudioData);
-
-		FEncodedAudioStruct EncodedData;
-		EncodedData.AudioData = MoveTemp(BulkAudioData);
-		for (FBaseRuntimeCodec* RuntimeCodec : RuntimeCodecs)
+		AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded, HeaderInfo = MoveTemp(HeaderInfo)]() mutable
 		{
-			EncodedData.AudioFormat = RuntimeCodec->GetAudioFormat();
-
-			FRuntimeAudioHeaderInfo HeaderInfo;
-			if (!RuntimeCodec->GetHeaderInfo(MoveTemp(EncodedData), HeaderInfo))
-			{
-				continue;
-			}
+			Result.ExecuteIfBound(bSucceeded, MoveTemp(HeaderInfo));
+		});
+	});
+}
 
-			ExecuteResult(true, MoveTemp(HeaderInfo));
-			return;
+bool URuntimeAudioUtilities::GetAudioHeaderInfoFromBuffer(FRuntimeAudioDataView AudioData, FRuntimeAudioHeaderInfo& HeaderInfo)
+{
+	// The codecs only borrow the buffer, so probing does not allocate a copy of the audio data
+	FRuntimeCodecFactory CodecFactory;
+	for (FBaseRuntimeCodec* RuntimeCodec : CodecFactory.GetCodecs(AudioData))
+	{
+		if (RuntimeCodec->GetHeaderInfo(FEncodedAudioView(AudioData, RuntimeCodec->GetAudioFormat()), HeaderInfo))
+		{
+			return true;
 		}
+	}
 
-		ExecuteResult(false, FRuntimeAudioHeaderInfo());
-	});
+	return false;
 }
 
 TArray<ERuntimeAudioFormat> URuntimeAudioUtilities::GetAudioFormatsAdvanced(const TArray64<uint8>& AudioData)
 {
-	return GetAudioFormatsAdvanced(FRuntimeBulkDataBuffer<uint8>(AudioData));
+	return GetAudioFormatsAdvanced(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()));
 }
 
 TArray<ERuntimeAudioFormat> URuntimeAudioUtilities::GetAudioFormatsAdvanced(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+{
+	return GetAudioFormatsAdvanced(FRuntimeAudioDataView(AudioData.GetView()));
+}
+
+TArray<ERuntimeAudioFormat> URuntimeAudioUtilities::GetAudioFormatsAdvanced(FRuntimeAudioDataView AudioData)
 {
 	FRuntimeCodecFactory CodecFactory;
 	TArray<FBaseRuntimeCodec*> RuntimeCodecs = CodecFactory.GetCodecs(AudioData);
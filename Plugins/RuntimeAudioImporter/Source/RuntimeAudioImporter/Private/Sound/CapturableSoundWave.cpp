@@ -3,9 +3,123 @@
 #include "Sound/CapturableSoundWave.h"
 
 #include "RuntimeAudioImporterDefines.h"
+#include "VAD/RuntimeVoiceActivityDetector.h"
 #include "AudioThread.h"
 #include "Async/Async.h"
 #include "UObject/WeakObjectPtrTemplates.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+
+namespace
+{
+	/** Number of samples the capture buffer holds, about 5 seconds of 48 kHz stereo audio. Captured data is dropped if its processing falls behind by more than that */
+	constexpr int64 CaptureBufferNumOfSamples = 1 << 19;
+
+	/**
+	 * Drive a capturable sound wave from a file or a synthetic source and measure the throughput and the latency of the capture path
+	 * Usage: RuntimeAudioImporter.Capture.Benchmark [Speed=1] [Seconds=30] [VAD=0] [FilePath]
+	 */
+	FAutoConsoleCommand BenchmarkCaptureCommand(
+		TEXT("RuntimeAudioImporter.Capture.Benchmark"),
+		TEXT("Captures the given number of seconds of audio from a looped file, or from synthetic tone bursts if no file is given, at the given speed relative to realtime (0 for as fast as possible), and logs the throughput and the latency of the capture path. Usage: RuntimeAudioImporter.Capture.Benchmark [Speed=1] [Seconds=30] [VAD=0] [FilePath]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const float Speed = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 0.f) : 1.f;
+			const float Seconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 30.f;
+			const bool bVAD = Args.Num() > 2 && FCString::Atoi(*Args[2]) != 0;
+			if (Seconds <= 0)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Usage: RuntimeAudioImporter.Capture.Benchmark [Speed=1] [Seconds=30] [VAD=0] [FilePath]"));
+				return;
+			}
+
+			TSharedPtr<FRuntimeGeneratedCaptureSource> CaptureSource;
+			if (Args.Num() > 3)
+			{
+				CaptureSource = MakeShared<FRuntimeFileCaptureSource>(Args[3], Speed, true);
+			}
+			else
+			{
+				// Speech-like alternation of activity and silence, so that the VAD has something to decide
+				FRuntimeSyntheticCaptureSourceSettings Settings;
+				Settings.BurstDuration = 1.5f;
+				Settings.PauseDuration = 0.5f;
+				CaptureSource = MakeShared<FRuntimeSyntheticCaptureSource>(Settings, Speed);
+			}
+
+			UCapturableSoundWave* SoundWave = UCapturableSoundWave::CreateCapturableSoundWave();
+			if (!SoundWave)
+			{
+				return;
+			}
+			if (bVAD)
+			{
+				SoundWave->ToggleVAD(true);
+			}
+			SoundWave->SetCaptureSource(CaptureSource);
+
+			// Updated on the audio task pipe of the sound wave, which processes the captured data serially
+			struct FBenchmarkStats
+			{
+				std::atomic<int64> NumOfProcessedFrames{0};
+				double StartTime = 0;
+				double LatencySum = 0, MaxLatency = 0;
+				int64 NumOfProcessedBuffers = 0;
+			};
+			TSharedRef<FBenchmarkStats> Stats = MakeShared<FBenchmarkStats>();
+
+			SoundWave->OnCaptureAudioDataNative.AddLambda([Stats, Speed](TArrayView<const float> PCMData, int32 InSampleRate, int32 InNumOfChannels)
+			{
+				const int64 NumOfProcessedFrames = Stats->NumOfProcessedFrames.load(std::memory_order_relaxed) + PCMData.Num() / InNumOfChannels;
+
+				// The paced source delivers every frame at a known time, so the delay of its processing is the latency of the capture path
+				if (Speed > 0)
+				{
+					const double Latency = FPlatformTime::Seconds() - (Stats->StartTime + NumOfProcessedFrames / (static_cast<double>(InSampleRate) * Speed));
+					Stats->LatencySum += Latency;
+					Stats->MaxLatency = FMath::Max(Stats->MaxLatency, Latency);
+				}
+				++Stats->NumOfProcessedBuffers;
+				Stats->NumOfProcessedFrames.store(NumOfProcessedFrames, std::memory_order_relaxed);
+			});
+
+			const double StartTime = FPlatformTime::Seconds();
+			Stats->StartTime = StartTime;
+			if (!SoundWave->StartCapture(INDEX_NONE))
+			{
+				return;
+			}
+
+			// Blocks the calling thread, the capture path runs on the thread of the source and on the audio task pipe
+			const int64 NumOfFramesToCapture = static_cast<int64>(Seconds * CaptureSource->GetSampleRate());
+			while (CaptureSource->IsCapturing() && CaptureSource->GetNumOfDeliveredFrames() < NumOfFramesToCapture)
+			{
+				FPlatformProcess::Sleep(0.005f);
+			}
+			SoundWave->StopCapture();
+			const double CaptureTime = FPlatformTime::Seconds() - StartTime;
+
+			// Wait for the processing of the remaining data, which may never complete if some of it was dropped
+			const int64 NumOfDeliveredFrames = CaptureSource->GetNumOfDeliveredFrames();
+			const double WaitStartTime = FPlatformTime::Seconds();
+			while (Stats->NumOfProcessedFrames.load(std::memory_order_relaxed) < NumOfDeliveredFrames && FPlatformTime::Seconds() - WaitStartTime < 5)
+			{
+				FPlatformProcess::Sleep(0.005f);
+			}
+			const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+			const int64 NumOfProcessedFrames = Stats->NumOfProcessedFrames.load(std::memory_order_relaxed);
+			const double AudioDuration = static_cast<double>(NumOfProcessedFrames) / CaptureSource->GetSampleRate();
+			UE_LOG(LogRuntimeAudioImporter, Display, TEXT("Captured %.2f sec of audio from %s (%d Hz, %d channels) in %.3f sec, %.3f sec including processing: %.1fx realtime. Delivered %lld frames, processed %lld frames in %lld buffers%s"),
+			       AudioDuration, *CaptureSource->GetDescription(), CaptureSource->GetSampleRate(), CaptureSource->GetNumOfChannels(), CaptureTime, TotalTime,
+			       TotalTime > 0 ? AudioDuration / TotalTime : 0.0, NumOfDeliveredFrames, NumOfProcessedFrames, Stats->NumOfProcessedBuffers, bVAD ? TEXT(", with VAD") : TEXT(""));
+			if (Speed > 0 && Stats->NumOfProcessedBuffers > 0)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Display, TEXT("Capture path latency: average %.2f ms, max %.2f ms"),
+				       Stats->LatencySum / Stats->NumOfProcessedBuffers * 1000.0, Stats->MaxLatency * 1000.0);
+			}
+		}));
+}
 
 UCapturableSoundWave::UCapturableSoundWave(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -14,10 +128,11 @@ UCapturableSoundWave::UCapturableSoundWave(const FObjectInitializer& ObjectIniti
 
 void UCapturableSoundWave::BeginDestroy()
 {
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
-	AudioCapture.AbortStream();
-	AudioCapture.CloseStream();
-#endif
+	if (CaptureSource)
+	{
+		CaptureSource->CloseStream();
+		CaptureSource.Reset();
+	}
 
 	Super::BeginDestroy();
 }
@@ -80,23 +195,40 @@ void UCapturableSoundWave::GetAvailableAudioInputDevices(const FOnGetAvailableAu
 #endif
 }
 
+void UCapturableSoundWave::SetCaptureSource(TSharedPtr<IRuntimeAudioCaptureSource> InCaptureSource)
+{
+	if (CaptureSource && CaptureSource->IsStreamOpen())
+	{
+		CaptureSource->CloseStream();
+	}
+
+	CaptureSource = MoveTemp(InCaptureSource);
+	bCustomCaptureSource = CaptureSource.IsValid();
+}
+
 bool UCapturableSoundWave::StartCapture_Implementation(int32 DeviceId)
 {
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
-	Audio::FAudioCaptureDeviceParams Params = Audio::FAudioCaptureDeviceParams();
-	Params.DeviceIndex = DeviceId;
 	LastDeviceIndex = DeviceId;
 
-#if UE_VERSION_NEWER_THAN(5, 2, 9)
-	Audio::FOnAudioCaptureFunction
+	if (CaptureSource && CaptureSource->IsStreamOpen())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capture as the stream is already open"));
+		return false;
+	}
+
+	if (!bCustomCaptureSource)
+	{
+#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
+		CaptureSource = MakeShared<FRuntimeDeviceCaptureSource>(DeviceId, 1024);
 #else
-	Audio::FOnCaptureFunction
-#endif
-	OnCapture = [WeakThis = MakeWeakObjectPtr(this)](const void* PCMData, int32 NumFrames, int32 NumOfChannels,
-#if UE_VERSION_NEWER_THAN(4, 25, 0)
-	                   int32 InSampleRate,
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capturing as its support is disabled (please enable in RuntimeAudioImporter.Build.cs)"));
+		return false;
 #endif
-	                   double StreamTime, bool bOverFlow)
+	}
+
+	PrepareCaptureBuffer_Internal();
+
+	if (!CaptureSource->OpenStream([WeakThis = MakeWeakObjectPtr(this)](const float* PCMData, int32 NumOfFrames, int32 NumOfChannels, int32 InSampleRate)
 	{
 		if (!WeakThis.IsValid())
 		{
@@ -104,74 +236,33 @@ bool UCapturableSoundWave::StartCapture_Implementation(int32 DeviceId)
 			return;
 		}
 
-		if (WeakThis->AudioCapture.IsCapturing())
-		{
-			const int64 PCMDataSize = NumOfChannels * NumFrames;
-			int64 PCMDataSizeInBytes = PCMDataSize * sizeof(float);
-
-			if (PCMDataSizeInBytes > TNumericLimits<int32>::Max())
-			{
-				UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Unable to append audio data as the size of the data exceeds the maximum size of int32 (PCMDataSizeInBytes: %lld, Max: %d)"), PCMDataSizeInBytes, TNumericLimits<int32>::Max());
-				PCMDataSizeInBytes = TNumericLimits<int32>::Max();
-			}
-
-			WeakThis->AppendAudioDataFromRAW(TArray<uint8>(reinterpret_cast<const uint8*>(PCMData), static_cast<int32>(PCMDataSizeInBytes)), ERuntimeRAWAudioFormat::Float32,
-#if UE_VERSION_NEWER_THAN(4, 25, 0)
-				InSampleRate
-#else
-				WeakThis->AudioCapture.GetSampleRate()
-#endif
-			  , NumOfChannels);
-		}
-	};
-
-	if (AudioCapture.IsStreamOpen())
-	{
-		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capture as the stream is already open"));
-		return false;
-	}
-
-	if (!AudioCapture.
-#if UE_VERSION_NEWER_THAN(5, 2, 9)
-		OpenAudioCaptureStream
-#else
-		OpenCaptureStream
-#endif
-		(Params, MoveTemp(OnCapture), 1024))
+		WeakThis->WriteCapturedAudio_Internal(PCMData, NumOfFrames, NumOfChannels, InSampleRate);
+	}))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open capturing stream for sound wave %s"), *GetName());
 		return false;
 	}
 
-	if (!AudioCapture.StartStream())
+	if (!CaptureSource->StartStream())
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capturing for sound wave %s"), *GetName());
 		return false;
 	}
 
-	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully started capturing for sound wave %s"), *GetName());
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully started capturing from %s for sound wave %s"), *CaptureSource->GetDescription(), *GetName());
 	return true;
-#else
-	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capturing as its support is disabled (please enable in RuntimeAudioImporter.Build.cs)"));
-	return false;
-#endif
 }
 
 void UCapturableSoundWave::StopCapture_Implementation()
 {
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
-	if (AudioCapture.IsStreamOpen())
+	if (CaptureSource && CaptureSource->IsStreamOpen())
 	{
-		AudioCapture.CloseStream();
+		CaptureSource->CloseStream();
 	}
-#else
-	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to stop capturing as its support is disabled (please enable in RuntimeAudioImporter.Build.cs)"));
-#endif
 }
 
 bool UCapturableSoundWave::ToggleMute_Implementation(bool bMute)
 {
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
 #if UE_VERSION_NEWER_THAN(5, 2, 9) || PLATFORM_ANDROID
 	if (bMute)
 	{
@@ -183,19 +274,19 @@ bool UCapturableSoundWave::ToggleMute_Implementation(bool bMute)
 		return StartCapture(LastDeviceIndex);
 	}
 #else
-	if (!AudioCapture.IsStreamOpen())
+	if (!CaptureSource || !CaptureSource->IsStreamOpen())
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to toggle mute for %s as the stream is not open"), *GetName());
 		return false;
 	}
 	if (bMute)
 	{
-		if (!AudioCapture.IsCapturing())
+		if (!CaptureSource->IsCapturing())
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to mute as the stream for %s is already closed"), *GetName());
 			return false;
 		}
-		if (!AudioCapture.StopStream())
+		if (!CaptureSource->StopStream())
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to mute the stream for sound wave %s"), *GetName());
 			return false;
@@ -205,12 +296,12 @@ bool UCapturableSoundWave::ToggleMute_Implementation(bool bMute)
 	}
 	else
 	{
-		if (AudioCapture.IsCapturing())
+		if (CaptureSource->IsCapturing())
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to unmute as the stream for %s is already open"), *GetName());
 			return false;
 		}
-		if (!AudioCapture.StartStream())
+		if (!CaptureSource->StartStream())
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to unmute the stream for sound wave %s"), *GetName());
 			return false;
@@ -219,18 +310,194 @@ bool UCapturableSoundWave::ToggleMute_Implementation(bool bMute)
 		return true;
 	}
 #endif
-#else
-	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to toggle mute as its support is disabled (please enable in RuntimeAudioImporter.Build.cs)"));
-	return false;
+}
+
+void UCapturableSoundWave::PrepareCaptureBuffer_Internal()
+{
+	// The data left from the previous capture has to be processed with its own format before the new capture starts writing
+	if (bCaptureProcessingScheduled || CaptureBuffer.GetNumOfReadableSamples() > 0)
+	{
+		AudioTaskPipe->WaitUntilEmpty();
+	}
+
+	// The capture buffer is allocated once and reused by all subsequent captures
+	if (CaptureBuffer.GetCapacity() == 0)
+	{
+		CaptureBuffer.Init(CaptureBufferNumOfSamples);
+	}
+}
+
+void UCapturableSoundWave::WriteCapturedAudio_Internal(const float* PCMData, int32 NumOfFrames, int32 InNumOfChannels, int32 InSampleRate)
+{
+	if (!PCMData || NumOfFrames <= 0 || InNumOfChannels <= 0 || InSampleRate <= 0)
+	{
+		return;
+	}
+
+	CaptureSampleRate.store(InSampleRate, std::memory_order_relaxed);
+	CaptureNumOfChannels.store(InNumOfChannels, std::memory_order_relaxed);
+
+	// Overflow is counted by the capture buffer and reported when the data is processed
+	CaptureBuffer.Write(PCMData, static_cast<int64>(NumOfFrames) * InNumOfChannels);
+
+	if (CaptureBlockNumOfFrames > 0 && CaptureBuffer.GetNumOfReadableSamples() < static_cast<int64>(CaptureBlockNumOfFrames) * InNumOfChannels)
+	{
+		return;
+	}
+
+	// A single processing task handles all the data written until it starts
+	if (!bCaptureProcessingScheduled.exchange(true))
+	{
+		AudioTaskPipe->Launch(AudioTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ProcessCapturedAudio_Internal();
+			}
+			else
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to process captured audio data as the capturable sound wave has been destroyed"));
+			}
+		}, UE::Tasks::ETaskPriority::BackgroundHigh);
+	}
+}
+
+void UCapturableSoundWave::ProcessCapturedAudio_Internal(bool bFlush)
+{
+	// Cleared before reading, so that the data written from now on schedules another processing
+	if (!bFlush)
+	{
+		bCaptureProcessingScheduled.store(false);
+	}
+
+	int64 NumOfSamples = CaptureBuffer.GetNumOfReadableSamples();
+	const int32 InSampleRate = CaptureSampleRate.load(std::memory_order_relaxed);
+	const int32 InNumOfChannels = CaptureNumOfChannels.load(std::memory_order_relaxed);
+
+	// Only whole blocks are handed over, the rest waits for more data unless flushing
+	if (CaptureBlockNumOfFrames > 0 && InNumOfChannels > 0 && !bFlush)
+	{
+		const int64 BlockNumOfSamples = static_cast<int64>(CaptureBlockNumOfFrames) * InNumOfChannels;
+		NumOfSamples -= NumOfSamples % BlockNumOfSamples;
+	}
+
+	if (const int64 NumOfDroppedSamples = CaptureBuffer.ExchangeNumOfDroppedSamples())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Dropped %lld captured samples for sound wave %s as the processing of the captured audio data fell behind"), NumOfDroppedSamples, *GetName());
+	}
+
+	if (NumOfSamples <= 0 || InSampleRate <= 0 || InNumOfChannels <= 0)
+	{
+		return;
+	}
+
+	// The data is handed over in whole blocks, or in spans of whole frames if it is not processed in blocks
+	const int32 UnitNumOfSamples = CaptureBlockNumOfFrames > 0 ? CaptureBlockNumOfFrames * InNumOfChannels : InNumOfChannels;
+
+	TArrayView<const float> FirstPCMData, SecondPCMData;
+	CaptureBuffer.Peek(NumOfSamples, FirstPCMData, SecondPCMData);
+
+	// A unit may be split by the end of the capture buffer. It is reassembled in the stitch buffer, which keeps its allocation between processings
+	CaptureStitchBuffer.Reset();
+	const int32 NumOfSplitSamples = FirstPCMData.Num() % UnitNumOfSamples;
+	if (NumOfSplitSamples > 0 && SecondPCMData.Num() > 0)
+	{
+		const int32 NumOfStitchedSamples = FMath::Min(UnitNumOfSamples - NumOfSplitSamples, SecondPCMData.Num());
+		CaptureStitchBuffer.Append(FirstPCMData.Right(NumOfSplitSamples));
+		CaptureStitchBuffer.Append(SecondPCMData.Left(NumOfStitchedSamples));
+		FirstPCMData = FirstPCMData.LeftChop(NumOfSplitSamples);
+		SecondPCMData = SecondPCMData.RightChop(NumOfStitchedSamples);
+	}
+
+	auto ProcessPCMData = [this, InSampleRate, InNumOfChannels, UnitNumOfSamples](TArrayView<const float> PCMData)
+	{
+		const int32 NumOfSamplesPerSpan = CaptureBlockNumOfFrames > 0 ? UnitNumOfSamples : PCMData.Num();
+		for (int32 SpanOffset = 0; SpanOffset < PCMData.Num(); SpanOffset += NumOfSamplesPerSpan)
+		{
+			const TArrayView<const float> Span = PCMData.Mid(SpanOffset, NumOfSamplesPerSpan);
+
+			{
+				FRAIScopeLock Lock(&OnPopulateAudioData_DataGuard);
+				OnCaptureAudioDataNative.Broadcast(Span, InSampleRate, InNumOfChannels);
+			}
+
+#if WITH_RUNTIMEAUDIOIMPORTER_VAD_SUPPORT
+			if (VADInstance && !VADInstance->ProcessVAD(Span, InSampleRate, InNumOfChannels))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("VAD detected silence, skipping audio data append"));
+				continue;
+			}
 #endif
+
+			AppendCapturedAudio_Internal(Span, InSampleRate, InNumOfChannels);
+		}
+	};
+
+	ProcessPCMData(FirstPCMData);
+	ProcessPCMData(CaptureStitchBuffer);
+	ProcessPCMData(SecondPCMData);
+
+	CaptureBuffer.Consume(NumOfSamples);
+}
+
+void UCapturableSoundWave::AppendCapturedAudio_Internal(TArrayView<const float> PCMData, int32 InSampleRate, int32 InNumOfChannels)
+{
+	bool bFormatMatches;
+	{
+		FRAIScopeLock Lock(&*DataGuard);
+
+		const bool bHasPreviouslyPopulatedRealPCMData = PCMBufferInfo->PCMData.GetView().Num() > 0;
+		bFormatMatches = bHasPreviouslyPopulatedRealPCMData
+			? InSampleRate == SampleRate && InNumOfChannels == NumChannels
+			: !InitialDesiredSampleRate.IsSet() && !InitialDesiredNumOfChannels.IsSet();
+
+		// The captured data is already in the format of the sound wave, so it is appended as is
+		if (bFormatMatches)
+		{
+			if (!bHasPreviouslyPopulatedRealPCMData)
+			{
+				SetSampleRate(InSampleRate);
+				NumChannels = InNumOfChannels;
+			}
+
+			FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal();
+			if (!MutablePCMBufferInfo.PCMData.ReserveForAppend(PCMData.Num()))
+			{
+				return;
+			}
+			MutablePCMBufferInfo.PCMData.Append(PCMData.GetData(), PCMData.Num());
+
+			const int32 NumOfFrames = PCMData.Num() / InNumOfChannels;
+			MutablePCMBufferInfo.PCMNumOfFrames += NumOfFrames;
+			Duration += static_cast<float>(NumOfFrames) / InSampleRate;
+			ResetPlaybackFinish();
+		}
+	}
+
+	if (bFormatMatches)
+	{
+		BroadcastPopulatedAudioData_Internal(PCMData);
+		return;
+	}
+
+	// Otherwise the data is resampled and mixed the same way as any other appended data
+	FDecodedAudioStruct DecodedAudioInfo;
+	{
+		const int64 PCMDataSizeInBytes = PCMData.Num() * sizeof(float);
+		DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(static_cast<float*>(FMemory::Memcpy(FMemory::Malloc(PCMDataSizeInBytes), PCMData.GetData(), PCMDataSizeInBytes)), PCMData.Num());
+		DecodedAudioInfo.PCMInfo.PCMNumOfFrames = PCMData.Num() / InNumOfChannels;
+		DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels = InNumOfChannels;
+		DecodedAudioInfo.SoundWaveBasicInfo.SampleRate = InSampleRate;
+		DecodedAudioInfo.SoundWaveBasicInfo.Duration = static_cast<float>(DecodedAudioInfo.PCMInfo.PCMNumOfFrames) / InSampleRate;
+	}
+
+	if (AppendDecodedAudio_Internal(DecodedAudioInfo))
+	{
+		BroadcastPopulatedAudioData_Internal(TArrayView<const float>(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), static_cast<int32>(DecodedAudioInfo.PCMInfo.PCMData.GetView().Num())));
+	}
 }
 
 bool UCapturableSoundWave::IsCapturing_Implementation() const
 {
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
-	return AudioCapture.IsCapturing();
-#else
-	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to get capturing state as its support is disabled (please enable in RuntimeAudioImporter.Build.cs)"));
-	return false;
-#endif
+	return CaptureSource && CaptureSource->IsCapturing();
 }
@@ -0,0 +1,410 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Sound/DiskStreamedSoundWave.h"
+#include "RuntimeAudioImporterDefines.h"
+#include "Codecs/RuntimeCodecFactory.h"
+
+#include "Async/Async.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+namespace
+{
+	/** The number of frames decoded per decoder call when filling the window */
+	constexpr int64 NumOfFramesPerDecodeBlock = 8192;
+}
+
+UDiskStreamedSoundWave::UDiskStreamedSoundWave(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+  , WindowStartFrame(0)
+  , SeekGeneration(0)
+  , bPrefetchScheduled(false)
+  , StreamingWindowDuration(4)
+{
+	DecodeTaskPipe = MakeUnique<UE::Tasks::FPipe>(*FString::Printf(TEXT("DecodeTaskPipe_%s"), *GetName()));
+	ensureMsgf(DecodeTaskPipe, TEXT("DecodeTaskPipe is not initialized. This will cause issues with disk streaming"));
+}
+
+UDiskStreamedSoundWave* UDiskStreamedSoundWave::CreateDiskStreamedSoundWave()
+{
+	if (!IsInGameThread())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to create a sound wave outside of the game thread"));
+		return nullptr;
+	}
+
+	return NewObject<UDiskStreamedSoundWave>();
+}
+
+void UDiskStreamedSoundWave::OpenAudioFile(const FString& FilePath, ERuntimeAudioFormat AudioFormat, const FOnOpenAudioFileResult& Result)
+{
+	OpenAudioFile(FilePath, AudioFormat, FOnOpenAudioFileResultNative::CreateWeakLambda(this, [Result](bool bSucceeded)
+	{
+		Result.ExecuteIfBound(bSucceeded);
+	}));
+}
+
+void UDiskStreamedSoundWave::OpenAudioFile(const FString& FilePath, ERuntimeAudioFormat AudioFormat, const FOnOpenAudioFileResultNative& Result)
+{
+	if (IsInGameThread())
+	{
+		DecodeTaskPipe->Launch(DecodeTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this), FilePath, AudioFormat, Result]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->OpenAudioFile(FilePath, AudioFormat, Result);
+			}
+			else
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to open the audio file '%s' for disk streaming as the sound wave has been destroyed"), *FilePath);
+			}
+		}, UE::Tasks::ETaskPriority::BackgroundHigh);
+		return;
+	}
+
+	auto ExecuteResult = [Result](bool bSucceeded)
+	{
+		AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded]()
+		{
+			Result.ExecuteIfBound(bSucceeded);
+		});
+	};
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+	if (AudioFormat == ERuntimeAudioFormat::Auto || AudioFormat == ERuntimeAudioFormat::Invalid)
+	{
+		FRuntimeCodecFactory CodecFactory;
+		const TArray<FBaseRuntimeCodec*> Codecs = CodecFactory.GetCodecs(FilePath);
+		if (Codecs.Num() == 0)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to determine the audio format of '%s' for disk streaming"), *FilePath);
+			ExecuteResult(false);
+			return;
+		}
+		AudioFormat = Codecs[0]->GetAudioFormat();
+	}
+
+	const TSharedRef<FRuntimeAudioFileStreamSource, ESPMode::ThreadSafe> FileSource = MakeShared<FRuntimeAudioFileStreamSource, ESPMode::ThreadSafe>(FilePath);
+	if (!FileSource->IsValid())
+	{
+		ExecuteResult(false);
+		return;
+	}
+
+	TUniquePtr<FRuntimeStreamingDecoder> NewDecoder = FRuntimeStreamingDecoder::Create(AudioFormat, FileSource);
+	if (!NewDecoder.IsValid() || NewDecoder->Open() != ERuntimeStreamingDecodeResult::Succeeded)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to open the audio file '%s' for disk streaming"), *FilePath);
+		ExecuteResult(false);
+		return;
+	}
+
+	// The length is needed for the duration and for seeking, and a complete file always allows it to be determined
+	const int64 TotalNumOfFrames = NewDecoder->GetTotalNumOfFrames();
+	if (TotalNumOfFrames <= 0 || TotalNumOfFrames > TNumericLimits<uint32>::Max())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to determine a valid length of the audio file '%s' for disk streaming"), *FilePath);
+		ExecuteResult(false);
+		return;
+	}
+
+	Decoder = MoveTemp(NewDecoder);
+
+	{
+		FRAIScopeLock Lock(&*DataGuard);
+		StreamedFilePath = FilePath;
+		ImportedAudioFormat = AudioFormat;
+		SetSampleRate(Decoder->GetSampleRate());
+		NumChannels = Decoder->GetNumOfChannels();
+
+		// The total number of frames is kept in the PCM buffer info, so that the playback state functions work as usual, but the PCM data itself is not resident
+		FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal(false);
+		MutablePCMBufferInfo.PCMData.Empty();
+		MutablePCMBufferInfo.PCMNumOfFrames = static_cast<uint32>(TotalNumOfFrames);
+		Duration = static_cast<float>(TotalNumOfFrames) / Decoder->GetSampleRate();
+
+		WindowPCMData.Reset();
+		WindowStartFrame = 0;
+		PlayedNumOfFrames = 0;
+		++SeekGeneration;
+		bPrefetchScheduled = true;
+		ResetPlaybackFinish();
+	}
+
+	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Opened the audio file '%s' for disk streaming (format: %s, duration: %f, window: %f seconds)"), *FilePath, *UEnum::GetValueAsString(AudioFormat), Duration, StreamingWindowDuration);
+
+	// Already running in the decode task pipe, so the first window is decoded right away
+	PrefetchWindow();
+	ExecuteResult(true);
+#else
+	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the audio file '%s' for disk streaming because file operation support is disabled"), *FilePath);
+	ExecuteResult(false);
+#endif
+}
+
+void UDiskStreamedSoundWave::SetStreamingWindowDuration(float WindowDuration)
+{
+	FRAIScopeLock Lock(&*DataGuard);
+	StreamingWindowDuration = FMath::Max(WindowDuration, 0.1f);
+	SchedulePrefetch_Internal();
+}
+
+FString UDiskStreamedSoundWave::GetStreamedFilePath() const
+{
+	FRAIScopeLock Lock(&*DataGuard);
+	return StreamedFilePath;
+}
+
+bool UDiskStreamedSoundWave::IsReadyForFinishDestroy()
+{
+	// The decode tasks access the window and the decoder, so they must complete before the memory is released
+	return Super::IsReadyForFinishDestroy() && (!DecodeTaskPipe || !DecodeTaskPipe->HasWork());
+}
+
+int32 UDiskStreamedSoundWave::OnGeneratePCMAudio(TArray<uint8>& OutAudio, int32 NumSamples)
+{
+	int32 NumOfCopiedSamples = 0;
+	{
+		FRAIScopeLock Lock(&*DataGuard);
+
+		if (NumChannels <= 0 || PCMBufferInfo->PCMNumOfFrames == 0)
+		{
+			return 0;
+		}
+
+		// Lack of frames means audio playback has finished
+		const int64 NumOfPlayedFrames = GetNumOfPlayedFrames_Internal();
+		if (NumOfPlayedFrames >= PCMBufferInfo->PCMNumOfFrames)
+		{
+			return 0;
+		}
+
+		const int64 NumOfRequestedFrames = FMath::Min<int64>(NumSamples / NumChannels, PCMBufferInfo->PCMNumOfFrames - NumOfPlayedFrames);
+		NumSamples = static_cast<int32>(NumOfRequestedFrames * NumChannels);
+
+		OutAudio.Reset(NumSamples * sizeof(float));
+		OutAudio.AddZeroed(NumSamples * sizeof(float));
+
+		const int64 NumOfWindowFrames = WindowPCMData.Num() / NumChannels;
+		const int64 WindowOffset = NumOfPlayedFrames - WindowStartFrame;
+		const int64 NumOfAvailableFrames = FMath::Clamp<int64>(NumOfWindowFrames - WindowOffset, 0, NumOfRequestedFrames);
+
+		if (NumOfAvailableFrames > 0)
+		{
+			NumOfCopiedSamples = static_cast<int32>(NumOfAvailableFrames * NumChannels);
+			FMemory::Memcpy(OutAudio.GetData(), WindowPCMData.GetData() + WindowOffset * NumChannels, NumOfCopiedSamples * sizeof(float));
+			SetNumOfPlayedFrames_Internal(static_cast<uint32>(NumOfPlayedFrames + NumOfAvailableFrames));
+		}
+
+		// On underrun, silence is output without advancing the playback position, so no audio is skipped once the decoder catches up
+		if (NumOfAvailableFrames < NumOfRequestedFrames)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Disk-streamed sound wave '%s' underrun: %lld of %lld frames available"), *GetName(), NumOfAvailableFrames, NumOfRequestedFrames);
+		}
+
+		// Evicting the played part of the window in batches of half a second to avoid shifting the window on every callback
+		const int64 NumOfFramesToEvict = GetNumOfPlayedFrames_Internal() - WindowStartFrame;
+		if (NumOfFramesToEvict >= SampleRate / 2)
+		{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+			WindowPCMData.RemoveAt(0, static_cast<int32>(NumOfFramesToEvict * NumChannels), false);
+#else
+			WindowPCMData.RemoveAt(0, static_cast<int32>(NumOfFramesToEvict * NumChannels), EAllowShrinking::No);
+#endif
+			WindowStartFrame += NumOfFramesToEvict;
+		}
+
+		SchedulePrefetch_Internal();
+	}
+
+	const bool IsBound = [this]()
+	{
+		FRAIScopeLock Lock(&OnGeneratePCMData_DataGuard);
+		return OnGeneratePCMDataNative.IsBound() || OnGeneratePCMData.IsBound();
+	}();
+	if (IsBound && NumOfCopiedSamples > 0)
+	{
+		TArray<float> PCMData(reinterpret_cast<const float*>(OutAudio.GetData()), NumOfCopiedSamples);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), PCMData = MoveTemp(PCMData)]() mutable
+		{
+			if (WeakThis.IsValid())
+			{
+				FRAIScopeLock Lock(&WeakThis->OnGeneratePCMData_DataGuard);
+				if (WeakThis->OnGeneratePCMDataNative.IsBound())
+				{
+					WeakThis->OnGeneratePCMDataNative.Broadcast(PCMData);
+				}
+
+				if (WeakThis->OnGeneratePCMData.IsBound())
+				{
+					WeakThis->OnGeneratePCMData.Broadcast(PCMData);
+				}
+			}
+		});
+	}
+
+	return NumSamples;
+}
+
+void UDiskStreamedSoundWave::DuplicateSoundWave(bool bUseSharedAudioBuffer, const FOnDuplicateSoundWaveNative& Result)
+{
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), bUseSharedAudioBuffer, Result]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->DuplicateSoundWave(bUseSharedAudioBuffer, Result);
+			}
+			else
+			{
+				Result.ExecuteIfBound(false, nullptr);
+			}
+		});
+		return;
+	}
+
+	// There is no resident audio buffer to share, so the duplicate streams the same file with its own decoder
+	UDiskStreamedSoundWave* DuplicatedSoundWave = NewObject<UDiskStreamedSoundWave>(GetOuter());
+	if (!DuplicatedSoundWave)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to duplicate the disk-streamed sound wave '%s'"), *GetName());
+		Result.ExecuteIfBound(false, nullptr);
+		return;
+	}
+
+	DuplicatedSoundWave->bStopSoundOnPlaybackFinish = bStopSoundOnPlaybackFinish;
+	DuplicatedSoundWave->bLooping = bLooping;
+	DuplicatedSoundWave->StreamingWindowDuration = StreamingWindowDuration;
+	DuplicatedSoundWave->OpenAudioFile(GetStreamedFilePath(), ImportedAudioFormat, FOnOpenAudioFileResultNative::CreateLambda([DuplicatedSoundWave = MakeWeakObjectPtr(DuplicatedSoundWave), Result](bool bSucceeded)
+	{
+		Result.ExecuteIfBound(bSucceeded && DuplicatedSoundWave.IsValid(), bSucceeded ? DuplicatedSoundWave.Get() : nullptr);
+	}));
+}
+
+void UDiskStreamedSoundWave::ReleaseMemory()
+{
+	{
+		FRAIScopeLock Lock(&*DataGuard);
+		WindowPCMData.Empty();
+		WindowStartFrame = 0;
+		++SeekGeneration;
+		StreamedFilePath.Empty();
+	}
+	Super::ReleaseMemory();
+
+	DecodeTaskPipe->Launch(DecodeTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]()
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->Decoder.Reset();
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundHigh);
+}
+
+bool UDiskStreamedSoundWave::SetNumOfPlayedFrames_Internal(uint32 NumOfFrames)
+{
+	if (!Super::SetNumOfPlayedFrames_Internal(NumOfFrames))
+	{
+		return false;
+	}
+
+	// Outside of the decoded window the decoder has to seek, and everything decoded so far is no longer needed
+	const int64 NumOfWindowFrames = NumChannels > 0 ? WindowPCMData.Num() / NumChannels : 0;
+	if (NumOfFrames < WindowStartFrame || NumOfFrames > WindowStartFrame + NumOfWindowFrames)
+	{
+		WindowPCMData.Reset();
+		WindowStartFrame = NumOfFrames;
+		++SeekGeneration;
+	}
+
+	SchedulePrefetch_Internal();
+	return true;
+}
+
+void UDiskStreamedSoundWave::SchedulePrefetch_Internal()
+{
+	if (bPrefetchScheduled || NumChannels <= 0 || PCMBufferInfo->PCMNumOfFrames == 0)
+	{
+		return;
+	}
+
+	// Refilling once less than half of the window is left ahead of the playback position
+	const int64 WindowEndFrame = WindowStartFrame + WindowPCMData.Num() / NumChannels;
+	if (WindowEndFrame >= PCMBufferInfo->PCMNumOfFrames || WindowEndFrame - GetNumOfPlayedFrames_Internal() > GetWindowCapacity() / 2)
+	{
+		return;
+	}
+
+	bPrefetchScheduled = true;
+	DecodeTaskPipe->Launch(DecodeTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]()
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->PrefetchWindow();
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundHigh);
+}
+
+void UDiskStreamedSoundWave::PrefetchWindow()
+{
+	TArray<float> BlockPCMData;
+
+	while (true)
+	{
+		int64 DecodeFromFrame;
+		int64 NumOfFramesToDecode;
+		uint32 Generation;
+		{
+			FRAIScopeLock Lock(&*DataGuard);
+			const int64 WindowEndFrame = NumChannels > 0 ? WindowStartFrame + WindowPCMData.Num() / NumChannels : 0;
+			const int64 TargetFrame = FMath::Min<int64>(GetNumOfPlayedFrames_Internal() + GetWindowCapacity(), PCMBufferInfo->PCMNumOfFrames);
+			if (!Decoder.IsValid() || WindowEndFrame >= TargetFrame)
+			{
+				bPrefetchScheduled = false;
+				return;
+			}
+
+			DecodeFromFrame = WindowEndFrame;
+			NumOfFramesToDecode = FMath::Min<int64>(NumOfFramesPerDecodeBlock, TargetFrame - WindowEndFrame);
+			Generation = SeekGeneration;
+		}
+
+		// Decoding outside of the data guard, so that the audio render thread is never blocked by the codec
+		if (Decoder->GetFramePosition() != DecodeFromFrame && !Decoder->Seek(DecodeFromFrame))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to seek the disk-streamed sound wave '%s' to frame %lld"), *GetName(), DecodeFromFrame);
+			FRAIScopeLock Lock(&*DataGuard);
+			bPrefetchScheduled = false;
+			return;
+		}
+
+		BlockPCMData.SetNumUninitialized(static_cast<int32>(NumOfFramesToDecode * Decoder->GetNumOfChannels()));
+		int64 NumOfDecodedFrames = 0;
+		Decoder->DecodeFrames(BlockPCMData.GetData(), NumOfFramesToDecode, NumOfDecodedFrames);
+
+		FRAIScopeLock Lock(&*DataGuard);
+
+		// A seek outside of the window happened while decoding, so the block belongs to the old position
+		if (Generation != SeekGeneration)
+		{
+			continue;
+		}
+
+		if (NumOfDecodedFrames <= 0)
+		{
+			// The stream ended before the length reported by its header, so the playback should end there as well
+			UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Disk-streamed sound wave '%s' ended at frame %lld instead of %u"), *GetName(), DecodeFromFrame, PCMBufferInfo->PCMNumOfFrames);
+			GetMutablePCMBuffer_Internal().PCMNumOfFrames = static_cast<uint32>(DecodeFromFrame);
+			Duration = static_cast<float>(DecodeFromFrame) / SampleRate;
+			bPrefetchScheduled = false;
+			return;
+		}
+
+		WindowPCMData.Append(BlockPCMData.GetData(), static_cast<int32>(NumOfDecodedFrames * NumChannels));
+	}
+}
+
+int64 UDiskStreamedSoundWave::GetWindowCapacity() const
+{
+	return FMath::Max<int64>(static_cast<int64>(StreamingWindowDuration * SampleRate), NumOfFramesPerDecodeBlock);
+}
@@ -15,9 +15,24 @@
 #endif
 #if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
 #include "Codecs/VORBIS_RuntimeCodec.h"
+#include "Codecs/WAV_RuntimeCodec.h"
+#include "MetaSound/MetasoundResourceCache.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryWriter.h"
 #endif
 #include "Codecs/RAW_RuntimeCodec.h"
 
+#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
+namespace
+{
+	int32 MaxMetaSoundsPCMResourceMB = 16;
+	FAutoConsoleVariableRef CVarMaxMetaSoundsPCMResource(
+		TEXT("RuntimeAudioImporter.MetaSounds.MaxPCMResourceMB"),
+		MaxMetaSoundsPCMResourceMB,
+		TEXT("Largest size in MB of the 16-bit PCM data of a sound wave prepared for MetaSounds without encoding. Larger sound waves are encoded to Vorbis to save memory"));
+}
+#endif
+
 UImportedSoundWave::UImportedSoundWave(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
   , DataGuard(MakeShared<FCriticalSection>())
@@ -92,16 +107,18 @@ void UImportedSoundWave::DuplicateSoundWave(bool bUseSharedAudioBuffer, const FO
 	}
 	DuplicatedSoundWave->SetInternalFlags(EInternalObjectFlags::Async);
 	FRAIScopeLock Lock(&*DataGuard);
+
+	// A shared buffer is never modified in place, so the duplicate keeps its own data guard and playback state
 	DuplicatedSoundWave->PCMBufferInfo = bUseSharedAudioBuffer ? PCMBufferInfo : MakeShared<FPCMStruct>(*PCMBufferInfo);
 	DuplicatedSoundWave->bStopSoundOnPlaybackFinish = bStopSoundOnPlaybackFinish;
 	DuplicatedSoundWave->ImportedAudioFormat = ImportedAudioFormat;
 	DuplicatedSoundWave->Duration = Duration;
 	DuplicatedSoundWave->SetSampleRate(GetSampleRate());
 	DuplicatedSoundWave->NumChannels = NumChannels;
-	if (bUseSharedAudioBuffer)
-	{
-		DuplicatedSoundWave->DataGuard = DataGuard;
-	}
+	DuplicatedSoundWave->Volume = Volume;
+	DuplicatedSoundWave->Pitch = Pitch;
+	DuplicatedSoundWave->bLooping = bLooping;
+	DuplicatedSoundWave->VirtualizationMode = VirtualizationMode;
 	ExecuteResult(true, DuplicatedSoundWave);
 }
 
@@ -117,7 +134,8 @@ TSharedPtr<Audio::IProxyData> UImportedSoundWave::CreateProxyData(const Audio::F
 	if (SoundWaveDataPtr)
 	{
 		SoundWaveDataPtr->InitializeDataFromSoundWave(*this);
-		SoundWaveDataPtr->OverrideRuntimeFormat(Audio::NAME_OGG);
+		FRAIScopeLock Lock(&*DataGuard);
+		SoundWaveDataPtr->OverrideRuntimeFormat(MetaSoundsRuntimeFormat.IsNone() ? Audio::NAME_OGG : MetaSoundsRuntimeFormat);
 	}
 	return USoundWave::CreateProxyData(InitParams);
 #else
@@ -137,17 +155,18 @@ TSharedPtr<Audio::IProxyData> UImportedSoundWave::CreateProxyData(const Audio::F
 	}
 
 	ProxyData_SoundWaveDataPtr->InitializeDataFromSoundWave(*this);
-	ProxyData_SoundWaveDataPtr->OverrideRuntimeFormat(Audio::NAME_OGG);
+	FRAIScopeLock Lock(&*DataGuard);
+	ProxyData_SoundWaveDataPtr->OverrideRuntimeFormat(MetaSoundsRuntimeFormat.IsNone() ? Audio::NAME_OGG : MetaSoundsRuntimeFormat);
 	return ProxyDataPtr;
 #endif
 }
 
 bool UImportedSoundWave::InitAudioResource(FName Format)
 {
-	// Only OGG format is supported for audio resource initialization
-	if (Format != Audio::NAME_OGG)
+	// The audio resource is either Vorbis encoded or 16-bit PCM, which the engine decodes without any additional codec
+	if (Format != Audio::NAME_OGG && Format != Audio::NAME_PCM)
 	{
-		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("RuntimeAudioImporter does not support audio format '%s' for initialization. Supported format: %s"), *Format.ToString(), *Audio::NAME_OGG.ToString());
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("RuntimeAudioImporter does not support audio format '%s' for initialization. Supported formats: %s, %s"), *Format.ToString(), *Audio::NAME_OGG.ToString(), *Audio::NAME_PCM.ToString());
 		return false;
 	}
 
@@ -163,44 +182,93 @@ bool UImportedSoundWave::InitAudioResource(FName Format)
 	}
 #endif
 
-	FDecodedAudioStruct DecodedAudioInfo;
+	// The PCM data is referenced rather than copied. Modifications of the sound wave during the preparation detach it from the referenced buffer
+	TSharedPtr<const FPCMStruct> PCMBuffer;
+	FSoundWaveBasicStruct SoundWaveBasicInfo;
 	{
 		FRAIScopeLock Lock(&*DataGuard);
-		{
-			DecodedAudioInfo.PCMInfo = GetPCMBuffer();
-			FSoundWaveBasicStruct SoundWaveBasicInfo;
-			{
-				SoundWaveBasicInfo.NumOfChannels = NumChannels;
-				SoundWaveBasicInfo.SampleRate = GetSampleRate();
-				SoundWaveBasicInfo.Duration = Duration;
-			}
-			DecodedAudioInfo.SoundWaveBasicInfo = SoundWaveBasicInfo;
-		}
+		PCMBuffer = GetPCMBufferSnapshot_Internal();
+		SoundWaveBasicInfo.NumOfChannels = NumChannels;
+		SoundWaveBasicInfo.SampleRate = GetSampleRate();
+		SoundWaveBasicInfo.Duration = Duration;
 	}
 
-	FVORBIS_RuntimeCodec VorbisCodec;
-	FEncodedAudioStruct EncodedAudioInfo;
-	if (!VorbisCodec.Encode(MoveTemp(DecodedAudioInfo), EncodedAudioInfo, 100))
+	if (!PCMBuffer.IsValid() || !PCMBuffer->IsValid() || SoundWaveBasicInfo.NumOfChannels <= 0 || SoundWaveBasicInfo.SampleRate <= 0)
 	{
-		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong while encoding Vorbis audio data"));
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the audio resource for the sound wave '%s' as the PCM data is invalid"), *GetName());
 		return false;
 	}
 
-	if (EncodedAudioInfo.AudioData.GetView().Num() <= 0)
+	const int64 NumOfSamples = PCMBuffer->PCMData.GetView().Num();
+	FByteBulkData CompressedBulkData;
+
+	if (Format == Audio::NAME_PCM)
 	{
-		return false;
-	}
+		if (NumOfSamples * static_cast<int64>(sizeof(int16)) > TNumericLimits<uint32>::Max() - (FWAV_RuntimeCodec::HeaderSize - 8))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to initialize the PCM audio resource for the sound wave '%s' as the audio data exceeds the 4 GB limit of the format"), *GetName());
+			return false;
+		}
 
-	FByteBulkData CompressedBulkData;
+		// No encoding is needed, the samples are converted to 16-bit directly into the resource behind a WAV header
+		TArray<uint8> Header;
+		FMemoryWriter HeaderWriter(Header);
+		FWAV_RuntimeCodec::WriteHeader(HeaderWriter, static_cast<uint16>(SoundWaveBasicInfo.NumOfChannels), SoundWaveBasicInfo.SampleRate, static_cast<uint32>(NumOfSamples * sizeof(int16)));
 
-	// Filling in the compressed data
+		CompressedBulkData.Lock(LOCK_READ_WRITE);
+		uint8* ResourceData = static_cast<uint8*>(CompressedBulkData.Realloc(Header.Num() + NumOfSamples * sizeof(int16)));
+		FMemory::Memcpy(ResourceData, Header.GetData(), Header.Num());
+		FRAW_RuntimeCodec::TranscodeRAWDataToBuffer<float, int16>(PCMBuffer->PCMData.GetView().GetData(), NumOfSamples, reinterpret_cast<int16*>(ResourceData + Header.Num()));
+		CompressedBulkData.Unlock();
+	}
+	else
 	{
+		using namespace RuntimeAudioImporter;
+
+		// The encoded resource depends only on the PCM data, so it is shared between sound waves and sessions
+		const FString ContentHash = FMetasoundResourceCache::ComputeContentHash(*PCMBuffer, SoundWaveBasicInfo.NumOfChannels, SoundWaveBasicInfo.SampleRate, Format);
+
+		TArray64<uint8> ResourceData;
+		if (FMetasoundResourceCache::Get().Find(ContentHash, ResourceData))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Reusing the cached Vorbis audio resource '%s' for the sound wave '%s'"), *ContentHash, *GetName());
+		}
+		else
+		{
+			FDecodedAudioView DecodedAudioView;
+			DecodedAudioView.SoundWaveBasicInfo = SoundWaveBasicInfo;
+			DecodedAudioView.PCMData = PCMBuffer->PCMData.GetView();
+			DecodedAudioView.PCMNumOfFrames = PCMBuffer->PCMNumOfFrames;
+
+			FVORBIS_RuntimeCodec VorbisCodec;
+			FEncodedAudioStruct EncodedAudioInfo;
+			if (!VorbisCodec.Encode(DecodedAudioView, EncodedAudioInfo, 100))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Something went wrong while encoding Vorbis audio data"));
+				return false;
+			}
+
+			if (EncodedAudioInfo.AudioData.GetView().Num() <= 0)
+			{
+				return false;
+			}
+
+			ResourceData.Append(EncodedAudioInfo.AudioData.GetView().GetData(), EncodedAudioInfo.AudioData.GetView().Num());
+			FMetasoundResourceCache::Get().Add(ContentHash, ResourceData);
+		}
+
+		// Filling in the compressed data
 		CompressedBulkData.Lock(LOCK_READ_WRITE);
-		FMemory::Memcpy(CompressedBulkData.Realloc(EncodedAudioInfo.AudioData.GetView().Num()), EncodedAudioInfo.AudioData.GetView().GetData(), EncodedAudioInfo.AudioData.GetView().Num());
+		FMemory::Memcpy(CompressedBulkData.Realloc(ResourceData.Num()), ResourceData.GetData(), ResourceData.Num());
 		CompressedBulkData.Unlock();
 	}
 
 	USoundWave::InitAudioResource(CompressedBulkData);
+
+	{
+		FRAIScopeLock Lock(&*DataGuard);
+		MetaSoundsRuntimeFormat = Format;
+	}
 	return true;
 }
 
@@ -247,6 +315,7 @@ int32 UImportedSoundWave::OnGeneratePCMAudio(TArray<uint8>& OutAudio, int32 NumS
 
 		// Filling in OutAudio array with the retrieved PCM data
 		OutAudio = TArray<uint8>(reinterpret_cast<uint8*>(RetrievedPCMDataPtr), RetrievedPCMDataSize);
+		RetrievedPCMDataPtr = reinterpret_cast<float*>(OutAudio.GetData());
 
 		// Increasing the number of frames played
 		SetNumOfPlayedFrames_Internal(GetNumOfPlayedFrames_Internal() + (NumSamples / NumChannels));
@@ -387,8 +456,9 @@ void UImportedSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 	NumChannels = DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels;
 	ImportedAudioFormat = DecodedAudioInfo.SoundWaveBasicInfo.AudioFormat;
 
-	PCMBufferInfo->PCMData = MoveTemp(DecodedAudioInfo.PCMInfo.PCMData);
-	PCMBufferInfo->PCMNumOfFrames = DecodedAudioInfo.PCMInfo.PCMNumOfFrames;
+	FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal(false);
+	MutablePCMBufferInfo.PCMData = MoveTemp(DecodedAudioInfo.PCMInfo.PCMData);
+	MutablePCMBufferInfo.PCMNumOfFrames = DecodedAudioInfo.PCMInfo.PCMNumOfFrames;
 
 	{
 		const bool IsBound = [this]()
@@ -458,48 +528,106 @@ void UImportedSoundWave::PrepareSoundWaveForMetaSounds(const FOnPrepareSoundWave
 
 void UImportedSoundWave::PrepareSoundWaveForMetaSounds(const FOnPrepareSoundWaveForMetaSoundsResultNative& Result)
 {
-#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
-	if (IsInGameThread())
-	{
-		AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), Result]()
-		{
-			WeakThis->PrepareSoundWaveForMetaSounds(Result);
-		});
-		return;
-	}
-	
-	auto ExecuteResult = [Result](bool bSucceeded)
+	PrepareSoundWaveForMetaSoundsAsync().Next([Result](bool bSucceeded)
 	{
 		AsyncTask(ENamedThreads::GameThread, [Result, bSucceeded]()
 		{
 			Result.ExecuteIfBound(bSucceeded);
 		});
-	};
+	});
+}
+
+TFuture<bool> UImportedSoundWave::PrepareSoundWaveForMetaSoundsAsync()
+{
+#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
+	TSharedRef<TPromise<bool>> Promise = MakeShared<TPromise<bool>>();
+	TFuture<bool> Future = Promise->GetFuture();
 
-	const bool bSucceeded = InitAudioResource(Audio::NAME_OGG);
-	if (bSucceeded)
+	TSharedPtr<TArray<TSharedRef<TPromise<bool>>>> Preparation;
 	{
-		UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully prepared the sound wave '%s' for MetaSounds"), *GetName());
+		FRAIScopeLock Lock(&*DataGuard);
+
+		// Joining the preparation in progress instead of encoding the same data twice
+		if (PendingMetaSoundsPreparation.IsValid())
+		{
+			PendingMetaSoundsPreparation->Add(Promise);
+			return Future;
+		}
+
+		PendingMetaSoundsPreparation = MakeShared<TArray<TSharedRef<TPromise<bool>>>>();
+		PendingMetaSoundsPreparation->Add(Promise);
+		Preparation = PendingMetaSoundsPreparation;
 	}
-	else
+
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), DataGuard = DataGuard, Preparation]()
 	{
-		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to initialize audio resource to prepare the sound wave '%s' for MetaSounds"), *GetName());
-	}
+		bool bSucceeded = false;
+		if (UImportedSoundWave* ThisPtr = WeakThis.Get())
+		{
+			FName Format;
+			{
+				FRAIScopeLock Lock(&*DataGuard);
+				Format = ThisPtr->MetaSoundsRuntimeFormat.IsNone() ? ThisPtr->GetMetaSoundsRuntimeFormat_Internal() : ThisPtr->MetaSoundsRuntimeFormat;
+			}
 
-	ExecuteResult(bSucceeded);
-		
+			bSucceeded = ThisPtr->InitAudioResource(Format);
+			if (bSucceeded)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully prepared the sound wave '%s' for MetaSounds (%s)"), *ThisPtr->GetName(), *Format.ToString());
+			}
+			else
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to initialize audio resource to prepare the sound wave '%s' for MetaSounds"), *ThisPtr->GetName());
+			}
+		}
+		else
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to prepare the sound wave for MetaSounds because it has been destroyed"));
+		}
+
+		// The data guard is shared with the task, so the promises are taken over consistently even if the sound wave has been destroyed meanwhile
+		TArray<TSharedRef<TPromise<bool>>> Promises;
+		{
+			FRAIScopeLock Lock(&*DataGuard);
+			if (UImportedSoundWave* ThisPtr = WeakThis.Get())
+			{
+				if (ThisPtr->PendingMetaSoundsPreparation == Preparation)
+				{
+					ThisPtr->PendingMetaSoundsPreparation.Reset();
+				}
+			}
+			Promises = MoveTemp(*Preparation);
+		}
+
+		for (const TSharedRef<TPromise<bool>>& PendingPromise : Promises)
+		{
+			PendingPromise->SetValue(bSucceeded);
+		}
+	});
+
+	return Future;
 #else
 	UE_LOG(LogRuntimeAudioImporter, Error, TEXT("PrepareSoundWaveForMetaSounds works only for Unreal Engine version >= 5.3 and if explicitly enabled in RuntimeAudioImporter.Build.cs"));
-	Result.ExecuteIfBound(false);
+	return MakeFulfilledPromise<bool>(false).GetFuture();
 #endif
 }
 
+#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
+FName UImportedSoundWave::GetMetaSoundsRuntimeFormat_Internal() const
+{
+	const int64 PCMResourceSize = PCMBufferInfo.IsValid() ? PCMBufferInfo->PCMData.GetView().Num() * static_cast<int64>(sizeof(int16)) : 0;
+	const bool bFitsPCMResource = PCMResourceSize <= static_cast<int64>(MaxMetaSoundsPCMResourceMB) * 1024 * 1024 && PCMResourceSize <= TNumericLimits<uint32>::Max() - (FWAV_RuntimeCodec::HeaderSize - 8);
+	return bFitsPCMResource ? Audio::NAME_PCM : Audio::NAME_OGG;
+}
+#endif
+
 void UImportedSoundWave::ReleaseMemory()
 {
 	FRAIScopeLock Lock(&*DataGuard);
 	UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Releasing memory for the sound wave '%s'"), *GetName());
-	PCMBufferInfo->PCMData.Empty();
-	PCMBufferInfo->PCMNumOfFrames = 0;
+	FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal(false);
+	MutablePCMBufferInfo.PCMData.Empty();
+	MutablePCMBufferInfo.PCMNumOfFrames = 0;
 	Duration = 0;
 }
 
@@ -596,7 +724,7 @@ bool UImportedSoundWave::SetInitialDesiredNumOfChannels(int32 DesiredNumOfChanne
 	return true;
 }
 
-bool UImportedSoundWave::ResampleSoundWave(int32 NewSampleRate)
+bool UImportedSoundWave::ResampleSoundWave(int32 NewSampleRate, ERuntimeResamplingQuality Quality)
 {
 	if (NewSampleRate == GetSampleRate())
 	{
@@ -613,9 +741,7 @@ bool UImportedSoundWave::ResampleSoundWave(int32 NewSampleRate)
 	FRAIScopeLock Lock(&*DataGuard);
 
 	Audio::FAlignedFloatBuffer NewPCMData;
-	Audio::FAlignedFloatBuffer SourcePCMData = Audio::FAlignedFloatBuffer(PCMBufferInfo->PCMData.GetView().GetData(), PCMBufferInfo->PCMData.GetView().Num());
-
-	if (!FRAW_RuntimeCodec::ResampleRAWData(SourcePCMData, GetNumOfChannels(), GetSampleRate(), NewSampleRate, NewPCMData))
+	if (!FRAW_RuntimeCodec::ResampleRAWData(PCMBufferInfo->PCMData.GetView().GetData(), PCMBufferInfo->PCMData.GetView().Num(), GetNumOfChannels(), GetSampleRate(), NewSampleRate, NewPCMData, Quality))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to resample the imported sound wave '%s' from sample rate '%d' to sample rate '%d'"), *GetName(), GetSampleRate(), NewSampleRate);
 		return false;
@@ -624,8 +750,9 @@ bool UImportedSoundWave::ResampleSoundWave(int32 NewSampleRate)
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully resampled the imported sound wave '%s' from sample rate '%d' to sample rate '%d'"), *GetName(), GetSampleRate(), NewSampleRate);
 	SampleRate = NewSampleRate;
 	{
-		PCMBufferInfo->PCMNumOfFrames = NewPCMData.Num() / GetNumOfChannels();
-		PCMBufferInfo->PCMData = FRuntimeBulkDataBuffer<float>(NewPCMData);
+		FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal(false);
+		MutablePCMBufferInfo.PCMNumOfFrames = NewPCMData.Num() / GetNumOfChannels();
+		MutablePCMBufferInfo.PCMData = FRuntimeBulkDataBuffer<float>(NewPCMData);
 	}
 	return true;
 }
@@ -658,8 +785,9 @@ bool UImportedSoundWave::MixSoundWaveChannels(int32 NewNumOfChannels)
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully mixed the imported sound wave '%s' from number of channels '%d' to number of channels '%d'"), *GetName(), GetNumOfChannels(), NewNumOfChannels);
 	NumChannels = NewNumOfChannels;
 	{
-		PCMBufferInfo->PCMNumOfFrames = NewPCMData.Num() / GetNumOfChannels();
-		PCMBufferInfo->PCMData = FRuntimeBulkDataBuffer<float>(NewPCMData);
+		FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal(false);
+		MutablePCMBufferInfo.PCMNumOfFrames = NewPCMData.Num() / GetNumOfChannels();
+		MutablePCMBufferInfo.PCMData = FRuntimeBulkDataBuffer<float>(NewPCMData);
 	}
 	return true;
 }
@@ -771,7 +899,7 @@ void UImportedSoundWave::ReverseAudioBuffer(const FOnReverseAudioDataNative& Res
 	FRAW_RuntimeCodec::ReverseRAWData(PCMData);
 
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully reversed the audio buffer for the imported sound wave '%s'"), *GetName());
-	PCMBufferInfo->PCMData = FRuntimeBulkDataBuffer<float>(PCMData);
+	GetMutablePCMBuffer_Internal(false).PCMData = FRuntimeBulkDataBuffer<float>(PCMData);
 	ExecuteResult(true);
 }
 
@@ -984,6 +1112,41 @@ const FPCMStruct& UImportedSoundWave::GetPCMBuffer() const
 	return *PCMBufferInfo.Get();
 }
 
+TSharedPtr<const FPCMStruct> UImportedSoundWave::GetPCMBufferSnapshot_Internal() const
+{
+	return PCMBufferInfo;
+}
+
+bool UImportedSoundWave::IsAudioBufferShared() const
+{
+	FRAIScopeLock Lock(&*DataGuard);
+	return PCMBufferInfo.IsValid() && !PCMBufferInfo.IsUnique();
+}
+
+FPCMStruct& UImportedSoundWave::GetMutablePCMBuffer_Internal(bool bPreserveData)
+{
+	// Other sound waves may be reading the shared buffer under their own data guards, so it is detached instead of being modified in place
+	if (!PCMBufferInfo.IsValid() || !PCMBufferInfo.IsUnique())
+	{
+		if (!PCMBufferInfo.IsValid())
+		{
+			PCMBufferInfo = MakeShared<FPCMStruct>();
+		}
+		else if (bPreserveData)
+		{
+			PCMBufferInfo = MakeShared<FPCMStruct>(*PCMBufferInfo);
+		}
+		else
+		{
+			// Only the data is about to be replaced, so the metadata is carried over without copying the data itself
+			TSharedPtr<FPCMStruct> DetachedPCMBufferInfo = MakeShared<FPCMStruct>();
+			DetachedPCMBufferInfo->PCMNumOfFrames = PCMBufferInfo->PCMNumOfFrames;
+			PCMBufferInfo = MoveTemp(DetachedPCMBufferInfo);
+		}
+	}
+	return *PCMBufferInfo;
+}
+
 ERuntimeAudioFormat UImportedSoundWave::GetAudioFormat() const
 {
 	return ImportedAudioFormat;
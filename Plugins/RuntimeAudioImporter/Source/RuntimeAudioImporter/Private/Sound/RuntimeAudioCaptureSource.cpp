@@ -0,0 +1,423 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Sound/RuntimeAudioCaptureSource.h"
+
+#include "RuntimeAudioImporterDefines.h"
+#include "RuntimeAudioImporterLibrary.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+
+#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
+FRuntimeDeviceCaptureSource::FRuntimeDeviceCaptureSource(int32 InDeviceIndex, int32 InNumOfFramesDesired)
+	: DeviceIndex(InDeviceIndex)
+	, NumOfFramesDesired(InNumOfFramesDesired)
+{
+}
+
+FRuntimeDeviceCaptureSource::~FRuntimeDeviceCaptureSource()
+{
+	AudioCapture.AbortStream();
+	AudioCapture.CloseStream();
+}
+
+bool FRuntimeDeviceCaptureSource::OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture)
+{
+	if (AudioCapture.IsStreamOpen())
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the capture stream of %s as it is already open"), *GetDescription());
+		return false;
+	}
+
+	OnCaptureAudio = MoveTemp(OnCapture);
+
+	Audio::FAudioCaptureDeviceParams Params = Audio::FAudioCaptureDeviceParams();
+	Params.DeviceIndex = DeviceIndex;
+
+#if UE_VERSION_NEWER_THAN(5, 2, 9)
+	Audio::FOnAudioCaptureFunction
+#else
+	Audio::FOnCaptureFunction
+#endif
+	OnDeviceCapture = [this](const void* PCMData, int32 NumFrames, int32 InNumOfChannels,
+#if UE_VERSION_NEWER_THAN(4, 25, 0)
+	                         int32 InSampleRate,
+#endif
+	                         double StreamTime, bool bOverFlow)
+	{
+		if (AudioCapture.IsCapturing())
+		{
+			OnCaptureAudio(static_cast<const float*>(PCMData), NumFrames, InNumOfChannels,
+#if UE_VERSION_NEWER_THAN(4, 25, 0)
+				InSampleRate
+#else
+				AudioCapture.GetSampleRate()
+#endif
+			);
+		}
+	};
+
+	if (!AudioCapture.
+#if UE_VERSION_NEWER_THAN(5, 2, 9)
+		OpenAudioCaptureStream
+#else
+		OpenCaptureStream
+#endif
+		(Params, MoveTemp(OnDeviceCapture), NumOfFramesDesired))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the capture stream of %s"), *GetDescription());
+		return false;
+	}
+
+	Audio::FCaptureDeviceInfo DeviceInfo;
+	NumOfChannels = AudioCapture.GetCaptureDeviceInfo(DeviceInfo, DeviceIndex) ? DeviceInfo.InputChannels : 0;
+	return true;
+}
+
+bool FRuntimeDeviceCaptureSource::CloseStream()
+{
+	if (!AudioCapture.IsStreamOpen())
+	{
+		return true;
+	}
+	return AudioCapture.CloseStream();
+}
+
+bool FRuntimeDeviceCaptureSource::StartStream()
+{
+	return AudioCapture.StartStream();
+}
+
+bool FRuntimeDeviceCaptureSource::StopStream()
+{
+	return AudioCapture.StopStream();
+}
+
+bool FRuntimeDeviceCaptureSource::IsStreamOpen() const
+{
+	return AudioCapture.IsStreamOpen();
+}
+
+bool FRuntimeDeviceCaptureSource::IsCapturing() const
+{
+	return AudioCapture.IsCapturing();
+}
+
+int32 FRuntimeDeviceCaptureSource::GetSampleRate() const
+{
+	return AudioCapture.GetSampleRate();
+}
+
+int32 FRuntimeDeviceCaptureSource::GetNumOfChannels() const
+{
+	return NumOfChannels;
+}
+
+FString FRuntimeDeviceCaptureSource::GetDescription() const
+{
+	return FString::Printf(TEXT("input device %d"), DeviceIndex);
+}
+#endif
+
+FRuntimeGeneratedCaptureSource::FRuntimeGeneratedCaptureSource(float InSpeed, int32 InNumOfFramesPerBuffer)
+	: Speed(FMath::Max(InSpeed, 0.f))
+	, NumOfFramesPerBuffer(FMath::Max(InNumOfFramesPerBuffer, 1))
+{
+}
+
+FRuntimeGeneratedCaptureSource::~FRuntimeGeneratedCaptureSource()
+{
+	// The thread must have been stopped by the derived class already, as it generates the data
+	check(!Thread);
+}
+
+bool FRuntimeGeneratedCaptureSource::OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture)
+{
+	if (bStreamOpen)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the capture stream of %s as it is already open"), *GetDescription());
+		return false;
+	}
+	if (SampleRate <= 0 || NumOfChannels <= 0)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the capture stream of %s as its format is invalid (sample rate: %d, number of channels: %d)"), *GetDescription(), SampleRate, NumOfChannels);
+		return false;
+	}
+
+	OnCaptureAudio = MoveTemp(OnCapture);
+	GenerationBuffer.SetNumUninitialized(NumOfFramesPerBuffer * NumOfChannels);
+	NumOfDeliveredFrames.store(0, std::memory_order_relaxed);
+	bStreamOpen = true;
+	return true;
+}
+
+bool FRuntimeGeneratedCaptureSource::CloseStream()
+{
+	StopStream();
+	bStreamOpen = false;
+	OnCaptureAudio = nullptr;
+	return true;
+}
+
+bool FRuntimeGeneratedCaptureSource::StartStream()
+{
+	if (!bStreamOpen)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capturing from %s as the stream is not open"), *GetDescription());
+		return false;
+	}
+	if (bCapturing)
+	{
+		return true;
+	}
+
+	// Clean up the thread if it has finished by itself at the end of the stream
+	StopStream();
+
+	bStopRequested = false;
+	bCapturing = true;
+	Thread = FRunnableThread::Create(this, TEXT("RuntimeAudioCaptureSource"), 0, TPri_AboveNormal);
+	if (!Thread)
+	{
+		bCapturing = false;
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to create the capture thread of %s"), *GetDescription());
+		return false;
+	}
+	return true;
+}
+
+bool FRuntimeGeneratedCaptureSource::StopStream()
+{
+	bStopRequested = true;
+	if (Thread)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	bCapturing = false;
+	return true;
+}
+
+uint32 FRuntimeGeneratedCaptureSource::Run()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	int64 NumOfFramesSinceStart = 0;
+
+	while (!bStopRequested)
+	{
+		const int32 NumOfGeneratedFrames = GenerateAudio(GenerationBuffer.GetData(), NumOfFramesPerBuffer);
+		if (NumOfGeneratedFrames == INDEX_NONE)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Capture stream of %s has ended"), *GetDescription());
+			break;
+		}
+		if (NumOfGeneratedFrames == 0)
+		{
+			FPlatformProcess::SleepNoStats(0.001f);
+			continue;
+		}
+
+		// Like a device, a buffer is delivered once the time it covers has passed. The pacing is relative to the start, so that sleeping inaccuracies do not accumulate
+		NumOfFramesSinceStart += NumOfGeneratedFrames;
+		if (Speed > 0)
+		{
+			const double Delay = StartTime + NumOfFramesSinceStart / (static_cast<double>(SampleRate) * Speed) - FPlatformTime::Seconds();
+			if (Delay > 0)
+			{
+				FPlatformProcess::SleepNoStats(static_cast<float>(Delay));
+			}
+		}
+
+		OnCaptureAudio(GenerationBuffer.GetData(), NumOfGeneratedFrames, NumOfChannels, SampleRate);
+		NumOfDeliveredFrames.fetch_add(NumOfGeneratedFrames, std::memory_order_relaxed);
+	}
+
+	bCapturing = false;
+	return 0;
+}
+
+void FRuntimeGeneratedCaptureSource::Stop()
+{
+	bStopRequested = true;
+}
+
+FRuntimeFileCaptureSource::FRuntimeFileCaptureSource(const FString& InFilePath, float InSpeed, bool bInLoop, int32 InNumOfFramesPerBuffer)
+	: FRuntimeGeneratedCaptureSource(InSpeed, InNumOfFramesPerBuffer)
+	, FilePath(InFilePath)
+	, bLoop(bInLoop)
+{
+}
+
+FRuntimeFileCaptureSource::~FRuntimeFileCaptureSource()
+{
+	StopStream();
+}
+
+bool FRuntimeFileCaptureSource::OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture)
+{
+	// The file is decoded once and replayed from the beginning every time the stream is opened
+	if (FilePCMData.Num() == 0)
+	{
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+		TArray64<uint8> AudioData;
+		FDecodedAudioStruct DecodedAudioInfo;
+		if (!RuntimeAudioImporter::LoadAudioFileToArray(AudioData, FilePath)
+			|| !URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(AudioData, ERuntimeAudioFormat::Auto), DecodedAudioInfo))
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the capture stream of %s as the file cannot be loaded or decoded"), *GetDescription());
+			return false;
+		}
+		FilePCMData.Append(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), static_cast<int32>(DecodedAudioInfo.PCMInfo.PCMData.GetView().Num()));
+		SampleRate = DecodedAudioInfo.SoundWaveBasicInfo.SampleRate;
+		NumOfChannels = DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels;
+#else
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to open the capture stream of %s as file operation support is disabled (please enable in RuntimeAudioImporter.Build.cs)"), *GetDescription());
+		return false;
+#endif
+	}
+
+	ReadFrame = 0;
+	return FRuntimeGeneratedCaptureSource::OpenStream(MoveTemp(OnCapture));
+}
+
+FString FRuntimeFileCaptureSource::GetDescription() const
+{
+	return FString::Printf(TEXT("file '%s'"), *FilePath);
+}
+
+int32 FRuntimeFileCaptureSource::GenerateAudio(float* PCMData, int32 NumOfFrames)
+{
+	const int64 NumOfFileFrames = FilePCMData.Num() / NumOfChannels;
+
+	int32 NumOfGeneratedFrames = 0;
+	while (NumOfGeneratedFrames < NumOfFrames && NumOfFileFrames > 0)
+	{
+		if (ReadFrame >= NumOfFileFrames)
+		{
+			if (!bLoop)
+			{
+				break;
+			}
+			ReadFrame = 0;
+		}
+
+		const int32 NumOfFramesToCopy = static_cast<int32>(FMath::Min<int64>(NumOfFrames - NumOfGeneratedFrames, NumOfFileFrames - ReadFrame));
+		FMemory::Memcpy(PCMData + static_cast<int64>(NumOfGeneratedFrames) * NumOfChannels, FilePCMData.GetData() + ReadFrame * NumOfChannels, static_cast<int64>(NumOfFramesToCopy) * NumOfChannels * sizeof(float));
+		NumOfGeneratedFrames += NumOfFramesToCopy;
+		ReadFrame += NumOfFramesToCopy;
+	}
+
+	return NumOfGeneratedFrames > 0 ? NumOfGeneratedFrames : INDEX_NONE;
+}
+
+FRuntimeSyntheticCaptureSource::FRuntimeSyntheticCaptureSource(const FRuntimeSyntheticCaptureSourceSettings& InSettings, float InSpeed, int32 InNumOfFramesPerBuffer)
+	: FRuntimeGeneratedCaptureSource(InSpeed, InNumOfFramesPerBuffer)
+	, Settings(InSettings)
+{
+	SampleRate = Settings.SampleRate;
+	NumOfChannels = Settings.NumOfChannels;
+}
+
+FRuntimeSyntheticCaptureSource::~FRuntimeSyntheticCaptureSource()
+{
+	StopStream();
+}
+
+bool FRuntimeSyntheticCaptureSource::OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture)
+{
+	Random.Initialize(Settings.Seed);
+	GeneratedFrame = 0;
+	return FRuntimeGeneratedCaptureSource::OpenStream(MoveTemp(OnCapture));
+}
+
+FString FRuntimeSyntheticCaptureSource::GetDescription() const
+{
+	return FString::Printf(TEXT("synthetic %.0f Hz tone"), Settings.ToneFrequency);
+}
+
+int32 FRuntimeSyntheticCaptureSource::GenerateAudio(float* PCMData, int32 NumOfFrames)
+{
+	const int64 NumOfBurstFrames = static_cast<int64>(Settings.BurstDuration * SampleRate);
+	const int64 NumOfPauseFrames = static_cast<int64>(Settings.PauseDuration * SampleRate);
+	const bool bPulsed = NumOfBurstFrames > 0 && NumOfPauseFrames > 0;
+	const double PhaseIncrement = 2.0 * PI * Settings.ToneFrequency / SampleRate;
+
+	for (int32 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex, ++GeneratedFrame)
+	{
+		const bool bToneActive = !bPulsed || GeneratedFrame % (NumOfBurstFrames + NumOfPauseFrames) < NumOfBurstFrames;
+		const float Tone = bToneActive ? Settings.ToneAmplitude * static_cast<float>(FMath::Sin(PhaseIncrement * GeneratedFrame)) : 0.f;
+		for (int32 ChannelIndex = 0; ChannelIndex < NumOfChannels; ++ChannelIndex)
+		{
+			PCMData[FrameIndex * NumOfChannels + ChannelIndex] = Tone + Settings.NoiseAmplitude * Random.FRandRange(-1.f, 1.f);
+		}
+	}
+
+	return NumOfFrames;
+}
+
+FRuntimeLoopbackCaptureSource::FRuntimeLoopbackCaptureSource(int32 InSampleRate, int32 InNumOfChannels, float InSpeed, int32 InNumOfFramesPerBuffer)
+	: FRuntimeGeneratedCaptureSource(InSpeed, InNumOfFramesPerBuffer)
+{
+	SampleRate = InSampleRate;
+	NumOfChannels = InNumOfChannels;
+}
+
+FRuntimeLoopbackCaptureSource::~FRuntimeLoopbackCaptureSource()
+{
+	StopStream();
+}
+
+FString FRuntimeLoopbackCaptureSource::GetDescription() const
+{
+	return TEXT("loopback");
+}
+
+void FRuntimeLoopbackCaptureSource::PushAudio(TArrayView<const float> PCMData)
+{
+	FScopeLock Lock(&QueueGuard);
+	QueuedPCMData.Append(PCMData.GetData(), PCMData.Num());
+}
+
+int64 FRuntimeLoopbackCaptureSource::GetNumOfQueuedFrames() const
+{
+	FScopeLock Lock(&QueueGuard);
+	return NumOfChannels > 0 ? (QueuedPCMData.Num() - QueueReadIndex) / NumOfChannels : 0;
+}
+
+int32 FRuntimeLoopbackCaptureSource::GenerateAudio(float* PCMData, int32 NumOfFrames)
+{
+	int32 NumOfQueuedFramesToCopy;
+	{
+		FScopeLock Lock(&QueueGuard);
+		NumOfQueuedFramesToCopy = FMath::Min(NumOfFrames, (QueuedPCMData.Num() - QueueReadIndex) / NumOfChannels);
+		const int32 NumOfSamplesToCopy = NumOfQueuedFramesToCopy * NumOfChannels;
+		FMemory::Memcpy(PCMData, QueuedPCMData.GetData() + QueueReadIndex, NumOfSamplesToCopy * sizeof(float));
+		QueueReadIndex += NumOfSamplesToCopy;
+
+		if (QueueReadIndex == QueuedPCMData.Num())
+		{
+			QueuedPCMData.Reset();
+			QueueReadIndex = 0;
+		}
+		else if (QueueReadIndex >= QueuedPCMData.Num() - QueueReadIndex)
+		{
+			QueuedPCMData.RemoveAt(0, QueueReadIndex,
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+				false
+#else
+				EAllowShrinking::No
+#endif
+			);
+			QueueReadIndex = 0;
+		}
+	}
+
+	// When paced, the gaps between the pushed data are filled with silence, like an idle microphone
+	if (Speed <= 0)
+	{
+		return NumOfQueuedFramesToCopy;
+	}
+	FMemory::Memzero(PCMData + NumOfQueuedFramesToCopy * NumOfChannels, (NumOfFrames - NumOfQueuedFramesToCopy) * NumOfChannels * sizeof(float));
+	return NumOfFrames;
+}
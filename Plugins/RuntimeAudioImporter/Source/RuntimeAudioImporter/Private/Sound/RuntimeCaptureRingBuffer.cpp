@@ -0,0 +1,63 @@
+﻿// Georgy Treshchev 2024.
+
+#include "Sound/RuntimeCaptureRingBuffer.h"
+
+void FRuntimeCaptureRingBuffer::Init(int64 InCapacity)
+{
+	Buffer.SetNumZeroed(static_cast<int32>(FMath::Clamp<int64>(InCapacity, 0, TNumericLimits<int32>::Max())));
+	WritePosition.store(0, std::memory_order_relaxed);
+	ReadPosition.store(0, std::memory_order_relaxed);
+	NumOfDroppedSamples.store(0, std::memory_order_relaxed);
+}
+
+bool FRuntimeCaptureRingBuffer::Write(const float* Samples, int64 NumOfSamples)
+{
+	const int64 Capacity = Buffer.Num();
+	const uint64 CurrentWritePosition = WritePosition.load(std::memory_order_relaxed);
+	const uint64 CurrentReadPosition = ReadPosition.load(std::memory_order_acquire);
+
+	if (NumOfSamples <= 0 || Capacity <= 0 || static_cast<int64>(CurrentWritePosition - CurrentReadPosition) + NumOfSamples > Capacity)
+	{
+		NumOfDroppedSamples.fetch_add(FMath::Max<int64>(NumOfSamples, 0), std::memory_order_relaxed);
+		return false;
+	}
+
+	const int64 StartIndex = static_cast<int64>(CurrentWritePosition % static_cast<uint64>(Capacity));
+	const int64 NumOfFirstSamples = FMath::Min(NumOfSamples, Capacity - StartIndex);
+	FMemory::Memcpy(Buffer.GetData() + StartIndex, Samples, NumOfFirstSamples * sizeof(float));
+	FMemory::Memcpy(Buffer.GetData(), Samples + NumOfFirstSamples, (NumOfSamples - NumOfFirstSamples) * sizeof(float));
+
+	// Publishing the samples to the consumer only after they have been written
+	WritePosition.store(CurrentWritePosition + NumOfSamples, std::memory_order_release);
+	return true;
+}
+
+int64 FRuntimeCaptureRingBuffer::GetNumOfReadableSamples() const
+{
+	return static_cast<int64>(WritePosition.load(std::memory_order_acquire) - ReadPosition.load(std::memory_order_relaxed));
+}
+
+void FRuntimeCaptureRingBuffer::Peek(int64 NumOfSamples, TArrayView<const float>& OutFirst, TArrayView<const float>& OutSecond) const
+{
+	const int64 Capacity = Buffer.Num();
+	NumOfSamples = FMath::Clamp<int64>(NumOfSamples, 0, GetNumOfReadableSamples());
+	if (NumOfSamples == 0 || Capacity <= 0)
+	{
+		OutFirst = TArrayView<const float>();
+		OutSecond = TArrayView<const float>();
+		return;
+	}
+
+	const int64 StartIndex = static_cast<int64>(ReadPosition.load(std::memory_order_relaxed) % static_cast<uint64>(Capacity));
+	const int64 NumOfFirstSamples = FMath::Min(NumOfSamples, Capacity - StartIndex);
+	OutFirst = TArrayView<const float>(Buffer.GetData() + StartIndex, static_cast<int32>(NumOfFirstSamples));
+	OutSecond = TArrayView<const float>(Buffer.GetData(), static_cast<int32>(NumOfSamples - NumOfFirstSamples));
+}
+
+void FRuntimeCaptureRingBuffer::Consume(int64 NumOfSamples)
+{
+	NumOfSamples = FMath::Clamp<int64>(NumOfSamples, 0, GetNumOfReadableSamples());
+
+	// Handing the space back to the producer only after the samples have been read
+	ReadPosition.store(ReadPosition.load(std::memory_order_relaxed) + NumOfSamples, std::memory_order_release);
+}
@@ -4,6 +4,7 @@
 
 #include "RuntimeAudioImporterLibrary.h"
 #include "Codecs/RAW_RuntimeCodec.h"
+#include "Codecs/RuntimeCodecFactory.h"
 
 #include "Async/Async.h"
 #include "SampleBuffer.h"
@@ -65,7 +66,7 @@ void UStreamingSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 	// Process VAD if necessary
 	if (VADInstance)
 	{
-		bool bDetected = VADInstance->ProcessVAD(TArray<float>(reinterpret_cast<const float*>(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData()), static_cast<int32>(DecodedAudioInfo.PCMInfo.PCMData.GetView().Num())), DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels);
+		bool bDetected = VADInstance->ProcessVAD(TArrayView<const float>(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), static_cast<int32>(DecodedAudioInfo.PCMInfo.PCMData.GetView().Num())), DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels);
 		if (!bDetected)
 		{
 			UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("VAD detected silence, skipping audio data append"));
@@ -75,12 +76,24 @@ void UStreamingSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 	}
 #endif
 
+	if (!AppendDecodedAudio_Internal(DecodedAudioInfo))
+	{
+		return;
+	}
+
+	BroadcastPopulatedAudioData_Internal(TArrayView<const float>(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), static_cast<int32>(DecodedAudioInfo.PCMInfo.PCMData.GetView().Num())));
+
+	UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Successfully added audio data to streaming sound wave.\nAdded audio info: %s"), *DecodedAudioInfo.ToString());
+}
+
+bool UStreamingSoundWave::AppendDecodedAudio_Internal(FDecodedAudioStruct& DecodedAudioInfo)
+{
 	{
 		FRAIScopeLock Lock(&*DataGuard);
 		if (!DecodedAudioInfo.IsValid())
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to continue populating the audio data because the decoded info is invalid"));
-			return;
+			return false;
 		}
 
 		// Whether the audio data has been populated with PCM buffer
@@ -89,6 +102,25 @@ void UStreamingSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 		// Make sure the sample rate and the number of channels match the previously populated audio data
 		if (bHasPreviouslyPopulatedRealPCMData)
 		{
+			// Appended chunks usually continue the same stream, so they are resampled with a persistent realtime resampler rather than one by one offline
+			const int32 SourceNumOfChannels = DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels;
+			if (DecodedAudioInfo.SoundWaveBasicInfo.SampleRate != SampleRate && SourceNumOfChannels > 0)
+			{
+				if (!AppendResampler.IsConfiguredFor(SourceNumOfChannels, DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, SampleRate, ERuntimeResamplingQuality::Polyphase))
+				{
+					// The previous stream ends here, so its filter tail has to be appended before the resampler is reconfigured
+					FlushAppendResampler_Internal();
+					AppendResampler.Init(SourceNumOfChannels, DecodedAudioInfo.SoundWaveBasicInfo.SampleRate, SampleRate, ERuntimeResamplingQuality::Polyphase);
+				}
+
+				Audio::FAlignedFloatBuffer ResampledPCMData;
+				if (AppendResampler.ProcessAudio(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), DecodedAudioInfo.PCMInfo.PCMData.GetView().Num() / SourceNumOfChannels, ResampledPCMData))
+				{
+					DecodedAudioInfo.PCMInfo.PCMNumOfFrames = ResampledPCMData.Num() / SourceNumOfChannels;
+					DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(ResampledPCMData);
+					DecodedAudioInfo.SoundWaveBasicInfo.SampleRate = SampleRate;
+				}
+			}
 			URuntimeAudioImporterLibrary::ResampleAndMixChannelsInDecodedInfo(DecodedAudioInfo, SampleRate, NumChannels);
 		}
 
@@ -107,13 +139,50 @@ void UStreamingSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 			NumChannels = DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels;
 		}
 
-		PCMBufferInfo->PCMData.Append(DecodedAudioInfo.PCMInfo.PCMData);
+		FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal();
+		MutablePCMBufferInfo.PCMData.Append(DecodedAudioInfo.PCMInfo.PCMData);
 
-		PCMBufferInfo->PCMNumOfFrames += DecodedAudioInfo.PCMInfo.PCMNumOfFrames;
+		MutablePCMBufferInfo.PCMNumOfFrames += DecodedAudioInfo.PCMInfo.PCMNumOfFrames;
 		Duration += DecodedAudioInfo.SoundWaveBasicInfo.Duration;
 		ResetPlaybackFinish();
 	}
+	return true;
+}
+
+void UStreamingSoundWave::FlushAppendResampler_Internal()
+{
+	if (!AppendResampler.IsInitialized())
+	{
+		return;
+	}
 
+	const int32 SourceNumOfChannels = AppendResampler.GetNumOfChannels();
+	Audio::FAlignedFloatBuffer FlushedPCMData;
+	AppendResampler.Flush(FlushedPCMData);
+	if (FlushedPCMData.Num() < SourceNumOfChannels || PCMBufferInfo->PCMData.GetView().Num() <= 0)
+	{
+		return;
+	}
+
+	FDecodedAudioStruct FlushedAudioInfo;
+	FlushedAudioInfo.PCMInfo.PCMNumOfFrames = FlushedPCMData.Num() / SourceNumOfChannels;
+	FlushedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(FlushedPCMData);
+	FlushedAudioInfo.SoundWaveBasicInfo.NumOfChannels = SourceNumOfChannels;
+	FlushedAudioInfo.SoundWaveBasicInfo.SampleRate = SampleRate;
+	FlushedAudioInfo.SoundWaveBasicInfo.Duration = static_cast<float>(FlushedAudioInfo.PCMInfo.PCMNumOfFrames) / SampleRate;
+	URuntimeAudioImporterLibrary::ResampleAndMixChannelsInDecodedInfo(FlushedAudioInfo, SampleRate, NumChannels);
+
+	FPCMStruct& MutablePCMBufferInfo = GetMutablePCMBuffer_Internal();
+	MutablePCMBufferInfo.PCMData.Append(FlushedAudioInfo.PCMInfo.PCMData);
+	MutablePCMBufferInfo.PCMNumOfFrames += FlushedAudioInfo.PCMInfo.PCMNumOfFrames;
+	Duration += FlushedAudioInfo.SoundWaveBasicInfo.Duration;
+	ResetPlaybackFinish();
+
+	BroadcastPopulatedAudioData_Internal(TArrayView<const float>(FlushedAudioInfo.PCMInfo.PCMData.GetView().GetData(), static_cast<int32>(FlushedAudioInfo.PCMInfo.PCMData.GetView().Num())));
+}
+
+void UStreamingSoundWave::BroadcastPopulatedAudioData_Internal(TArrayView<const float> PopulatedPCMData)
+{
 	{
 		const bool IsBound = [this]()
 		{
@@ -122,7 +191,7 @@ void UStreamingSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 		}();
 		if (IsBound)
 		{
-			TArray<float> PCMData(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), DecodedAudioInfo.PCMInfo.PCMData.GetView().Num());
+			TArray<float> PCMData(PopulatedPCMData.GetData(), PopulatedPCMData.Num());
 			AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), PCMData = MoveTemp(PCMData)]() mutable
 			{
 				if (WeakThis.IsValid())
@@ -168,8 +237,6 @@ void UStreamingSoundWave::PopulateAudioDataFromDecodedInfo(FDecodedAudioStruct&&
 			});
 		}
 	}
-
-	UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Successfully added audio data to streaming sound wave.\nAdded audio info: %s"), *DecodedAudioInfo.ToString());
 }
 
 UStreamingSoundWave* UStreamingSoundWave::CreateStreamingSoundWave()
@@ -219,7 +286,7 @@ void UStreamingSoundWave::PreAllocateAudioData(int64 NumOfBytesToPreAllocate, co
 		});
 	};
 
-	PCMBufferInfo->PCMData.Reserve(NumOfBytesToPreAllocate / sizeof(float));
+	GetMutablePCMBuffer_Internal().PCMData.Reserve(NumOfBytesToPreAllocate / sizeof(float));
 
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully pre-allocated '%lld' number of bytes"), NumOfBytesToPreAllocate);
 	ExecuteResult(true);
@@ -243,9 +310,8 @@ void UStreamingSoundWave::AppendAudioDataFromEncoded(TArray<uint8> AudioData, ER
 		return;
 	}
 
-	FEncodedAudioStruct EncodedAudioInfo(MoveTemp(AudioData), AudioFormat);
 	FDecodedAudioStruct DecodedAudioInfo;
-	if (!URuntimeAudioImporterLibrary::DecodeAudioData(MoveTemp(EncodedAudioInfo), DecodedAudioInfo))
+	if (!URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(AudioData, AudioFormat), DecodedAudioInfo))
 	{
 		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to decode audio data to populate streaming sound wave audio data"));
 		return;
@@ -254,6 +320,156 @@ void UStreamingSoundWave::AppendAudioDataFromEncoded(TArray<uint8> AudioData, ER
 	PopulateAudioDataFromDecodedInfo(MoveTemp(DecodedAudioInfo));
 }
 
+void UStreamingSoundWave::AppendAudioDataFromEncodedStream(TArray<uint8> AudioData, ERuntimeAudioFormat AudioFormat)
+{
+	if (IsInGameThread())
+	{
+		AudioTaskPipe->Launch(AudioTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this), AudioData = MoveTemp(AudioData), AudioFormat]() mutable
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->AppendAudioDataFromEncodedStream(MoveTemp(AudioData), AudioFormat);
+			}
+			else
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to append encoded stream data to streaming sound wave as the streaming sound wave has been destroyed"));
+			}
+		}, UE::Tasks::ETaskPriority::BackgroundHigh);
+		return;
+	}
+
+	if (!EncodedStreamSource.IsValid())
+	{
+		EncodedStreamSource = MakeShared<FRuntimeAudioMemoryStreamSource, ESPMode::ThreadSafe>();
+		EncodedStreamFormat = AudioFormat;
+	}
+	else if (AudioFormat != EncodedStreamFormat && AudioFormat != ERuntimeAudioFormat::Auto)
+	{
+		UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("Ignoring the audio format %s of the appended chunk since the encoded stream has already been started. Call FinishEncodedStream to start a new stream"), *UEnum::GetValueAsString(AudioFormat));
+	}
+
+	EncodedStreamSource->Append(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()));
+	DecodeEncodedStream();
+}
+
+void UStreamingSoundWave::FinishEncodedStream()
+{
+	if (IsInGameThread())
+	{
+		AudioTaskPipe->Launch(AudioTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->FinishEncodedStream();
+			}
+			else
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to finish the encoded stream as the streaming sound wave has been destroyed"));
+			}
+		}, UE::Tasks::ETaskPriority::BackgroundHigh);
+		return;
+	}
+
+	if (EncodedStreamSource.IsValid())
+	{
+		EncodedStreamSource->MarkComplete();
+		DecodeEncodedStream();
+
+		EncodedStreamDecoder.Reset();
+		EncodedStreamSource.Reset();
+		EncodedStreamFormat = ERuntimeAudioFormat::Invalid;
+	}
+
+	FRAIScopeLock Lock(&*DataGuard);
+	FlushAppendResampler_Internal();
+}
+
+void UStreamingSoundWave::DecodeEncodedStream()
+{
+	if (!EncodedStreamDecoder.IsValid())
+	{
+		// The format can only be detected once enough data is buffered to contain the header and a few frames
+		if (EncodedStreamFormat == ERuntimeAudioFormat::Auto || EncodedStreamFormat == ERuntimeAudioFormat::Invalid)
+		{
+			constexpr int64 NumOfBytesToDetectFormat = 64 * 1024;
+			if (!EncodedStreamSource->IsComplete() && EncodedStreamSource->GetNumOfAvailableBytes() < NumOfBytesToDetectFormat)
+			{
+				return;
+			}
+
+			TArray64<uint8> BufferedData;
+			EncodedStreamSource->CopyBufferedData(BufferedData);
+
+			FRuntimeCodecFactory CodecFactory;
+			const TArray<FBaseRuntimeCodec*> Codecs = CodecFactory.GetCodecs(FRuntimeAudioDataView(BufferedData.GetData(), BufferedData.Num()));
+			if (Codecs.Num() == 0)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to determine the format of the encoded stream, discarding it"));
+				EncodedStreamSource.Reset();
+				return;
+			}
+			EncodedStreamFormat = Codecs[0]->GetAudioFormat();
+		}
+
+		EncodedStreamDecoder = FRuntimeStreamingDecoder::Create(EncodedStreamFormat, EncodedStreamSource.ToSharedRef());
+		if (!EncodedStreamDecoder.IsValid())
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to create a streaming decoder for the %s format, discarding the encoded stream"), *UEnum::GetValueAsString(EncodedStreamFormat));
+			EncodedStreamSource.Reset();
+			return;
+		}
+	}
+
+	if (!EncodedStreamDecoder->IsOpen())
+	{
+		const ERuntimeStreamingDecodeResult OpenResult = EncodedStreamDecoder->Open();
+		if (OpenResult == ERuntimeStreamingDecodeResult::NeedMoreData)
+		{
+			return;
+		}
+		if (OpenResult != ERuntimeStreamingDecodeResult::Succeeded)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to open the encoded stream, discarding it"));
+			EncodedStreamDecoder.Reset();
+			EncodedStreamSource.Reset();
+			return;
+		}
+	}
+
+	const uint32 StreamNumOfChannels = EncodedStreamDecoder->GetNumOfChannels();
+	const uint32 StreamSampleRate = EncodedStreamDecoder->GetSampleRate();
+
+	// Populating the sound wave block by block, so that playback can start before the rest of the received data is decoded
+	constexpr int64 NumOfFramesPerBlock = 16384;
+	while (true)
+	{
+		float* PCMData = static_cast<float*>(FMemory::Malloc(NumOfFramesPerBlock * StreamNumOfChannels * sizeof(float)));
+		int64 NumOfDecodedFrames = 0;
+		const ERuntimeStreamingDecodeResult DecodeResult = EncodedStreamDecoder->DecodeFrames(PCMData, NumOfFramesPerBlock, NumOfDecodedFrames);
+
+		if (NumOfDecodedFrames <= 0)
+		{
+			FMemory::Free(PCMData);
+			if (DecodeResult == ERuntimeStreamingDecodeResult::Failed)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to decode the encoded stream"));
+			}
+			break;
+		}
+
+		FDecodedAudioStruct DecodedAudioInfo;
+		{
+			DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(PCMData, NumOfDecodedFrames * StreamNumOfChannels);
+			DecodedAudioInfo.PCMInfo.PCMNumOfFrames = NumOfDecodedFrames;
+			DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels = StreamNumOfChannels;
+			DecodedAudioInfo.SoundWaveBasicInfo.SampleRate = StreamSampleRate;
+			DecodedAudioInfo.SoundWaveBasicInfo.Duration = static_cast<float>(NumOfDecodedFrames) / StreamSampleRate;
+			DecodedAudioInfo.SoundWaveBasicInfo.AudioFormat = EncodedStreamFormat;
+		}
+		PopulateAudioDataFromDecodedInfo(MoveTemp(DecodedAudioInfo));
+	}
+}
+
 void UStreamingSoundWave::AppendAudioDataFromRAW(TArray<uint8> RAWData, ERuntimeRAWAudioFormat RAWFormat, int32 InSampleRate, int32 NumOfChannels)
 {
 	if (IsInGameThread())
@@ -5,10 +5,75 @@
 #include "AudioDevice.h"
 #include "Codecs/RAW_RuntimeCodec.h"
 #include "Engine/World.h"
+#include "Sound/SoundSubmix.h"
+
+namespace
+{
+	/** Number of frames the captured synth audio is handed over in, independent of the game frame rate and of the mixer buffer size */
+	constexpr int32 SynthCaptureBlockNumOfFrames = 1024;
+
+	/** Resizes the scratch buffer without releasing its allocation, so that pulling does not allocate once warmed up */
+	void ResizeScratchBuffer(TArray<float>& Buffer, int32 NumOfSamples)
+	{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+		Buffer.SetNumUninitialized(NumOfSamples, false);
+#else
+		Buffer.SetNumUninitialized(NumOfSamples, EAllowShrinking::No);
+#endif
+	}
+}
+
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+/**
+ * Listener of the main submix pulling the synth audio for every rendered buffer
+ */
+class FSynthBasedSoundWaveSubmixListener : public ISubmixBufferListener
+{
+public:
+	explicit FSynthBasedSoundWaveSubmixListener(USynthBasedSoundWave* InSoundWave)
+		: SoundWave(InSoundWave)
+	{
+	}
+
+	//~ Begin ISubmixBufferListener Interface
+	virtual void OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock) override
+	{
+		if (NumChannels > 0 && SoundWave.IsValid())
+		{
+			SoundWave->PullSynthAudio_Internal(NumSamples / NumChannels, SampleRate);
+		}
+	}
+
+#if !UE_VERSION_OLDER_THAN(5, 3, 0)
+	virtual const FString& GetListenerName() const override
+	{
+		static const FString ListenerName = TEXT("SynthBasedSoundWaveSubmixListener");
+		return ListenerName;
+	}
+#endif
+	//~ End ISubmixBufferListener Interface
+
+private:
+	TWeakObjectPtr<USynthBasedSoundWave> SoundWave;
+};
+#endif
 
 USynthBasedSoundWave::USynthBasedSoundWave(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer), SynthComponent(nullptr)
 {
+	CaptureBlockNumOfFrames = SynthCaptureBlockNumOfFrames;
+}
+
+void USynthBasedSoundWave::BeginDestroy()
+{
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	if (bCapturing)
+	{
+		SetSubmixListenerRegistered(false);
+	}
+#endif
+
+	Super::BeginDestroy();
 }
 
 USynthBasedSoundWave* USynthBasedSoundWave::CreateSynthBasedSoundWave(USynthComponent* InSynthComponent)
@@ -64,6 +129,27 @@ bool USynthBasedSoundWave::StartCapture_Implementation(int32 DeviceId)
 	}
 #endif
 
+	// The sound generator renders in the format it was initialized with, the synth sound in its own format
+	CapturedSynthSound = SynthSound;
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	SynthNumOfChannels = SoundGenerator ? InitParams.NumChannels : SynthSound->NumChannels;
+	SynthSampleRate = SoundGenerator ? static_cast<int32>(InitParams.SampleRate) : static_cast<int32>(SynthSound->GetSampleRateForCurrentPlatform());
+#else
+	SynthNumOfChannels = SynthSound->NumChannels;
+	SynthSampleRate = SynthSound->GetSampleRateForCurrentPlatform();
+#endif
+	SynthFrameRemainder = 0;
+
+	PrepareCaptureBuffer_Internal();
+
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	if (!SetSubmixListenerRegistered(true))
+	{
+		UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to start capturing for sound wave '%s' as the audio device is not available"), *GetName());
+		return false;
+	}
+#endif
+
 	// After starting the synth component, it will automatically play the sound to audio device, so we need to stop it to accumulate audio data into this sound wave
 	StopSynthSound().Next([WeakThis = MakeWeakObjectPtr(this)](bool bSuccess)
 	{
@@ -83,12 +169,23 @@ void USynthBasedSoundWave::StopCapture_Implementation()
 	bCapturing = false;
 
 #if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	SetSubmixListenerRegistered(false);
+
 	if (SoundGenerator)
 	{
 		SoundGenerator->OnEndGenerate();
 	}
 #endif
 
+	// Handing over the last incomplete block
+	AudioTaskPipe->Launch(AudioTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]()
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->ProcessCapturedAudio_Internal(true);
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundHigh);
+
 	if (SynthComponent)
 	{
 		SynthComponent->Stop();
@@ -131,93 +228,135 @@ void USynthBasedSoundWave::Tick(float DeltaTime)
 	{
 		StopSynthSound();
 	}
-	if (IsCapturing())
+
+#if !WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	// Without the submix listener, the synth is pulled once per game frame instead of once per mixer buffer
+	if (IsCapturing() && SynthSampleRate > 0)
 	{
-		AudioTaskPipe->Launch(AudioTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]() mutable
+		AudioTaskPipe->Launch(AudioTaskPipe->GetDebugName(), [WeakThis = MakeWeakObjectPtr(this)]()
 		{
-			if (!WeakThis.IsValid())
+			if (WeakThis.IsValid())
 			{
-				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to populate audio data into the synth-based sound wave as it is not available"));
-				return;
+				WeakThis->PullSynthAudio_Internal(WeakThis->NumSamplesToGeneratePerCallback / FMath::Max(WeakThis->SynthNumOfChannels, 1), WeakThis->SynthSampleRate);
 			}
-			
-			USynthSound* SynthSound = WeakThis->GetSynthSound();
-			if (!SynthSound)
+			else
 			{
-				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to populate audio data into the synth-based sound wave as the synth sound is not available"));
-				return;
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to populate audio data into the synth-based sound wave as it is not available"));
 			}
-			
-			TArray<float> PCMData;
+		});
+	}
+#endif
+}
 
-#if !UE_VERSION_OLDER_THAN(5, 0, 0)
-			// Use the sound generator if available, otherwise use the synth component (same to FAsyncDecodeWorker behavior)
-			if (WeakThis->SoundGenerator)
-			{
-				PCMData.SetNumUninitialized(WeakThis->NumSamplesToGeneratePerCallback);
-				PCMData.SetNum(WeakThis->SoundGenerator->OnGenerateAudio(PCMData.GetData(), PCMData.Num()));
-			}
-			else
+void USynthBasedSoundWave::PullSynthAudio_Internal(int32 NumOfMixerFrames, int32 MixerSampleRate)
+{
+	if (!bCapturing || NumOfMixerFrames <= 0 || MixerSampleRate <= 0 || SynthNumOfChannels <= 0 || SynthSampleRate <= 0)
+	{
+		return;
+	}
+
+	// Pulling as many frames as the synth renders in the duration of the mixer buffer
+	SynthFrameRemainder += static_cast<double>(NumOfMixerFrames) * SynthSampleRate / MixerSampleRate;
+	const int32 NumOfFrames = FMath::FloorToInt32(SynthFrameRemainder);
+	SynthFrameRemainder -= NumOfFrames;
+	if (NumOfFrames <= 0)
+	{
+		return;
+	}
+
+	const int32 NumOfSamples = NumOfFrames * SynthNumOfChannels;
+	int32 NumOfGeneratedSamples = 0;
+
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	// Use the sound generator if available, otherwise use the synth component (same to FAsyncDecodeWorker behavior)
+	if (SoundGenerator)
+	{
+		ResizeScratchBuffer(SynthPCMData, NumOfSamples);
+		NumOfGeneratedSamples = SoundGenerator->OnGenerateAudio(SynthPCMData.GetData(), NumOfSamples);
+	}
+	else
 #endif
-			{
-				TArray<uint8> AudioData;
-				SynthSound->OnGeneratePCMAudio(AudioData, WeakThis->NumSamplesToGeneratePerCallback);
+	{
+		USynthSound* SynthSound = CapturedSynthSound.Get();
+		if (!SynthSound)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to populate audio data into the synth-based sound wave as the synth sound is not available"));
+			return;
+		}
 
-				const Audio::EAudioMixerStreamDataFormat::Type GeneratedPCMDataFormat = SynthSound->GetGeneratedPCMDataFormat();
+		SynthAudioData.Reset();
+		SynthSound->OnGeneratePCMAudio(SynthAudioData, NumOfSamples);
 
-				if (GeneratedPCMDataFormat == Audio::EAudioMixerStreamDataFormat::Float)
-				{
-					PCMData = TArray<float>(reinterpret_cast<float*>(AudioData.GetData()), AudioData.Num() / sizeof(float));
-				}
-				else if (GeneratedPCMDataFormat == Audio::EAudioMixerStreamDataFormat::Int16)
-				{
-					// TODO: Confirm that it works correctly (only float format was tested)
-					float* FloatPCMDataPtr = nullptr;
-					const int64 NumOfSamples = AudioData.Num() / sizeof(int16);
-					FRAW_RuntimeCodec::TranscodeRAWData(reinterpret_cast<int16*>(AudioData.GetData()), NumOfSamples, FloatPCMDataPtr);
-					PCMData = TArray<float>(FloatPCMDataPtr, NumOfSamples);
-					FMemory::Free(FloatPCMDataPtr);
-				}
-			}
+		const Audio::EAudioMixerStreamDataFormat::Type GeneratedPCMDataFormat = SynthSound->GetGeneratedPCMDataFormat();
+		if (GeneratedPCMDataFormat == Audio::EAudioMixerStreamDataFormat::Float)
+		{
+			NumOfGeneratedSamples = SynthAudioData.Num() / sizeof(float);
+			ResizeScratchBuffer(SynthPCMData, NumOfGeneratedSamples);
+			FMemory::Memcpy(SynthPCMData.GetData(), SynthAudioData.GetData(), NumOfGeneratedSamples * sizeof(float));
+		}
+		else if (GeneratedPCMDataFormat == Audio::EAudioMixerStreamDataFormat::Int16)
+		{
+			// TODO: Confirm that it works correctly (only float format was tested)
+			NumOfGeneratedSamples = SynthAudioData.Num() / sizeof(int16);
+			ResizeScratchBuffer(SynthPCMData, NumOfGeneratedSamples);
+			FRAW_RuntimeCodec::TranscodeRAWDataToBuffer<int16, float>(reinterpret_cast<const int16*>(SynthAudioData.GetData()), NumOfGeneratedSamples, SynthPCMData.GetData());
+		}
+	}
 
-			if (PCMData.Num() > 0)
-			{
-				// If all the values in the buffer are zero, it generally means that the generator doesn't have any audio to generate at the moment, e.g. in pixel streaming when the player is not talking, so we can skip the rest of the processing
-				{
-					const bool bCheckIfAllBufferZero = FRAIMemory::MemIsZero(PCMData.GetData(), PCMData.Num() * sizeof(float));
-					if (bCheckIfAllBufferZero)
-					{
-						UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("All values in the buffer provided by the sound '%s' are zero, skipping the rest of the processing"), *WeakThis->GetName());
-						return;
-					}
-				}
+	// Only whole frames are written
+	NumOfGeneratedSamples -= NumOfGeneratedSamples % SynthNumOfChannels;
+	if (NumOfGeneratedSamples <= 0)
+	{
+		return;
+	}
 
-				UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Audio data has been generated by the sound '%s'"), *WeakThis->GetName());
-				
-				FDecodedAudioStruct DecodedAudioInfo;
-				{
-					FPCMStruct PCMInfo;
-					{
-						PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(PCMData);
-						PCMInfo.PCMNumOfFrames = PCMData.Num() / SynthSound->NumChannels;
-					}
-					DecodedAudioInfo.PCMInfo = MoveTemp(PCMInfo);
-
-					FSoundWaveBasicStruct SoundWaveBasicInfo;
-					{
-						SoundWaveBasicInfo.NumOfChannels = SynthSound->NumChannels;
-						SoundWaveBasicInfo.SampleRate = SynthSound->GetSampleRateForCurrentPlatform();
-						SoundWaveBasicInfo.Duration = static_cast<float>(DecodedAudioInfo.PCMInfo.PCMNumOfFrames) / SynthSound->GetSampleRateForCurrentPlatform();
-					}
-					DecodedAudioInfo.SoundWaveBasicInfo = MoveTemp(SoundWaveBasicInfo);
-				}
-				WeakThis->PopulateAudioDataFromDecodedInfo(MoveTemp(DecodedAudioInfo));
-				UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Audio data has been appended to the sound wave '%s'"), *WeakThis->GetName());
-			}
-		});
+	// If all the values in the buffer are zero, it generally means that the generator doesn't have any audio to generate at the moment, e.g. in pixel streaming when the player is not talking, so we can skip the rest of the processing
+	if (FRAIMemory::MemIsZero(SynthPCMData.GetData(), NumOfGeneratedSamples * sizeof(float)))
+	{
+		UE_LOG(LogRuntimeAudioImporter, VeryVerbose, TEXT("All values in the buffer provided by the sound '%s' are zero, skipping the rest of the processing"), *GetName());
+		return;
 	}
+
+	WriteCapturedAudio_Internal(SynthPCMData.GetData(), NumOfGeneratedSamples / SynthNumOfChannels, SynthNumOfChannels, SynthSampleRate);
 }
 
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+bool USynthBasedSoundWave::SetSubmixListenerRegistered(bool bRegister)
+{
+	FAudioDevice* AudioDevice = GetAudioDevice();
+	if (!AudioDevice)
+	{
+		return false;
+	}
+
+	if (!SubmixListener.IsValid())
+	{
+		SubmixListener = MakeShared<FSynthBasedSoundWaveSubmixListener, ESPMode::ThreadSafe>(this);
+	}
+
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+	if (bRegister)
+	{
+		AudioDevice->RegisterSubmixBufferListener(SubmixListener.Get());
+	}
+	else
+	{
+		AudioDevice->UnregisterSubmixBufferListener(SubmixListener.Get());
+	}
+#else
+	if (bRegister)
+	{
+		AudioDevice->RegisterSubmixBufferListener(SubmixListener.ToSharedRef(), AudioDevice->GetMainSubmixObject());
+	}
+	else
+	{
+		AudioDevice->UnregisterSubmixBufferListener(SubmixListener.ToSharedRef(), AudioDevice->GetMainSubmixObject());
+	}
+#endif
+	return true;
+}
+#endif
+
 ETickableTickType USynthBasedSoundWave::GetTickableTickType() const
 {
 	return ETickableTickType::Conditional;
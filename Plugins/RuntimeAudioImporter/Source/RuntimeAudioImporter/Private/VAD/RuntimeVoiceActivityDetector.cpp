@@ -6,11 +6,155 @@
 #include "RuntimeAudioImporterTypes.h"
 #include "VADIncludes.h"
 #include "HAL/UnrealMemory.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
 #include "Codecs/RAW_RuntimeCodec.h"
+#include "RuntimeAudioImporterLibrary.h"
+#include "Math/RandomStream.h"
 #if !UE_VERSION_OLDER_THAN(5, 1, 0)
 #include "DSP/FloatArrayMath.h"
 #endif
 
+#if WITH_RUNTIMEAUDIOIMPORTER_VAD_SUPPORT
+namespace
+{
+	int32 bEnableVADSIMD = 1;
+	FAutoConsoleVariableRef CVarEnableVADSIMD(
+		TEXT("RuntimeAudioImporter.VAD.EnableSIMD"),
+		bEnableVADSIMD,
+		TEXT("Whether the VAD uses the SIMD versions of the filterbank and the GMM evaluation where supported. Their decisions are bit-identical to the scalar ones. Applied when a VAD is created or reset"));
+
+	/**
+	 * Applies RuntimeAudioImporter.VAD.EnableSIMD to the VAD instance
+	 */
+	void ApplyVADSIMD(FVAD_RuntimeAudioImporter::Fvad* VADInstance)
+	{
+		if (FVAD_RuntimeAudioImporter::fvad_set_simd(VADInstance, bEnableVADSIMD != 0) != 0)
+		{
+			FVAD_RuntimeAudioImporter::fvad_set_simd(VADInstance, 0);
+		}
+	}
+
+	/**
+	 * Run the SIMD and the scalar VAD side by side and compare their decisions, features and timing
+	 * Usage: RuntimeAudioImporter.VAD.VerifySIMD [Directory]
+	 */
+	FAutoConsoleCommand VerifyVADSIMDCommand(
+		TEXT("RuntimeAudioImporter.VAD.VerifySIMD"),
+		TEXT("Compares the SIMD and the scalar VAD frame by frame on all audio files in the directory, or on a synthetic signal if no directory is given. Usage: RuntimeAudioImporter.VAD.VerifySIMD [Directory]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			using namespace FVAD_RuntimeAudioImporter;
+
+			Fvad* SIMDInstance = fvad_new();
+			Fvad* ScalarInstance = fvad_new();
+			if (!SIMDInstance || !ScalarInstance || fvad_set_simd(SIMDInstance, 1) != 0)
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to verify VAD SIMD as it is not supported on this platform"));
+				if (SIMDInstance)
+				{
+					fvad_free(SIMDInstance);
+				}
+				if (ScalarInstance)
+				{
+					fvad_free(ScalarInstance);
+				}
+				return;
+			}
+			fvad_set_simd(ScalarInstance, 0);
+
+			// 8 kHz mono signals, which is what the detector feeds to the VAD
+			TArray<TPair<FString, TArray<int16>>> Signals;
+			if (Args.Num() > 0)
+			{
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+				TArray<FString> FilePaths;
+				IFileManager::Get().FindFilesRecursive(FilePaths, *Args[0], TEXT("*"), true, false);
+				for (const FString& FilePath : FilePaths)
+				{
+					TArray64<uint8> AudioData;
+					FDecodedAudioStruct DecodedAudioInfo;
+					if (!RuntimeAudioImporter::LoadAudioFileToArray(AudioData, FilePath)
+						|| !URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(AudioData, ERuntimeAudioFormat::Auto), DecodedAudioInfo)
+						|| !URuntimeAudioImporterLibrary::ResampleAndMixChannelsInDecodedInfo(DecodedAudioInfo, 8000, 1))
+					{
+						continue;
+					}
+					TArray<int16>& Signal = Signals.Emplace_GetRef(FilePath, TArray<int16>()).Value;
+					for (const float Sample : DecodedAudioInfo.PCMInfo.PCMData.GetView())
+					{
+						Signal.Add(static_cast<int16>(FMath::Clamp(Sample * 32767.f, -32768.f, 32767.f)));
+					}
+				}
+#else
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to load the audio files as file operation support is disabled"));
+#endif
+			}
+			else
+			{
+				// Alternating silence and tones of random loudness with a little noise, with a fixed seed so runs are comparable
+				FRandomStream Random(1234);
+				TArray<int16>& Signal = Signals.Emplace_GetRef(TEXT("Synthetic"), TArray<int16>()).Value;
+				Signal.SetNumUninitialized(8000 * 600);
+				for (int32 SampleIndex = 0; SampleIndex < Signal.Num(); ++SampleIndex)
+				{
+					const int32 Segment = SampleIndex / 4000;
+					const float Gain = Segment % 3 == 0 ? 0.f : FMath::Pow(10.f, (Segment * 7919 % 60) / 20.f) * 20.f;
+					const float Time = SampleIndex / 8000.f;
+					const float Tone = FMath::Sin(Time * 2.f * PI * (150.f + Segment % 7 * 40.f)) + 0.5f * FMath::Sin(Time * 2.f * PI * 1200.f);
+					Signal[SampleIndex] = static_cast<int16>(FMath::Clamp(Gain * Tone + Random.FRandRange(-32.f, 32.f), -32768.f, 32767.f));
+				}
+			}
+
+			int64 NumOfFrames = 0, NumOfMismatches = 0;
+			double SIMDTime = 0, ScalarTime = 0;
+			for (const TPair<FString, TArray<int16>>& Signal : Signals)
+			{
+				// Cycles through the 10, 20 and 30 ms frame lengths
+				int64 NumOfSignalMismatches = 0;
+				int32 FrameLengthIndex = 0;
+				for (int32 FrameStart = 0; ; ++FrameLengthIndex)
+				{
+					const int32 FrameLength = 80 * (FrameLengthIndex % 3 + 1);
+					if (FrameStart + FrameLength > Signal.Value.Num())
+					{
+						break;
+					}
+
+					double StartTime = FPlatformTime::Seconds();
+					const int SIMDResult = fvad_process(SIMDInstance, Signal.Value.GetData() + FrameStart, FrameLength);
+					SIMDTime += FPlatformTime::Seconds() - StartTime;
+
+					StartTime = FPlatformTime::Seconds();
+					const int ScalarResult = fvad_process(ScalarInstance, Signal.Value.GetData() + FrameStart, FrameLength);
+					ScalarTime += FPlatformTime::Seconds() - StartTime;
+
+					if (SIMDResult != ScalarResult
+						|| SIMDInstance->core.total_power != ScalarInstance->core.total_power
+						|| FMemory::Memcmp(SIMDInstance->core.feature_vector, ScalarInstance->core.feature_vector, sizeof(SIMDInstance->core.feature_vector)) != 0)
+					{
+						if (NumOfSignalMismatches == 0)
+						{
+							UE_LOG(LogRuntimeAudioImporter, Warning, TEXT("'%s': first mismatch at sample %d, SIMD decision %d, scalar decision %d"), *Signal.Key, FrameStart, SIMDResult, ScalarResult);
+						}
+						++NumOfSignalMismatches;
+					}
+
+					FrameStart += FrameLength;
+					++NumOfFrames;
+				}
+				NumOfMismatches += NumOfSignalMismatches;
+			}
+
+			fvad_free(SIMDInstance);
+			fvad_free(ScalarInstance);
+
+			UE_LOG(LogRuntimeAudioImporter, Display, TEXT("Verified VAD SIMD on %d signals, %lld frames: %lld mismatches. SIMD took %.3f sec, scalar took %.3f sec (%.2fx)"),
+			       Signals.Num(), NumOfFrames, NumOfMismatches, SIMDTime, ScalarTime, SIMDTime > 0 ? ScalarTime / SIMDTime : 0.0);
+		}));
+}
+#endif
+
 URuntimeVoiceActivityDetector::URuntimeVoiceActivityDetector()
 	: AppliedSampleRate(0)
 #if WITH_RUNTIMEAUDIOIMPORTER_VAD_SUPPORT
@@ -22,6 +166,7 @@ URuntimeVoiceActivityDetector::URuntimeVoiceActivityDetector()
 	if (VADInstance)
 	{
 		UE_LOG(LogRuntimeAudioImporter, VeryVerbose, TEXT("Successfully created VAD instance for %s"), *GetName());
+		ApplyVADSIMD(VADInstance);
 		SetVADMode(ERuntimeVADMode::VeryAggressive);
 	}
 	else
@@ -57,8 +202,10 @@ bool URuntimeVoiceActivityDetector::ResetVAD()
 		return false;
 	}
 	FVAD_RuntimeAudioImporter::fvad_reset(VADInstance);
+	ApplyVADSIMD(VADInstance);
 	SetVADMode(ERuntimeVADMode::VeryAggressive);
 	AppliedSampleRate = 0;
+	Resampler.Reset();
 	UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Successfully reset VAD for %s"), *GetName());
 	return true;
 #else
@@ -89,6 +236,11 @@ bool URuntimeVoiceActivityDetector::SetVADMode(ERuntimeVADMode Mode)
 }
 
 bool URuntimeVoiceActivityDetector::ProcessVAD(TArray<float> PCMData, int32 InSampleRate, int32 NumOfChannels)
+{
+	return ProcessVAD(TArrayView<const float>(PCMData), InSampleRate, NumOfChannels);
+}
+
+bool URuntimeVoiceActivityDetector::ProcessVAD(TArrayView<const float> PCMData, int32 InSampleRate, int32 NumOfChannels)
 {
 #if WITH_RUNTIMEAUDIOIMPORTER_VAD_SUPPORT
 	if (!VADInstance)
@@ -113,7 +265,7 @@ bool URuntimeVoiceActivityDetector::ProcessVAD(TArray<float> PCMData, int32 InSa
 	}
 
 	Audio::FAlignedFloatBuffer AlignedPCMData;
-	AlignedPCMData = MoveTemp(PCMData);
+	AlignedPCMData.Append(PCMData.GetData(), PCMData.Num());
 
 	// Mix channels if necessary (VAD only supports mono audio data)
 	if (NumOfChannels > 1)
@@ -128,11 +280,17 @@ bool URuntimeVoiceActivityDetector::ProcessVAD(TArray<float> PCMData, int32 InSa
 	}
 
 	// Resample the audio data if necessary (VAD only supports 8 kHz audio data)
+	// The VAD runs in realtime on consecutive chunks, so a persistent polyphase resampler is used instead of the offline one
 	static constexpr int32 VADTargetSampleRate = 8000;
 	if (InSampleRate != VADTargetSampleRate)
 	{
+		if (!Resampler.IsConfiguredFor(1, InSampleRate, VADTargetSampleRate, ERuntimeResamplingQuality::Polyphase))
+		{
+			Resampler.Init(1, InSampleRate, VADTargetSampleRate, ERuntimeResamplingQuality::Polyphase);
+		}
+
 		Audio::FAlignedFloatBuffer AlignedPCMData_Resampled;
-		if (!FRAW_RuntimeCodec::ResampleRAWData(AlignedPCMData, 1, InSampleRate, VADTargetSampleRate, AlignedPCMData_Resampled))
+		if (!Resampler.ProcessAudio(AlignedPCMData.GetData(), AlignedPCMData.Num(), AlignedPCMData_Resampled))
 		{
 			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to resample audio data for %s"), *GetName());
 			return false;
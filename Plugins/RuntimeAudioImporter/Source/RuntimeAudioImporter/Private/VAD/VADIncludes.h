@@ -24,6 +24,11 @@
 
 THIRD_PARTY_INCLUDES_START
 
+// Included outside of the namespace, the SIMD kernels of libfvad only pick up the already defined intrinsics
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#endif
+
 namespace FVAD_RuntimeAudioImporter
 {
 #include "fvad.h"
@@ -31,6 +36,7 @@ namespace FVAD_RuntimeAudioImporter
 #include "vad/vad_core.c"
 #include "vad/vad_sp.c"
 #include "vad/vad_gmm.c"
+#include "vad/vad_simd.c"
 #include "vad/vad_filterbank.c"
 #include "signal_processing/division_operations.c"
 #include "signal_processing/energy.c"
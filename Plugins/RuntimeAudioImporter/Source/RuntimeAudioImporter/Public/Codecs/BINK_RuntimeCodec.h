@@ -9,10 +9,14 @@ class RUNTIMEAUDIOIMPORTER_API FBINK_RuntimeCodec : public FBaseRuntimeCodec
 {
 public:
 	//~ Begin FBaseRuntimeCodec Interface
-	virtual bool CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData) override;
-	virtual bool GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) override;
-	virtual bool Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) override;
-	virtual bool Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData) override;
+	using FBaseRuntimeCodec::CheckAudioFormat;
+	using FBaseRuntimeCodec::GetHeaderInfo;
+	using FBaseRuntimeCodec::Encode;
+	using FBaseRuntimeCodec::Decode;
+	virtual bool CheckAudioFormat(FRuntimeAudioDataView AudioData) override;
+	virtual bool GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) override;
+	virtual bool Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) override;
+	virtual bool Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData) override;
 	virtual ERuntimeAudioFormat GetAudioFormat() const override { return ERuntimeAudioFormat::Bink; }
 	virtual bool IsExtensionSupported(const FString& Extension) const override
 	{
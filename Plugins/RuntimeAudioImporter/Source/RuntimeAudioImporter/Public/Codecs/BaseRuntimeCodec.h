@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Features/IModularFeature.h"
 #include "RuntimeAudioImporterTypes.h"
+#include "RuntimeStreamingDecoder.h"
 
 /**
  * Base runtime codec
@@ -21,21 +22,67 @@ public:
 	/**
 	 * Check if the given audio data appears to be valid
 	 */
-	virtual bool CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData) PURE_VIRTUAL(FBaseRuntimeCodec::CheckAudioFormat, return false;)
+	virtual bool CheckAudioFormat(FRuntimeAudioDataView AudioData) PURE_VIRTUAL(FBaseRuntimeCodec::CheckAudioFormat, return false;)
 
 	/**
 	 * Retrieve audio header information from an encoded source
+	 * The encoded data is borrowed and must not be copied
 	 */
-	virtual bool GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) PURE_VIRTUAL(FBaseRuntimeCodec::GetHeaderInfo, return false;)
+	virtual bool GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) PURE_VIRTUAL(FBaseRuntimeCodec::GetHeaderInfo, return false;)
 
 	/**
 	 * Encode uncompressed PCM data into a compressed format
+	 * The PCM data is borrowed and must not be copied
 	 */
-	virtual bool Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) PURE_VIRTUAL(FBaseRuntimeCodec::Encode, return false;)
+	virtual bool Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) PURE_VIRTUAL(FBaseRuntimeCodec::Encode, return false;)
+
 	/**
 	 * Decode compressed audio data into PCM format
+	 * The encoded data is borrowed and must not be copied. The PCM buffer already held by DecodedData is reused where possible
+	 */
+	virtual bool Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData) PURE_VIRTUAL(FBaseRuntimeCodec::Decode, return false;)
+
+	/**
+	 * Adapters for the owning audio structs, forwarding to the view-based functions above without copying the audio data
+	 */
+	bool CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData)
+	{
+		return CheckAudioFormat(FRuntimeAudioDataView(AudioData.GetView()));
+	}
+
+	bool GetHeaderInfo(const FEncodedAudioStruct& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo)
+	{
+		return GetHeaderInfo(FEncodedAudioView(EncodedData), HeaderInfo);
+	}
+
+	bool Encode(const FDecodedAudioStruct& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality)
+	{
+		return Encode(FDecodedAudioView(DecodedData), EncodedData, Quality);
+	}
+
+	bool Decode(const FEncodedAudioStruct& EncodedData, FDecodedAudioStruct& DecodedData)
+	{
+		return Decode(FEncodedAudioView(EncodedData), DecodedData);
+	}
+
+	/**
+	 * Create a pull-based decoder that decodes the data incrementally as it becomes available from the source
+	 * Codecs that cannot decode incrementally return a nullptr, in which case the data has to be decoded as a whole via Decode
+	 */
+	virtual TUniquePtr<FRuntimeStreamingDecoder> CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source)
+	{
+		return nullptr;
+	}
+
+	/**
+	 * Retrieve audio header information by reading only the parts of the source that the format needs, e.g. without loading a whole file into memory
+	 * By default, the header is parsed by opening a streaming decoder, falling back to reading the whole source (up to a limit) and calling GetHeaderInfo
+	 *
+	 * @param Source The complete source of the encoded data. The read position is changed
+	 * @param HeaderInfo The retrieved header information
+	 * @return Whether the header information was successfully retrieved or not
 	 */
-	virtual bool Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData) PURE_VIRTUAL(FBaseRuntimeCodec::Decode, return false;)
+	virtual bool GetHeaderInfoFromStream(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source, FRuntimeAudioHeaderInfo& HeaderInfo);
 
 	/**
 	 * Retrieve the format applicable to this codec
@@ -9,10 +9,16 @@ class RUNTIMEAUDIOIMPORTER_API FMP3_RuntimeCodec : public FBaseRuntimeCodec
 {
 public:
 	//~ Begin FBaseRuntimeCodec Interface
-	virtual bool CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData) override;
-	virtual bool GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) override;
-	virtual bool Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) override;
-	virtual bool Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData) override;
+	using FBaseRuntimeCodec::CheckAudioFormat;
+	using FBaseRuntimeCodec::GetHeaderInfo;
+	using FBaseRuntimeCodec::Encode;
+	using FBaseRuntimeCodec::Decode;
+	virtual bool CheckAudioFormat(FRuntimeAudioDataView AudioData) override;
+	virtual bool GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) override;
+	virtual bool Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) override;
+	virtual bool Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData) override;
+	virtual TUniquePtr<FRuntimeStreamingDecoder> CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source) override;
+	virtual bool GetHeaderInfoFromStream(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source, FRuntimeAudioHeaderInfo& HeaderInfo) override;
 	virtual ERuntimeAudioFormat GetAudioFormat() const override { return ERuntimeAudioFormat::Mp3; }
 	virtual bool IsExtensionSupported(const FString& Extension) const override
 	{
@@ -0,0 +1,150 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Codecs/RuntimeResampler.h"
+#include "DSP/BufferVectorOperations.h"
+
+/**
+ * Stateful MPEG-1 Layer III encoder of interleaved float PCM data
+ * The data can be fed in chunks of any size and the frames are produced as soon as enough input is available,
+ * so arbitrarily long audio can be encoded block by block with a bounded memory footprint
+ * Frames are encoded at a constant bitrate with long blocks and mono, stereo or mid/side stereo, without using the bit reservoir
+ * Input with a sample rate other than 32, 44.1 or 48 kHz is resampled, and input with more than two channels is downmixed to stereo
+ * The stream starts with an Info tag frame holding the number of frames, the encoder delay and the padding, which lets decoders
+ * supporting the tag (such as minimp3) return exactly the encoded frames
+ */
+class RUNTIMEAUDIOIMPORTER_API FMP3_RuntimeEncoder
+{
+public:
+	FMP3_RuntimeEncoder();
+
+	/**
+	 * Initialize the encoder, discarding any previous state
+	 *
+	 * @param InNumOfChannels Number of interleaved channels of the input data
+	 * @param InSampleRate Sample rate of the input data
+	 * @param Quality The quality of the encoded audio data, from 0 to 100. See GetBitrateFromQuality
+	 * @return Whether the encoder was initialized successfully or not
+	 */
+	bool Init(uint32 InNumOfChannels, uint32 InSampleRate, uint8 Quality);
+
+	/**
+	 * Encode a chunk of input data, appending the produced frames to the output buffer
+	 * The first call also appends the placeholder of the Info tag frame, see GetInfoFrame
+	 *
+	 * @param PCMData Interleaved input samples
+	 * @param NumOfFrames Number of input frames (samples per channel)
+	 * @param OutEncodedData Buffer the encoded frames are appended to
+	 * @return Whether the data was encoded successfully or not
+	 */
+	bool EncodeFrames(const float* PCMData, int64 NumOfFrames, TArray64<uint8>& OutEncodedData);
+
+	/**
+	 * Encode the input held back by the encoder, padding the last frame with silence
+	 * No more data can be encoded afterwards until the encoder is initialized again
+	 *
+	 * @param OutEncodedData Buffer the remaining frames are appended to
+	 * @return Whether the data was encoded successfully or not
+	 */
+	bool Flush(TArray64<uint8>& OutEncodedData);
+
+	/**
+	 * Get the Info tag frame describing the frames encoded so far. It has the same size as the placeholder written at the beginning of the stream,
+	 * which is expected to be overwritten with it once the encoding is finished (for example, by seeking back to the beginning of a file)
+	 *
+	 * @param OutFrame The Info tag frame
+	 */
+	void GetInfoFrame(TArray64<uint8>& OutFrame) const;
+
+	/**
+	 * Get the bitrate in kbps used for the specified quality, following the nominal bitrates of the Vorbis quality levels
+	 * (e.g. quality 40 gives 128 kbps for stereo, which is about 11 times smaller than 16-bit PCM at 44.1 kHz)
+	 *
+	 * @param Quality The quality of the encoded audio data, from 0 to 100
+	 * @param NumOfChannels Number of encoded channels (1 or 2). Mono uses about half of the stereo bitrate
+	 * @return The bitrate in kbps, one of the MPEG-1 Layer III bitrates
+	 */
+	static int32 GetBitrateFromQuality(uint8 Quality, uint32 NumOfChannels);
+
+	/**
+	 * Get the sample rate the input with the specified sample rate is encoded at, which is the nearest supported sample rate not below it if possible
+	 */
+	static uint32 GetEncodedSampleRate(uint32 InSampleRate);
+
+	/**
+	 * Get the number of frames the decoded output is delayed by relative to the input, not counting the Info tag frame
+	 * Decoders supporting the Info tag remove it, others output it before the input
+	 */
+	static int32 GetEncoderDelay();
+
+	bool IsInitialized() const { return NumOfChannels > 0; }
+
+	uint32 GetNumOfEncodedChannels() const { return NumOfChannels; }
+	uint32 GetEncodedSampleRate() const { return SampleRate; }
+	int32 GetBitrate() const { return Bitrate; }
+
+private:
+	/** Convert the input to the encoded sample rate and number of channels and append it to the input buffers */
+	bool AppendInput(const float* PCMData, int64 NumOfFrames);
+
+	/** Append interleaved data with the encoded sample rate and up to two channels to the input buffers */
+	void AppendDeinterleaved(const float* PCMData, int64 NumOfFrames, int32 NumOfDataChannels);
+
+	/** Encode all frames for which the input buffers hold enough data */
+	void EncodeAvailableFrames(TArray64<uint8>& OutEncodedData);
+
+	/** Encode the frame starting at the beginning of the input buffers */
+	void EncodeFrame(TArray64<uint8>& OutEncodedData);
+
+	/** Number of channels and sample rate of the input data */
+	uint32 NumOfInputChannels;
+	uint32 InputSampleRate;
+
+	/** Number of channels and sample rate of the encoded data */
+	uint32 NumOfChannels;
+	uint32 SampleRate;
+
+	/** Bitrate in kbps */
+	int32 Bitrate;
+
+	/** Indices of the sample rate and the bitrate in the frame header */
+	int32 SampleRateIndex;
+	int32 BitrateIndex;
+
+	/** Index of the first spectral line removed by the lowpass, depending on the bitrate */
+	int32 LowpassLine;
+
+	/** Resampler used if the input sample rate is not supported by the format */
+	FRuntimeResampler Resampler;
+
+	/** Scratch space for the converted input */
+	Audio::FAlignedFloatBuffer ResampledBuffer;
+	Audio::FAlignedFloatBuffer MixedBuffer;
+
+	/** Deinterleaved input, whose part not yet consumed starts at InputReadOffset with the filterbank history of the next frame */
+	TArray<float> InputBuffers[2];
+
+	/** Number of consumed samples at the beginning of each input buffer. They are removed once per call rather than once per frame */
+	int32 InputReadOffset;
+
+	/** Subband samples of the previous granule of each channel, which the first half of the MDCT window overlaps */
+	TArray<float> PreviousSubbandSamples[2];
+
+	/** Remainder of the frame size in bytes, accumulated to decide which frames are padded with an extra byte */
+	int64 FrameSizeRemainder;
+
+	/** Size of the Info tag frame placeholder written at the beginning of the stream */
+	int32 InfoFrameSize;
+
+	/** Total number of converted input frames and of encoded MPEG frames, excluding the Info tag frame */
+	int64 NumOfInputFrames;
+	int64 NumOfEncodedFrames;
+
+	/** Total number of bytes of the stream, including the Info tag frame */
+	int64 NumOfEncodedBytes;
+
+	bool bInfoFrameWritten;
+	bool bFlushed;
+};
@@ -8,6 +8,7 @@
 #include "RuntimeAudioImporterDefines.h"
 #include "SampleBuffer.h"
 #include "AudioResampler.h"
+#include "Codecs/RuntimeResampler.h"
 #include <type_traits>
 #include <limits>
 
@@ -99,7 +100,19 @@ public:
 	{
 		/** Creating an empty PCM buffer */
 		RAWDataTo = static_cast<IntegralTypeTo*>(FMemory::Malloc(NumOfSamples * sizeof(IntegralTypeTo)));
+		TranscodeRAWDataToBuffer<IntegralTypeFrom, IntegralTypeTo>(RAWDataFrom, NumOfSamples, RAWDataTo);
+	}
 
+	/**
+	 * Transcoding one RAW Data format to another into already allocated memory, e.g. to reuse a buffer between blocks of the same stream
+	 *
+	 * @param RAWDataFrom Pointer to memory location of the RAW data for transcoding
+	 * @param NumOfSamples Number of samples in the RAW data
+	 * @param RAWDataTo Pointer to memory location with space for NumOfSamples samples of the specified format
+	 */
+	template <typename IntegralTypeFrom, typename IntegralTypeTo>
+	static void TranscodeRAWDataToBuffer(const IntegralTypeFrom* RAWDataFrom, int64 NumOfSamples, IntegralTypeTo* RAWDataTo)
+	{
 		const TTuple<long long, long long> MinAndMaxValuesFrom{GetRawMinAndMaxValues<IntegralTypeFrom>()};
 		const TTuple<long long, long long> MinAndMaxValuesTo{GetRawMinAndMaxValues<IntegralTypeTo>()};
 
@@ -113,6 +126,32 @@ public:
 		       static_cast<uint64>(sizeof(IntegralTypeFrom)), MinAndMaxValuesFrom.Key, MinAndMaxValuesFrom.Value, static_cast<uint64>(sizeof(IntegralTypeTo)), MinAndMaxValuesTo.Key, MinAndMaxValuesTo.Value);
 	}
 
+	/**
+	 * Transcoding RAW data to a wider format within the same buffer, so that the source and the transcoded data never need separate allocations
+	 * The source samples must be located at the end of the buffer, starting at byte offset NumOfSamples * (sizeof(IntegralTypeTo) - sizeof(IntegralTypeFrom))
+	 *
+	 * @param Buffer Buffer large enough to hold NumOfSamples samples of IntegralTypeTo
+	 * @param NumOfSamples Number of samples in the RAW data
+	 */
+	template <typename IntegralTypeFrom, typename IntegralTypeTo>
+	static void TranscodeRAWDataInPlace(uint8* Buffer, int64 NumOfSamples)
+	{
+		static_assert(sizeof(IntegralTypeTo) >= sizeof(IntegralTypeFrom), "In-place transcoding is only possible to a format of the same or larger size");
+
+		const IntegralTypeFrom* RAWDataFrom = reinterpret_cast<const IntegralTypeFrom*>(Buffer + NumOfSamples * (sizeof(IntegralTypeTo) - sizeof(IntegralTypeFrom)));
+		IntegralTypeTo* RAWDataTo = reinterpret_cast<IntegralTypeTo*>(Buffer);
+
+		const TTuple<long long, long long> MinAndMaxValuesFrom{GetRawMinAndMaxValues<IntegralTypeFrom>()};
+		const TTuple<long long, long long> MinAndMaxValuesTo{GetRawMinAndMaxValues<IntegralTypeTo>()};
+
+		/** Iterating forward is safe since writing a sample never overlaps a source sample that has not been read yet */
+		for (int64 SampleIndex = 0; SampleIndex < NumOfSamples; ++SampleIndex)
+		{
+			const IntegralTypeFrom SourceSample = RAWDataFrom[SampleIndex];
+			RAWDataTo[SampleIndex] = static_cast<IntegralTypeTo>(FMath::GetMappedRangeValueClamped(FVector2D(MinAndMaxValuesFrom.Key, MinAndMaxValuesFrom.Value), FVector2D(MinAndMaxValuesTo.Key, MinAndMaxValuesTo.Value), SourceSample));
+		}
+	}
+
 	/**
 	 * Resampling RAW Data to a different sample rate
 	 *
@@ -121,9 +160,27 @@ public:
 	 * @param SourceSampleRate Source sample rate of the RAW data
 	 * @param DestinationSampleRate Destination sample rate of the RAW data
 	 * @param ResampledRAWData Resampled RAW data
+	 * @param Quality Resampling quality tier
 	 * @return True if the RAW data was successfully resampled
 	 */
-	static bool ResampleRAWData(Audio::FAlignedFloatBuffer& RAWData, uint32 NumOfChannels, uint32 SourceSampleRate, uint32 DestinationSampleRate, Audio::FAlignedFloatBuffer& ResampledRAWData)
+	static bool ResampleRAWData(Audio::FAlignedFloatBuffer& RAWData, uint32 NumOfChannels, uint32 SourceSampleRate, uint32 DestinationSampleRate, Audio::FAlignedFloatBuffer& ResampledRAWData, ERuntimeResamplingQuality Quality = ERuntimeResamplingQuality::BestSinc)
+	{
+		return ResampleRAWData(RAWData.GetData(), RAWData.Num(), NumOfChannels, SourceSampleRate, DestinationSampleRate, ResampledRAWData, Quality);
+	}
+
+	/**
+	 * Resampling RAW Data to a different sample rate
+	 *
+	 * @param RAWData Pointer to memory location of the RAW data for resampling
+	 * @param NumOfSamples Number of samples in the RAW data
+	 * @param NumOfChannels Number of channels in the RAW data
+	 * @param SourceSampleRate Source sample rate of the RAW data
+	 * @param DestinationSampleRate Destination sample rate of the RAW data
+	 * @param ResampledRAWData Resampled RAW data
+	 * @param Quality Resampling quality tier
+	 * @return True if the RAW data was successfully resampled
+	 */
+	static bool ResampleRAWData(const float* RAWData, int64 NumOfSamples, uint32 NumOfChannels, uint32 SourceSampleRate, uint32 DestinationSampleRate, Audio::FAlignedFloatBuffer& ResampledRAWData, ERuntimeResamplingQuality Quality = ERuntimeResamplingQuality::BestSinc)
 	{
 		if (NumOfChannels <= 0)
 		{
@@ -144,18 +201,41 @@ public:
 		// No need to resample if the sample rates are the same
 		if (SourceSampleRate == DestinationSampleRate)
 		{
-			ResampledRAWData = RAWData;
+			ResampledRAWData = Audio::FAlignedFloatBuffer(RAWData, NumOfSamples);
+			return true;
+		}
+
+		// The faster quality tiers and exact ratios (e.g. 48000 -> 16000, 44100 -> 22050) run on the polyphase resampler
+		// Other ratios at the best quality are left to the engine's sinc resampler
+		if (Quality != ERuntimeResamplingQuality::BestSinc || FRuntimeResampler::IsExactRatio(SourceSampleRate, DestinationSampleRate))
+		{
+			FRuntimeResampler Resampler;
+			if (!Resampler.Init(NumOfChannels, SourceSampleRate, DestinationSampleRate, Quality))
+			{
+				return false;
+			}
+
+			const int64 NumOfFrames = NumOfSamples / NumOfChannels;
+			ResampledRAWData.Reset(Resampler.GetNumOfOutputFrames(NumOfFrames) * NumOfChannels);
+			if (!Resampler.ProcessAudio(RAWData, NumOfFrames, ResampledRAWData))
+			{
+				UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Unable to resample audio data from %d to %d"), SourceSampleRate, DestinationSampleRate);
+				return false;
+			}
+			Resampler.Flush(ResampledRAWData);
 			return true;
 		}
 
+		const Audio::FAlignedFloatBuffer InputData(RAWData, NumOfSamples);
 		const Audio::FResamplingParameters ResampleParameters = {
 			Audio::EResamplingMethod::BestSinc,
 			static_cast<int32>(NumOfChannels),
 			static_cast<float>(SourceSampleRate),
 			static_cast<float>(DestinationSampleRate),
-			RAWData
+			InputData
 		};
 
+		ResampledRAWData.Reset();
 		ResampledRAWData.AddUninitialized(Audio::GetOutputBufferSize(ResampleParameters));
 		Audio::FResamplerResults ResampleResults;
 		ResampleResults.OutBuffer = &ResampledRAWData;
@@ -7,6 +7,7 @@
 /**
  * A factory for constructing the codecs used for encoding and decoding audio data
  * Codecs are intended to be registered as modular features
+ * The list of registered codecs, as well as the format and extension lookups, are cached and rebuilt only when a codec is registered or unregistered
  */
 class RUNTIMEAUDIOIMPORTER_API FRuntimeCodecFactory
 {
@@ -39,12 +40,43 @@ public:
 
 	/**
 	 * Get the codec based on the audio data (slower, but more reliable)
+	 * The format is first detected using the magic bytes of the well-known containers, falling back to probing every codec
 	 *
 	 * @param AudioData The audio data from which to get the codec
 	 * @return The detected codec, or a nullptr if it could not be detected
 	 */
 	virtual TArray<FBaseRuntimeCodec*> GetCodecs(const FRuntimeBulkDataBuffer<uint8>& AudioData);
 
+	/**
+	 * Get the codec based on a borrowed view of the audio data (slower, but more reliable)
+	 * The format is first detected using the magic bytes of the well-known containers, falling back to probing every codec
+	 *
+	 * @param AudioData The audio data from which to get the codec. It is not copied
+	 * @return The detected codec, or a nullptr if it could not be detected
+	 */
+	virtual TArray<FBaseRuntimeCodec*> GetCodecs(FRuntimeAudioDataView AudioData);
+
+	/**
+	 * Detect the audio format using only the magic bytes at the beginning of the audio data, without involving any codec
+	 *
+	 * @param AudioData The audio data from which to detect the format
+	 * @param bOutConclusive Whether the signature is specific enough for the format to be trusted without the codec validating the data
+	 * @return The detected audio format, or ERuntimeAudioFormat::Invalid if none of the known signatures match
+	 */
+	static ERuntimeAudioFormat SniffAudioFormat(FRuntimeAudioDataView AudioData, bool& bOutConclusive);
+
+	/**
+	 * Start tracking the codec registrations so that the cached codec lookups are invalidated when the set of codecs changes
+	 * Must be called before the codecs are registered as modular features
+	 */
+	static void StartupCodecRegistry();
+
+	/**
+	 * Stop tracking the codec registrations and release the cached codec lookups
+	 * Must be called after the codecs are unregistered as modular features
+	 */
+	static void ShutdownCodecRegistry();
+
 	/**
 	 * Get the name of the modular feature
 	 * This name should be used when registering the codec as a modular feature
@@ -0,0 +1,119 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeAudioImporterTypes.h"
+#include "DSP/BufferVectorOperations.h"
+
+/**
+ * Stateful resampler of interleaved float PCM data
+ * The conversion ratio is kept as an exact fraction of the sample rates, so integer ratios (e.g. 48000 -> 16000, 44100 -> 22050) and
+ * small rational ratios (e.g. 44100 -> 48000) use a precomputed polyphase filter bank without any interpolation of the filter coefficients
+ * The filter history is kept between calls, so audio can be processed chunk by chunk without discontinuities at the chunk boundaries
+ * The output is aligned with the input (no group delay), which means that a few input frames are held back until the next call or Flush
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeResampler
+{
+public:
+	FRuntimeResampler();
+
+	/**
+	 * Initialize the resampler, discarding any previous state
+	 *
+	 * @param InNumOfChannels Number of interleaved channels
+	 * @param InSourceSampleRate Sample rate of the input data
+	 * @param InDestinationSampleRate Sample rate of the output data
+	 * @param InQuality Resampling quality tier
+	 * @return Whether the resampler was initialized successfully or not
+	 */
+	bool Init(int32 InNumOfChannels, uint32 InSourceSampleRate, uint32 InDestinationSampleRate, ERuntimeResamplingQuality InQuality);
+
+	/**
+	 * Clear the filter history and positions, keeping the configuration, e.g. before processing an unrelated stream
+	 */
+	void Reset();
+
+	/**
+	 * Resample a chunk of input data, appending the produced frames to the output buffer
+	 *
+	 * @param InData Interleaved input samples
+	 * @param NumOfFrames Number of input frames (samples per channel)
+	 * @param OutData Buffer the resampled interleaved samples are appended to
+	 * @return Whether the data was resampled successfully or not
+	 */
+	bool ProcessAudio(const float* InData, int64 NumOfFrames, Audio::FAlignedFloatBuffer& OutData);
+
+	/**
+	 * Output the frames held back by the filter, so that the total output length matches the total input length converted to the destination sample rate
+	 * The resampler is reset afterwards
+	 *
+	 * @param OutData Buffer the remaining interleaved samples are appended to
+	 */
+	void Flush(Audio::FAlignedFloatBuffer& OutData);
+
+	/**
+	 * Whether the resampler has been initialized
+	 */
+	bool IsInitialized() const { return NumOfChannels > 0; }
+
+	/**
+	 * Whether the resampler was initialized with the specified parameters, i.e. can continue processing the same stream
+	 */
+	bool IsConfiguredFor(int32 InNumOfChannels, uint32 InSourceSampleRate, uint32 InDestinationSampleRate, ERuntimeResamplingQuality InQuality) const;
+
+	/**
+	 * Whether the specified conversion runs on an exact polyphase filter bank, i.e. the ratio of the sample rates is a small fraction
+	 */
+	static bool IsExactRatio(uint32 SourceSampleRate, uint32 DestinationSampleRate);
+
+	/**
+	 * Get the number of output frames corresponding to the specified number of input frames
+	 */
+	int64 GetNumOfOutputFrames(int64 NumOfInputFrames) const;
+
+	int32 GetNumOfChannels() const { return NumOfChannels; }
+	uint32 GetSourceSampleRate() const { return SourceSampleRate; }
+	uint32 GetDestinationSampleRate() const { return DestinationSampleRate; }
+
+private:
+	/** Fill the coefficients of the window for the specified fractional position, ordered from the oldest to the newest input frame */
+	const float* GetCoefficients(int64 Phase);
+
+	/** Build the windowed-sinc filter bank for the sinc quality tiers */
+	void BuildFilterBank(int32 BaseNumOfTaps, float Rolloff, float KaiserBeta);
+
+	int32 NumOfChannels;
+	uint32 SourceSampleRate;
+	uint32 DestinationSampleRate;
+	ERuntimeResamplingQuality Quality;
+
+	/** Reduced conversion fraction. Output frame N is located at input position N * Decimation / Interpolation */
+	int64 Interpolation;
+	int64 Decimation;
+
+	/** Number of input frames each output frame is computed from */
+	int32 NumOfTaps;
+
+	/** Number of rows of the filter bank, equal to Interpolation for exact ratios. Rows in between are interpolated otherwise */
+	int32 NumOfPhases;
+
+	/** Filter bank of (NumOfPhases + 1) rows of NumOfTaps coefficients each */
+	TArray<float> FilterBank;
+
+	/** Scratch space for interpolated or computed coefficients */
+	TArray<float> Coefficients;
+
+	/** Interleaved history of the last (NumOfTaps - 1) input frames followed by the frames being processed */
+	Audio::FAlignedFloatBuffer WorkBuffer;
+
+	/** Index of the newest input frame needed for the next output frame, relative to the beginning of the work buffer */
+	int64 NextFrameIndex;
+
+	/** Fractional position of the next output frame between two input frames, in units of 1 / Interpolation */
+	int64 NextPhase;
+
+	/** Total number of frames consumed and produced since the last reset, used to make the flushed output length exact */
+	int64 TotalInputFrames;
+	int64 TotalOutputFrames;
+};
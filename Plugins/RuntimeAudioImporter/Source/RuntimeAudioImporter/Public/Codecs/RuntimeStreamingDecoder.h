@@ -0,0 +1,290 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeAudioImporterTypes.h"
+#include "HAL/CriticalSection.h"
+
+class IFileHandle;
+
+/**
+ * Source of encoded bytes pulled by a streaming decoder
+ * Implementations may grow over time (e.g. network or pipe input) or be fully available from the start (e.g. a file)
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeAudioStreamSource
+{
+public:
+	virtual ~FRuntimeAudioStreamSource() = default;
+
+	/**
+	 * Read up to the specified number of bytes from the current position
+	 *
+	 * @return The number of bytes actually read. Zero means that no data is currently available
+	 */
+	virtual int64 Read(uint8* Destination, int64 NumOfBytes) = 0;
+
+	/**
+	 * Move the read position to the specified absolute byte offset
+	 *
+	 * @return Whether the position is reachable. Positions past the currently available data or already discarded data are not
+	 */
+	virtual bool Seek(int64 Position) = 0;
+
+	/**
+	 * Get the current absolute read position
+	 */
+	virtual int64 Tell() const = 0;
+
+	/**
+	 * Get the total size of the encoded data in bytes, or -1 if it is not known yet
+	 */
+	virtual int64 GetSize() const = 0;
+
+	/**
+	 * Get the number of bytes that can be read from the current position without waiting for more data
+	 */
+	virtual int64 GetNumOfAvailableBytes() const = 0;
+
+	/**
+	 * Whether no more data will be appended to the source
+	 */
+	virtual bool IsComplete() const = 0;
+
+	/**
+	 * Whether arbitrary positions of the data can be revisited, which is required for frame-accurate seeking
+	 */
+	virtual bool IsSeekable() const = 0;
+
+	/**
+	 * Release the memory occupied by data that lies more than the specified number of bytes behind the read position
+	 * Sources that do not buffer data may ignore this
+	 */
+	virtual void ReleaseConsumedData(int64 NumOfBytesToKeep) {}
+};
+
+/**
+ * Memory source that accepts arbitrarily split chunks of encoded data, e.g. as they arrive from a network or pipe
+ * Data that has been consumed by the decoder is released, so that only a bounded window of encoded data is kept in memory
+ * Thread-safe: data can be appended from one thread while being decoded on another
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeAudioMemoryStreamSource : public FRuntimeAudioStreamSource
+{
+public:
+	FRuntimeAudioMemoryStreamSource() = default;
+
+	/**
+	 * Append a chunk of encoded data. The chunk does not have to be aligned to any frame or page boundary
+	 */
+	void Append(FRuntimeAudioDataView AudioData);
+
+	/**
+	 * Mark the source as complete, meaning that no more data will be appended
+	 * The decoder will then be allowed to drain the remaining data
+	 */
+	void MarkComplete();
+
+	/**
+	 * Copy the currently buffered data, starting from the oldest retained byte. Used for format detection before the decoder is opened
+	 */
+	void CopyBufferedData(TArray64<uint8>& OutAudioData) const;
+
+	//~ Begin FRuntimeAudioStreamSource Interface
+	virtual int64 Read(uint8* Destination, int64 NumOfBytes) override;
+	virtual bool Seek(int64 Position) override;
+	virtual int64 Tell() const override;
+	virtual int64 GetSize() const override;
+	virtual int64 GetNumOfAvailableBytes() const override;
+	virtual bool IsComplete() const override;
+	virtual bool IsSeekable() const override;
+	virtual void ReleaseConsumedData(int64 NumOfBytesToKeep) override;
+	//~ End FRuntimeAudioStreamSource Interface
+
+private:
+	/** Buffered encoded data. The first element corresponds to the absolute position BufferStartPosition */
+	TArray64<uint8> Buffer;
+
+	/** Absolute position of the first buffered byte (increases as consumed data is released) */
+	int64 BufferStartPosition = 0;
+
+	/** Absolute read position */
+	int64 ReadPosition = 0;
+
+	/** Whether no more data will be appended */
+	bool bComplete = false;
+
+	/** Data guard for the buffer and positions */
+	mutable FCriticalSection DataGuard;
+};
+
+#if WITH_RUNTIMEAUDIOIMPORTER_FILEOPERATION_SUPPORT
+/**
+ * File source reading the encoded data directly from disk, without loading the whole file into memory
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeAudioFileStreamSource : public FRuntimeAudioStreamSource
+{
+public:
+	explicit FRuntimeAudioFileStreamSource(const FString& FilePath);
+	virtual ~FRuntimeAudioFileStreamSource() override;
+
+	/**
+	 * Whether the file has been opened successfully
+	 */
+	bool IsValid() const;
+
+	//~ Begin FRuntimeAudioStreamSource Interface
+	virtual int64 Read(uint8* Destination, int64 NumOfBytes) override;
+	virtual bool Seek(int64 Position) override;
+	virtual int64 Tell() const override;
+	virtual int64 GetSize() const override;
+	virtual int64 GetNumOfAvailableBytes() const override;
+	virtual bool IsComplete() const override { return true; }
+	virtual bool IsSeekable() const override { return true; }
+	//~ End FRuntimeAudioStreamSource Interface
+
+private:
+	/** Handle of the opened file */
+	TUniquePtr<IFileHandle> FileHandle;
+
+	/** Cached file size */
+	int64 FileSize = 0;
+
+	/** Data guard for the file handle */
+	mutable FCriticalSection DataGuard;
+};
+#endif
+
+/**
+ * Result of the streaming decoder operations
+ */
+enum class ERuntimeStreamingDecodeResult : uint8
+{
+	/** The operation succeeded */
+	Succeeded,
+
+	/** Not enough encoded data is buffered yet, try again after appending more data */
+	NeedMoreData,
+
+	/** The source is complete and all frames have been decoded */
+	EndOfStream,
+
+	/** The encoded data is invalid or the decoder failed */
+	Failed
+};
+
+/**
+ * Pull-based, stateful decoder producing interleaved 32-bit float PCM frames from a stream source
+ * Unlike FBaseRuntimeCodec::Decode, only the frames that are requested are decoded, so playback can start after the first block
+ * Decoders are not thread-safe and are expected to be driven from a single thread at a time
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeStreamingDecoder
+{
+public:
+	explicit FRuntimeStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> InSource);
+	virtual ~FRuntimeStreamingDecoder() = default;
+
+	/**
+	 * Create a streaming decoder for the specified format using the registered codecs
+	 *
+	 * @return The created decoder, or a nullptr if no codec supports streaming decoding of this format
+	 */
+	static TUniquePtr<FRuntimeStreamingDecoder> Create(ERuntimeAudioFormat AudioFormat, TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> InSource);
+
+	/**
+	 * Parse the stream header. Returns NeedMoreData if the header has not been fully received yet
+	 */
+	ERuntimeStreamingDecodeResult Open();
+
+	/**
+	 * Decode up to the specified number of frames
+	 *
+	 * @param OutPCMData Destination for interleaved float PCM data, must be able to hold MaxNumOfFrames * GetNumOfChannels() samples
+	 * @param MaxNumOfFrames Maximum number of frames to decode
+	 * @param OutNumOfFrames The number of frames actually decoded
+	 * @return Succeeded if any frames were decoded, NeedMoreData if waiting for data, EndOfStream once everything has been decoded
+	 */
+	ERuntimeStreamingDecodeResult DecodeFrames(float* OutPCMData, int64 MaxNumOfFrames, int64& OutNumOfFrames);
+
+	/**
+	 * Seek to the specified PCM frame. Requires a seekable source
+	 *
+	 * @return Whether the seek succeeded
+	 */
+	bool Seek(int64 FrameIndex);
+
+	/**
+	 * Close the decoder and release its state. The decoder can be opened again afterwards
+	 */
+	void Close();
+
+	/** Whether the decoder has been opened */
+	bool IsOpen() const { return bOpen; }
+
+	/** The number of channels, valid once opened */
+	uint32 GetNumOfChannels() const { return NumOfChannels; }
+
+	/** The sample rate, valid once opened */
+	uint32 GetSampleRate() const { return SampleRate; }
+
+	/** The total number of frames, or -1 if it cannot be determined without reading the whole stream */
+	int64 GetTotalNumOfFrames() const { return TotalNumOfFrames; }
+
+	/** The index of the next frame to be decoded */
+	int64 GetFramePosition() const { return FramePosition; }
+
+	/** The source this decoder pulls from */
+	const TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe>& GetSource() const { return Source; }
+
+protected:
+	/**
+	 * Codec-specific header parsing. Must fill in NumOfChannels, SampleRate and, if known, TotalNumOfFrames
+	 */
+	virtual bool Open_Internal() = 0;
+
+	/**
+	 * Codec-specific decoding. Returns the number of frames decoded, with zero meaning that no frames could be produced from the available data
+	 */
+	virtual int64 DecodeFrames_Internal(float* OutPCMData, int64 MaxNumOfFrames) = 0;
+
+	/**
+	 * Codec-specific seeking
+	 */
+	virtual bool Seek_Internal(int64 FrameIndex) = 0;
+
+	/**
+	 * Codec-specific cleanup
+	 */
+	virtual void Close_Internal() = 0;
+
+	/**
+	 * The number of bytes that must be buffered ahead of the read position before decoding, unless the source is complete
+	 * The underlying libraries treat a short read as the end of the stream, so this must cover the largest read they may issue for one step
+	 */
+	virtual int64 GetMinNumOfBytesAhead() const = 0;
+
+	/**
+	 * The maximum number of frames decoded between two checks of the buffered data
+	 */
+	virtual int64 GetMaxNumOfFramesPerStep() const { return 4096; }
+
+	/** Whether there is enough buffered data to proceed */
+	bool HasEnoughDataAhead() const;
+
+	/** The source the encoded data is pulled from */
+	TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source;
+
+	/** The number of channels */
+	uint32 NumOfChannels = 0;
+
+	/** The sample rate */
+	uint32 SampleRate = 0;
+
+	/** The total number of frames, or -1 if unknown */
+	int64 TotalNumOfFrames = -1;
+
+	/** The index of the next frame to be decoded */
+	int64 FramePosition = 0;
+
+	/** Whether the decoder has been opened */
+	bool bOpen = false;
+};
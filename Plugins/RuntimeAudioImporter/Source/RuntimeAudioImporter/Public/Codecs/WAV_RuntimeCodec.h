@@ -9,10 +9,15 @@ class RUNTIMEAUDIOIMPORTER_API FWAV_RuntimeCodec : public FBaseRuntimeCodec
 {
 public:
 	//~ Begin FBaseRuntimeCodec Interface
-	virtual bool CheckAudioFormat(const FRuntimeBulkDataBuffer<uint8>& AudioData) override;
-	virtual bool GetHeaderInfo(FEncodedAudioStruct EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) override;
-	virtual bool Encode(FDecodedAudioStruct DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) override;
-	virtual bool Decode(FEncodedAudioStruct EncodedData, FDecodedAudioStruct& DecodedData) override;
+	using FBaseRuntimeCodec::CheckAudioFormat;
+	using FBaseRuntimeCodec::GetHeaderInfo;
+	using FBaseRuntimeCodec::Encode;
+	using FBaseRuntimeCodec::Decode;
+	virtual bool CheckAudioFormat(FRuntimeAudioDataView AudioData) override;
+	virtual bool GetHeaderInfo(const FEncodedAudioView& EncodedData, FRuntimeAudioHeaderInfo& HeaderInfo) override;
+	virtual bool Encode(const FDecodedAudioView& DecodedData, FEncodedAudioStruct& EncodedData, uint8 Quality) override;
+	virtual bool Decode(const FEncodedAudioView& EncodedData, FDecodedAudioStruct& DecodedData) override;
+	virtual TUniquePtr<FRuntimeStreamingDecoder> CreateStreamingDecoder(TSharedRef<FRuntimeAudioStreamSource, ESPMode::ThreadSafe> Source) override;
 	virtual ERuntimeAudioFormat GetAudioFormat() const override { return ERuntimeAudioFormat::Wav; }
 	virtual bool IsExtensionSupported(const FString& Extension) const override
 	{
@@ -20,4 +25,17 @@ public:
 		|| Extension.Equals(TEXT("wave"), ESearchCase::IgnoreCase);
 	}
 	//~ End FBaseRuntimeCodec Interface
+
+	/**
+	 * Write a canonical RIFF header of 16-bit PCM data, the same layout as produced by Encode
+	 *
+	 * @param Writer Archive to write the header to
+	 * @param NumOfChannels Number of interleaved channels
+	 * @param SampleRate Sample rate of the data
+	 * @param DataSize Size of the 16-bit PCM data following the header, in bytes
+	 */
+	static void WriteHeader(FArchive& Writer, uint16 NumOfChannels, uint32 SampleRate, uint32 DataSize);
+
+	/** Size of the header written by WriteHeader */
+	static constexpr int32 HeaderSize = 44;
 };
@@ -0,0 +1,69 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
+#include "CoreMinimal.h"
+#include "RuntimeAudioImporterTypes.h"
+#include "HAL/CriticalSection.h"
+
+namespace RuntimeAudioImporter
+{
+	/**
+	 * Cache of the compressed audio resources prepared for MetaSounds, keyed by a hash of the PCM content
+	 * Recently prepared resources are kept in memory up to a size budget, and all resources are stored in the Saved directory,
+	 * so preparing the same clip again, from another sound wave or in another session, does not encode it again
+	 */
+	class RUNTIMEAUDIOIMPORTER_API FMetasoundResourceCache
+	{
+	public:
+		static FMetasoundResourceCache& Get();
+
+		/**
+		 * Compute the key of the PCM data, covering the samples, the layout and the format the resource is encoded to
+		 *
+		 * @param PCMInfo PCM data to compute the key of
+		 * @param NumOfChannels Number of channels of the PCM data
+		 * @param SampleRate Sample rate of the PCM data
+		 * @param Format Runtime format of the resource
+		 * @return Content hash of the PCM data
+		 */
+		static FString ComputeContentHash(const FPCMStruct& PCMInfo, uint32 NumOfChannels, uint32 SampleRate, FName Format);
+
+		/**
+		 * Find the resource of the content, looking in memory first and then on disk
+		 *
+		 * @param ContentHash Key computed by ComputeContentHash
+		 * @param OutResourceData Found resource data
+		 * @return Whether the resource was found or not
+		 */
+		bool Find(const FString& ContentHash, TArray64<uint8>& OutResourceData);
+
+		/**
+		 * Add the resource of the content to the memory cache and store it on disk
+		 *
+		 * @param ContentHash Key computed by ComputeContentHash
+		 * @param ResourceData Resource data to store
+		 */
+		void Add(const FString& ContentHash, const TArray64<uint8>& ResourceData);
+
+		/**
+		 * Remove all resources from memory, and optionally from disk
+		 */
+		void Clear(bool bDeleteFiles);
+
+	private:
+		FString GetCacheFilePath(const FString& ContentHash) const;
+
+		/** Add the resource to the memory cache, evicting the oldest resources over the size budget. Should only be used if CacheGuard is locked */
+		void AddToMemory_Internal(const FString& ContentHash, TSharedRef<const TArray64<uint8>> ResourceData);
+
+		FCriticalSection CacheGuard;
+
+		/** Resources kept in memory, and their keys from the oldest to the most recently used */
+		TMap<FString, TSharedRef<const TArray64<uint8>>> MemoryResources;
+		TArray<FString> MemoryResourceOrder;
+		int64 MemorySize = 0;
+	};
+}
+#endif
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "RuntimeAudioImporterTypes.h"
+#include "Serialization/BulkData.h"
 #include "PreImportedSoundAsset.generated.h"
 
 /**
@@ -17,7 +18,11 @@ class RUNTIMEAUDIOIMPORTER_API UPreImportedSoundAsset : public UObject
 public:
 	UPreImportedSoundAsset();
 
-	/** Audio data array */
+	//~ Begin UObject Interface
+	virtual void Serialize(FArchive& Ar) override;
+	//~ End UObject Interface
+
+	/** Audio data array. Empty in cooked builds if the audio data was cooked to a decoded format */
 	UPROPERTY()
 	TArray<uint8> AudioDataArray;
 
@@ -25,6 +30,29 @@ public:
 	UPROPERTY(Category = "Info", VisibleAnywhere, Meta = (DisplayName = "Audio format"))
 	ERuntimeAudioFormat AudioFormat;
 
+	/**
+	 * Representation of the audio data in cooked builds. Decoded formats take more disk space but are imported without decoding,
+	 * which suits frequently used sounds that have to start instantly
+	 */
+	UPROPERTY(Category = "Cooking", EditAnywhere, Meta = (DisplayName = "Cooked format"))
+	EPreImportedSoundCookedFormat CookedFormat;
+
+	/**
+	 * Check whether the asset contains audio data decoded at cook time
+	 *
+	 * @return True if the audio data can be imported without decoding
+	 */
+	bool HasCookedAudioData() const;
+
+	/**
+	 * Retrieve the audio data decoded at cook time. The payload is memory-mapped where the platform supports it and read directly into the decoded buffer
+	 * Can be called from any thread
+	 *
+	 * @param DecodedAudioInfo Decoded audio data
+	 * @return Whether the retrieval was successful or not
+	 */
+	bool GetCookedAudioData(FDecodedAudioStruct& DecodedAudioInfo) const;
+
 	/** Information about the basic details of an audio file. Used only for convenience in the editor */
 #if WITH_EDITORONLY_DATA
 	UPROPERTY(Category = "File Path", VisibleAnywhere, Meta = (DisplayName = "Source file path"))
@@ -39,4 +67,29 @@ public:
 	UPROPERTY(Category = "Info", VisibleAnywhere, Meta = (DisplayName = "Sample rate"))
 	int32 SampleRate;
 #endif
+
+protected:
+#if WITH_EDITOR
+	/**
+	 * Decode the audio data to the cooked format
+	 *
+	 * @return Whether the decoding was successful or not
+	 */
+	bool CacheCookedAudioData();
+#endif
+
+	/** Format of the cooked audio data. Original if there's no cooked audio data */
+	EPreImportedSoundCookedFormat CookedDataFormat;
+
+	/** Number of channels of the cooked audio data */
+	uint32 CookedNumOfChannels;
+
+	/** Sample rate of the cooked audio data */
+	uint32 CookedSampleRate;
+
+	/** Audio data decoded at cook time, interleaved in the cooked format */
+	mutable FByteBulkData CookedAudioData;
+
+	/** Guards the cooked audio data, which is read from the importer threads */
+	mutable FCriticalSection CookedAudioDataGuard;
 };
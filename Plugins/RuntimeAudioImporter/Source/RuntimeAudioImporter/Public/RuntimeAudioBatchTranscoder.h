@@ -0,0 +1,302 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "RuntimeAudioImporterTypes.h"
+#include "RuntimeAudioBatchTranscoder.generated.h"
+
+/** Possible states of a batch transcoding job */
+UENUM(BlueprintType, Category = "Runtime Audio Batch Transcoder")
+enum class ERuntimeAudioTranscodeJobStatus : uint8
+{
+	Pending,
+	Running,
+	Succeeded,
+	Failed,
+	Cancelled,
+	Invalid UMETA(Hidden)
+};
+
+/**
+ * Batch transcoding job, converting an encoded audio file into another format
+ */
+USTRUCT(BlueprintType, Category = "Runtime Audio Batch Transcoder")
+struct RUNTIMEAUDIOIMPORTER_API FRuntimeAudioTranscodeJob
+{
+	GENERATED_BODY()
+
+	FRuntimeAudioTranscodeJob()
+		: EncodedFormatFrom(ERuntimeAudioFormat::Auto)
+	  , EncodedFormatTo(ERuntimeAudioFormat::Auto)
+	  , Quality(100)
+	{}
+
+	/** Path to the file with the encoded audio data to transcode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Audio Batch Transcoder")
+	FString FilePathFrom;
+
+	/** The original format of the encoded audio data. Auto to determine it from the data */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Audio Batch Transcoder")
+	ERuntimeAudioFormat EncodedFormatFrom;
+
+	/** Path to save the transcoded audio data to */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Audio Batch Transcoder")
+	FString FilePathTo;
+
+	/** The desired format of the transcoded audio data. Auto to determine it from the extension of FilePathTo */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Audio Batch Transcoder")
+	ERuntimeAudioFormat EncodedFormatTo;
+
+	/** The quality of the transcoded audio data, from 0 to 100 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Audio Batch Transcoder")
+	uint8 Quality;
+
+	/** The override options for the transcoded audio data */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Audio Batch Transcoder")
+	FRuntimeAudioExportOverrideOptions OverrideOptions;
+};
+
+/**
+ * Summary of a batch transcoding run
+ */
+USTRUCT(BlueprintType, Category = "Runtime Audio Batch Transcoder")
+struct RUNTIMEAUDIOIMPORTER_API FRuntimeAudioBatchTranscodeReport
+{
+	GENERATED_BODY()
+
+	FRuntimeAudioBatchTranscodeReport()
+		: NumOfSucceededJobs(0)
+	  , NumOfFailedJobs(0)
+	  , NumOfCancelledJobs(0)
+	  , ElapsedTime(0.f)
+	  , AudioDuration(0.f)
+	  , FilesPerSecond(0.f)
+	  , RealtimeFactor(0.f)
+	  , NumOfBytesRead(0)
+	  , NumOfBytesWritten(0)
+	{}
+
+	/**
+	 * Converts the report to a readable format
+	 *
+	 * @return String representation of the report
+	 */
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("Succeeded: %d, failed: %d, cancelled: %d, elapsed: %.2f sec, audio: %.2f sec, %.2f files/s, %.1fx realtime, read: %lld bytes, written: %lld bytes"),
+			NumOfSucceededJobs, NumOfFailedJobs, NumOfCancelledJobs, ElapsedTime, AudioDuration, FilesPerSecond, RealtimeFactor, NumOfBytesRead, NumOfBytesWritten);
+	}
+
+	/** Number of jobs transcoded successfully */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	int32 NumOfSucceededJobs;
+
+	/** Number of jobs that failed to transcode */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	int32 NumOfFailedJobs;
+
+	/** Number of jobs cancelled before they finished */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	int32 NumOfCancelledJobs;
+
+	/** Wall time of the run, sec */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	float ElapsedTime;
+
+	/** Total duration of the transcoded audio, sec */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	float AudioDuration;
+
+	/** Number of successfully transcoded files per second of wall time */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	float FilesPerSecond;
+
+	/** Seconds of audio transcoded per second of wall time */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	float RealtimeFactor;
+
+	/** Total size of the source files read */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	int64 NumOfBytesRead;
+
+	/** Total size of the transcoded files written */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Batch Transcoder")
+	int64 NumOfBytesWritten;
+};
+
+/** Static delegate broadcasting the progress of the batch transcoding, each time a job finishes */
+DECLARE_DELEGATE_FourParams(FOnBatchTranscodeProgressNative, int32, ERuntimeAudioTranscodeJobStatus, int32, int32);
+
+/** Dynamic delegate broadcasting the progress of the batch transcoding, each time a job finishes */
+DECLARE_DYNAMIC_DELEGATE_FourParams(FOnBatchTranscodeProgress, int32, JobId, ERuntimeAudioTranscodeJobStatus, Status, int32, NumOfFinishedJobs, int32, NumOfJobs);
+
+/** Static delegate broadcasting the result of the batch transcoding, once all jobs are finished */
+DECLARE_DELEGATE_OneParam(FOnBatchTranscodeResultNative, const FRuntimeAudioBatchTranscodeReport&);
+
+/** Dynamic delegate broadcasting the result of the batch transcoding, once all jobs are finished */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnBatchTranscodeResult, const FRuntimeAudioBatchTranscodeReport&, Report);
+
+/**
+ * Runtime Audio Batch Transcoder
+ * Transcodes many encoded audio files on a bounded pool of workers
+ * Each worker pulls the next job only after finishing the previous one, so at most one file per worker is held in memory
+ * and the number of tasks occupying the task graph does not depend on the number of jobs
+ * The transcoder is kept alive while the batch is running, and its destruction waits for the workers to stop
+ */
+UCLASS(BlueprintType, Category = "Runtime Audio Batch Transcoder")
+class RUNTIMEAUDIOIMPORTER_API URuntimeAudioBatchTranscoder : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UObject Interface
+	virtual void BeginDestroy() override;
+	virtual bool IsReadyForFinishDestroy() override;
+	//~ End UObject Interface
+
+	/**
+	 * Create a batch transcoder
+	 *
+	 * @param MaxNumOfWorkers Maximum number of jobs transcoded in parallel. If 0 or less, the number of task graph worker threads is used
+	 * @return The created batch transcoder
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Batch Transcoder")
+	static URuntimeAudioBatchTranscoder* CreateRuntimeAudioBatchTranscoder(int32 MaxNumOfWorkers);
+
+	/**
+	 * Add a job to the batch. Jobs added while the batch is running are picked up by the running workers
+	 *
+	 * @param Job The job to add
+	 * @return Identifier of the added job
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Batch Transcoder")
+	int32 EnqueueJob(const FRuntimeAudioTranscodeJob& Job);
+
+	/**
+	 * Add a job for each audio file in the directory, saving the transcoded files under the same relative paths in the output directory
+	 *
+	 * @param DirectoryFrom The directory path to search for audio files
+	 * @param bRecursive Whether to search for files recursively in subdirectories
+	 * @param DirectoryTo The directory path to save the transcoded files to
+	 * @param EncodedFormatTo The desired format of the transcoded audio data. Must be a specific format, since it determines the extension of the transcoded files
+	 * @param Quality The quality of the transcoded audio data, from 0 to 100
+	 * @param OverrideOptions The override options for the transcoded audio data
+	 * @return Identifiers of the added jobs
+	 */
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Folder"), Category = "Runtime Audio Batch Transcoder")
+	TArray<int32> EnqueueDirectory(const FString& DirectoryFrom, bool bRecursive, const FString& DirectoryTo, ERuntimeAudioFormat EncodedFormatTo, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions);
+
+	/**
+	 * Start transcoding the enqueued jobs. Only the jobs that have not been run yet are processed
+	 *
+	 * @param Progress Delegate broadcasting the progress each time a job finishes
+	 * @param Result Delegate broadcasting the report once all jobs are finished
+	 * @return Whether the batch was started, i.e. it was not already running
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Batch Transcoder")
+	bool Run(const FOnBatchTranscodeProgress& Progress, const FOnBatchTranscodeResult& Result);
+
+	/**
+	 * Start transcoding the enqueued jobs. Suitable for use in C++
+	 *
+	 * @param Progress Delegate broadcasting the progress each time a job finishes
+	 * @param Result Delegate broadcasting the report once all jobs are finished
+	 * @return Whether the batch was started, i.e. it was not already running
+	 */
+	bool Run(const FOnBatchTranscodeProgressNative& Progress, const FOnBatchTranscodeResultNative& Result);
+
+	/**
+	 * Cancel a job. A pending job is skipped, a running job is stopped at the next stage (reading, transcoding or writing) and leaves no output file
+	 *
+	 * @param JobId Identifier of the job
+	 * @return Whether the job was pending or running
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Batch Transcoder")
+	bool CancelJob(int32 JobId);
+
+	/**
+	 * Cancel all pending and running jobs
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Batch Transcoder")
+	void CancelAllJobs();
+
+	/**
+	 * Get the status of a job
+	 *
+	 * @param JobId Identifier of the job
+	 * @return Status of the job, or Invalid if there is no such job
+	 */
+	UFUNCTION(BlueprintPure, Category = "Runtime Audio Batch Transcoder")
+	ERuntimeAudioTranscodeJobStatus GetJobStatus(int32 JobId) const;
+
+	/**
+	 * Whether the batch is currently running
+	 */
+	UFUNCTION(BlueprintPure, Category = "Runtime Audio Batch Transcoder")
+	bool IsRunning() const;
+
+protected:
+	/** Internal state of a job */
+	struct FJobState
+	{
+		FRuntimeAudioTranscodeJob Job;
+		ERuntimeAudioTranscodeJobStatus Status = ERuntimeAudioTranscodeJobStatus::Pending;
+		bool bCancelRequested = false;
+	};
+
+	/**
+	 * Start a worker if the running batch has pending jobs and fewer workers than allowed
+	 * The workers access the transcoder directly, which is safe since it is rooted while the batch is running and its destruction waits for them
+	 * Should only be used if JobsGuard is locked
+	 */
+	void SpawnWorkers_Internal();
+
+	/**
+	 * Worker loop, pulling and transcoding the pending jobs until there are none left. Runs on a background thread
+	 */
+	void RunWorker();
+
+	/**
+	 * Transcode a single job. Runs on a background thread
+	 *
+	 * @return Final status of the job
+	 */
+	ERuntimeAudioTranscodeJobStatus TranscodeJob(int32 JobId, const FRuntimeAudioTranscodeJob& Job, float& AudioDuration, int64& NumOfBytesRead, int64& NumOfBytesWritten);
+
+	/**
+	 * Whether the cancellation of the job was requested
+	 */
+	bool IsJobCancelled(int32 JobId) const;
+
+	/** Maximum number of jobs transcoded in parallel */
+	int32 MaxNumOfWorkers;
+
+	/** Jobs indexed by their identifiers */
+	TArray<FJobState> Jobs;
+
+	/** Index of the first job that may still be pending, so that the workers do not rescan the finished jobs */
+	int32 NextPendingJobIndex;
+
+	/** Number of workers currently running, including the ones that have been spawned but not started yet */
+	int32 NumOfActiveWorkers;
+
+	/** Whether the batch is running */
+	bool bRunning;
+
+	/** Number of jobs finished and the total number of jobs in the current run, for the progress */
+	int32 NumOfFinishedJobs;
+	int32 NumOfRunJobs;
+
+	/** Report accumulated during the current run */
+	FRuntimeAudioBatchTranscodeReport Report;
+	double RunStartTime;
+
+	/** Delegates of the current run */
+	FOnBatchTranscodeProgressNative ProgressDelegate;
+	FOnBatchTranscodeResultNative ResultDelegate;
+
+	/** Guard for the jobs and the run state */
+	mutable FCriticalSection JobsGuard;
+};
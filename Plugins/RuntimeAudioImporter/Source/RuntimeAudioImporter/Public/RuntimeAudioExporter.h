@@ -19,6 +19,12 @@ DECLARE_DELEGATE_OneParam(FOnAudioExportToFileResultNative, bool);
 /** Dynamic delegate broadcasting the result of the audio export to file */
 DECLARE_DYNAMIC_DELEGATE_OneParam(FOnAudioExportToFileResult, bool, bSucceeded);
 
+/** Static delegate broadcasting the progress of the streamed audio export to file */
+DECLARE_DELEGATE_OneParam(FOnAudioExportProgressNative, int32);
+
+/** Dynamic delegate broadcasting the progress of the streamed audio export to file */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnAudioExportProgress, int32, Percentage);
+
 
 /**
  * Runtime Audio Exporter
@@ -55,6 +61,44 @@ public:
 	 */
 	static void ExportSoundWaveToFile(TWeakObjectPtr<UImportedSoundWave> ImportedSoundWavePtr, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportToFileResultNative& Result);
 
+	/**
+	 * Export the imported sound wave to a file block by block, writing each block as soon as it is encoded
+	 * Memory usage does not depend on the duration of the sound wave, and the blocks are encoded in parallel (MP3 blocks are encoded in order, as the encoder keeps state between them)
+	 * Formats that can only be encoded as a whole (see IsStreamedExportSupported) are exported the same way as with ExportSoundWaveToFile
+	 *
+	 * @param ImportedSoundWave Imported sound wave to be exported
+	 * @param SavePath The path where the exported file will be saved
+	 * @param AudioFormat The desired audio format for the exported file. Note that some formats may not be supported
+	 * @param Quality The quality of the encoded audio data, from 0 to 100
+	 * @param OverrideOptions Override options for the export
+	 * @param Progress Delegate broadcasting the export progress, from 0 to 100
+	 * @param Result Delegate broadcasting the result
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Exporter")
+	static void ExportSoundWaveToFileStreamed(UImportedSoundWave* ImportedSoundWave, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportProgress& Progress, const FOnAudioExportToFileResult& Result);
+
+	/**
+	 * Export the imported sound wave to a file block by block, writing each block as soon as it is encoded. Suitable for use in C++
+	 *
+	 * @param ImportedSoundWavePtr Imported sound wave to be exported
+	 * @param SavePath The path where the exported file will be saved
+	 * @param AudioFormat The desired audio format for the exported file. Note that some formats may not be supported
+	 * @param Quality The quality of the encoded audio data, from 0 to 100
+	 * @param OverrideOptions Override options for the export
+	 * @param Progress Delegate broadcasting the export progress, from 0 to 100
+	 * @param Result Delegate broadcasting the result
+	 */
+	static void ExportSoundWaveToFileStreamed(TWeakObjectPtr<UImportedSoundWave> ImportedSoundWavePtr, const FString& SavePath, ERuntimeAudioFormat AudioFormat, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnAudioExportProgressNative& Progress, const FOnAudioExportToFileResultNative& Result);
+
+	/**
+	 * Check whether the audio format can be exported block by block, i.e. without encoding the whole sound wave in memory
+	 *
+	 * @param AudioFormat The audio format to check
+	 * @return Whether the streamed export is supported for the format
+	 */
+	UFUNCTION(BlueprintPure, Category = "Runtime Audio Exporter")
+	static bool IsStreamedExportSupported(ERuntimeAudioFormat AudioFormat);
+
 	/**
 	 * Export the imported sound wave into a buffer
 	 *
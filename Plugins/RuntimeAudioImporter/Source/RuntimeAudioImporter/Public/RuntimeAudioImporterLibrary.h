@@ -165,6 +165,15 @@ public:
 	 */
 	static bool DecodeAudioData(FEncodedAudioStruct&& EncodedAudioInfo, FDecodedAudioStruct& DecodedAudioInfo);
 
+	/**
+	 * Decode compressed audio data to uncompressed without copying the compressed data
+	 *
+	 * @param EncodedAudioInfo The encoded audio data, borrowed for the duration of the call
+	 * @param DecodedAudioInfo The decoded audio data. Its existing PCM buffer is reused where possible
+	 * @return Whether the decoding was successful or not
+	 */
+	static bool DecodeAudioData(const FEncodedAudioView& EncodedAudioInfo, FDecodedAudioStruct& DecodedAudioInfo);
+
 	/**
 	 * Encode uncompressed audio data to compressed.
 	 *
@@ -175,6 +184,16 @@ public:
 	 */
 	static bool EncodeAudioData(FDecodedAudioStruct&& DecodedAudioInfo, FEncodedAudioStruct& EncodedAudioInfo, uint8 Quality);
 
+	/**
+	 * Encode uncompressed audio data to compressed without copying the uncompressed data
+	 *
+	 * @param DecodedAudioInfo The decoded audio data, borrowed for the duration of the call
+	 * @param EncodedAudioInfo The encoded audio data
+	 * @param Quality The quality of the encoded audio data, from 0 to 100
+	 * @return Whether the encoding was successful or not
+	 */
+	static bool EncodeAudioData(const FDecodedAudioView& DecodedAudioInfo, FEncodedAudioStruct& EncodedAudioInfo, uint8 Quality);
+
 	/**
 	 * Import audio from 32-bit float PCM data
 	 *
@@ -95,6 +95,8 @@ namespace UE
 
 			FString GetDebugName() const { return FString(); }
 
+			bool HasWork() const { return bIsTaskRunning; }
+
 		private:
 			struct FTaskInfo
 			{
@@ -189,6 +191,25 @@ enum class ERuntimeRAWAudioFormat : uint8
 	Float32 UMETA(DisplayName = "Floating point 32-bit")
 };
 
+/** Possible representations of the audio data of a pre-imported sound asset in cooked builds, trading disk size against the import latency */
+UENUM(BlueprintType, Category = "Runtime Audio Importer")
+enum class EPreImportedSoundCookedFormat : uint8
+{
+	Original UMETA(DisplayName = "Original encoded data", ToolTip = "The encoded audio data as imported. Smallest on disk, fully decoded at runtime on every import"),
+	PCM16 UMETA(DisplayName = "16-bit PCM", ToolTip = "Decoded at cook time to 16-bit PCM. Converted to float at runtime in a single pass, without decoding"),
+	Float32 UMETA(DisplayName = "32-bit float PCM", ToolTip = "Decoded at cook time to 32-bit float PCM. Largest on disk, read directly into the sound wave at runtime")
+};
+
+/** Possible resampling quality tiers, from the cheapest to the most accurate */
+UENUM(BlueprintType, Category = "Runtime Audio Importer")
+enum class ERuntimeResamplingQuality : uint8
+{
+	Linear UMETA(ToolTip = "Linear interpolation. Cheapest, audible aliasing when downsampling"),
+	Cubic UMETA(ToolTip = "Cubic (Catmull-Rom) interpolation. Cheap, suitable for realtime paths that tolerate some aliasing"),
+	Polyphase UMETA(DisplayName = "Polyphase FIR", ToolTip = "Short windowed-sinc polyphase filter. Good quality at a realtime cost"),
+	BestSinc UMETA(ToolTip = "Long windowed-sinc filter. Offline quality")
+};
+
 /** Possible VAD (Voice Activity Detection) modes */
 UENUM(BlueprintType, Category = "Runtime Audio Importer")
 enum class ERuntimeVADMode : uint8
@@ -233,8 +254,10 @@ class FRuntimeBulkDataBuffer
 public:
 #if UE_VERSION_OLDER_THAN(4, 27, 0)
 	using ViewType = TArrayView<DataType>;
+	using ConstViewType = TArrayView<const DataType>;
 #else
 	using ViewType = TArrayView64<DataType>;
+	using ConstViewType = TArrayView64<const DataType>;
 #endif
 
 	FRuntimeBulkDataBuffer() = default;
@@ -301,7 +324,7 @@ public:
 			View = ViewType(View.GetData(), View.Num() + InNumberOfElements);
 			int64 NewReservedCapacity = ReservedCapacity - InNumberOfElements;
 			NewReservedCapacity = NewReservedCapacity < 0 ? 0 : NewReservedCapacity;
-			UE_LOG(LogRuntimeAudioImporter, Log, TEXT("Appending data to buffer (previous capacity: %lld, new capacity: %lld)"), ReservedCapacity, NewReservedCapacity);
+			UE_LOG(LogRuntimeAudioImporter, Verbose, TEXT("Appending data to buffer (previous capacity: %lld, new capacity: %lld)"), ReservedCapacity, NewReservedCapacity);
 			ReservedCapacity = NewReservedCapacity;
 		}
 		// Not enough reserved capacity or no reserved capacity, reallocate entire buffer
@@ -327,6 +350,40 @@ public:
 		}
 	}
 
+	/**
+	 * Make sure the given number of elements can be appended without reallocating
+	 * The capacity grows geometrically, so that repeated small appends (e.g. during capture) take amortized constant time
+	 *
+	 * @param NumOfElementsToAppend Number of elements about to be appended
+	 * @return True if the capacity is sufficient, false if the memory could not be allocated
+	 */
+	bool ReserveForAppend(int64 NumOfElementsToAppend)
+	{
+		if (NumOfElementsToAppend <= ReservedCapacity)
+		{
+			return true;
+		}
+
+		const int64 NumOfElements = View.Num();
+		const int64 NewReservedCapacity = FMath::Max(NumOfElementsToAppend, NumOfElements / 2);
+		DataType* NewBuffer = static_cast<DataType*>(FMemory::Malloc((NumOfElements + NewReservedCapacity) * sizeof(DataType)));
+		if (!NewBuffer)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate buffer to reserve memory for appending (new capacity: %lld)"), NumOfElements + NewReservedCapacity);
+			return false;
+		}
+
+		if (NumOfElements > 0)
+		{
+			FMemory::Memcpy(NewBuffer, View.GetData(), NumOfElements * sizeof(DataType));
+		}
+
+		FreeBuffer();
+		View = ViewType(NewBuffer, NumOfElements);
+		ReservedCapacity = NewReservedCapacity;
+		return true;
+	}
+
 	FRuntimeBulkDataBuffer(const FRuntimeBulkDataBuffer& Other)
 	{
 		*this = Other;
@@ -377,10 +434,11 @@ public:
 
 			const int64 BufferSize = Other.View.Num() + Other.ReservedCapacity;
 
+			// Only the elements in use are copied, the reserved capacity remains reserved in the copy
 			DataType* BufferCopy = static_cast<DataType*>(FMemory::Malloc(BufferSize * sizeof(DataType)));
-			FMemory::Memcpy(BufferCopy, Other.View.GetData(), BufferSize * sizeof(DataType));
+			FMemory::Memcpy(BufferCopy, Other.View.GetData(), Other.View.Num() * sizeof(DataType));
 
-			View = ViewType(BufferCopy, BufferSize);
+			View = ViewType(BufferCopy, Other.View.Num());
 			ReservedCapacity = Other.ReservedCapacity;
 		}
 
@@ -422,6 +480,55 @@ public:
 		return View;
 	}
 
+	/**
+	 * Resize the buffer to hold the given number of elements, reusing the existing allocation where possible
+	 * Existing elements are preserved when shrinking, otherwise the contents are left uninitialized
+	 *
+	 * @param NewNumberOfElements New number of elements
+	 * @return True if the buffer was successfully resized, false otherwise
+	 */
+	bool SetNumUninitialized(int64 NewNumberOfElements)
+	{
+		if (NewNumberOfElements <= 0)
+		{
+			Empty();
+			return true;
+		}
+
+		if (View.Num() == NewNumberOfElements && ReservedCapacity == 0)
+		{
+			return true;
+		}
+
+		DataType* NewBuffer;
+		if (View.GetData() != nullptr && View.Num() + ReservedCapacity >= NewNumberOfElements)
+		{
+			// Shrinking is usually done in place by the allocator
+			NewBuffer = static_cast<DataType*>(FMemory::Realloc(View.GetData(), NewNumberOfElements * sizeof(DataType)));
+		}
+		else
+		{
+			// Freeing first so that the old and the new buffers never coexist
+			FreeBuffer();
+			NewBuffer = static_cast<DataType*>(FMemory::Malloc(NewNumberOfElements * sizeof(DataType)));
+		}
+
+		if (!NewBuffer)
+		{
+			UE_LOG(LogRuntimeAudioImporter, Error, TEXT("Failed to allocate buffer to resize it (new size: %lld, %lld bytes)"), NewNumberOfElements, NewNumberOfElements * sizeof(DataType));
+			// A failed Realloc leaves the old buffer allocated, so it is freed here to keep the buffer empty on failure either way
+			FreeBuffer();
+			return false;
+		}
+
+#if UE_VERSION_OLDER_THAN(4, 27, 0)
+		check(NewNumberOfElements <= TNumericLimits<int32>::Max())
+#endif
+		View = ViewType(NewBuffer, NewNumberOfElements);
+		ReservedCapacity = 0;
+		return true;
+	}
+
 protected:
 	void FreeBuffer()
 	{
@@ -576,6 +683,91 @@ struct FEncodedAudioStruct
 	ERuntimeAudioFormat AudioFormat;
 };
 
+/** Read-only view of encoded audio data (e.g. a loaded file) that does not own the memory */
+using FRuntimeAudioDataView = FRuntimeBulkDataBuffer<uint8>::ConstViewType;
+
+/**
+ * Encoded audio information borrowed from another buffer
+ * Used by the codecs to avoid copying the encoded data. The referenced memory must outlive the view
+ */
+struct FEncodedAudioView
+{
+	FEncodedAudioView()
+		: AudioFormat(ERuntimeAudioFormat::Invalid)
+	{}
+
+	FEncodedAudioView(FRuntimeAudioDataView InAudioData, ERuntimeAudioFormat InAudioFormat)
+		: AudioData(InAudioData)
+	  , AudioFormat(InAudioFormat)
+	{}
+
+	template <typename Allocator>
+	FEncodedAudioView(const TArray<uint8, Allocator>& AudioDataArray, ERuntimeAudioFormat InAudioFormat)
+		: AudioData(AudioDataArray.GetData(), AudioDataArray.Num())
+	  , AudioFormat(InAudioFormat)
+	{}
+
+	explicit FEncodedAudioView(const FEncodedAudioStruct& EncodedData)
+		: AudioData(EncodedData.AudioData.GetView())
+	  , AudioFormat(EncodedData.AudioFormat)
+	{}
+
+	/**
+	 * Converts Encoded Audio View to a readable format
+	 *
+	 * @return String representation of the Encoded Audio View
+	 */
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("Validity of audio data in memory: %s, audio data size: %lld, audio format: %s"),
+			AudioData.IsValidIndex(0) ? TEXT("Valid") : TEXT("Invalid"), static_cast<int64>(AudioData.Num()),
+			*UEnum::GetValueAsName(AudioFormat).ToString());
+	}
+
+	/** Audio data */
+	FRuntimeAudioDataView AudioData;
+
+	/** Format of the audio data (e.g. mp3, flac, etc) */
+	ERuntimeAudioFormat AudioFormat;
+};
+
+/**
+ * Decoded audio information borrowed from another buffer
+ * Used by the codecs to avoid copying the PCM data. The referenced memory must outlive the view
+ */
+struct FDecodedAudioView
+{
+	FDecodedAudioView()
+		: PCMNumOfFrames(0)
+	{}
+
+	explicit FDecodedAudioView(const FDecodedAudioStruct& DecodedData)
+		: SoundWaveBasicInfo(DecodedData.SoundWaveBasicInfo)
+	  , PCMData(DecodedData.PCMInfo.PCMData.GetView())
+	  , PCMNumOfFrames(DecodedData.PCMInfo.PCMNumOfFrames)
+	{}
+
+	/**
+	 * Converts Decoded Audio View to a readable format
+	 *
+	 * @return String representation of the Decoded Audio View
+	 */
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("SoundWave Basic Info:\n%s\n\nPCM Info:\nNumber of PCM frames: %d, PCM data size: %lld"),
+			*SoundWaveBasicInfo.ToString(), PCMNumOfFrames, static_cast<int64>(PCMData.Num()));
+	}
+
+	/** SoundWave basic info (e.g. duration, number of channels, etc) */
+	FSoundWaveBasicStruct SoundWaveBasicInfo;
+
+	/** 32-bit float PCM data */
+	FRuntimeBulkDataBuffer<float>::ConstViewType PCMData;
+
+	/** Number of PCM frames */
+	uint32 PCMNumOfFrames;
+};
+
 /** Compressed sound wave information */
 USTRUCT(BlueprintType, Category = "Runtime Audio Importer")
 struct FCompressedSoundWaveInfo
@@ -0,0 +1,195 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "RuntimeAudioImporterTypes.h"
+#include "RuntimeAudioLibraryIndex.generated.h"
+
+/**
+ * Metadata of an indexed audio file
+ */
+USTRUCT(BlueprintType, Category = "Runtime Audio Library Index")
+struct RUNTIMEAUDIOIMPORTER_API FRuntimeAudioFileMetadata
+{
+	GENERATED_BODY()
+
+	FRuntimeAudioFileMetadata()
+		: AudioFormat(ERuntimeAudioFormat::Invalid)
+	  , Duration(0.f)
+	  , SampleRate(0)
+	  , NumOfChannels(0)
+	  , FileSize(0)
+	{}
+
+	/**
+	 * Whether the file was successfully probed as audio
+	 */
+	bool IsValidAudio() const
+	{
+		return AudioFormat != ERuntimeAudioFormat::Invalid && SampleRate > 0 && NumOfChannels > 0;
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FRuntimeAudioFileMetadata& Metadata);
+
+	/** Full path to the audio file */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	FString FilePath;
+
+	/** Format of the audio data, or Invalid if the file could not be probed */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	ERuntimeAudioFormat AudioFormat;
+
+	/** Audio duration, sec */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	float Duration;
+
+	/** Sample rate (samples per second, sampling frequency) */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	int32 SampleRate;
+
+	/** Number of channels */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	int32 NumOfChannels;
+
+	/** MD5 hash of the file contents, e.g. to detect duplicates */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	FString ContentHash;
+
+	/** Size of the file in bytes at the time it was indexed */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	int64 FileSize;
+
+	/** Modification time of the file at the time it was indexed */
+	UPROPERTY(BlueprintReadOnly, Category = "Runtime Audio Library Index")
+	FDateTime ModificationTime;
+};
+
+/** Static delegate broadcasting the result of scanning a directory into the audio library index */
+DECLARE_DELEGATE_TwoParams(FOnScanAudioLibraryResultNative, bool, const TArray<FRuntimeAudioFileMetadata>&);
+
+/** Dynamic delegate broadcasting the result of scanning a directory into the audio library index */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnScanAudioLibraryResult, bool, bSucceeded, const TArray<FRuntimeAudioFileMetadata>&, AudioFiles);
+
+/**
+ * Runtime Audio Library Index
+ * Keeps the metadata of audio files in an on-disk index keyed by the file path, size and modification time
+ * Scanning a directory only probes the files that are new or have changed since the last scan, and probing is done in parallel
+ * Once a directory has been scanned, its contents can be queried from the index without touching the disk
+ */
+UCLASS(BlueprintType, Category = "Runtime Audio Library Index")
+class RUNTIMEAUDIOIMPORTER_API URuntimeAudioLibraryIndex : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Create a library index, loading the previously saved entries if the index file exists
+	 *
+	 * @param IndexFilePath Path to the index file. If empty, the index is stored in the project's Saved directory
+	 * @return The created library index
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Library Index")
+	static URuntimeAudioLibraryIndex* CreateRuntimeAudioLibraryIndex(const FString& IndexFilePath);
+
+	/**
+	 * Scan the directory for audio files, probing only the files that are not in the index or have changed, and save the index
+	 *
+	 * @param Directory The directory path to scan for audio files
+	 * @param bRecursive Whether to search for files recursively in subdirectories
+	 * @param Result Delegate broadcasting the audio files found in the directory
+	 */
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Folder"), Category = "Runtime Audio Library Index")
+	void ScanDirectory(const FString& Directory, bool bRecursive, const FOnScanAudioLibraryResult& Result);
+
+	/**
+	 * Scan the directory for audio files, probing only the files that are not in the index or have changed, and save the index. Suitable for use in C++
+	 *
+	 * @param Directory The directory path to scan for audio files
+	 * @param bRecursive Whether to search for files recursively in subdirectories
+	 * @param Result Delegate broadcasting the audio files found in the directory
+	 */
+	void ScanDirectory(const FString& Directory, bool bRecursive, const FOnScanAudioLibraryResultNative& Result);
+
+	/**
+	 * Get the indexed audio files located in the directory, without accessing the disk
+	 * The directory has to be scanned first for the result to reflect its current contents
+	 *
+	 * @param Directory The directory path
+	 * @param bRecursive Whether to include the files in subdirectories
+	 * @return The indexed audio files
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Library Index")
+	TArray<FRuntimeAudioFileMetadata> GetIndexedAudioFiles(const FString& Directory, bool bRecursive) const;
+
+	/**
+	 * Find the metadata of an indexed audio file, without accessing the disk
+	 *
+	 * @param FilePath The path to the audio file
+	 * @param Metadata The found metadata
+	 * @return Whether the file is in the index and is a valid audio file
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Library Index")
+	bool FindAudioFileMetadata(const FString& FilePath, FRuntimeAudioFileMetadata& Metadata) const;
+
+	/**
+	 * Get the number of indexed audio files
+	 */
+	UFUNCTION(BlueprintPure, Category = "Runtime Audio Library Index")
+	int32 GetNumOfIndexedAudioFiles() const;
+
+	/**
+	 * Remove all entries from the index
+	 *
+	 * @param bDeleteIndexFile Whether to also delete the index file from disk
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Library Index")
+	void ClearIndex(bool bDeleteIndexFile);
+
+	/**
+	 * Save the index to disk
+	 *
+	 * @return Whether the index was saved successfully or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Audio Library Index")
+	bool SaveIndex();
+
+	/**
+	 * Get the path to the index file
+	 */
+	UFUNCTION(BlueprintPure, Category = "Runtime Audio Library Index")
+	const FString& GetIndexFilePath() const { return IndexFilePath; }
+
+protected:
+	/**
+	 * Load the entries from the index file, replacing the current ones
+	 *
+	 * @return Whether the index was loaded successfully or not
+	 */
+	bool LoadIndex();
+
+	/**
+	 * Scan the directory synchronously. Must be called from a background thread
+	 *
+	 * @return Whether the directory was scanned successfully or not
+	 */
+	bool ScanDirectory_Internal(const FString& Directory, bool bRecursive, TArray<FRuntimeAudioFileMetadata>& AudioFiles);
+
+	/**
+	 * Convert the path to the form used as the index key
+	 */
+	static FString NormalizePath(const FString& Path);
+
+	/** Path to the index file */
+	FString IndexFilePath;
+
+	/** Indexed entries keyed by the normalized file path. Includes the files that failed to probe, so that they are not probed again until they change */
+	TMap<FString, FRuntimeAudioFileMetadata> Entries;
+
+	/** Guard for the entries */
+	mutable FRWLock EntriesLock;
+
+	/** Guard serializing the writes to the index file */
+	FCriticalSection SaveGuard;
+};
@@ -146,6 +146,20 @@ public:
 	 */
 	static void TranscodeEncodedDataFromFile(const FString& FilePathFrom, ERuntimeAudioFormat EncodedFormatFrom, const FString& FilePathTo, ERuntimeAudioFormat EncodedFormatTo, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, const FOnEncodedDataTranscodeFromFileResultNative& Result);
 
+	/**
+	 * Transcode encoded data from one format into another on the calling thread
+	 *
+	 * @param EncodedDataFrom The encoded audio data to transcode. Released as soon as it is decoded
+	 * @param EncodedFormatFrom The original format of the encoded audio data
+	 * @param EncodedFormatTo The desired format of the transcoded encoded audio data
+	 * @param Quality The quality of the transcoded encoded audio data
+	 * @param OverrideOptions The override options for the encoded audio data (fill with -1 if you don't want to override)
+	 * @param EncodedDataTo The transcoded encoded audio data
+	 * @param SourceInfo Basic information about the decoded source audio data, e.g. its duration
+	 * @return Whether the transcoding was successful or not
+	 */
+	static bool TranscodeEncodedData_Internal(TArray64<uint8>&& EncodedDataFrom, ERuntimeAudioFormat EncodedFormatFrom, ERuntimeAudioFormat EncodedFormatTo, uint8 Quality, const FRuntimeAudioExportOverrideOptions& OverrideOptions, FEncodedAudioStruct& EncodedDataTo, FSoundWaveBasicStruct& SourceInfo);
+
 	/**
 	 * Helper function for transcoding RAW format
 	 * 
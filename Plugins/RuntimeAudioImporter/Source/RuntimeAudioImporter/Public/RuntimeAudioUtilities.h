@@ -66,6 +66,16 @@ public:
 	 */
 	static void GetAudioHeaderInfoFromFile(const FString& FilePath, const FOnGetAudioHeaderInfoResultNative& Result);
 
+	/**
+	 * Retrieve audio header (metadata) information from a file synchronously
+	 * Only the parts of the file that the format needs are read (e.g. the RIFF chunks, the FLAC STREAMINFO, the Ogg first and last pages or the MP3 VBR tag)
+	 *
+	 * @param FilePath The path to the audio file from which header information will be retrieved
+	 * @param HeaderInfo The retrieved header information
+	 * @return Whether the header information was successfully retrieved or not
+	 */
+	static bool GetAudioHeaderInfoFromFile(const FString& FilePath, FRuntimeAudioHeaderInfo& HeaderInfo);
+
 	/**
 	 * Retrieve audio header (metadata) information from a buffer
 	 *
@@ -83,6 +93,15 @@ public:
 	 */
 	static void GetAudioHeaderInfoFromBuffer(TArray64<uint8> AudioData, const FOnGetAudioHeaderInfoResultNative& Result);
 
+	/**
+	 * Retrieve audio header (metadata) information from a borrowed buffer synchronously. The audio data is not copied
+	 *
+	 * @param AudioData The audio data from which the header information will be retrieved
+	 * @param HeaderInfo The retrieved header information
+	 * @return Whether the header information was successfully retrieved or not
+	 */
+	static bool GetAudioHeaderInfoFromBuffer(FRuntimeAudioDataView AudioData, FRuntimeAudioHeaderInfo& HeaderInfo);
+
 	/**
 	 * Determine audio format based on audio data. A more advanced way to get the format. Suitable for use with 64-bit data size
 	 *
@@ -99,6 +118,14 @@ public:
 	 */
 	static TArray<ERuntimeAudioFormat> GetAudioFormatsAdvanced(const FRuntimeBulkDataBuffer<uint8>& AudioData);
 
+	/**
+	 * Determine audio format based on a borrowed view of the audio data. The audio data is not copied
+	 *
+	 * @param AudioData Audio data view
+	 * @return The found audio formats (e.g. mp3. flac, etc)
+	 */
+	static TArray<ERuntimeAudioFormat> GetAudioFormatsAdvanced(FRuntimeAudioDataView AudioData);
+
 	/**
 	 * Convert seconds to string (hh:mm:ss or mm:ss depending on the number of seconds)
 	 *
@@ -3,15 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
-#include "AudioCaptureCore.h"
-#if PLATFORM_IOS && !PLATFORM_TVOS
-#include "IOS/AudioCaptureIOS.h"
-#elif PLATFORM_ANDROID
-#include "Android/AudioCaptureAndroid.h"
-#endif
-#endif
 #include "StreamingSoundWave.h"
+#include "RuntimeCaptureRingBuffer.h"
+#include "RuntimeAudioCaptureSource.h"
+#include <atomic>
 #include "CapturableSoundWave.generated.h"
 
 /** Static delegate broadcasting available audio input devices */
@@ -20,6 +15,9 @@ DECLARE_DELEGATE_OneParam(FOnGetAvailableAudioInputDevicesResultNative, const TA
 /** Dynamic delegate broadcasting available audio input devices */
 DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGetAvailableAudioInputDevicesResult, const TArray<FRuntimeAudioInputDeviceInfo>&, AvailableDevices);
 
+/** Static delegate broadcasting captured audio data with its sample rate and number of channels. The data is referenced in place and is valid only during the broadcast */
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnCaptureAudioDataNative, TArrayView<const float>, int32, int32);
+
 /**
  * Sound wave that can capture audio data from input devices (eg. microphone)
  */
@@ -58,10 +56,26 @@ public:
 	 */
 	static void GetAvailableAudioInputDevices(const FOnGetAvailableAudioInputDevicesResultNative& Result);
 
+	/**
+	 * Set the source to capture from instead of an input device, e.g. a replayed file for testing without audio hardware
+	 * Stops the current capture, if any. The source is used from the next StartCapture. Suitable for use in C++
+	 *
+	 * @param InCaptureSource Capture source, or nullptr to capture from an input device again
+	 */
+	void SetCaptureSource(TSharedPtr<IRuntimeAudioCaptureSource> InCaptureSource);
+
+	/**
+	 * Get the source the sound wave captures from, if any. Suitable for use in C++
+	 */
+	TSharedPtr<IRuntimeAudioCaptureSource> GetCaptureSource() const
+	{
+		return CaptureSource;
+	}
+
 	/**
 	 * Start the capture process
 	 *
-	 * @param DeviceId Required device index (order as from GetAvailableAudioInputDevices)
+	 * @param DeviceId Required device index (order as from GetAvailableAudioInputDevices). Ignored if a capture source is set (see SetCaptureSource)
 	 * @return Whether the capture was started or not
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Capturable Sound Wave|Capture")
@@ -102,20 +116,78 @@ public:
 protected:
 	virtual bool IsCapturing_Implementation() const;
 
+public:
+	/**
+	 * Bind to this delegate to read the captured audio data in place, without copying (e.g. for speech recognition)
+	 * Broadcast from a background thread before the data is appended to the sound wave. Suitable for use in C++
+	 */
+	FOnCaptureAudioDataNative OnCaptureAudioDataNative;
+
+protected:
+	/**
+	 * Allocate the capture buffer if necessary and wait for the data of the previous capture to be processed
+	 * Must be called before the capture starts writing
+	 */
+	void PrepareCaptureBuffer_Internal();
+
+	/**
+	 * Write captured audio data to the capture buffer and schedule its processing
+	 * Called from the capture thread for every captured buffer, so it neither locks nor allocates
+	 *
+	 * @param PCMData Captured PCM data in 32-bit floating point interleaved format
+	 * @param NumOfFrames Number of captured frames
+	 * @param InNumOfChannels Number of channels of the captured data
+	 * @param InSampleRate Sample rate of the captured data
+	 */
+	void WriteCapturedAudio_Internal(const float* PCMData, int32 NumOfFrames, int32 InNumOfChannels, int32 InSampleRate);
+
+	/**
+	 * Process the audio data buffered in the capture buffer: broadcast it, run VAD and append it to the sound wave
+	 * Runs on the audio task pipe
+	 *
+	 * @param bFlush Whether to process all buffered data, including an incomplete block (see CaptureBlockNumOfFrames)
+	 */
+	void ProcessCapturedAudio_Internal(bool bFlush = false);
+
+	/**
+	 * Append a span of captured audio data to the sound wave
+	 * The data is appended directly if its format matches the format of the sound wave, and converted otherwise
+	 *
+	 * @param PCMData Captured PCM data consisting of whole frames
+	 * @param InSampleRate Sample rate of the captured data
+	 * @param InNumOfChannels Number of channels of the captured data
+	 */
+	void AppendCapturedAudio_Internal(TArrayView<const float> PCMData, int32 InSampleRate, int32 InNumOfChannels);
+
+	/** Buffer the capture callback writes to. Written by the capture thread and read on the audio task pipe */
+	FRuntimeCaptureRingBuffer CaptureBuffer;
+
+	/** Sample rate of the data in the capture buffer. Set by the capture thread before writing */
+	std::atomic<int32> CaptureSampleRate{0};
+
+	/** Number of channels of the data in the capture buffer. Set by the capture thread before writing */
+	std::atomic<int32> CaptureNumOfChannels{0};
+
+	/** Whether processing of the capture buffer has been scheduled and has not started yet */
+	std::atomic<bool> bCaptureProcessingScheduled{false};
+
+	/**
+	 * Number of frames the captured data is processed in. The processing is scheduled once a whole block is buffered, so its rate does not depend on how often the data is written
+	 * 0 to process the data as soon as it is written
+	 */
+	int32 CaptureBlockNumOfFrames = 0;
+
+	/** Reassembles the data split by the end of the capture buffer. Accessed only on the audio task pipe */
+	TArray<float> CaptureStitchBuffer;
+
 private:
-#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
-#if PLATFORM_IOS && !PLATFORM_TVOS
-	/** Audio capture instance specific to iOS. Implemented manually due to the engine not properly supporting iOS audio capture at the moment */
-	Audio::FAudioCaptureIOS AudioCapture;
-#elif PLATFORM_ANDROID
-	/** Audio capture instance specific to Android. Implemented manually due to the engine not properly supporting Android audio capture at the moment */
-	Audio::FAudioCaptureAndroid AudioCapture;
-#else
-	/** Audio capture instance */
-	Audio::FAudioCapture AudioCapture;
-#endif
+	/** Source the audio data is captured from. Either set explicitly (see SetCaptureSource) or an input device source created by StartCapture */
+	TSharedPtr<IRuntimeAudioCaptureSource> CaptureSource;
+
+	/** Whether the capture source was set explicitly rather than created for an input device */
+	bool bCustomCaptureSource = false;
+
 protected:
 	/** The last device index used for capture */
 	int32 LastDeviceIndex = -1;
-#endif
 };
@@ -0,0 +1,126 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImportedSoundWave.h"
+#include "Codecs/RuntimeStreamingDecoder.h"
+#include "DiskStreamedSoundWave.generated.h"
+
+/** Static delegate broadcasting the result of opening an audio file for disk streaming */
+DECLARE_DELEGATE_OneParam(FOnOpenAudioFileResultNative, bool);
+
+/** Dynamic delegate broadcasting the result of opening an audio file for disk streaming */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnOpenAudioFileResult, bool, bSucceeded);
+
+/**
+ * Disk-streamed sound wave. Decodes the audio file incrementally during playback instead of keeping all of its PCM data in memory
+ * Only a window of decoded audio data ahead of the playback position is kept in memory, and the played part is evicted
+ * Seeking (e.g. RewindPlaybackTime) is performed through the codec, which requires a codec supporting streaming decoding (MP3, WAV, FLAC, OGG Vorbis)
+ * Since the PCM data is not resident, PCM buffer based operations (GetPCMBufferCopy, ReverseAudioBuffer, ResampleSoundWave, MetaSounds) are not supported
+ */
+UCLASS(BlueprintType, Category = "Disk Streamed Sound Wave")
+class RUNTIMEAUDIOIMPORTER_API UDiskStreamedSoundWave : public UImportedSoundWave
+{
+	GENERATED_BODY()
+
+public:
+	UDiskStreamedSoundWave(const FObjectInitializer& ObjectInitializer);
+
+	/**
+	 * Create a new instance of the disk-streamed sound wave
+	 *
+	 * @return Created disk-streamed sound wave
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Disk Streamed Sound Wave|Main")
+	static UDiskStreamedSoundWave* CreateDiskStreamedSoundWave();
+
+	/**
+	 * Open an audio file for streaming playback. Only the header and the first window of audio data are decoded
+	 *
+	 * @param FilePath Path to the audio file
+	 * @param AudioFormat Audio format. If set to Auto, the format is determined from the file extension
+	 * @param Result Delegate broadcasting the result
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Disk Streamed Sound Wave|Main")
+	void OpenAudioFile(const FString& FilePath, ERuntimeAudioFormat AudioFormat, const FOnOpenAudioFileResult& Result);
+
+	/**
+	 * Open an audio file for streaming playback. Suitable for use in C++
+	 *
+	 * @param FilePath Path to the audio file
+	 * @param AudioFormat Audio format. If set to Auto, the format is determined from the file extension
+	 * @param Result Delegate broadcasting the result
+	 */
+	void OpenAudioFile(const FString& FilePath, ERuntimeAudioFormat AudioFormat, const FOnOpenAudioFileResultNative& Result);
+
+	/**
+	 * Set the duration of audio data decoded ahead of the playback position. Determines the memory footprint of the sound wave
+	 *
+	 * @param WindowDuration Duration of the decoded window, in seconds
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Disk Streamed Sound Wave|Properties")
+	void SetStreamingWindowDuration(float WindowDuration = 4);
+
+	/**
+	 * Get the path of the streamed audio file
+	 */
+	UFUNCTION(BlueprintPure, Category = "Disk Streamed Sound Wave|Info")
+	FString GetStreamedFilePath() const;
+
+	//~ Begin UObject Interface
+	virtual bool IsReadyForFinishDestroy() override;
+	//~ End UObject Interface
+
+	//~ Begin USoundWaveProcedural Interface
+	virtual int32 OnGeneratePCMAudio(TArray<uint8>& OutAudio, int32 NumSamples) override;
+	//~ End USoundWaveProcedural Interface
+
+	//~ Begin UImportedSoundWave Interface
+	using UImportedSoundWave::DuplicateSoundWave;
+	virtual void DuplicateSoundWave(bool bUseSharedAudioBuffer, const FOnDuplicateSoundWaveNative& Result) override;
+	virtual void ReleaseMemory() override;
+	virtual bool SetNumOfPlayedFrames_Internal(uint32 NumOfFrames) override;
+	//~ End UImportedSoundWave Interface
+
+protected:
+	/**
+	 * Schedule decoding of the window ahead of the playback position if it is running low
+	 * Should only be used if DataGuard is locked
+	 */
+	void SchedulePrefetch_Internal();
+
+	/**
+	 * Decode audio data into the window until it is full. Executed in the decode task pipe
+	 */
+	void PrefetchWindow();
+
+	/**
+	 * Get the number of frames kept decoded ahead of the playback position
+	 */
+	int64 GetWindowCapacity() const;
+
+	/** The decode task pipe (decoder access is sequential, so the decoder itself needs no locking) */
+	TUniquePtr<UE::Tasks::FPipe> DecodeTaskPipe;
+
+	/** Decoder of the audio file. Accessed only from the decode task pipe */
+	TUniquePtr<FRuntimeStreamingDecoder> Decoder;
+
+	/** Path of the streamed audio file */
+	FString StreamedFilePath;
+
+	/** Decoded interleaved PCM data of the window, starting from WindowStartFrame. Guarded by DataGuard */
+	TArray<float> WindowPCMData;
+
+	/** Index of the first frame in the window. Guarded by DataGuard */
+	int64 WindowStartFrame;
+
+	/** Incremented on every seek outside of the window, so that data decoded before the seek is discarded. Guarded by DataGuard */
+	uint32 SeekGeneration;
+
+	/** Whether a prefetch task has been scheduled and has not finished yet. Guarded by DataGuard */
+	bool bPrefetchScheduled;
+
+	/** Duration of audio data decoded ahead of the playback position, in seconds */
+	float StreamingWindowDuration;
+};
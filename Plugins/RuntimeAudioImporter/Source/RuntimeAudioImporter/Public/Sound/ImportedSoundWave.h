@@ -5,6 +5,7 @@
 #include "RuntimeAudioImporterTypes.h"
 #include "Sound/SoundWaveProcedural.h"
 #include "Misc/Optional.h"
+#include "Async/Future.h"
 #include "ImportedSoundWave.generated.h"
 
 class UImportedSoundWave;
@@ -75,6 +76,7 @@ DECLARE_DYNAMIC_DELEGATE_OneParam(FOnReverseAudioData, bool, bSucceeded);
  * Imported sound wave. Assumed to be dynamically populated once from the decoded audio data.
  * Accumulates audio data in 32-bit interleaved floating-point format.
  * Only a single playback is supported at a time (see DuplicateSoundWave for parallel playback)
+ * The PCM data is reference-counted and copy-on-write, so duplicates can share it while keeping their own playback state
  * Audio data preparation takes place in the Runtime Audio Importer library
  */
 UCLASS(BlueprintType, Category = "Imported Sound Wave")
@@ -109,8 +111,9 @@ public:
 
 	/**
 	 * Duplicate the sound wave to be able to play it in parallel
+	 * The duplicate has its own playback position, volume, pitch and looping, initialized from this sound wave
 	 * 
-	 * @param bUseSharedAudioBuffer Whether to use the same audio buffer for the duplicated sound wave or not
+	 * @param bUseSharedAudioBuffer Whether to share the audio buffer with the duplicated sound wave instead of copying it. The buffer is shared until either sound wave modifies its audio data (e.g. appends, resamples or releases it), which then gets a private copy
 	 * @param Result Delegate broadcasting the result
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Imported Sound Wave|Main")
@@ -118,8 +121,9 @@ public:
 
 	/**
 	 * Duplicate the sound wave to be able to play it in parallel. Suitable for use in C++
+	 * The duplicate has its own playback position, volume, pitch and looping, initialized from this sound wave
 	 * 
-	 * @param bUseSharedAudioBuffer Whether to use the same audio buffer for the duplicated sound wave or not
+	 * @param bUseSharedAudioBuffer Whether to share the audio buffer with the duplicated sound wave instead of copying it. The buffer is shared until either sound wave modifies its audio data (e.g. appends, resamples or releases it), which then gets a private copy
 	 * @param Result Delegate broadcasting the result
 	 */
 	virtual void DuplicateSoundWave(bool bUseSharedAudioBuffer, const FOnDuplicateSoundWaveNative& Result);
@@ -148,6 +152,16 @@ public:
 	 */
 	void PrepareSoundWaveForMetaSounds(const FOnPrepareSoundWaveForMetaSoundsResultNative& Result);
 
+	/**
+	 * Prepare this sound wave to be able to set wave parameter for MetaSounds on a background thread. Suitable for use in C++
+	 * Short sounds are wrapped as 16-bit PCM without any encoding, longer sounds are encoded to Vorbis (see RuntimeAudioImporter.MetaSounds.MaxPCMResourceMB),
+	 * with the encoded resource cached by content, so preparing the same audio data again costs no encoding. Calls made while a preparation is in progress share its result
+	 *
+	 * @return Future resolved with whether the preparation succeeded, on a background thread. Set the wave parameter only after it has been resolved
+	 * @warning This works if bEnableMetaSoundSupport is enabled in RuntimeAudioImporter.Build.cs/RuntimeAudioImporterEditor.Build.cs and only on Unreal Engine version >= 5.2
+	 */
+	TFuture<bool> PrepareSoundWaveForMetaSoundsAsync();
+
 	/**
 	 * Release sound wave data. Call it manually only if you are sure of it
 	 */
@@ -239,10 +253,11 @@ public:
 	 *
 	 * @note This is not thread-safe at the moment
 	 * @param NewSampleRate The new sample rate
+	 * @param Quality Resampling quality tier. Lower tiers are considerably faster, e.g. for realtime use
 	 * @return Whether the sound wave was resampled or not
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Imported Sound Wave|Main")
-	bool ResampleSoundWave(int32 NewSampleRate);
+	bool ResampleSoundWave(int32 NewSampleRate, ERuntimeResamplingQuality Quality = ERuntimeResamplingQuality::BestSinc);
 
 	// TODO: Make this async
 	/**
@@ -301,7 +316,7 @@ public:
 	 * Thread-unsafe equivalent of SetNumOfPlayedFrames
 	 * Should only be used if DataGuard is locked
 	 */
-	bool SetNumOfPlayedFrames_Internal(uint32 NumOfFrames);
+	virtual bool SetNumOfPlayedFrames_Internal(uint32 NumOfFrames);
 
 	/**
 	 * Get the number of frames played back
@@ -464,6 +479,21 @@ public:
 	 */
 	const FPCMStruct& GetPCMBuffer() const;
 
+	/**
+	 * Get a reference to the current PCM buffer without copying it
+	 * The referenced data stays valid and unchanged even if the sound wave is modified afterwards, since modifications detach the sound wave from the referenced buffer
+	 * Should only be used if DataGuard is locked
+	 *
+	 * @return Shared PCM buffer in 32-bit float format
+	 */
+	TSharedPtr<const FPCMStruct> GetPCMBufferSnapshot_Internal() const;
+
+	/**
+	 * Whether the audio buffer is currently shared with other sound waves (see DuplicateSoundWave)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Imported Sound Wave|Info")
+	bool IsAudioBufferShared() const;
+
 	/**
 	 * Get audio format of the audio imported into the sound wave
 	 * @return Audio format
@@ -481,9 +511,18 @@ protected:
 	/** The number of frames played. Increments during playback, should not be > PCMBufferInfo.PCMNumOfFrames */
 	uint32 PlayedNumOfFrames;
 
-	/** Contains PCM data for sound wave playback */
+	/** Contains PCM data for sound wave playback. May be shared with duplicated sound waves, so it must not be modified in place (see GetMutablePCMBuffer_Internal) */
 	TSharedPtr<FPCMStruct> PCMBufferInfo;
 
+	/**
+	 * Get the PCM buffer for modification, detaching it from the sound waves it is shared with (copy-on-write)
+	 * Should only be used if DataGuard is locked
+	 *
+	 * @param bPreserveData Whether the detached buffer should contain the current data. Pass false if the data is about to be replaced entirely; the number of frames is carried over either way
+	 * @return PCM buffer owned exclusively by this sound wave
+	 */
+	FPCMStruct& GetMutablePCMBuffer_Internal(bool bPreserveData = true);
+
 	/** Whether to stop the sound at the end of playback or not. Sound wave will not be garbage collected if playback was completed while this parameter is set to false */
 	bool bStopSoundOnPlaybackFinish;
 
@@ -495,4 +534,18 @@ protected:
 
 	/** Initial desired number of channels of the sound wave (see SetInitialDesiredNumChannels) */
 	TOptional<uint32> InitialDesiredNumOfChannels;
+
+#if WITH_RUNTIMEAUDIOIMPORTER_METASOUND_SUPPORT
+	/**
+	 * Get the runtime format the audio resource for MetaSounds is prepared in, depending on the size of the PCM data
+	 * Should only be used if DataGuard is locked
+	 */
+	FName GetMetaSoundsRuntimeFormat_Internal() const;
+
+	/** Runtime format of the initialized audio resource, or none if the resource has not been initialized yet */
+	FName MetaSoundsRuntimeFormat;
+
+	/** Promises of the calls waiting for the MetaSounds preparation in progress, if any */
+	TSharedPtr<TArray<TSharedRef<TPromise<bool>>>> PendingMetaSoundsPreparation;
+#endif
 };
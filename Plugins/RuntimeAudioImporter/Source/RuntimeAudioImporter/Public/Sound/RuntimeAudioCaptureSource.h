@@ -0,0 +1,341 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Math/RandomStream.h"
+#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
+#include "AudioCaptureCore.h"
+#if PLATFORM_IOS && !PLATFORM_TVOS
+#include "IOS/AudioCaptureIOS.h"
+#elif PLATFORM_ANDROID
+#include "Android/AudioCaptureAndroid.h"
+#endif
+#endif
+#include <atomic>
+
+class FRunnableThread;
+
+/**
+ * Callback receiving captured audio data, called from the thread of the capture source
+ *
+ * @param PCMData Captured PCM data in 32-bit floating point interleaved format, valid only during the call
+ * @param NumOfFrames Number of captured frames
+ * @param NumOfChannels Number of channels of the captured data
+ * @param SampleRate Sample rate of the captured data
+ */
+using FOnRuntimeCaptureSourceAudio = TFunction<void(const float* PCMData, int32 NumOfFrames, int32 NumOfChannels, int32 SampleRate)>;
+
+/**
+ * Source of captured audio data, e.g. an input device or a replayed file
+ * Follows the stream lifecycle of Audio::FAudioCapture: the stream is opened with a callback, then started and stopped any number of times, then closed
+ * Must be opened, started, stopped and closed from a single thread other than the capture thread
+ */
+class RUNTIMEAUDIOIMPORTER_API IRuntimeAudioCaptureSource
+{
+public:
+	virtual ~IRuntimeAudioCaptureSource() = default;
+
+	/**
+	 * Open the stream. Nothing is captured until the stream is started
+	 *
+	 * @param OnCapture Callback receiving the captured audio data
+	 * @return Whether the stream was opened or not
+	 */
+	virtual bool OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture) = 0;
+
+	/**
+	 * Close the stream, stopping it if necessary. The callback is not called after this returns
+	 */
+	virtual bool CloseStream() = 0;
+
+	/**
+	 * Start or resume capturing
+	 */
+	virtual bool StartStream() = 0;
+
+	/**
+	 * Pause capturing without closing the stream. The callback is not called after this returns
+	 */
+	virtual bool StopStream() = 0;
+
+	virtual bool IsStreamOpen() const = 0;
+	virtual bool IsCapturing() const = 0;
+
+	/**
+	 * Get the sample rate of the captured data. Valid once the stream is open
+	 */
+	virtual int32 GetSampleRate() const = 0;
+
+	/**
+	 * Get the number of channels of the captured data. Valid once the stream is open
+	 */
+	virtual int32 GetNumOfChannels() const = 0;
+
+	/**
+	 * Get a human-readable description of the source, for logging
+	 */
+	virtual FString GetDescription() const = 0;
+};
+
+#if WITH_RUNTIMEAUDIOIMPORTER_CAPTURE_SUPPORT
+/**
+ * Capture source reading from an audio input device (e.g. a microphone)
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeDeviceCaptureSource : public IRuntimeAudioCaptureSource
+{
+public:
+	/**
+	 * @param InDeviceIndex Device index (order as from UCapturableSoundWave::GetAvailableAudioInputDevices), INDEX_NONE for the default device
+	 * @param InNumOfFramesDesired Number of frames the device is asked to deliver per callback
+	 */
+	explicit FRuntimeDeviceCaptureSource(int32 InDeviceIndex = INDEX_NONE, int32 InNumOfFramesDesired = 1024);
+	virtual ~FRuntimeDeviceCaptureSource() override;
+
+	//~ Begin IRuntimeAudioCaptureSource Interface
+	virtual bool OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture) override;
+	virtual bool CloseStream() override;
+	virtual bool StartStream() override;
+	virtual bool StopStream() override;
+	virtual bool IsStreamOpen() const override;
+	virtual bool IsCapturing() const override;
+	virtual int32 GetSampleRate() const override;
+	virtual int32 GetNumOfChannels() const override;
+	virtual FString GetDescription() const override;
+	//~ End IRuntimeAudioCaptureSource Interface
+
+private:
+#if PLATFORM_IOS && !PLATFORM_TVOS
+	/** Audio capture instance specific to iOS. Implemented manually due to the engine not properly supporting iOS audio capture at the moment */
+	Audio::FAudioCaptureIOS AudioCapture;
+#elif PLATFORM_ANDROID
+	/** Audio capture instance specific to Android. Implemented manually due to the engine not properly supporting Android audio capture at the moment */
+	Audio::FAudioCaptureAndroid AudioCapture;
+#else
+	/** Audio capture instance */
+	Audio::FAudioCapture AudioCapture;
+#endif
+
+	int32 DeviceIndex;
+	int32 NumOfFramesDesired;
+
+	/** Number of input channels of the device, known once the stream is open */
+	int32 NumOfChannels = 0;
+
+	FOnRuntimeCaptureSourceAudio OnCaptureAudio;
+};
+#endif
+
+/**
+ * Capture source generating its data on its own thread, delivering it in fixed-size buffers paced like a real device
+ * Does not depend on any audio hardware, so the capture path can be driven deterministically, e.g. on a headless machine
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeGeneratedCaptureSource : public IRuntimeAudioCaptureSource, public FRunnable
+{
+public:
+	/**
+	 * @param InSpeed Delivery speed relative to realtime, e.g. 1 to deliver at the rate of a real device, 4 to deliver four times faster. 0 to deliver as fast as possible
+	 * @param InNumOfFramesPerBuffer Number of frames delivered per callback
+	 */
+	FRuntimeGeneratedCaptureSource(float InSpeed, int32 InNumOfFramesPerBuffer);
+
+	/** Derived classes must stop the stream in their destructors, as the thread calls into them */
+	virtual ~FRuntimeGeneratedCaptureSource() override;
+
+	//~ Begin IRuntimeAudioCaptureSource Interface
+	virtual bool OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture) override;
+	virtual bool CloseStream() override;
+	virtual bool StartStream() override;
+	virtual bool StopStream() override;
+	virtual bool IsStreamOpen() const override { return bStreamOpen; }
+	virtual bool IsCapturing() const override { return bCapturing; }
+	virtual int32 GetSampleRate() const override { return SampleRate; }
+	virtual int32 GetNumOfChannels() const override { return NumOfChannels; }
+	//~ End IRuntimeAudioCaptureSource Interface
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+	/**
+	 * Get the total number of frames delivered since the stream was opened
+	 */
+	int64 GetNumOfDeliveredFrames() const
+	{
+		return NumOfDeliveredFrames.load(std::memory_order_relaxed);
+	}
+
+protected:
+	/**
+	 * Generate the next audio data. Called on the thread of the source
+	 *
+	 * @param PCMData Buffer to fill with interleaved samples in the format of the source
+	 * @param NumOfFrames Number of frames the buffer holds
+	 * @return Number of frames generated, 0 if no data is available yet, or INDEX_NONE if the stream has ended
+	 */
+	virtual int32 GenerateAudio(float* PCMData, int32 NumOfFrames) = 0;
+
+	/** Sample rate of the generated data. Must be set by the time the base OpenStream is called */
+	int32 SampleRate = 0;
+
+	/** Number of channels of the generated data. Must be set by the time the base OpenStream is called */
+	int32 NumOfChannels = 0;
+
+	float Speed;
+	int32 NumOfFramesPerBuffer;
+
+private:
+	FOnRuntimeCaptureSourceAudio OnCaptureAudio;
+
+	/** Thread delivering the data while the stream is started */
+	FRunnableThread* Thread = nullptr;
+
+	bool bStreamOpen = false;
+	std::atomic<bool> bCapturing{false};
+	std::atomic<bool> bStopRequested{false};
+	std::atomic<int64> NumOfDeliveredFrames{0};
+
+	/** Buffer the data is generated to. Accessed only on the thread of the source */
+	TArray<float> GenerationBuffer;
+};
+
+/**
+ * Capture source replaying an audio file (WAV, or any other format supported by the importer) in its own format
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeFileCaptureSource : public FRuntimeGeneratedCaptureSource
+{
+public:
+	/**
+	 * @param InFilePath Path to the audio file. Decoded when the stream is opened
+	 * @param InSpeed Delivery speed relative to realtime, 0 to deliver as fast as possible
+	 * @param bInLoop Whether to restart from the beginning at the end of the file instead of ending the stream
+	 * @param InNumOfFramesPerBuffer Number of frames delivered per callback
+	 */
+	explicit FRuntimeFileCaptureSource(const FString& InFilePath, float InSpeed = 1.f, bool bInLoop = false, int32 InNumOfFramesPerBuffer = 1024);
+	virtual ~FRuntimeFileCaptureSource() override;
+
+	//~ Begin IRuntimeAudioCaptureSource Interface
+	virtual bool OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture) override;
+	virtual FString GetDescription() const override;
+	//~ End IRuntimeAudioCaptureSource Interface
+
+protected:
+	//~ Begin FRuntimeGeneratedCaptureSource Interface
+	virtual int32 GenerateAudio(float* PCMData, int32 NumOfFrames) override;
+	//~ End FRuntimeGeneratedCaptureSource Interface
+
+private:
+	FString FilePath;
+	bool bLoop;
+
+	/** Decoded PCM data of the file, kept between the openings of the stream */
+	TArray<float> FilePCMData;
+
+	/** Read position in frames. Accessed only on the thread of the source */
+	int64 ReadFrame = 0;
+};
+
+/** Settings of the synthetic capture source */
+struct FRuntimeSyntheticCaptureSourceSettings
+{
+	int32 SampleRate = 16000;
+	int32 NumOfChannels = 1;
+
+	/** Frequency of the tone in Hz */
+	float ToneFrequency = 220.f;
+
+	/** Peak amplitude of the tone, 0 for noise only */
+	float ToneAmplitude = 0.3f;
+
+	/** Peak amplitude of the white noise added on top of the tone */
+	float NoiseAmplitude = 0.01f;
+
+	/** Duration in seconds the tone is played for before each pause, so that the data alternates between activity and silence like speech. 0 to play the tone continuously */
+	float BurstDuration = 0.f;
+
+	/** Duration in seconds of the pauses between the tone bursts */
+	float PauseDuration = 0.f;
+
+	/** Seed of the noise, so that runs with the same settings deliver the same data */
+	int32 Seed = 0;
+};
+
+/**
+ * Capture source generating a tone with white noise, optionally in bursts
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeSyntheticCaptureSource : public FRuntimeGeneratedCaptureSource
+{
+public:
+	/**
+	 * @param InSettings Settings of the generated signal
+	 * @param InSpeed Delivery speed relative to realtime, 0 to deliver as fast as possible
+	 * @param InNumOfFramesPerBuffer Number of frames delivered per callback
+	 */
+	explicit FRuntimeSyntheticCaptureSource(const FRuntimeSyntheticCaptureSourceSettings& InSettings, float InSpeed = 1.f, int32 InNumOfFramesPerBuffer = 1024);
+	virtual ~FRuntimeSyntheticCaptureSource() override;
+
+	//~ Begin IRuntimeAudioCaptureSource Interface
+	virtual bool OpenStream(FOnRuntimeCaptureSourceAudio&& OnCapture) override;
+	virtual FString GetDescription() const override;
+	//~ End IRuntimeAudioCaptureSource Interface
+
+protected:
+	//~ Begin FRuntimeGeneratedCaptureSource Interface
+	virtual int32 GenerateAudio(float* PCMData, int32 NumOfFrames) override;
+	//~ End FRuntimeGeneratedCaptureSource Interface
+
+private:
+	FRuntimeSyntheticCaptureSourceSettings Settings;
+
+	/** Noise generator and position of the signal. Accessed only on the thread of the source */
+	FRandomStream Random;
+	int64 GeneratedFrame = 0;
+};
+
+/**
+ * Capture source delivering the audio data pushed to it from within the process (e.g. by a test driving the capture path), and silence when there is none, like an idle microphone
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeLoopbackCaptureSource : public FRuntimeGeneratedCaptureSource
+{
+public:
+	/**
+	 * @param InSampleRate Sample rate of the pushed and the delivered data
+	 * @param InNumOfChannels Number of channels of the pushed and the delivered data
+	 * @param InSpeed Delivery speed relative to realtime. 0 to deliver only the pushed data, as fast as possible, without filling the gaps with silence
+	 * @param InNumOfFramesPerBuffer Number of frames delivered per callback
+	 */
+	FRuntimeLoopbackCaptureSource(int32 InSampleRate, int32 InNumOfChannels, float InSpeed = 1.f, int32 InNumOfFramesPerBuffer = 1024);
+	virtual ~FRuntimeLoopbackCaptureSource() override;
+
+	//~ Begin IRuntimeAudioCaptureSource Interface
+	virtual FString GetDescription() const override;
+	//~ End IRuntimeAudioCaptureSource Interface
+
+	/**
+	 * Queue audio data to be delivered. Can be called from any thread
+	 *
+	 * @param PCMData PCM data in 32-bit floating point interleaved format, in the format of the source
+	 */
+	void PushAudio(TArrayView<const float> PCMData);
+
+	/**
+	 * Get the number of queued frames not yet delivered
+	 */
+	int64 GetNumOfQueuedFrames() const;
+
+protected:
+	//~ Begin FRuntimeGeneratedCaptureSource Interface
+	virtual int32 GenerateAudio(float* PCMData, int32 NumOfFrames) override;
+	//~ End FRuntimeGeneratedCaptureSource Interface
+
+private:
+	mutable FCriticalSection QueueGuard;
+
+	/** Pushed samples, of which the ones from QueueReadIndex on are not yet delivered */
+	TArray<float> QueuedPCMData;
+
+	/** Number of delivered samples at the beginning of the queue. They are removed only once they outnumber the rest, so that delivering stays linear in the queued data */
+	int32 QueueReadIndex = 0;
+};
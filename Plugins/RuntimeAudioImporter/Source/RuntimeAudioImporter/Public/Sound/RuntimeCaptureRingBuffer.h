@@ -0,0 +1,83 @@
+﻿// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Single-producer single-consumer lock-free ring of interleaved 32-bit float samples
+ * The producer (e.g. an audio capture callback) writes without locking or allocating, and the consumer reads the buffered samples in place
+ */
+class RUNTIMEAUDIOIMPORTER_API FRuntimeCaptureRingBuffer
+{
+public:
+	/**
+	 * Allocate the ring, discarding any buffered samples
+	 * Must not be called while the producer or the consumer is active
+	 *
+	 * @param InCapacity Number of samples the ring can hold
+	 */
+	void Init(int64 InCapacity);
+
+	/**
+	 * Get the number of samples the ring can hold
+	 */
+	int64 GetCapacity() const
+	{
+		return Buffer.Num();
+	}
+
+	/**
+	 * Write samples to the ring. Producer only
+	 * The samples are written either entirely or not at all, so that interleaved frames are never split by an overflow
+	 *
+	 * @param Samples Samples to write
+	 * @param NumOfSamples Number of samples to write
+	 * @return True if the samples were written, false if there was not enough free space and they were dropped
+	 */
+	bool Write(const float* Samples, int64 NumOfSamples);
+
+	/**
+	 * Get the number of samples that can be read. Consumer only
+	 */
+	int64 GetNumOfReadableSamples() const;
+
+	/**
+	 * Get the readable samples in place, in order. Consumer only
+	 * The samples are split into two spans if they wrap around the end of the ring. The spans stay valid until Consume is called
+	 *
+	 * @param NumOfSamples Number of samples to get, must not exceed GetNumOfReadableSamples
+	 * @param OutFirst The first span of the samples
+	 * @param OutSecond The second span of the samples, empty if the samples do not wrap around
+	 */
+	void Peek(int64 NumOfSamples, TArrayView<const float>& OutFirst, TArrayView<const float>& OutSecond) const;
+
+	/**
+	 * Release the given number of read samples, making space for the producer. Consumer only
+	 *
+	 * @param NumOfSamples Number of samples to release, must not exceed GetNumOfReadableSamples
+	 */
+	void Consume(int64 NumOfSamples);
+
+	/**
+	 * Get and reset the number of samples dropped by the producer since the last call due to overflow
+	 */
+	int64 ExchangeNumOfDroppedSamples()
+	{
+		return NumOfDroppedSamples.exchange(0, std::memory_order_relaxed);
+	}
+
+private:
+	/** Sample storage. Not resized while the producer or the consumer is active */
+	TArray<float> Buffer;
+
+	/** Total number of samples ever written. Modified by the producer only */
+	std::atomic<uint64> WritePosition{0};
+
+	/** Total number of samples ever consumed. Modified by the consumer only */
+	std::atomic<uint64> ReadPosition{0};
+
+	/** Number of samples dropped due to overflow */
+	std::atomic<int64> NumOfDroppedSamples{0};
+};
@@ -6,6 +6,8 @@
 #include "ImportedSoundWave.h"
 #include "Delegates/Delegate.h"
 #include "Containers/Queue.h"
+#include "Codecs/RuntimeStreamingDecoder.h"
+#include "Codecs/RuntimeResampler.h"
 #include "StreamingSoundWave.generated.h"
 
 class URuntimeVoiceActivityDetector;
@@ -63,6 +65,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Streaming Sound Wave|Append")
 	void AppendAudioDataFromEncoded(TArray<uint8> AudioData, ERuntimeAudioFormat AudioFormat);
 
+	/**
+	 * Append a chunk of an encoded audio stream, e.g. as it arrives from a network or pipe
+	 * Unlike AppendAudioDataFromEncoded, the chunk does not have to be a self-contained file and can be split at any byte
+	 * The data is decoded incrementally, so playback can start as soon as the first block is decoded
+	 * Call FinishEncodedStream once all chunks have been appended to decode the remaining data and allow a new stream to be started
+	 *
+	 * @param AudioData Chunk of the encoded audio data
+	 * @param AudioFormat Audio format of the stream. Only used for the first chunk of the stream
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Streaming Sound Wave|Append")
+	void AppendAudioDataFromEncodedStream(TArray<uint8> AudioData, ERuntimeAudioFormat AudioFormat);
+
+	/**
+	 * Finish the encoded audio stream started by AppendAudioDataFromEncodedStream, decoding all remaining data
+	 * Also appends the last few frames held back by the resampler when the appended data had a different sample rate than the sound wave
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Streaming Sound Wave|Append")
+	void FinishEncodedStream();
+
 	/**
 	 * Append audio data to the end of existing data from RAW audio data
 	 *
@@ -119,6 +140,43 @@ protected:
 	/** The audio task pipe (enforces sequential asynchronous execution of audio tasks as opposed to parallel which is possible with the default async task graph) */
 	TUniquePtr<UE::Tasks::FPipe> AudioTaskPipe;
 
+	/**
+	 * Decode all frames of the encoded stream that can be decoded with the data received so far
+	 */
+	void DecodeEncodedStream();
+
+	/**
+	 * Append decoded audio data to the PCM buffer, resampling and mixing it to the format of the sound wave if necessary
+	 *
+	 * @param DecodedAudioInfo Decoded audio data. May be converted in place
+	 * @return Whether the audio data was appended or not
+	 */
+	bool AppendDecodedAudio_Internal(FDecodedAudioStruct& DecodedAudioInfo);
+
+	/**
+	 * Append the frames held back by the append resampler to the PCM buffer and reset the resampler. Must be called with DataGuard locked
+	 */
+	void FlushAppendResampler_Internal();
+
+	/**
+	 * Broadcast the populate audio data delegates for appended audio data
+	 *
+	 * @param PopulatedPCMData The appended PCM data. Copied only if the delegates broadcasting the audio data are bound
+	 */
+	void BroadcastPopulatedAudioData_Internal(TArrayView<const float> PopulatedPCMData);
+
+	/** Encoded stream data received via AppendAudioDataFromEncodedStream. Accessed only from the audio task pipe */
+	TSharedPtr<FRuntimeAudioMemoryStreamSource, ESPMode::ThreadSafe> EncodedStreamSource;
+
+	/** Decoder of the encoded stream, created once the format is known. Accessed only from the audio task pipe */
+	TUniquePtr<FRuntimeStreamingDecoder> EncodedStreamDecoder;
+
+	/** Format of the encoded stream */
+	ERuntimeAudioFormat EncodedStreamFormat = ERuntimeAudioFormat::Invalid;
+
+	/** Resampler converting appended data to the sample rate of the sound wave. Kept between appends, so consecutive chunks are resampled seamlessly. Guarded by DataGuard */
+	FRuntimeResampler AppendResampler;
+
 	/** The VAD (Voice Activity Detector) instance. Is valid only if VAD is enabled (see ToggleVAD) */
 	UPROPERTY(Transient, BlueprintReadOnly, Category = "Streaming Sound Wave|VAD")
 	URuntimeVoiceActivityDetector* VADInstance;
@@ -15,19 +15,27 @@
 // Sound generator support is only available in UE 5.0 and later
 #define WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT !UE_VERSION_OLDER_THAN(5, 0, 0)
 
+class ISubmixBufferListener;
 
 /**
  * Sound wave that captures audio data using a synth component.
  * This class is capable of working with any derived class of USynthComponent, but it has been thoroughly tested with UPixelStreamingAudioComponent.
+ * The audio is pulled from the synth on the audio render thread once per buffer of the main submix, so the capture follows the audio clock rather than the game tick.
  */
 UCLASS(BlueprintType, Category = "Synth Based Sound Wave")
 class RUNTIMEAUDIOIMPORTER_API USynthBasedSoundWave : public UCapturableSoundWave, public FTickableGameObject
 {
 	GENERATED_BODY()
 
+	friend class FSynthBasedSoundWaveSubmixListener;
+
 public:
 	USynthBasedSoundWave(const FObjectInitializer& ObjectInitializer);
 
+	//~ Begin UImportedSoundWave Interface
+	virtual void BeginDestroy() override;
+	//~ End UImportedSoundWave Interface
+
 	/**
 	 * Create a new instance of the synth-based sound wave.
 	 *
@@ -90,4 +98,42 @@ protected:
 
 	/** Whether the sound wave is currently capturing audio */
 	std::atomic<bool> bCapturing{ false };
+
+	/**
+	 * Pull the audio generated by the synth and write it to the capture buffer
+	 * Called on the audio render thread for every buffer rendered by the main submix
+	 *
+	 * @param NumOfMixerFrames Number of frames rendered by the mixer
+	 * @param MixerSampleRate Sample rate of the mixer
+	 */
+	void PullSynthAudio_Internal(int32 NumOfMixerFrames, int32 MixerSampleRate);
+
+#if WITH_RUNTIMEAUDIOIMPORTER_SYNTH_SOUND_GENERATOR_SUPPORT
+	/** Listener of the main submix driving the capture. Kept alive for the lifetime of the sound wave, since the mixer releases it asynchronously */
+	TSharedPtr<ISubmixBufferListener, ESPMode::ThreadSafe> SubmixListener;
+
+	/**
+	 * Register or unregister the submix listener with the audio device of the synth component
+	 *
+	 * @param bRegister Whether to register or unregister the listener
+	 * @return Whether the operation was successful or not
+	 */
+	bool SetSubmixListenerRegistered(bool bRegister);
+#endif
+
+	/** Synth sound the audio is pulled from if there's no sound generator. Set when the capture starts */
+	TWeakObjectPtr<USynthSound> CapturedSynthSound;
+
+	/** Number of channels of the pulled audio. Set when the capture starts */
+	int32 SynthNumOfChannels = 0;
+
+	/** Sample rate of the pulled audio. Set when the capture starts */
+	int32 SynthSampleRate = 0;
+
+	/** Fraction of a synth frame carried over between pulls if the synth and the mixer sample rates differ. Accessed only on the audio render thread */
+	double SynthFrameRemainder = 0;
+
+	/** Buffers the pulled audio is written to, keeping their allocations between pulls. Accessed only on the audio render thread */
+	TArray<float> SynthPCMData;
+	TArray<uint8> SynthAudioData;
 };
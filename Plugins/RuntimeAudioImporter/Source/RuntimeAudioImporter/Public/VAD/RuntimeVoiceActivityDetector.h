@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
+#include "Codecs/RuntimeResampler.h"
 #include "RuntimeVoiceActivityDetector.generated.h"
 
 enum class ERuntimeVADMode : uint8;
@@ -61,10 +62,23 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "Voice Activity Detector Process"), Category = "Voice Activity Detector")
 	bool ProcessVAD(TArray<float> PCMData, UPARAM(DisplayName = "Sample Rate") int32 InSampleRate, int32 NumOfChannels);
 
+	/**
+	 * Calculates a VAD (Voice Activity Detection) decision for an audio frame, reading the PCM data in place. Suitable for use in C++
+	 *
+	 * @param PCMData PCM audio data in 32-bit floating point interleaved format
+	 * @param InSampleRate The sample rate of the provided PCM data
+	 * @param NumOfChannels The number of channels in the provided PCM data
+	 * @return True if the VAD decision was successfully calculated
+	 */
+	bool ProcessVAD(TArrayView<const float> PCMData, int32 InSampleRate, int32 NumOfChannels);
+
 protected:
 	/** The sample rate at which the VAD is currently applied */
 	int32 AppliedSampleRate;
 
+	/** Resampler converting the incoming data to the VAD sample rate. Kept between calls, so consecutive chunks are resampled seamlessly */
+	FRuntimeResampler Resampler;
+
 #if WITH_RUNTIMEAUDIOIMPORTER_VAD_SUPPORT
 	/** The VAD instance. Initialized in the constructor and destroyed in BeginDestroy */
 	FVAD_RuntimeAudioImporter::Fvad* VADInstance;
@@ -33,7 +33,8 @@ public class RuntimeAudioImporter : ModuleRules
 
 		AddEngineThirdPartyPrivateStaticDependencies(Target,
 			"UEOgg",
-			"Vorbis"
+			"Vorbis",
+			"VorbisFile"
 		);
 
 		if (Target.Version.MajorVersion >= 5 && Target.Version.MinorVersion >= 4)
@@ -47,10 +47,8 @@ UObject* UPreImportedSoundFactory::FactoryCreateFile(UClass* InClass, UObject* I
 		return nullptr;
 	}
 
-	FRuntimeBulkDataBuffer<uint8> BulkDataBuffer(AudioData);
-
 	FRuntimeCodecFactory CodecFactory;
-	TArray<FBaseRuntimeCodec*> RuntimeCodecs = CodecFactory.GetCodecs(BulkDataBuffer);
+	TArray<FBaseRuntimeCodec*> RuntimeCodecs = CodecFactory.GetCodecs(FRuntimeAudioDataView(AudioData.GetData(), AudioData.Num()));
 
 	if (RuntimeCodecs.Num() == 0)
 	{
@@ -62,9 +60,7 @@ UObject* UPreImportedSoundFactory::FactoryCreateFile(UClass* InClass, UObject* I
 	for (FBaseRuntimeCodec* RuntimeCodec : RuntimeCodecs)
 	{
 		FRuntimeAudioHeaderInfo HeaderInfo;
-		FEncodedAudioStruct EncodedAudioInfo = FEncodedAudioStruct(BulkDataBuffer, RuntimeCodec->GetAudioFormat());
-	
-		if (!RuntimeCodec->GetHeaderInfo(MoveTemp(EncodedAudioInfo), HeaderInfo))
+		if (!RuntimeCodec->GetHeaderInfo(FEncodedAudioView(AudioData, RuntimeCodec->GetAudioFormat()), HeaderInfo))
 		{
 			ErrorText = FText::Format(LOCTEXT("PreImportedSoundFactory_HeaderError", "Unable to get the header info for the file '{0}'. Make sure the file is not corrupted'"), FText::FromString(Filename));
 			continue;
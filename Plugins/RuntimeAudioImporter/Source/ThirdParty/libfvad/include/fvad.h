@@ -64,6 +64,16 @@ void fvad_reset(Fvad *inst);
 int fvad_set_mode(Fvad* inst, int mode);
 
 
+/*
+ * Enables or disables the SIMD implementations of the filterbank and the GMM
+ * evaluation for a VAD instance. They give bit-identical decisions to the
+ * scalar implementations. SIMD is enabled by default where it is supported.
+ *
+ * Returns 0 on success, or -1 if SIMD is requested but not supported.
+ */
+int fvad_set_simd(Fvad* inst, int enabled);
+
+
 /*
  * Sets the input sample rate in Hz for a VAD instance.
  *
@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include "vad/vad_core.h"
+#include "vad/vad_simd.h"
 
 // valid sample rates in kHz
 static const int valid_rates[] = { 8, 16, 32, 48 };
@@ -69,6 +70,16 @@ int fvad_set_mode(Fvad* inst, int mode)
 }
 
 
+int fvad_set_simd(Fvad* inst, int enabled)
+{
+    assert(inst);
+    if (enabled && !WebRtcVad_SimdAvailable())
+        return -1;
+    inst->core.use_simd = enabled ? 1 : 0;
+    return 0;
+}
+
+
 int fvad_set_sample_rate(Fvad* inst, int sample_rate)
 {
     assert(inst);
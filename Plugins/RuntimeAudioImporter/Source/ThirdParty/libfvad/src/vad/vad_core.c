@@ -11,6 +11,7 @@
 #include "vad_core.h"
 #include "vad_filterbank.h"
 #include "vad_gmm.h"
+#include "vad_simd.h"
 #include "vad_sp.h"
 #include <string.h>
 
@@ -150,6 +151,10 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
   int32_t sum_log_likelihood_ratios = 0;
   int32_t noise_global_mean, speech_global_mean;
   int32_t noise_probability[kNumGaussians], speech_probability[kNumGaussians];
+  // Inputs and outputs of all the Gaussians, noise ones first, then speech.
+  int16_t gaussian_input[2 * kTableSize], gaussian_mean[2 * kTableSize];
+  int16_t gaussian_std[2 * kTableSize], gaussian_delta[2 * kTableSize];
+  int32_t gaussian_probability[2 * kTableSize];
   int16_t overhead1, overhead2, individualTest, totalTest;
 
   // Set various thresholds based on frame lengths (80, 160 or 240 samples).
@@ -182,6 +187,31 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
     //
     // We combine a global LRT with local tests, for each frequency sub-band,
     // here defined as |channel|.
+
+    // The Gaussians don't depend on each other, so they are all evaluated at
+    // once, which lets the SIMD version process them in parallel.
+    for (gaussian = 0; gaussian < kTableSize; gaussian++) {
+      gaussian_input[gaussian] = features[gaussian % kNumChannels];
+      gaussian_input[kTableSize + gaussian] = features[gaussian % kNumChannels];
+    }
+    memcpy(gaussian_mean, self->noise_means, sizeof(self->noise_means));
+    memcpy(gaussian_mean + kTableSize, self->speech_means,
+           sizeof(self->speech_means));
+    memcpy(gaussian_std, self->noise_stds, sizeof(self->noise_stds));
+    memcpy(gaussian_std + kTableSize, self->speech_stds,
+           sizeof(self->speech_stds));
+    if (self->use_simd) {
+      WebRtcVad_GaussianProbabilitiesSimd(gaussian_input, gaussian_mean,
+                                          gaussian_std, 2 * kTableSize,
+                                          gaussian_probability, gaussian_delta);
+    } else {
+      WebRtcVad_GaussianProbabilities(gaussian_input, gaussian_mean,
+                                      gaussian_std, 2 * kTableSize,
+                                      gaussian_probability, gaussian_delta);
+    }
+    memcpy(deltaN, gaussian_delta, sizeof(deltaN));
+    memcpy(deltaS, gaussian_delta + kTableSize, sizeof(deltaS));
+
     for (channel = 0; channel < kNumChannels; channel++) {
       // For each channel we model the probability with a GMM consisting of
       // |kNumGaussians|, with different means and standard deviations depending
@@ -192,19 +222,13 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
         gaussian = channel + k * kNumChannels;
         // Probability under H0, that is, probability of frame being noise.
         // Value given in Q27 = Q7 * Q20.
-        tmp1_s32 = WebRtcVad_GaussianProbability(features[channel],
-                                                 self->noise_means[gaussian],
-                                                 self->noise_stds[gaussian],
-                                                 &deltaN[gaussian]);
+        tmp1_s32 = gaussian_probability[gaussian];
         noise_probability[k] = kNoiseDataWeights[gaussian] * tmp1_s32;
         h0_test += noise_probability[k];  // Q27
 
         // Probability under H1, that is, probability of frame being speech.
         // Value given in Q27 = Q7 * Q20.
-        tmp1_s32 = WebRtcVad_GaussianProbability(features[channel],
-                                                 self->speech_means[gaussian],
-                                                 self->speech_stds[gaussian],
-                                                 &deltaS[gaussian]);
+        tmp1_s32 = gaussian_probability[kTableSize + gaussian];
         speech_probability[k] = kSpeechDataWeights[gaussian] * tmp1_s32;
         h1_test += speech_probability[k];  // Q27
       }
@@ -495,6 +519,7 @@ int WebRtcVad_InitCore(VadInstT* self) {
 
   // Initialization of general struct variables.
   self->vad = 1;  // Speech active (=1).
+  self->use_simd = WebRtcVad_SimdAvailable();
   self->frame_counter = 0;
   self->over_hang = 0;
   self->num_of_speech = 0;
@@ -51,6 +51,9 @@ typedef struct VadInstT_ {
     int16_t feature_vector[kNumChannels];
     int16_t total_power;
 
+    // Use the SIMD versions of the filterbank and the GMM evaluation.
+    int use_simd;
+
     int init_flag;
 } VadInstT;
 
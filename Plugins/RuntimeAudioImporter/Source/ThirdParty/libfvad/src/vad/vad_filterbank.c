@@ -9,6 +9,7 @@
  */
 
 #include "vad_filterbank.h"
+#include "vad_simd.h"
 
 // Constants used in LogOfEnergy().
 static const int16_t kLogConst = 24660;  // 160*log10(2) in Q9.
@@ -104,6 +105,7 @@ static void AllPassFilter(const int16_t* data_in, size_t data_length,
 // Splits |data_in| into |hp_data_out| and |lp_data_out| corresponding to
 // an upper (high pass) part and a lower (low pass) part respectively.
 //
+// - use_simd     [i]   : Use the SIMD version of the LP/HP combination.
 // - data_in      [i]   : Input audio data to be split into two frequency bands.
 // - data_length  [i]   : Length of |data_in|.
 // - upper_state  [i/o] : State of the upper filter, given in Q(-1).
@@ -112,7 +114,8 @@ static void AllPassFilter(const int16_t* data_in, size_t data_length,
 //                        The length is |data_length| / 2.
 // - lp_data_out  [o]   : Output audio data of the lower half of the spectrum.
 //                        The length is |data_length| / 2.
-static void SplitFilter(const int16_t* data_in, size_t data_length,
+static void SplitFilter(int use_simd, const int16_t* data_in,
+                        size_t data_length,
                         int16_t* upper_state, int16_t* lower_state,
                         int16_t* hp_data_out, int16_t* lp_data_out) {
   size_t i;
@@ -128,6 +131,10 @@ static void SplitFilter(const int16_t* data_in, size_t data_length,
                 lp_data_out);
 
   // Make LP and HP signals.
+  if (use_simd) {
+    WebRtcVad_SplitCombineSimd(hp_data_out, lp_data_out, half_length);
+    return;
+  }
   for (i = 0; i < half_length; i++) {
     tmp_out = *hp_data_out;
     *hp_data_out++ -= *lp_data_out;
@@ -138,6 +145,7 @@ static void SplitFilter(const int16_t* data_in, size_t data_length,
 // Calculates the energy of |data_in| in dB, and also updates an overall
 // |total_energy| if necessary.
 //
+// - use_simd     [i]   : Use the SIMD version of the energy calculation.
 // - data_in      [i]   : Input audio data for energy calculation.
 // - data_length  [i]   : Length of input data.
 // - offset       [i]   : Offset value added to |log_energy|.
@@ -146,7 +154,8 @@ static void SplitFilter(const int16_t* data_in, size_t data_length,
 //                        NOTE: |total_energy| is only updated if
 //                        |total_energy| <= |kMinEnergy|.
 // - log_energy   [o]   : 10 * log10("energy of |data_in|") given in Q4.
-static void LogOfEnergy(const int16_t* data_in, size_t data_length,
+static void LogOfEnergy(int use_simd, const int16_t* data_in,
+                        size_t data_length,
                         int16_t offset, int16_t* total_energy,
                         int16_t* log_energy) {
   // |tot_rshifts| accumulates the number of right shifts performed on |energy|.
@@ -158,8 +167,13 @@ static void LogOfEnergy(const int16_t* data_in, size_t data_length,
   RTC_DCHECK(data_in);
   RTC_DCHECK_GT(data_length, 0);
 
-  energy = (uint32_t) WebRtcSpl_Energy((int16_t*) data_in, data_length,
-                                       &tot_rshifts);
+  if (use_simd) {
+    energy = (uint32_t) WebRtcVad_EnergySimd(data_in, data_length,
+                                             &tot_rshifts);
+  } else {
+    energy = (uint32_t) WebRtcSpl_Energy((int16_t*) data_in, data_length,
+                                         &tot_rshifts);
+  }
 
   if (energy != 0) {
     // By construction, normalizing to 15 bits is equivalent with 17 leading
@@ -260,7 +274,8 @@ int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
   RTC_DCHECK_LT(4, kNumChannels - 1);  // Checking maximum |frequency_band|.
 
   // Split at 2000 Hz and downsample.
-  SplitFilter(in_ptr, data_length, &self->upper_state[frequency_band],
+  SplitFilter(self->use_simd, in_ptr, data_length,
+              &self->upper_state[frequency_band],
               &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
 
   // For the upper band (2000 Hz - 4000 Hz) split at 3000 Hz and downsample.
@@ -268,16 +283,19 @@ int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
   in_ptr = hp_120;  // [2000 - 4000] Hz.
   hp_out_ptr = hp_60;  // [3000 - 4000] Hz.
   lp_out_ptr = lp_60;  // [2000 - 3000] Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
+  SplitFilter(self->use_simd, in_ptr, length,
+              &self->upper_state[frequency_band],
               &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
 
   // Energy in 3000 Hz - 4000 Hz.
   length >>= 1;  // |data_length| / 4 <=> bandwidth = 1000 Hz.
 
-  LogOfEnergy(hp_60, length, kOffsetVector[5], &total_energy, &features[5]);
+  LogOfEnergy(self->use_simd, hp_60, length, kOffsetVector[5],
+              &total_energy, &features[5]);
 
   // Energy in 2000 Hz - 3000 Hz.
-  LogOfEnergy(lp_60, length, kOffsetVector[4], &total_energy, &features[4]);
+  LogOfEnergy(self->use_simd, lp_60, length, kOffsetVector[4],
+              &total_energy, &features[4]);
 
   // For the lower band (0 Hz - 2000 Hz) split at 1000 Hz and downsample.
   frequency_band = 2;
@@ -285,42 +303,49 @@ int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
   hp_out_ptr = hp_60;  // [1000 - 2000] Hz.
   lp_out_ptr = lp_60;  // [0 - 1000] Hz.
   length = half_data_length;  // |data_length| / 2 <=> bandwidth = 2000 Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
+  SplitFilter(self->use_simd, in_ptr, length,
+              &self->upper_state[frequency_band],
               &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
 
   // Energy in 1000 Hz - 2000 Hz.
   length >>= 1;  // |data_length| / 4 <=> bandwidth = 1000 Hz.
-  LogOfEnergy(hp_60, length, kOffsetVector[3], &total_energy, &features[3]);
+  LogOfEnergy(self->use_simd, hp_60, length, kOffsetVector[3],
+              &total_energy, &features[3]);
 
   // For the lower band (0 Hz - 1000 Hz) split at 500 Hz and downsample.
   frequency_band = 3;
   in_ptr = lp_60;  // [0 - 1000] Hz.
   hp_out_ptr = hp_120;  // [500 - 1000] Hz.
   lp_out_ptr = lp_120;  // [0 - 500] Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
+  SplitFilter(self->use_simd, in_ptr, length,
+              &self->upper_state[frequency_band],
               &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
 
   // Energy in 500 Hz - 1000 Hz.
   length >>= 1;  // |data_length| / 8 <=> bandwidth = 500 Hz.
-  LogOfEnergy(hp_120, length, kOffsetVector[2], &total_energy, &features[2]);
+  LogOfEnergy(self->use_simd, hp_120, length, kOffsetVector[2],
+              &total_energy, &features[2]);
 
   // For the lower band (0 Hz - 500 Hz) split at 250 Hz and downsample.
   frequency_band = 4;
   in_ptr = lp_120;  // [0 - 500] Hz.
   hp_out_ptr = hp_60;  // [250 - 500] Hz.
   lp_out_ptr = lp_60;  // [0 - 250] Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
+  SplitFilter(self->use_simd, in_ptr, length,
+              &self->upper_state[frequency_band],
               &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
 
   // Energy in 250 Hz - 500 Hz.
   length >>= 1;  // |data_length| / 16 <=> bandwidth = 250 Hz.
-  LogOfEnergy(hp_60, length, kOffsetVector[1], &total_energy, &features[1]);
+  LogOfEnergy(self->use_simd, hp_60, length, kOffsetVector[1],
+              &total_energy, &features[1]);
 
   // Remove 0 Hz - 80 Hz, by high pass filtering the lower band.
   HighPassFilter(lp_60, length, self->hp_filter_state, hp_120);
 
   // Energy in 80 Hz - 250 Hz.
-  LogOfEnergy(hp_120, length, kOffsetVector[0], &total_energy, &features[0]);
+  LogOfEnergy(self->use_simd, hp_120, length, kOffsetVector[0],
+              &total_energy, &features[0]);
 
   return total_energy;
 }
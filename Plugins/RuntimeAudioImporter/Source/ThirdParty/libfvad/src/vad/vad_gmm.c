@@ -79,3 +79,17 @@ int32_t WebRtcVad_GaussianProbability(int16_t input,
   // Q-domain: Q10 * Q10 = Q20.
   return inv_std * exp_value;
 }
+
+void WebRtcVad_GaussianProbabilities(const int16_t* input,
+                                     const int16_t* mean,
+                                     const int16_t* std,
+                                     size_t length,
+                                     int32_t* probability,
+                                     int16_t* delta) {
+  size_t i;
+
+  for (i = 0; i < length; i++) {
+    probability[i] = WebRtcVad_GaussianProbability(input[i], mean[i], std[i],
+                                                   &delta[i]);
+  }
+}
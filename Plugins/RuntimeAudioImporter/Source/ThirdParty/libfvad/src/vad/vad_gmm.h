@@ -36,4 +36,13 @@ int32_t WebRtcVad_GaussianProbability(int16_t input,
                                       int16_t std,
                                       int16_t* delta);
 
+// Calls WebRtcVad_GaussianProbability() for each of the |length| elements of
+// |input|, |mean| and |std|.
+void WebRtcVad_GaussianProbabilities(const int16_t* input,
+                                     const int16_t* mean,
+                                     const int16_t* std,
+                                     size_t length,
+                                     int32_t* probability,
+                                     int16_t* delta);
+
 #endif  // COMMON_AUDIO_VAD_VAD_GMM_H_
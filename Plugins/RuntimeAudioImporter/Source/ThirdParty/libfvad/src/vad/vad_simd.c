@@ -0,0 +1,249 @@
+/*
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree.
+ */
+
+#include "vad_simd.h"
+#include "vad_gmm.h"
+#include "../signal_processing/signal_processing_library.h"
+
+#if WEBRTC_VAD_HAS_SSE2
+#include <emmintrin.h>
+
+// Low 16 bits of (a * b) >> shift for signed 16-bit lanes, 0 < shift < 16.
+// This is what the reference gets by truncating the 32-bit product to int16.
+static __inline __m128i MulShiftW16(__m128i a, __m128i b, int shift) {
+  const __m128i lo = _mm_mullo_epi16(a, b);
+  const __m128i hi = _mm_mulhi_epi16(a, b);
+  return _mm_or_si128(_mm_srl_epi16(lo, _mm_cvtsi32_si128(shift)),
+                      _mm_sll_epi16(hi, _mm_cvtsi32_si128(16 - shift)));
+}
+
+// Low 32 bits of a * b for 32-bit lanes (SSE2 has no _mm_mullo_epi32).
+static __inline __m128i MulLoW32(__m128i a, __m128i b) {
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                    _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Packs two vectors of 32-bit lanes into 16-bit lanes, keeping the low 16
+// bits of each lane like a cast to int16_t does.
+static __inline __m128i WrapToW16(__m128i lo, __m128i hi) {
+  return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16),
+                         _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+
+// Truncating 32-bit division of |num| by |den|. The quotient of two numbers
+// below 2^31 is computed exactly in double precision, so the truncation
+// matches the integer division.
+static __inline __m128i DivW32(__m128i num, __m128i den) {
+  const __m128d lo = _mm_div_pd(_mm_cvtepi32_pd(num), _mm_cvtepi32_pd(den));
+  const __m128d hi = _mm_div_pd(
+      _mm_cvtepi32_pd(_mm_shuffle_epi32(num, _MM_SHUFFLE(1, 0, 3, 2))),
+      _mm_cvtepi32_pd(_mm_shuffle_epi32(den, _MM_SHUFFLE(1, 0, 3, 2))));
+  return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+
+// WebRtcVad_GaussianProbability() for 8 lanes. Returns a bit mask of the lanes
+// the vectorized evaluation doesn't cover (a non-positive |std| or a shift
+// count the reference leaves undefined), which are evaluated by the reference.
+static int GaussianProbability8(const int16_t* input,
+                                const int16_t* mean,
+                                const int16_t* std,
+                                int32_t* probability,
+                                int16_t* delta) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i input_v = _mm_loadu_si128((const __m128i*) input);
+  const __m128i mean_v = _mm_loadu_si128((const __m128i*) mean);
+  const __m128i std_v = _mm_loadu_si128((const __m128i*) std);
+  const __m128i std_lo = _mm_srai_epi32(_mm_unpacklo_epi16(std_v, std_v), 16);
+  const __m128i std_hi = _mm_srai_epi32(_mm_unpackhi_epi16(std_v, std_v), 16);
+  __m128i inv_std, inv_std2, tmp16, delta_v, lo, hi, tmp32_lo, tmp32_hi;
+  __m128i in_range, shift, shift_lo, shift_hi, exp_lo, exp_hi, exp_value;
+  __m128i unsupported;
+
+  // |inv_std| = 1 / s, in Q10.
+  inv_std = WrapToW16(
+      DivW32(_mm_add_epi32(_mm_set1_epi32(131072), _mm_srai_epi32(std_lo, 1)),
+             std_lo),
+      DivW32(_mm_add_epi32(_mm_set1_epi32(131072), _mm_srai_epi32(std_hi, 1)),
+             std_hi));
+
+  // |inv_std2| = 1 / s^2, in Q14.
+  tmp16 = _mm_srai_epi16(inv_std, 2);
+  inv_std2 = MulShiftW16(tmp16, tmp16, 2);
+
+  // x - m, in Q7.
+  tmp16 = _mm_sub_epi16(_mm_slli_epi16(input_v, 3), mean_v);
+
+  // |delta| = (x - m) / s^2, in Q11.
+  delta_v = MulShiftW16(inv_std2, tmp16, 10);
+  _mm_storeu_si128((__m128i*) delta, delta_v);
+
+  // (x - m)^2 / (2 * s^2), in Q10.
+  lo = _mm_mullo_epi16(delta_v, tmp16);
+  hi = _mm_mulhi_epi16(delta_v, tmp16);
+  tmp32_lo = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 9);
+  tmp32_hi = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 9);
+  in_range = _mm_packs_epi32(
+      _mm_cmplt_epi32(tmp32_lo, _mm_set1_epi32(22005)),
+      _mm_cmplt_epi32(tmp32_hi, _mm_set1_epi32(22005)));
+
+  // log2(exp(1)) * tmp32, in Q10, and the exp2() approximation.
+  tmp16 = WrapToW16(
+      _mm_srai_epi32(MulLoW32(tmp32_lo, _mm_set1_epi32(5909)), 12),
+      _mm_srai_epi32(MulLoW32(tmp32_hi, _mm_set1_epi32(5909)), 12));
+  tmp16 = _mm_sub_epi16(zero, tmp16);
+  exp_value = _mm_or_si128(_mm_set1_epi16(0x0400),
+                           _mm_and_si128(tmp16, _mm_set1_epi16(0x03FF)));
+  shift = _mm_add_epi16(
+      _mm_srai_epi16(_mm_xor_si128(tmp16, _mm_set1_epi16(-1)), 10),
+      _mm_set1_epi16(1));
+
+  // |exp_value| >> |shift| per lane. Multiplying by 2^-shift is exact in
+  // single precision for these magnitudes, and truncation floors them.
+  shift_lo = _mm_srai_epi32(_mm_unpacklo_epi16(shift, shift), 16);
+  shift_hi = _mm_srai_epi32(_mm_unpackhi_epi16(shift, shift), 16);
+  exp_lo = _mm_cvttps_epi32(_mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_unpacklo_epi16(exp_value, zero)),
+      _mm_castsi128_ps(_mm_slli_epi32(
+          _mm_sub_epi32(_mm_set1_epi32(127), shift_lo), 23))));
+  exp_hi = _mm_cvttps_epi32(_mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_unpackhi_epi16(exp_value, zero)),
+      _mm_castsi128_ps(_mm_slli_epi32(
+          _mm_sub_epi32(_mm_set1_epi32(127), shift_hi), 23))));
+  exp_value = _mm_and_si128(_mm_packs_epi32(exp_lo, exp_hi), in_range);
+
+  // (1 / s) * exp(-(x - m)^2 / (2 * s^2)), in Q20.
+  lo = _mm_mullo_epi16(inv_std, exp_value);
+  hi = _mm_mulhi_epi16(inv_std, exp_value);
+  _mm_storeu_si128((__m128i*) probability, _mm_unpacklo_epi16(lo, hi));
+  _mm_storeu_si128((__m128i*) (probability + 4), _mm_unpackhi_epi16(lo, hi));
+
+  unsupported = _mm_or_si128(
+      _mm_cmpgt_epi16(_mm_set1_epi16(1), std_v),
+      _mm_and_si128(in_range,
+                    _mm_or_si128(_mm_cmplt_epi16(shift, zero),
+                                 _mm_cmpgt_epi16(shift, _mm_set1_epi16(31)))));
+  return _mm_movemask_epi8(_mm_packs_epi16(unsupported, zero));
+}
+#endif  // WEBRTC_VAD_HAS_SSE2
+
+int WebRtcVad_SimdAvailable(void) {
+  return WEBRTC_VAD_HAS_SSE2;
+}
+
+int32_t WebRtcVad_EnergySimd(const int16_t* vector,
+                             size_t vector_length,
+                             int* scale_factor) {
+#if WEBRTC_VAD_HAS_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  __m128i max_v = _mm_set1_epi16(-1);
+  __m128i energy_v = zero;
+  __m128i shift_v;
+  int16_t smax, sabs, t;
+  int16_t nbits = WebRtcSpl_GetSizeInBits((uint32_t) vector_length);
+  int scaling = 0;
+  int32_t en = 0;
+  size_t i = 0;
+
+  // Same as WebRtcSpl_GetScalingSquare(). The negation wraps around for
+  // -32768 in both versions.
+  for (; i + 8 <= vector_length; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*) (vector + i));
+    max_v = _mm_max_epi16(max_v, _mm_max_epi16(x, _mm_sub_epi16(zero, x)));
+  }
+  max_v = _mm_max_epi16(max_v, _mm_shuffle_epi32(max_v, _MM_SHUFFLE(1, 0, 3, 2)));
+  max_v = _mm_max_epi16(max_v, _mm_shuffle_epi32(max_v, _MM_SHUFFLE(2, 3, 0, 1)));
+  max_v = _mm_max_epi16(max_v, _mm_srli_epi32(max_v, 16));
+  smax = (int16_t) _mm_cvtsi128_si32(max_v);
+  for (; i < vector_length; i++) {
+    sabs = (vector[i] > 0 ? vector[i] : -vector[i]);
+    smax = (sabs > smax ? sabs : smax);
+  }
+  t = WebRtcSpl_NormW32(WEBRTC_SPL_MUL(smax, smax));
+  if (smax != 0) {
+    scaling = (t > nbits) ? 0 : nbits - t;
+  }
+
+  // Each square is shifted before it is accumulated, as in the reference.
+  shift_v = _mm_cvtsi32_si128(scaling);
+  for (i = 0; i + 8 <= vector_length; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*) (vector + i));
+    const __m128i lo = _mm_mullo_epi16(x, x);
+    const __m128i hi = _mm_mulhi_epi16(x, x);
+    energy_v = _mm_add_epi32(energy_v,
+                             _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift_v));
+    energy_v = _mm_add_epi32(energy_v,
+                             _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift_v));
+  }
+  energy_v = _mm_add_epi32(energy_v,
+                           _mm_shuffle_epi32(energy_v, _MM_SHUFFLE(1, 0, 3, 2)));
+  energy_v = _mm_add_epi32(energy_v,
+                           _mm_shuffle_epi32(energy_v, _MM_SHUFFLE(2, 3, 0, 1)));
+  en = _mm_cvtsi128_si32(energy_v);
+  for (; i < vector_length; i++) {
+    en += (vector[i] * vector[i]) >> scaling;
+  }
+  *scale_factor = scaling;
+
+  return en;
+#else
+  return WebRtcSpl_Energy((int16_t*) vector, vector_length, scale_factor);
+#endif
+}
+
+void WebRtcVad_SplitCombineSimd(int16_t* hp_data,
+                                int16_t* lp_data,
+                                size_t length) {
+  size_t i = 0;
+  int16_t tmp_out;
+
+#if WEBRTC_VAD_HAS_SSE2
+  for (; i + 8 <= length; i += 8) {
+    const __m128i hp = _mm_loadu_si128((const __m128i*) (hp_data + i));
+    const __m128i lp = _mm_loadu_si128((const __m128i*) (lp_data + i));
+    _mm_storeu_si128((__m128i*) (hp_data + i), _mm_sub_epi16(hp, lp));
+    _mm_storeu_si128((__m128i*) (lp_data + i), _mm_add_epi16(lp, hp));
+  }
+#endif
+
+  for (; i < length; i++) {
+    tmp_out = hp_data[i];
+    hp_data[i] -= lp_data[i];
+    lp_data[i] += tmp_out;
+  }
+}
+
+void WebRtcVad_GaussianProbabilitiesSimd(const int16_t* input,
+                                         const int16_t* mean,
+                                         const int16_t* std,
+                                         size_t length,
+                                         int32_t* probability,
+                                         int16_t* delta) {
+  size_t i = 0;
+
+#if WEBRTC_VAD_HAS_SSE2
+  int lane;
+  int unsupported;
+
+  for (; i + 8 <= length; i += 8) {
+    unsupported = GaussianProbability8(&input[i], &mean[i], &std[i],
+                                       &probability[i], &delta[i]);
+    for (lane = 0; unsupported != 0; lane++, unsupported >>= 1) {
+      if (unsupported & 1) {
+        probability[i + lane] = WebRtcVad_GaussianProbability(
+            input[i + lane], mean[i + lane], std[i + lane], &delta[i + lane]);
+      }
+    }
+  }
+#endif
+
+  for (; i < length; i++) {
+    probability[i] = WebRtcVad_GaussianProbability(input[i], mean[i], std[i],
+                                                   &delta[i]);
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree.
+ */
+
+// SIMD versions of the data parallel parts of the VAD, used in
+// vad_filterbank.c and vad_core.c. Each function gives results bit-identical
+// to the scalar reference it replaces, and falls back to that reference on
+// platforms without SIMD support.
+
+#ifndef COMMON_AUDIO_VAD_VAD_SIMD_H_
+#define COMMON_AUDIO_VAD_VAD_SIMD_H_
+
+#include "../common.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WEBRTC_VAD_HAS_SSE2 1
+#else
+#define WEBRTC_VAD_HAS_SSE2 0
+#endif
+
+// Returns 1 if the functions below are vectorized on this CPU, 0 otherwise.
+int WebRtcVad_SimdAvailable(void);
+
+// Same as WebRtcSpl_Energy().
+int32_t WebRtcVad_EnergySimd(const int16_t* vector,
+                             size_t vector_length,
+                             int* scale_factor);
+
+// Makes the LP and HP signals of SplitFilter() from the all-pass outputs:
+// |hp_data| -= |lp_data| and |lp_data| += |hp_data| (the original value),
+// both wrapping around in 16 bits.
+void WebRtcVad_SplitCombineSimd(int16_t* hp_data,
+                                int16_t* lp_data,
+                                size_t length);
+
+// Same as calling WebRtcVad_GaussianProbability() for each of the |length|
+// elements of |input|, |mean| and |std|.
+void WebRtcVad_GaussianProbabilitiesSimd(const int16_t* input,
+                                         const int16_t* mean,
+                                         const int16_t* std,
+                                         size_t length,
+                                         int32_t* probability,
+                                         int16_t* delta);
+
+#endif  // COMMON_AUDIO_VAD_VAD_SIMD_H_
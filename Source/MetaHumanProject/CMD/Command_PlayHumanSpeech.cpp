@@ -7,9 +7,44 @@ void UCommad_PlayHumanSpeech::ProcessCommand(const FCommandDescribe& CommandDesc
 {
 	Super::ProcessCommand(CommandDesc);
 
+	//同步路径:直接读取并播放
+	PrepareCommand_AnyThread(CommandDesc);
+	PlaySpeech(CommandDesc);
+	ResetCommand();
+}
+
+void UCommad_PlayHumanSpeech::PrepareCommand_AnyThread(const FCommandDescribe& CommandDesc)
+{
+	//内联音频:载荷整块就是音频时直接引用,否则拷贝所需的片段
+	if (CommandDesc.HasInlinePayload())
+	{
+		bUseWholeInlinePayload = CommandDesc.InlinePayloadOffset == 0 && CommandDesc.InlinePayloadSize == CommandDesc.InlinePayload->Num();
+		if (!bUseWholeInlinePayload)
+		{
+			WavBuffer.Append(CommandDesc.GetInlinePayloadView().GetData(), CommandDesc.InlinePayloadSize);
+		}
+		bLoadedFile = true;
+		return;
+	}
+
 	//查看音频是否存在.
-	TArray<uint8> WavBuffer;
-	bool bLoadedFile = FFileHelper::LoadFileToArray(WavBuffer,*CommandDesc.VoiceSourceFileFullPath);
+	bLoadedFile = FFileHelper::LoadFileToArray(WavBuffer,*CommandDesc.VoiceSourceFileFullPath);
+}
+
+void UCommad_PlayHumanSpeech::ApplyCommand(const FCommandDescribe& CommandDesc)
+{
+	PlaySpeech(CommandDesc);
+}
+
+void UCommad_PlayHumanSpeech::ResetCommand()
+{
+	WavBuffer.Reset();
+	bLoadedFile = false;
+	bUseWholeInlinePayload = false;
+}
+
+void UCommad_PlayHumanSpeech::PlaySpeech(const FCommandDescribe& CommandDesc)
+{
 	if (!bLoadedFile)
 	{
 		return;
@@ -20,6 +55,6 @@ void UCommad_PlayHumanSpeech::ProcessCommand(const FCommandDescribe& CommandDesc
 		return;
 	}
 	
-	MetaHumanPlayerController->PlayHumanSpeech(WavBuffer,CommandDesc.ExpressionType,CommandDesc.AnimationType);
-	
+	const TArray<uint8>& SpeechData = bUseWholeInlinePayload ? *CommandDesc.InlinePayload : WavBuffer;
+	MetaHumanPlayerController->PlayHumanSpeech(SpeechData,CommandDesc.ExpressionType,CommandDesc.AnimationType);
 }
@@ -10,4 +10,17 @@ class UCommad_PlayHumanSpeech : public UCommandBase
 public:
 
 	virtual void ProcessCommand(const FCommandDescribe& CommandDesc) override;
-};
\ No newline at end of file
+
+	//音频文件读取放在后台线程
+	virtual bool HasAsyncPhase() const override { return true; }
+	virtual void PrepareCommand_AnyThread(const FCommandDescribe& CommandDesc) override;
+	virtual void ApplyCommand(const FCommandDescribe& CommandDesc) override;
+	virtual void ResetCommand() override;
+
+private:
+	void PlaySpeech(const FCommandDescribe& CommandDesc);
+
+	TArray<uint8> WavBuffer;
+	bool bLoadedFile = false;
+	bool bUseWholeInlinePayload = false;
+};
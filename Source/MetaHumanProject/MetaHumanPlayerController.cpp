@@ -10,6 +10,10 @@
 #include "GameFramework/GameUserSettings.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "Slate/SceneViewport.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
 
 
 namespace mu
@@ -55,44 +59,18 @@ void AMetaHumanPlayerController::BeginPlay()
 #endif
 	SeqConverterComponent->OnNewSequence.AddUniqueDynamic(this,&AMetaHumanPlayerController::OnSoundSeqFinish);
 
-	TArray<FString> FoundFiles;
-	FString SearchPath = FPaths::ProjectContentDir()+TEXT("Back");
-
-	{
-		TArray<FString> LevelFiles;
-		IFileManager::Get().FindFilesRecursive(LevelFiles, *SearchPath, TEXT("*.png"), true, false);
-		FoundFiles.Append(LevelFiles);
-	}
-	{
-		TArray<FString> LevelFiles;
-		IFileManager::Get().FindFilesRecursive(LevelFiles, *SearchPath, TEXT("*.jpg"), true, false);
-		FoundFiles.Append(LevelFiles);
-	}
-	{
-		TArray<FString> LevelFiles;
-		IFileManager::Get().FindFilesRecursive(LevelFiles, *SearchPath, TEXT("*.jpeg"), true, false);
-		FoundFiles.Append(LevelFiles);
-	}
-	{
-		TArray<FString> LevelFiles;
-		IFileManager::Get().FindFilesRecursive(LevelFiles, *SearchPath, TEXT("*.bmp"), true, false);
-		FoundFiles.Append(LevelFiles);
-	}
-
-	for (auto& File : FoundFiles)
-	{
-		UTexture2D* Tex = LoadTexture2D(File);
-		if (Tex)
-		{
-			LoadedTextures.Emplace(Tex);
-		}
-	}
+	StartBackgroundImageLoading();
 }
 
 void AMetaHumanPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 	SeqConverterComponent->OnNewSequence.RemoveAll(this);
+	if (BackgroundLoadState.IsValid())
+	{
+		BackgroundLoadState->bCancelled = true;
+		BackgroundLoadState.Reset();
+	}
 }
 
 void AMetaHumanPlayerController::TestCommand(const FString& Param)
@@ -158,6 +136,7 @@ void AMetaHumanPlayerController::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 	AdjustViewPortSize();
+	UploadDecodedBackgroundImages();
 	//动作处理.
 	if (LipSystemComponent->IsPlaying())
 	{
@@ -287,57 +266,277 @@ void AMetaHumanPlayerController::OnUnPossess()
 }
 
 UTexture2D* AMetaHumanPlayerController::LoadTexture2D(FString FilePath)
-    {
-        if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath)) //判断文件是否存在
-        {
-            return nullptr; //如果不存在 就返回空
-        }
-
-        // 加载文件数据
-        TArray<uint8> FileData;
-        if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
-        {
-            UE_LOG(LogTemp, Error, TEXT("Failed to load file: %s"), *FilePath);
-            return nullptr;
-        }
-
-        // 获取 ImageWrapper 模块
-        IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-        EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
-        if (ImageFormat == EImageFormat::Invalid)
-        {
-            UE_LOG(LogTemp, Error, TEXT("Invalid image format: %s"), *FilePath);
-            return nullptr;
-        }
-
-        TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
-
-        // 解码图片数据
-        if (ImageWrapper.IsValid() && ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
-        {
-            TArray<uint8> UncompressedBGRA;
-            if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, UncompressedBGRA))
-            {
-                // 创建纹理
-                UTexture2D* Texture = UTexture2D::CreateTransient(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), PF_B8G8R8A8);
-                if (!Texture)
-                {
-                    UE_LOG(LogTemp, Error, TEXT("Failed to create texture"));
-                    return nullptr;
-                }
-
-                // 填充纹理数据
-                void* TextureData = Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-                FMemory::Memcpy(TextureData, UncompressedBGRA.GetData(), UncompressedBGRA.Num());
-                Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
-
-                // 更新纹理资源
-                Texture->UpdateResource();
-                return Texture;
-            }
-        }
-
-        UE_LOG(LogTemp, Error, TEXT("Failed to decode image: %s"), *FilePath);
-        return nullptr;
-    }
-	
\ No newline at end of file
+{
+	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath)) //判断文件是否存在
+	{
+		return nullptr; //如果不存在 就返回空
+	}
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	FDecodedBackgroundImage Image;
+	if (!DecodeImageFile(ImageWrapperModule, FilePath, Image))
+	{
+		return nullptr;
+	}
+	return CreateTextureFromDecodedImage(Image);
+}
+
+UTexture2D* AMetaHumanPlayerController::RequestBackgroundTexture(int32 ImageIndex)
+{
+	if (!BackgroundImagePaths.IsValidIndex(ImageIndex))
+	{
+		return nullptr;
+	}
+
+	if (UTexture2D** Texture = ResidentBackgroundTextures.Find(ImageIndex))
+	{
+		//更新最近使用顺序
+		ResidentBackgroundLRU.Remove(ImageIndex);
+		ResidentBackgroundLRU.Add(ImageIndex);
+		return *Texture;
+	}
+
+	DecodeBackgroundImages({ImageIndex});
+	return nullptr;
+}
+
+void AMetaHumanPlayerController::PrefetchBackgroundTextures(const TArray<int32>& ImageIndices)
+{
+	TArray<int32> MissingIndices;
+	for (const int32 ImageIndex : ImageIndices)
+	{
+		if (BackgroundImagePaths.IsValidIndex(ImageIndex) && !ResidentBackgroundTextures.Contains(ImageIndex))
+		{
+			MissingIndices.AddUnique(ImageIndex);
+		}
+	}
+	DecodeBackgroundImages(MissingIndices);
+}
+
+void AMetaHumanPlayerController::StartBackgroundImageLoading()
+{
+	BackgroundLoadState = MakeShared<FBackgroundImageLoadState, ESPMode::ThreadSafe>();
+	//模块必须在游戏线程加载,工作线程只使用其接口
+	BackgroundLoadState->ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+	const FString SearchPath = FPaths::ProjectContentDir() + TEXT("Back");
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis = MakeWeakObjectPtr(this), LoadState = BackgroundLoadState, SearchPath]()
+	{
+		//一次遍历目录,按扩展名筛选
+		TArray<FString> ImagePaths;
+		IFileManager::Get().IterateDirectoryRecursively(*SearchPath, [&ImagePaths](const TCHAR* Path, bool bIsDirectory)
+		{
+			if (!bIsDirectory)
+			{
+				const FString Extension = FPaths::GetExtension(Path).ToLower();
+				if (Extension == TEXT("png") || Extension == TEXT("jpg") || Extension == TEXT("jpeg") || Extension == TEXT("bmp"))
+				{
+					ImagePaths.Emplace(Path);
+				}
+			}
+			return true;
+		});
+		ImagePaths.Sort();
+
+		if (LoadState->bCancelled)
+		{
+			return;
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, ImagePaths = MoveTemp(ImagePaths)]() mutable
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->OnBackgroundImagesScannedInternal(MoveTemp(ImagePaths));
+			}
+		});
+	});
+}
+
+void AMetaHumanPlayerController::OnBackgroundImagesScannedInternal(TArray<FString>&& ImagePaths)
+{
+	BackgroundImagePaths = MoveTemp(ImagePaths);
+	UE_LOG(LogTemp, Log, TEXT("Found %d background images (lazy loading: %s)"), BackgroundImagePaths.Num(), bLazyLoadBackgrounds ? TEXT("true") : TEXT("false"));
+	OnBackgroundImagesScanned.Broadcast(BackgroundImagePaths.Num());
+
+	if (!bLazyLoadBackgrounds)
+	{
+		TArray<int32> AllIndices;
+		AllIndices.Reserve(BackgroundImagePaths.Num());
+		for (int32 ImageIndex = 0; ImageIndex < BackgroundImagePaths.Num(); ++ImageIndex)
+		{
+			AllIndices.Add(ImageIndex);
+		}
+		DecodeBackgroundImages(AllIndices);
+	}
+}
+
+void AMetaHumanPlayerController::DecodeBackgroundImages(const TArray<int32>& ImageIndices)
+{
+	if (!BackgroundLoadState.IsValid())
+	{
+		return;
+	}
+
+	TArray<TPair<int32, FString>> Jobs;
+	for (const int32 ImageIndex : ImageIndices)
+	{
+		if (BackgroundImagePaths.IsValidIndex(ImageIndex) && !BackgroundImagesInFlight.Contains(ImageIndex))
+		{
+			BackgroundImagesInFlight.Add(ImageIndex);
+			Jobs.Emplace(ImageIndex, BackgroundImagePaths[ImageIndex]);
+		}
+	}
+	if (Jobs.Num() == 0)
+	{
+		return;
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [LoadState = BackgroundLoadState, Jobs = MoveTemp(Jobs)]()
+	{
+		//读取和解码在工作线程并行进行,结果放入队列由游戏线程按预算上传
+		ParallelFor(Jobs.Num(), [&LoadState, &Jobs](int32 JobIndex)
+		{
+			if (LoadState->bCancelled)
+			{
+				return;
+			}
+			FDecodedBackgroundImage Image;
+			DecodeImageFile(*LoadState->ImageWrapperModule, Jobs[JobIndex].Value, Image);
+			//解码失败也要入队,以便游戏线程推进上传顺序
+			Image.ImageIndex = Jobs[JobIndex].Key;
+			LoadState->DecodedImages.Enqueue(MoveTemp(Image));
+		});
+	});
+}
+
+void AMetaHumanPlayerController::UploadDecodedBackgroundImages()
+{
+	if (!BackgroundLoadState.IsValid())
+	{
+		return;
+	}
+
+	FDecodedBackgroundImage Image;
+	while (BackgroundLoadState->DecodedImages.Dequeue(Image))
+	{
+		PendingUploadImages.Add(Image.ImageIndex, MoveTemp(Image));
+	}
+
+	const int64 UploadBudgetBytes = static_cast<int64>(TextureUploadBudgetMBPerFrame) * 1024 * 1024;
+	int64 UploadedBytes = 0;
+	while (PendingUploadImages.Num() > 0 && UploadedBytes < UploadBudgetBytes)
+	{
+		//非按需模式按文件顺序上传,保持LoadedTextures顺序稳定
+		int32 ImageIndex = INDEX_NONE;
+		if (bLazyLoadBackgrounds)
+		{
+			ImageIndex = PendingUploadImages.CreateConstIterator().Key();
+		}
+		else if (PendingUploadImages.Contains(NextOrderedUploadIndex))
+		{
+			ImageIndex = NextOrderedUploadIndex++;
+		}
+		else
+		{
+			break;
+		}
+
+		FDecodedBackgroundImage ReadyImage;
+		PendingUploadImages.RemoveAndCopyValue(ImageIndex, ReadyImage);
+		BackgroundImagesInFlight.Remove(ImageIndex);
+		if (!ReadyImage.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to decode image: %s"), *BackgroundImagePaths[ImageIndex]);
+			continue;
+		}
+
+		UploadedBytes += ReadyImage.BGRA.Num();
+		UTexture2D* Texture = CreateTextureFromDecodedImage(ReadyImage);
+		if (!Texture)
+		{
+			continue;
+		}
+
+		if (!bLazyLoadBackgrounds)
+		{
+			LoadedTextures.Emplace(Texture);
+		}
+		AddResidentBackgroundTexture(ImageIndex, Texture);
+		OnBackgroundTextureLoaded.Broadcast(ImageIndex, Texture);
+	}
+}
+
+void AMetaHumanPlayerController::AddResidentBackgroundTexture(int32 ImageIndex, UTexture2D* Texture)
+{
+	ResidentBackgroundTextures.Add(ImageIndex, Texture);
+	ResidentBackgroundLRU.Remove(ImageIndex);
+	ResidentBackgroundLRU.Add(ImageIndex);
+
+	if (!bLazyLoadBackgrounds)
+	{
+		return;
+	}
+
+	//淘汰最久未使用的纹理,交给GC释放显存
+	while (ResidentBackgroundLRU.Num() > MaxResidentBackgroundTextures)
+	{
+		const int32 EvictedIndex = ResidentBackgroundLRU[0];
+		ResidentBackgroundLRU.RemoveAt(0);
+		ResidentBackgroundTextures.Remove(EvictedIndex);
+	}
+}
+
+bool AMetaHumanPlayerController::DecodeImageFile(IImageWrapperModule& ImageWrapperModule, const FString& FilePath, FDecodedBackgroundImage& OutImage)
+{
+	// 加载文件数据
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to load file: %s"), *FilePath);
+		return false;
+	}
+
+	EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
+	if (ImageFormat == EImageFormat::Invalid)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid image format: %s"), *FilePath);
+		return false;
+	}
+
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+
+	// 解码图片数据
+	if (ImageWrapper.IsValid() && ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
+	{
+		if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutImage.BGRA))
+		{
+			OutImage.Width = ImageWrapper->GetWidth();
+			OutImage.Height = ImageWrapper->GetHeight();
+			return OutImage.IsValid();
+		}
+	}
+
+	UE_LOG(LogTemp, Error, TEXT("Failed to decode image: %s"), *FilePath);
+	return false;
+}
+
+UTexture2D* AMetaHumanPlayerController::CreateTextureFromDecodedImage(const FDecodedBackgroundImage& Image)
+{
+	// 创建纹理
+	UTexture2D* Texture = UTexture2D::CreateTransient(Image.Width, Image.Height, PF_B8G8R8A8);
+	if (!Texture)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to create texture"));
+		return nullptr;
+	}
+
+	// 填充纹理数据
+	void* TextureData = Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(TextureData, Image.BGRA.GetData(), Image.BGRA.Num());
+	Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
+
+	// 更新纹理资源
+	Texture->UpdateResource();
+	return Texture;
+}
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "RuntimeAudioImporterTypes.h"
+#include "Containers/Queue.h"
+#include "Templates/Atomic.h"
 #include "MetaHumanPlayerController.generated.h"
 
 
@@ -40,6 +42,30 @@ public:
 	FOnLipTick OnLipTick;
 };
 
+class IImageWrapperModule;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBackgroundImagesScanned, int32, NumImages);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBackgroundTextureLoaded, int32, ImageIndex, UTexture2D*, Texture);
+
+//工作线程解码后的背景图片,等待在游戏线程上传为纹理
+struct FDecodedBackgroundImage
+{
+	int32 ImageIndex = INDEX_NONE;
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<uint8> BGRA;
+
+	bool IsValid() const { return Width > 0 && Height > 0 && BGRA.Num() == Width * Height * 4; }
+};
+
+//背景图片加载的共享状态,工作线程和游戏线程共同持有
+struct FBackgroundImageLoadState
+{
+	TQueue<FDecodedBackgroundImage, EQueueMode::Mpsc> DecodedImages;
+	TAtomic<bool> bCancelled{false};
+	IImageWrapperModule* ImageWrapperModule = nullptr;
+};
+
 UCLASS()
 class AMetaHumanPlayerController : public APlayerController
 {
@@ -66,6 +92,23 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	UTexture2D* LoadTexture2D(FString FilePath);
+
+	//按需获取背景纹理,未加载时发起异步加载并返回空,加载完成后广播OnBackgroundTextureLoaded
+	UFUNCTION(BlueprintCallable)
+	UTexture2D* RequestBackgroundTexture(int32 ImageIndex);
+
+	//预取一批背景纹理(并行解码)
+	UFUNCTION(BlueprintCallable)
+	void PrefetchBackgroundTextures(const TArray<int32>& ImageIndices);
+
+	UFUNCTION(BlueprintPure)
+	int32 GetNumBackgroundImages() const { return BackgroundImagePaths.Num(); }
+
+	UPROPERTY(BlueprintAssignable)
+	FOnBackgroundImagesScanned OnBackgroundImagesScanned;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnBackgroundTextureLoaded OnBackgroundTextureLoaded;
 	
 protected:
 	UPROPERTY(EditAnywhere)
@@ -100,8 +143,45 @@ protected:
 
 	UPROPERTY(Transient,BlueprintReadOnly)
 	TArray<UTexture2D*> LoadedTextures;
+
+	//背景图片按需加载,开启后启动时不加载全部图片,只保留最近使用的纹理
+	UPROPERTY(EditAnywhere, Category = "Background")
+	bool bLazyLoadBackgrounds = false;
+
+	//按需加载模式下常驻的纹理数量上限
+	UPROPERTY(EditAnywhere, Category = "Background", meta = (ClampMin = "1", EditCondition = "bLazyLoadBackgrounds"))
+	int32 MaxResidentBackgroundTextures = 8;
+
+	//每帧上传纹理的数据量预算(MB),每帧至少上传一张
+	UPROPERTY(EditAnywhere, Category = "Background", meta = (ClampMin = "1"))
+	int32 TextureUploadBudgetMBPerFrame = 32;
+
+	UPROPERTY(Transient,BlueprintReadOnly)
+	TArray<FString> BackgroundImagePaths;
+
+	//已上传的背景纹理,按图片索引
+	UPROPERTY(Transient)
+	TMap<int32, UTexture2D*> ResidentBackgroundTextures;
 private:
 	bool bLipPlay = false;
 
 	void AdjustViewPortSize();
+
+	//背景图片加载
+	void StartBackgroundImageLoading();
+	void OnBackgroundImagesScannedInternal(TArray<FString>&& ImagePaths);
+	void DecodeBackgroundImages(const TArray<int32>& ImageIndices);
+	void UploadDecodedBackgroundImages();
+	void AddResidentBackgroundTexture(int32 ImageIndex, UTexture2D* Texture);
+
+	static bool DecodeImageFile(IImageWrapperModule& ImageWrapperModule, const FString& FilePath, FDecodedBackgroundImage& OutImage);
+	static UTexture2D* CreateTextureFromDecodedImage(const FDecodedBackgroundImage& Image);
+
+	TSharedPtr<FBackgroundImageLoadState, ESPMode::ThreadSafe> BackgroundLoadState;
+	//已解码但尚未按顺序上传的图片(非按需模式下保证LoadedTextures的顺序与文件顺序一致)
+	TMap<int32, FDecodedBackgroundImage> PendingUploadImages;
+	int32 NextOrderedUploadIndex = 0;
+	TSet<int32> BackgroundImagesInFlight;
+	//最近使用顺序,末尾为最近使用
+	TArray<int32> ResidentBackgroundLRU;
 };
\ No newline at end of file
@@ -62,6 +62,29 @@ struct METAHUMANPROJECT_API FSpeechSystemConfig
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Audio", meta = (DisplayName = "缓冲区大小", ClampMin = "240", ClampMax = "4800"))
     int32 BufferSize = 960;
 
+    // 语音合成配置
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "合成语速", ClampMin = "0", ClampMax = "100"))
+    int32 TTSSpeed = 50;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "合成音量", ClampMin = "0", ClampMax = "100"))
+    int32 TTSVolume = 50;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "合成音调", ClampMin = "0", ClampMax = "100"))
+    int32 TTSPitch = 50;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "启用合成缓存"))
+    bool bEnableTTSCache = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "内存缓存条数", ClampMin = "1", ClampMax = "1024"))
+    int32 TTSCacheMemoryEntries = 64;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "磁盘缓存压缩质量", ClampMin = "0", ClampMax = "100"))
+    int32 TTSCacheCompressionQuality = 70;
+
+    // 启动时预先合成并缓存的常用语句（问候语、常见问答等）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TTS", meta = (DisplayName = "预热语句列表"))
+    TArray<FString> TTSPrewarmTexts;
+
     // 调试配置
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (DisplayName = "启用详细日志"))
     bool bEnableVerboseLogging = false;
@@ -1,5 +1,6 @@
 #include "SpeechManager.h"
 #include "SpeechConfig.h"
+#include "SpeechTTSCache.h"
 
 #include <string>
 
@@ -9,6 +10,7 @@
 #include "HAL/PlatformMisc.h"
 #include "Misc/Paths.h"
 #include "Async/TaskGraphInterfaces.h"
+#include "Async/Async.h"
 
 USpeechManager::USpeechManager()
     : bIsSDKInitialized(false)
@@ -34,10 +36,25 @@ void USpeechManager::Initialize(FSubsystemCollectionBase& Collection)
     {
         UE_LOG(LogTemp, Log, TEXT("USpeechManager: Speech SDK initialized successfully"));
     }
+
+    // 语音合成缓存及启动预热
+    const FSpeechSystemConfig& Config = USpeechSystemSettings::Get()->GetConfig();
+    if (Config.bEnableTTSCache)
+    {
+        TTSCache = MakeShared<FSpeechTTSCache, ESPMode::ThreadSafe>(Config.TTSCacheMemoryEntries, Config.TTSCacheCompressionQuality);
+        PrewarmTTSCache(Config.TTSPrewarmTexts, Config.DefaultVoice);
+    }
 }
 
 void USpeechManager::Deinitialize()
 {
+    // 等待预热任务结束，避免在SDK登出后继续访问
+    bStopPrewarm = true;
+    if (PrewarmFuture.IsValid())
+    {
+        PrewarmFuture.Wait();
+    }
+
     // 停止所有语音操作
     if (bIsRecognitionActive)
     {
@@ -250,13 +267,65 @@ bool USpeechManager::SynthesizeText(const FString& Text, const FString& Voice)
         return false;
     }
 
+    if (!TTSCache.IsValid())
+    {
+        return StartSynthesisSession(Text, Voice, FString());
+    }
+
+    const FString CacheKey = MakeTTSCacheKey(Text, Voice);
+
+    // 内存命中：下一帧直接广播，不经过网络
+    TArray<uint8> CachedAudio;
+    if (TTSCache->FindInMemory(CacheKey, CachedAudio))
+    {
+        UE_LOG(LogTemp, Log, TEXT("SpeechManager: TTS cache hit (memory) for text: %s"), *Text);
+        AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), CachedAudio = MoveTemp(CachedAudio)]()
+        {
+            if (WeakThis.IsValid())
+            {
+                WeakThis->OnSpeechSynthesized.Broadcast(CachedAudio);
+            }
+        });
+        return true;
+    }
+
+    if (!TTSCache->Contains(CacheKey))
+    {
+        TTSCache->RecordMiss();
+        return StartSynthesisSession(Text, Voice, CacheKey);
+    }
+
+    // 磁盘命中：后台解码，失败时回退到在线合成
+    AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), Cache = TTSCache, CacheKey, Text, Voice]()
+    {
+        TArray<uint8> DiskAudio;
+        const bool bFound = Cache->FindOnDisk(CacheKey, DiskAudio);
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, bFound, DiskAudio = MoveTemp(DiskAudio), CacheKey, Text, Voice]()
+        {
+            if (!WeakThis.IsValid())
+            {
+                return;
+            }
+            if (bFound)
+            {
+                UE_LOG(LogTemp, Log, TEXT("SpeechManager: TTS cache hit (disk) for text: %s"), *Text);
+                WeakThis->OnSpeechSynthesized.Broadcast(DiskAudio);
+            }
+            else
+            {
+                WeakThis->StartSynthesisSession(Text, Voice, CacheKey);
+            }
+        });
+    });
+    return true;
+}
+
+bool USpeechManager::StartSynthesisSession(const FString& Text, const FString& Voice, const FString& CacheKey)
+{
     FScopeLock Lock(&SynthesisCriticalSection);
 
     // 构造合成参数（参考SDK示例的参数设置）
-    FString SynthesisParams = FString::Printf(
-        TEXT("voice_name = %s, text_encoding = utf8, sample_rate = 16000, speed = 50, volume = 50, pitch = 50, rdn = 2"),
-        *Voice
-    );
+    FString SynthesisParams = BuildSynthesisParams(Voice);
 
     std::string ParamsAnsi = TCHAR_TO_UTF8(*SynthesisParams);
     
@@ -294,67 +363,31 @@ bool USpeechManager::SynthesizeText(const FString& Text, const FString& Voice)
     std::string SessionIDCopy = SessionID;
 
     // 开始获取音频数据（参考SDK示例的循环逻辑）
-    AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [this, SessionIDCopy, Text]()
+    AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [this, SessionIDCopy, Text, CacheKey]()
     {
-        TArray<uint8> CompleteAudioData;
-        FWavePCMHeader WavHeader;
-        // 先添加WAV文件头（暂时数据大小为0）
-        CompleteAudioData.Append((const uint8*)(&WavHeader), sizeof(WavHeader));
-        
-        unsigned int AudioLen = 0;
-        int SynthStatus = MSP_TTS_FLAG_STILL_HAVE_DATA;
-        int ErrorCode = 0;
-        
         UE_LOG(LogTemp, Log, TEXT("SpeechManager: Starting TTS synthesis for text: %s"), *Text);
 
-        // 参考SDK示例的音频获取循环
-        while (SynthStatus == MSP_TTS_FLAG_STILL_HAVE_DATA && bIsSynthesisActive)
+        TArray<uint8> CompleteAudioData;
+        const int ErrorCode = CollectSynthesizedAudio(SessionIDCopy.c_str(), CompleteAudioData, [this]() { return bIsSynthesisActive; });
+        if (ErrorCode != MSP_SUCCESS)
         {
-            const void* AudioData = QTTSAudioGet(SessionIDCopy.c_str(), &AudioLen, &SynthStatus, &ErrorCode);
-            
-            if (ErrorCode != MSP_SUCCESS)
-            {
-                AsyncTask(ENamedThreads::GameThread, [this, ErrorCode]()
-                {
-                    LogSpeechError(ErrorCode, TEXT("QTTSAudioGet"));
-                });
-                break;
-            }
-
-            if (AudioData && AudioLen > 0)
-            {
-                // 添加PCM音频数据到完整缓冲区
-                const uint8* AudioBytes = static_cast<const uint8*>(AudioData);
-                CompleteAudioData.Append(AudioBytes, AudioLen);
-                WavHeader.data_size += AudioLen;
-                
-                UE_LOG(LogTemp, VeryVerbose, TEXT("SpeechManager: Got audio chunk: %d bytes, status: %d"), AudioLen, SynthStatus);
-            }
-            
-            if (SynthStatus == MSP_TTS_FLAG_DATA_END)
+            AsyncTask(ENamedThreads::GameThread, [this, ErrorCode]()
             {
-                UE_LOG(LogTemp, Log, TEXT("SpeechManager: TTS synthesis completed, total audio data: %d bytes"), WavHeader.data_size);
-                break;
-            }
-            
-            // 参考SDK示例的延迟，防止频繁占用CPU
-            FPlatformProcess::Sleep(0.05f); // 50ms
+                LogSpeechError(ErrorCode, TEXT("QTTSAudioGet"));
+            });
+        }
+        else if (TTSCache.IsValid() && !CacheKey.IsEmpty())
+        {
+            TTSCache->Add(CacheKey, CompleteAudioData);
         }
-
-        // 完成WAV文件头设置（参考SDK示例）
-        WavHeader.size_8 = WavHeader.data_size + (sizeof(WavHeader) - 8);
-        
-        // 更新WAV文件头中的大小信息
-        FMemory::Memcpy(CompleteAudioData.GetData() + 4, &WavHeader.size_8, sizeof(WavHeader.size_8));
-        FMemory::Memcpy(CompleteAudioData.GetData() + 40, &WavHeader.data_size, sizeof(WavHeader.data_size));
 
         // 合成完成，回到主线程触发事件
-        AsyncTask(ENamedThreads::GameThread, [this, SessionIDCopy, CompleteAudioData, WavHeader]()
+        AsyncTask(ENamedThreads::GameThread, [this, SessionIDCopy, CompleteAudioData]()
         {
             if (CompleteAudioData.Num() > sizeof(FWavePCMHeader))
             {
                 UE_LOG(LogTemp, Log, TEXT("SpeechManager: TTS synthesis successful - Total size: %d bytes (PCM data: %d bytes)"), 
-                       CompleteAudioData.Num(), WavHeader.data_size);
+                       CompleteAudioData.Num(), CompleteAudioData.Num() - static_cast<int32>(sizeof(FWavePCMHeader)));
                 OnSpeechSynthesized.Broadcast(CompleteAudioData);
             }
             else
@@ -373,6 +406,153 @@ bool USpeechManager::SynthesizeText(const FString& Text, const FString& Voice)
     return true;
 }
 
+int USpeechManager::CollectSynthesizedAudio(const char* SessionID, TArray<uint8>& OutWavData, TFunctionRef<bool()> ShouldContinue)
+{
+    FWavePCMHeader WavHeader;
+    // 先添加WAV文件头（暂时数据大小为0）
+    OutWavData.Reset();
+    OutWavData.Append((const uint8*)(&WavHeader), sizeof(WavHeader));
+    
+    unsigned int AudioLen = 0;
+    int SynthStatus = MSP_TTS_FLAG_STILL_HAVE_DATA;
+    int ErrorCode = MSP_SUCCESS;
+
+    // 参考SDK示例的音频获取循环
+    while (SynthStatus == MSP_TTS_FLAG_STILL_HAVE_DATA && ShouldContinue())
+    {
+        const void* AudioData = QTTSAudioGet(SessionID, &AudioLen, &SynthStatus, &ErrorCode);
+        
+        if (ErrorCode != MSP_SUCCESS)
+        {
+            break;
+        }
+
+        if (AudioData && AudioLen > 0)
+        {
+            // 添加PCM音频数据到完整缓冲区
+            const uint8* AudioBytes = static_cast<const uint8*>(AudioData);
+            OutWavData.Append(AudioBytes, AudioLen);
+            WavHeader.data_size += AudioLen;
+            
+            UE_LOG(LogTemp, VeryVerbose, TEXT("SpeechManager: Got audio chunk: %d bytes, status: %d"), AudioLen, SynthStatus);
+        }
+        
+        if (SynthStatus == MSP_TTS_FLAG_DATA_END)
+        {
+            UE_LOG(LogTemp, Log, TEXT("SpeechManager: TTS synthesis completed, total audio data: %d bytes"), WavHeader.data_size);
+            break;
+        }
+        
+        // 参考SDK示例的延迟，防止频繁占用CPU
+        FPlatformProcess::Sleep(0.05f); // 50ms
+    }
+
+    // 完成WAV文件头设置（参考SDK示例）
+    WavHeader.size_8 = WavHeader.data_size + (sizeof(WavHeader) - 8);
+    
+    // 更新WAV文件头中的大小信息
+    FMemory::Memcpy(OutWavData.GetData() + 4, &WavHeader.size_8, sizeof(WavHeader.size_8));
+    FMemory::Memcpy(OutWavData.GetData() + 40, &WavHeader.data_size, sizeof(WavHeader.data_size));
+
+    return ErrorCode;
+}
+
+void USpeechManager::PrewarmTTSCache(const TArray<FString>& Texts, const FString& Voice)
+{
+    if (!bIsSDKInitialized || !TTSCache.IsValid() || Texts.Num() == 0)
+    {
+        return;
+    }
+
+    if (PrewarmFuture.IsValid() && !PrewarmFuture.IsReady())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SpeechManager: TTS cache prewarm already running"));
+        return;
+    }
+
+    // 在游戏线程上生成键和参数，后台线程只访问SDK和缓存
+    TArray<TPair<FString, FString>> PendingItems;
+    for (const FString& Text : Texts)
+    {
+        const FString CacheKey = MakeTTSCacheKey(Text, Voice);
+        if (!Text.IsEmpty() && !TTSCache->Contains(CacheKey))
+        {
+            PendingItems.Emplace(Text, CacheKey);
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("SpeechManager: Prewarming TTS cache, %d of %d texts need synthesis"), PendingItems.Num(), Texts.Num());
+    if (PendingItems.Num() == 0)
+    {
+        return;
+    }
+
+    bStopPrewarm = false;
+    const std::string ParamsUTF8 = TCHAR_TO_UTF8(*BuildSynthesisParams(Voice));
+    PrewarmFuture = Async(EAsyncExecution::ThreadPool, [this, Cache = TTSCache, PendingItems = MoveTemp(PendingItems), ParamsUTF8]()
+    {
+        int32 NumSynthesized = 0;
+        for (const TPair<FString, FString>& Item : PendingItems)
+        {
+            if (bStopPrewarm)
+            {
+                break;
+            }
+
+            int ErrorCode = 0;
+            const char* SessionID = QTTSSessionBegin(ParamsUTF8.c_str(), &ErrorCode);
+            if (ErrorCode != MSP_SUCCESS || SessionID == nullptr)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("SpeechManager: Prewarm QTTSSessionBegin failed with error code: %d"), ErrorCode);
+                break;
+            }
+
+            const std::string TextUTF8 = TCHAR_TO_UTF8(*Item.Key);
+            ErrorCode = QTTSTextPut(SessionID, TextUTF8.c_str(), TextUTF8.length(), nullptr);
+            if (ErrorCode == MSP_SUCCESS)
+            {
+                TArray<uint8> WavData;
+                ErrorCode = CollectSynthesizedAudio(SessionID, WavData, [this]() { return !bStopPrewarm; });
+                if (ErrorCode == MSP_SUCCESS && !bStopPrewarm)
+                {
+                    Cache->Add(Item.Value, WavData);
+                    ++NumSynthesized;
+                }
+            }
+            QTTSSessionEnd(SessionID, ErrorCode == MSP_SUCCESS ? "Normal" : "PrewarmError");
+
+            if (ErrorCode != MSP_SUCCESS)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("SpeechManager: Prewarm synthesis failed for text: %s (error %d)"), *Item.Key, ErrorCode);
+            }
+        }
+        UE_LOG(LogTemp, Log, TEXT("SpeechManager: TTS cache prewarm finished, %d texts cached. %s"), NumSynthesized, *Cache->GetStats().ToString());
+    });
+}
+
+void USpeechManager::ClearTTSCache(bool bClearDisk)
+{
+    if (TTSCache.IsValid())
+    {
+        TTSCache->Clear(bClearDisk);
+    }
+}
+
+FString USpeechManager::BuildSynthesisParams(const FString& Voice) const
+{
+    const FSpeechSystemConfig& Config = USpeechSystemSettings::Get()->GetConfig();
+    return FString::Printf(
+        TEXT("voice_name = %s, text_encoding = utf8, sample_rate = %d, speed = %d, volume = %d, pitch = %d, rdn = 2"),
+        *Voice, TTSSampleRate, Config.TTSSpeed, Config.TTSVolume, Config.TTSPitch
+    );
+}
+
+FString USpeechManager::MakeTTSCacheKey(const FString& Text, const FString& Voice) const
+{
+    const FSpeechSystemConfig& Config = USpeechSystemSettings::Get()->GetConfig();
+    return FSpeechTTSCache::MakeKey(Text, Voice, Config.TTSSpeed, Config.TTSVolume, Config.TTSPitch, TTSSampleRate);
+}
+
 // 静态回调函数实现
 void USpeechManager::OnRecognitionResult(const char* sessionID, const char* result, int resultLen, int resultStatus, void* userData)
 {
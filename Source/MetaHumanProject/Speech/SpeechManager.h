@@ -4,6 +4,8 @@
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Engine/Engine.h"
 #include "HAL/PlatformFilemanager.h"
+#include "Async/Future.h"
+#include "Templates/Atomic.h"
 
 THIRD_PARTY_INCLUDES_START
 #include "msp_cmn.h"
@@ -37,6 +39,7 @@ struct FWavePCMHeader
 static_assert(sizeof(FWavePCMHeader) == 44, "WAV header must be 44 bytes");
 #pragma pack(pop)
 
+class FSpeechTTSCache;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSpeechRecognized, const FString&, RecognizedText);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSpeechSynthesized, const TArray<uint8>&, SynthesizedAudio);
@@ -79,6 +82,14 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Speech|Synthesis")
     bool SynthesizeText(const FString& Text, const FString& Voice = TEXT("xiaoyan"));
 
+    // 在后台预先合成并缓存常用语句，已缓存的语句会被跳过，不会触发OnSpeechSynthesized
+    UFUNCTION(BlueprintCallable, Category = "Speech|Synthesis")
+    void PrewarmTTSCache(const TArray<FString>& Texts, const FString& Voice = TEXT("xiaoyan"));
+
+    // 清空语音合成缓存
+    UFUNCTION(BlueprintCallable, Category = "Speech|Synthesis")
+    void ClearTTSCache(bool bClearDisk = false);
+
     // 事件委托
     UPROPERTY(BlueprintAssignable, Category = "Speech|Events")
     FOnSpeechRecognized OnSpeechRecognized;
@@ -117,6 +128,19 @@ protected:
     FString GetDefaultAPIKey() const;
     void LogSpeechError(int ErrorCode, const FString& Context);
 
+    // 语音合成参数
+    FString BuildSynthesisParams(const FString& Voice) const;
+    FString MakeTTSCacheKey(const FString& Text, const FString& Voice) const;
+
+    // 拉取合成音频直到结束，返回带WAV头的完整数据，会阻塞，需在后台线程调用
+    static int CollectSynthesizedAudio(const char* SessionID, TArray<uint8>& OutWavData, TFunctionRef<bool()> ShouldContinue);
+
+    // 启动在线合成（缓存未命中时）
+    bool StartSynthesisSession(const FString& Text, const FString& Voice, const FString& CacheKey);
+
+    // 合成采样率，与FWavePCMHeader默认值一致
+    static constexpr int32 TTSSampleRate = 16000;
+
 private:
     // 线程安全
     FCriticalSection RecognitionCriticalSection;
@@ -124,4 +148,11 @@ private:
 
     // 音频缓冲区
     TArray<uint8> SynthesizedAudioBuffer;
+
+    // 语音合成缓存
+    TSharedPtr<FSpeechTTSCache, ESPMode::ThreadSafe> TTSCache;
+
+    // 预热任务
+    TFuture<void> PrewarmFuture;
+    TAtomic<bool> bStopPrewarm{false};
 };
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "SpeechTTSCache.h"
+#include "SpeechManager.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+#include "RuntimeAudioImporterLibrary.h"
+#include "Codecs/RAW_RuntimeCodec.h"
+
+FSpeechTTSCache::FSpeechTTSCache(int32 InMaxMemoryEntries, int32 InCompressionQuality)
+    : CacheDir(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TTSCache")))
+    , CompressionQuality(FMath::Clamp(InCompressionQuality, 0, 100))
+    , MemoryCache(FMath::Max(InMaxMemoryEntries, 1))
+{
+}
+
+FString FSpeechTTSCache::MakeKey(const FString& Text, const FString& Voice, int32 Speed, int32 Volume, int32 Pitch, int32 SampleRate)
+{
+    // 参数全部参与哈希，任一参数变化都视为不同的合成结果
+    const FString KeySource = FString::Printf(TEXT("%s|%s|%d|%d|%d|%d"), *Voice, *Text, Speed, Volume, Pitch, SampleRate);
+    const FTCHARToUTF8 KeySourceUTF8(*KeySource);
+
+    FSHAHash Hash;
+    FSHA1::HashBuffer(KeySourceUTF8.Get(), KeySourceUTF8.Length(), Hash.Hash);
+    return Hash.ToString();
+}
+
+bool FSpeechTTSCache::FindInMemory(const FString& Key, TArray<uint8>& OutWavData)
+{
+    FScopeLock Lock(&MemoryCacheGuard);
+    if (const TArray<uint8>* Cached = MemoryCache.FindAndTouch(Key))
+    {
+        OutWavData = *Cached;
+        MemoryHits.Increment();
+        return true;
+    }
+    return false;
+}
+
+bool FSpeechTTSCache::FindOnDisk(const FString& Key, TArray<uint8>& OutWavData)
+{
+    TArray<uint8> EncodedData;
+    if (!FFileHelper::LoadFileToArray(EncodedData, *GetCacheFilePath(Key), FILEREAD_Silent))
+    {
+        Misses.Increment();
+        return false;
+    }
+
+    FDecodedAudioStruct DecodedAudioInfo;
+    if (!URuntimeAudioImporterLibrary::DecodeAudioData(FEncodedAudioView(EncodedData, ERuntimeAudioFormat::OggVorbis), DecodedAudioInfo))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SpeechTTSCache: Failed to decode cache entry %s, removing it"), *Key);
+        IFileManager::Get().Delete(*GetCacheFilePath(Key), false, false, true);
+        Misses.Increment();
+        return false;
+    }
+
+    // 解码为float PCM后转换回16位WAV，与在线合成的输出格式保持一致
+    const int64 NumOfSamples = DecodedAudioInfo.PCMInfo.PCMData.GetView().Num();
+    int16* Int16Data = nullptr;
+    FRAW_RuntimeCodec::TranscodeRAWData<float, int16>(DecodedAudioInfo.PCMInfo.PCMData.GetView().GetData(), NumOfSamples, Int16Data);
+
+    FWavePCMHeader WavHeader;
+    WavHeader.channels = static_cast<int16>(DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels);
+    WavHeader.samples_per_sec = static_cast<int32>(DecodedAudioInfo.SoundWaveBasicInfo.SampleRate);
+    WavHeader.block_align = WavHeader.channels * sizeof(int16);
+    WavHeader.avg_bytes_per_sec = WavHeader.samples_per_sec * WavHeader.block_align;
+    WavHeader.data_size = static_cast<int32>(NumOfSamples * sizeof(int16));
+    WavHeader.size_8 = WavHeader.data_size + (sizeof(WavHeader) - 8);
+
+    OutWavData.Reset(sizeof(WavHeader) + WavHeader.data_size);
+    OutWavData.Append(reinterpret_cast<const uint8*>(&WavHeader), sizeof(WavHeader));
+    OutWavData.Append(reinterpret_cast<const uint8*>(Int16Data), WavHeader.data_size);
+    FMemory::Free(Int16Data);
+
+    {
+        FScopeLock Lock(&MemoryCacheGuard);
+        MemoryCache.Add(Key, OutWavData);
+    }
+    DiskHits.Increment();
+    return true;
+}
+
+bool FSpeechTTSCache::Contains(const FString& Key) const
+{
+    {
+        FScopeLock Lock(&MemoryCacheGuard);
+        if (MemoryCache.Contains(Key))
+        {
+            return true;
+        }
+    }
+    return FPaths::FileExists(GetCacheFilePath(Key));
+}
+
+void FSpeechTTSCache::Add(const FString& Key, const TArray<uint8>& WavData)
+{
+    if (WavData.Num() <= static_cast<int32>(sizeof(FWavePCMHeader)))
+    {
+        return;
+    }
+
+    {
+        FScopeLock Lock(&MemoryCacheGuard);
+        MemoryCache.Add(Key, WavData);
+    }
+    Stores.Increment();
+
+    // 压缩编码比较耗时，放到后台线程
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis = TWeakPtr<FSpeechTTSCache, ESPMode::ThreadSafe>(AsShared()), Key, WavData]()
+    {
+        const TSharedPtr<FSpeechTTSCache, ESPMode::ThreadSafe> This = WeakThis.Pin();
+        if (This.IsValid() && !This->SaveToDisk(Key, WavData))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("SpeechTTSCache: Failed to write cache entry %s"), *Key);
+        }
+    });
+}
+
+void FSpeechTTSCache::Clear(bool bClearDisk)
+{
+    {
+        FScopeLock Lock(&MemoryCacheGuard);
+        MemoryCache.Empty(MemoryCache.Max());
+    }
+
+    if (bClearDisk)
+    {
+        IFileManager::Get().DeleteDirectory(*CacheDir, false, true);
+    }
+}
+
+FSpeechTTSCacheStats FSpeechTTSCache::GetStats() const
+{
+    FSpeechTTSCacheStats Stats;
+    Stats.MemoryHits = MemoryHits.GetValue();
+    Stats.DiskHits = DiskHits.GetValue();
+    Stats.Misses = Misses.GetValue();
+    Stats.Stores = Stores.GetValue();
+    return Stats;
+}
+
+FString FSpeechTTSCache::GetCacheFilePath(const FString& Key) const
+{
+    return FPaths::Combine(CacheDir, Key + TEXT(".ogg"));
+}
+
+bool FSpeechTTSCache::SaveToDisk(const FString& Key, const TArray<uint8>& WavData) const
+{
+    FWavePCMHeader WavHeader;
+    FMemory::Memcpy(&WavHeader, WavData.GetData(), sizeof(WavHeader));
+    if (WavHeader.bits_per_sample != 16 || WavHeader.channels <= 0 || WavHeader.samples_per_sec <= 0)
+    {
+        return false;
+    }
+
+    const int64 NumOfSamples = FMath::Min<int64>(WavHeader.data_size, WavData.Num() - sizeof(WavHeader)) / sizeof(int16);
+    float* FloatData = nullptr;
+    FRAW_RuntimeCodec::TranscodeRAWData<int16, float>(reinterpret_cast<const int16*>(WavData.GetData() + sizeof(WavHeader)), NumOfSamples, FloatData);
+
+    FDecodedAudioStruct DecodedAudioInfo;
+    DecodedAudioInfo.PCMInfo.PCMData = FRuntimeBulkDataBuffer<float>(FloatData, NumOfSamples);
+    DecodedAudioInfo.PCMInfo.PCMNumOfFrames = NumOfSamples / WavHeader.channels;
+    DecodedAudioInfo.SoundWaveBasicInfo.NumOfChannels = WavHeader.channels;
+    DecodedAudioInfo.SoundWaveBasicInfo.SampleRate = WavHeader.samples_per_sec;
+    DecodedAudioInfo.SoundWaveBasicInfo.Duration = static_cast<float>(DecodedAudioInfo.PCMInfo.PCMNumOfFrames) / WavHeader.samples_per_sec;
+
+    FEncodedAudioStruct EncodedAudioInfo;
+    EncodedAudioInfo.AudioFormat = ERuntimeAudioFormat::OggVorbis;
+    if (!URuntimeAudioImporterLibrary::EncodeAudioData(MoveTemp(DecodedAudioInfo), EncodedAudioInfo, static_cast<uint8>(CompressionQuality)))
+    {
+        return false;
+    }
+
+    // 先写临时文件再重命名，避免读到写了一半的缓存
+    const FString FilePath = GetCacheFilePath(Key);
+    const FString TempFilePath = FilePath + TEXT(".tmp");
+    const TArrayView<const uint8> EncodedView(EncodedAudioInfo.AudioData.GetView().GetData(), static_cast<int32>(EncodedAudioInfo.AudioData.GetView().Num()));
+    if (!FFileHelper::SaveArrayToFile(EncodedView, *TempFilePath))
+    {
+        return false;
+    }
+    return IFileManager::Get().Move(*FilePath, *TempFilePath, true, true);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Templates/SharedPointer.h"
+
+/**
+ * 语音合成缓存统计
+ */
+struct METAHUMANPROJECT_API FSpeechTTSCacheStats
+{
+    int64 MemoryHits = 0;
+    int64 DiskHits = 0;
+    int64 Misses = 0;
+    int64 Stores = 0;
+
+    FString ToString() const
+    {
+        const int64 Lookups = MemoryHits + DiskHits + Misses;
+        return FString::Printf(TEXT("TTS cache: lookups %lld, memory hits %lld, disk hits %lld, misses %lld, stores %lld"),
+            Lookups, MemoryHits, DiskHits, Misses, Stores);
+    }
+};
+
+/**
+ * 语音合成结果缓存
+ * 以 (文本, 发音人, 语速, 音量, 音调, 采样率) 为键缓存合成好的WAV数据
+ * 内存层为LRU，磁盘层使用Vorbis压缩存放在 Saved/TTSCache 下
+ * 线程安全，可在后台线程中查询和写入
+ */
+class METAHUMANPROJECT_API FSpeechTTSCache : public TSharedFromThis<FSpeechTTSCache, ESPMode::ThreadSafe>
+{
+public:
+    explicit FSpeechTTSCache(int32 InMaxMemoryEntries, int32 InCompressionQuality);
+
+    // 生成缓存键
+    static FString MakeKey(const FString& Text, const FString& Voice, int32 Speed, int32 Volume, int32 Pitch, int32 SampleRate);
+
+    // 仅查询内存层，命中时可直接播放
+    bool FindInMemory(const FString& Key, TArray<uint8>& OutWavData);
+
+    // 查询磁盘层并解码，会阻塞，需在后台线程调用。命中后提升到内存层
+    bool FindOnDisk(const FString& Key, TArray<uint8>& OutWavData);
+
+    // 是否存在缓存（内存或磁盘）
+    bool Contains(const FString& Key) const;
+
+    // 记录一次未命中（内存和磁盘都没有）
+    void RecordMiss() { Misses.Increment(); }
+
+    // 写入内存层，磁盘层的压缩写入在后台线程进行
+    void Add(const FString& Key, const TArray<uint8>& WavData);
+
+    // 清空缓存
+    void Clear(bool bClearDisk);
+
+    FSpeechTTSCacheStats GetStats() const;
+
+private:
+    FString GetCacheFilePath(const FString& Key) const;
+    bool SaveToDisk(const FString& Key, const TArray<uint8>& WavData) const;
+
+    FString CacheDir;
+    int32 CompressionQuality;
+
+    mutable FCriticalSection MemoryCacheGuard;
+    TLruCache<FString, TArray<uint8>> MemoryCache;
+
+    FThreadSafeCounter64 MemoryHits;
+    FThreadSafeCounter64 DiskHits;
+    FThreadSafeCounter64 Misses;
+    FThreadSafeCounter64 Stores;
+};
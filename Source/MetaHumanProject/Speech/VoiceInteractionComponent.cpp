@@ -332,6 +332,12 @@ bool UVoiceInteractionComponent::StartAudioCapture()
         return true;
     }
 
+    // 非设备来源不经过UE音频捕获
+    if (CustomCaptureSource || CaptureSourceType != EVoiceCaptureSourceType::Device)
+    {
+        return StartCaptureSourceCapture();
+    }
+
     // 首先尝试UE原生音频捕获，如果失败则尝试备选方案
     return StartUEAudioCapture();
 }
@@ -343,6 +349,12 @@ bool UVoiceInteractionComponent::StopAudioCapture()
         return true;
     }
 
+    if (ActiveCaptureSource)
+    {
+        bIsAudioCapturing = false;
+        return StopCaptureSourceCapture();
+    }
+
     // 尝试停止UE音频捕获，如果失败则尝试停止备选方案
     bool result = StopUEAudioCapture();
     if (!result)
@@ -357,6 +369,13 @@ bool UVoiceInteractionComponent::StopAudioCapture()
 void UVoiceInteractionComponent::OnSpeechRecognizedInternal(const FString& RecognizedText)
 {
     UE_LOG(LogTemp, Warning, TEXT("VoiceInteractionComponent: *** RECOGNITION RESULT RECEIVED *** : %s"), *RecognizedText);
+
+    // 端到端延迟：从最后一次送入识别的音频到收到识别结果
+    LastRecognitionResultTime = FPlatformTime::Seconds();
+    if (LastSpeechDataSentTime > 0.0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VoiceInteractionComponent: Recognition latency %.1f ms after the last audio sent"), (LastRecognitionResultTime - LastSpeechDataSentTime) * 1000.0);
+    }
     
     // 广播识别结果
     OnRecognitionResult.Broadcast(RecognizedText);
@@ -436,6 +455,12 @@ void UVoiceInteractionComponent::OnSpeechRecognizedInternal(const FString& Recog
 void UVoiceInteractionComponent::OnSpeechSynthesizedInternal(const TArray<uint8>& SynthesizedAudio)
 {
     UE_LOG(LogTemp, Log, TEXT("VoiceInteractionComponent: Synthesis complete, audio size: %d bytes"), SynthesizedAudio.Num());
+
+    // 端到端延迟：从识别结果到合成完成
+    if (LastRecognitionResultTime > 0.0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VoiceInteractionComponent: Synthesis completed %.1f ms after the recognition result"), (FPlatformTime::Seconds() - LastRecognitionResultTime) * 1000.0);
+    }
     
     bIsSpeaking = false;
 
@@ -726,6 +751,7 @@ void UVoiceInteractionComponent::SendAudioToSpeechRecognition(const TArray<float
     // 发送到语音识别
     if (ConvertedData.Num() > 0)
     {
+        LastSpeechDataSentTime = CurrentTime;
         SpeechManager->WriteSpeechData(ConvertedData);
     }
 }
@@ -1205,6 +1231,89 @@ bool UVoiceInteractionComponent::StopSimpleAudioCapture()
     UE_LOG(LogTemp, Log, TEXT("VoiceInteractionComponent: Simple audio capture stopped"));
     return true;
 }
+
+// 非设备来源的音频捕获实现
+bool UVoiceInteractionComponent::StartCaptureSourceCapture()
+{
+    TSharedPtr<IRuntimeAudioCaptureSource> CaptureSource = CustomCaptureSource;
+    LoopbackCaptureSource.Reset();
+    if (!CaptureSource)
+    {
+        switch (CaptureSourceType)
+        {
+        case EVoiceCaptureSourceType::File:
+            CaptureSource = MakeShared<FRuntimeFileCaptureSource>(CaptureSourceFilePath, CaptureSourceSpeed, bLoopCaptureSourceFile);
+            break;
+        case EVoiceCaptureSourceType::Tone:
+        {
+            // 合成音以突发和停顿交替模拟说话，直接生成语音识别使用的16kHz单声道
+            FRuntimeSyntheticCaptureSourceSettings Settings;
+            Settings.SampleRate = 16000;
+            Settings.NumOfChannels = 1;
+            Settings.BurstDuration = 1.5f;
+            Settings.PauseDuration = 1.0f;
+            CaptureSource = MakeShared<FRuntimeSyntheticCaptureSource>(Settings, CaptureSourceSpeed);
+            break;
+        }
+        case EVoiceCaptureSourceType::Loopback:
+            LoopbackCaptureSource = MakeShared<FRuntimeLoopbackCaptureSource>(16000, 1, CaptureSourceSpeed);
+            CaptureSource = LoopbackCaptureSource;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    // 与UE音频捕获共用同一处理路径
+    if (!CaptureSource->OpenStream([this](const float* AudioData, int32 NumFrames, int32 NumChannels, int32 SampleRate)
+    {
+        OnNativeAudioData(AudioData, NumFrames, NumChannels, SampleRate);
+    }))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VoiceInteractionComponent: Failed to open capture source %s"), *CaptureSource->GetDescription());
+        LoopbackCaptureSource.Reset();
+        return false;
+    }
+
+    SetupResampling(CaptureSource->GetSampleRate(), CaptureSource->GetNumOfChannels());
+
+    if (!CaptureSource->StartStream())
+    {
+        UE_LOG(LogTemp, Error, TEXT("VoiceInteractionComponent: Failed to start capture source %s"), *CaptureSource->GetDescription());
+        CaptureSource->CloseStream();
+        LoopbackCaptureSource.Reset();
+        return false;
+    }
+
+    ActiveCaptureSource = CaptureSource;
+    bIsAudioCapturing = true;
+    UE_LOG(LogTemp, Warning, TEXT("VoiceInteractionComponent: Audio capture started from %s, speed %.2f"), *CaptureSource->GetDescription(), CaptureSourceSpeed);
+    return true;
+}
+
+bool UVoiceInteractionComponent::StopCaptureSourceCapture()
+{
+    if (ActiveCaptureSource)
+    {
+        ActiveCaptureSource->CloseStream();
+        UE_LOG(LogTemp, Log, TEXT("VoiceInteractionComponent: Stopped audio capture from %s"), *ActiveCaptureSource->GetDescription());
+        ActiveCaptureSource.Reset();
+    }
+    LoopbackCaptureSource.Reset();
+    return true;
+}
+
+bool UVoiceInteractionComponent::PushLoopbackAudio(const TArray<float>& AudioData)
+{
+    if (!LoopbackCaptureSource)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VoiceInteractionComponent: Unable to push loopback audio as no loopback capture source is active"));
+        return false;
+    }
+
+    LoopbackCaptureSource->PushAudio(AudioData);
+    return true;
+}
 void UVoiceInteractionComponent::SetupResampling(int32 SampleRate, int32 NumChannels)
 {
     // 语音识别只支持16000Hz采样率和单声道
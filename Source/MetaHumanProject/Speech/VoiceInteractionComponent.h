@@ -7,6 +7,7 @@
 #include "Sound/SoundWave.h"
 #include "VAD/RuntimeVoiceActivityDetector.h"
 #include "RuntimeAudioImporterTypes.h"
+#include "Sound/RuntimeAudioCaptureSource.h"
 
 // UE音频录制支持
 namespace Audio { class FAudioCapture; }
@@ -18,6 +19,18 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVoiceSynthesisComplete, USoundWav
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVoiceError, const FString&, ErrorMessage);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVoiceActivityChanged, bool, bVoiceDetected);
 
+/**
+ * 音频采集来源 - 非设备来源不依赖麦克风，可在无音频硬件的机器上压力测试和分析整个语音交互流程
+ */
+UENUM(BlueprintType)
+enum class EVoiceCaptureSourceType : uint8
+{
+    Device   UMETA(DisplayName = "输入设备"),
+    File     UMETA(DisplayName = "文件回放"),
+    Tone     UMETA(DisplayName = "合成音"),
+    Loopback UMETA(DisplayName = "进程内回环")
+};
+
 /**
  * 语音交互组件 - 为Actor提供语音交互能力
  * 可以添加到MetaHuman角色上实现语音对话功能
@@ -76,6 +89,13 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Voice Interaction|Audio")
     bool StopAudioCapture();
 
+    // 设置自定义音频采集来源（仅C++），优先于CaptureSourceType，传入nullptr恢复。下次开始采集时生效
+    void SetCaptureSource(TSharedPtr<IRuntimeAudioCaptureSource> InCaptureSource) { CustomCaptureSource = MoveTemp(InCaptureSource); }
+
+    // 向进程内回环来源推送16kHz单声道音频，仅在回环来源采集中有效
+    UFUNCTION(BlueprintCallable, Category = "Voice Interaction|Audio")
+    bool PushLoopbackAudio(const TArray<float>& AudioData);
+
     // VAD控制
     UFUNCTION(BlueprintCallable, Category = "Voice Interaction|VAD")
     bool InitializeVAD(ERuntimeVADMode Mode = ERuntimeVADMode::Aggressive, int32 SampleRate = 16000);
@@ -129,6 +149,20 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voice Interaction|Settings")
     float VoiceDetectionThreshold = 0.1f;
 
+    // 音频采集来源设置
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voice Interaction|Capture Source")
+    EVoiceCaptureSourceType CaptureSourceType = EVoiceCaptureSourceType::Device;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voice Interaction|Capture Source", meta = (EditCondition = "CaptureSourceType == EVoiceCaptureSourceType::File"))
+    FString CaptureSourceFilePath;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voice Interaction|Capture Source", meta = (EditCondition = "CaptureSourceType == EVoiceCaptureSourceType::File"))
+    bool bLoopCaptureSourceFile = false;
+
+    // 非设备来源的投递速度（相对实时），0表示尽可能快
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voice Interaction|Capture Source", meta = (ClampMin = "0.0"))
+    float CaptureSourceSpeed = 1.0f;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voice Interaction|VAD Settings")
     bool bVADEnabled = true;  
 
@@ -199,6 +233,15 @@ protected:
 
     // 音频捕获 - 使用UE原生音频系统
     Audio::FAudioCapture* AudioCapture;
+
+    // 非设备音频采集来源
+    TSharedPtr<IRuntimeAudioCaptureSource> CustomCaptureSource;
+    TSharedPtr<IRuntimeAudioCaptureSource> ActiveCaptureSource;
+    TSharedPtr<FRuntimeLoopbackCaptureSource> LoopbackCaptureSource;
+
+    // 端到端延迟测量
+    double LastSpeechDataSentTime = 0.0;
+    double LastRecognitionResultTime = 0.0;
     
     TArray<uint8> AudioBuffer;
     
@@ -256,6 +299,10 @@ private:
     // 备选的简单音频捕获（如果UE AudioCapture失败）
     bool StartSimpleAudioCapture();
     bool StopSimpleAudioCapture();
+
+    // 非设备来源的音频捕获（文件回放、合成音、回环）
+    bool StartCaptureSourceCapture();
+    bool StopCaptureSourceCapture();
     
     // UE原生音频数据回调函数
     void OnNativeAudioData(const float* AudioData, int32 NumFrames, int32 NumChannels, int32 SampleRate);